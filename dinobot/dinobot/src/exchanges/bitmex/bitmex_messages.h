@@ -1,4 +1,10 @@
-#include "../../utils/date.h"
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../../libcore/time/iso8601.hpp"
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
@@ -94,23 +100,18 @@ enum class symbol_t : uint16_t
 
 
 
-std::chrono::system_clock::time_point parse_date(std::string ss)
+// "2017-09-02T17:05:49.250000Z" straight to a time_point, the day start is
+// cached per thread so only the time of day is computed for most messages.
+// throws on a malformed or impossible date, eg Feb 31
+std::chrono::system_clock::time_point parse_date(const sajson::value &v)
 {
-    using namespace std::chrono;
-    using namespace date;
-
-    std::stringstream datestr(ss);
-
-#ifdef __APPLE__
-    date::sys_time<std::chrono::microseconds> tp;
-#else
-    date::sys_time<std::chrono::nanoseconds> tp; // mac doesn't seems to have nanos currently
-#endif
+    thread_local dinobot::time::iso8601_parser parser;
 
-    datestr >> date::parse("%FT%T", tp);
-    if (datestr.fail())
-        std::cout << "Could not parse date time string, exiting " << std::endl;
-    return tp;
+    uint64_t nanos = 0;
+    if (!parser.parse(v.as_cstring(), v.get_string_length(), nanos))
+        throw std::runtime_error("Could not parse date time string " + v.as_string() + ", exiting");
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(nanos)));
 }
 
 // {"table":"quote","action":"insert","data":[{"timestamp":"2018-10-06T06:27:22.745Z","symbol":"ETHUSD","bidSize":130388,"bidPrice":225.8,"askPrice":225.85,"askSize":338939}]}
@@ -141,7 +142,7 @@ void parse_quote_insert(const sajson::value &node, uint64_t ts)
         auto quote = datas.get_array_element(i);
         msg.receive_time = ts;
         msg.symbol = symbol_t::XBTUSD; // XXX
-        msg.timestamp = parse_date(quote.get_value_of_key(cache::timestamp).as_string());
+        msg.timestamp = parse_date(quote.get_value_of_key(cache::timestamp));
         msg.bidSize = quote.get_value_of_key(cache::bidsz).get_integer_value();
         msg.bidPrice = get_double_value(quote.get_value_of_key(cache::bidpx));
         msg.askSize = quote.get_value_of_key(cache::asksz).get_integer_value();
@@ -186,7 +187,7 @@ void parse_trade_insert(const sajson::value &node, uint64_t ts)
     	auto trade = datas.get_array_element(i);
         msg.receive_time = ts;
         msg.symbol = symbol_t::XBTUSD; // XXX
-        msg.timestamp = parse_date(trade.get_value_of_key(cache::timestamp).as_string());
+        msg.timestamp = parse_date(trade.get_value_of_key(cache::timestamp));
 	    msg.side = build_side_t(trade, cache::side);
     	msg.size = trade.get_value_of_key(cache::size).get_integer_value();
     	msg.price = get_double_value(trade.get_value_of_key(cache::price));
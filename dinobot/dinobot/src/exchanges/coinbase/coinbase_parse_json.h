@@ -5,6 +5,7 @@
 #include <chrono>
 #include <ostream>
 #include <iostream>
+#include <stdexcept>
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
@@ -12,27 +13,33 @@
 #pragma GCC diagnostic pop
 
 #include "coinbase_messages.h"
+#include "../../libcore/math/decimal.hpp"
+#include "../../libcore/time/iso8601.hpp"
 
 namespace exchange { namespace coinbase { namespace websocket {
 
-    std::chrono::system_clock::time_point parse_date(std::string ss)
+    // "2017-09-02T17:05:49.250000Z" straight to a time_point, the day start is
+    // cached per thread so only the time of day is computed for most messages.
+// throws on a malformed or impossible date, eg Feb 31
+    std::chrono::system_clock::time_point parse_date(const sajson::value &v)
     {
-        using namespace std::chrono;
-        using namespace date;
+        thread_local dinobot::time::iso8601_parser parser;
 
-        std::stringstream datestr(ss);
-
-#ifdef __APPLE__
-        date::sys_time<std::chrono::microseconds> tp;
-#else
-        date::sys_time<std::chrono::nanoseconds> tp; // mac doesn't seems to have nanos currently 
-#endif
-
-        datestr >> date::parse("%FT%T", tp);
-        if (datestr.fail())
-            std::cout << "Could not parse date time string, exiting " << std::endl;
-        return tp;
+        uint64_t nanos = 0;
+        if (!parser.parse(v.as_cstring(), v.get_string_length(), nanos))
+            throw std::runtime_error("Could not parse date time string " + v.as_string() + ", exiting");
+        return std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(nanos)));
+    }
 
+    // prices and sizes come as strings, "4388.01000000", converted in place
+    // without the std::string copy and locale lookup of std::stod
+    double parse_decimal(const sajson::value &v)
+    {
+        double d = 0.0;
+        if (!dinobot::math::parse_double(v.as_cstring(), v.get_string_length(), d))
+            throw std::runtime_error("Could not parse decimal string " + v.as_string() + ", exiting");
+        return d;
     }
 
     const sajson::value is_valid(const sajson::document& doc)
@@ -60,7 +67,7 @@ namespace exchange { namespace coinbase { namespace websocket {
         msg.get_value_of_key(sajson::string("sequence",8)).get_int53_value(&hb.sequence);
         msg.get_value_of_key(sajson::string("last_trade_id",13)).get_int53_value(&hb.last_trade_id);
         hb.product_id = exchange::coinbase::convert_product_id(msg.get_value_of_key(sajson::string("product_id", 10)).as_string());
-        hb.time = parse_date(msg.get_value_of_key(sajson::string("time", 4)).as_string());
+        hb.time = parse_date(msg.get_value_of_key(sajson::string("time", 4)));
     }
 
     // error meesage
@@ -84,13 +91,13 @@ namespace exchange { namespace coinbase { namespace websocket {
         tick.receive_time = std::chrono::system_clock::now();
         msg.get_value_of_key(sajson::string("trade_id",8)).get_int53_value(&tick.trade_id);
         msg.get_value_of_key(sajson::string("sequence",8)).get_int53_value(&tick.sequence);
-        tick.time = parse_date(msg.get_value_of_key(sajson::string("time", 4)).as_string());
+        tick.time = parse_date(msg.get_value_of_key(sajson::string("time", 4)));
         tick.product_id = exchange::coinbase::convert_product_id(msg.get_value_of_key(sajson::string("product_id", 10)).as_string());
-        tick.price = std::stod(msg.get_value_of_key(sajson::string("price",5)).as_string());
+        tick.price = parse_decimal(msg.get_value_of_key(sajson::string("price",5)));
         tick.side = exchange::coinbase::convert_side_type(msg.get_value_of_key(sajson::string("side", 4)).as_string());
-        tick.last_size = std::stod(msg.get_value_of_key(sajson::string("last_size",9)).as_string());
-        tick.best_bid = std::stod(msg.get_value_of_key(sajson::string("best_bid",8)).as_string());
-        tick.best_ask = std::stod(msg.get_value_of_key(sajson::string("best_ask",8)).as_string());
+        tick.last_size = parse_decimal(msg.get_value_of_key(sajson::string("last_size",9)));
+        tick.best_bid = parse_decimal(msg.get_value_of_key(sajson::string("best_bid",8)));
+        tick.best_ask = parse_decimal(msg.get_value_of_key(sajson::string("best_ask",8)));
     }
 
     //{"type": "l2update","product_id": "BTC-EUR","changes": [["buy", "6500.09", "0.84702376"],["sell", "6507.00", "1.88933140"],["sell", "6505.54", "1.12386524"],["sell", "6504.38", "0"]]}
@@ -107,8 +114,8 @@ namespace exchange { namespace coinbase { namespace websocket {
             auto book_update  = changes.get_array_element(i);
             exchange::coinbase::ws_l2_update_book book;
             book.side = exchange::coinbase::convert_side_type(book_update.get_array_element(0).as_string());
-            book.price = std::stod(book_update.get_array_element(1).as_string());
-            book.size = std::stod(book_update.get_array_element(2).as_string());
+            book.price = parse_decimal(book_update.get_array_element(1));
+            book.size = parse_decimal(book_update.get_array_element(2));
             update.changes.push_back(std::move(book));
         }
     }
@@ -127,8 +134,8 @@ namespace exchange { namespace coinbase { namespace websocket {
         {
             auto bid_update = bids.get_array_element(i);
             exchange::coinbase::ws_l2_snapshot_book book;    
-            book.size = std::stod(bid_update.get_array_element(0).as_string());
-            book.price = std::stod(bid_update.get_array_element(1).as_string());
+            book.size = parse_decimal(bid_update.get_array_element(0));
+            book.price = parse_decimal(bid_update.get_array_element(1));
             snapshot.bids.push_back(std::move(book));
         }
 
@@ -139,8 +146,8 @@ namespace exchange { namespace coinbase { namespace websocket {
         {
             auto ask_update = asks.get_array_element(i);
             exchange::coinbase::ws_l2_snapshot_book book;    
-            book.size = std::stod(ask_update.get_array_element(0).as_string());
-            book.price = std::stod(ask_update.get_array_element(1).as_string());
+            book.size = parse_decimal(ask_update.get_array_element(0));
+            book.price = parse_decimal(ask_update.get_array_element(1));
             snapshot.asks.push_back(std::move(book));
         }
     }
@@ -150,11 +157,11 @@ namespace exchange { namespace coinbase { namespace websocket {
     {
         rec.receive_time = std::chrono::system_clock::now();
         rec.product_id = exchange::coinbase::convert_product_id(msg.get_value_of_key(sajson::string("product_id", 10)).as_string());    
-        rec.time = parse_date(msg.get_value_of_key(sajson::string("time", 4)).as_string());
+        rec.time = parse_date(msg.get_value_of_key(sajson::string("time", 4)));
         msg.get_value_of_key(sajson::string("sequence",8)).get_int53_value(&rec.sequence);
         strcpy(rec.order_id, msg.get_value_of_key(sajson::string("order_id",8)).as_cstring());
-        rec.size = std::stod(msg.get_value_of_key(sajson::string("size",4)).as_string());     
-        rec.price = std::stod(msg.get_value_of_key(sajson::string("price",5)).as_string());     
+        rec.size = parse_decimal(msg.get_value_of_key(sajson::string("size",4)));     
+        rec.price = parse_decimal(msg.get_value_of_key(sajson::string("price",5)));     
         rec.side = exchange::coinbase::convert_side_type(msg.get_value_of_key(sajson::string("side", 4)).as_string());
     }
 
@@ -163,7 +170,7 @@ namespace exchange { namespace coinbase { namespace websocket {
     {
         rec.receive_time = std::chrono::system_clock::now();
         rec.product_id = exchange::coinbase::convert_product_id(msg.get_value_of_key(sajson::string("product_id", 10)).as_string());    
-        rec.time = parse_date(msg.get_value_of_key(sajson::string("time", 4)).as_string());
+        rec.time = parse_date(msg.get_value_of_key(sajson::string("time", 4)));
         msg.get_value_of_key(sajson::string("sequence",8)).get_int53_value(&rec.sequence);
         strcpy(rec.order_id, msg.get_value_of_key(sajson::string("order_id",8)).as_cstring());
         rec.side = exchange::coinbase::convert_side_type(msg.get_value_of_key(sajson::string("side", 4)).as_string());
@@ -171,19 +178,19 @@ namespace exchange { namespace coinbase { namespace websocket {
         const sajson::string funds("funds",5);
         const sajson::value res = msg.get_value_of_key(funds);
         if (res.get_type() != sajson::type::TYPE_NULL)
-            rec.funds = std::stod(msg.get_value_of_key(funds).as_string());     
+            rec.funds = parse_decimal(msg.get_value_of_key(funds));     
     }
 
     //{"type": "open","time": "2014-11-07T08:19:27.028459Z","product_id": "BTC-USD","sequence": 10,"order_id": "d50ec984-77a8-460a-b958-66f114b0de9b","price": "200.2","remaining_size": "1.00","side": "sell"}
     void parse_json_full_open(const sajson::value &msg, exchange::coinbase::ws_full_channel_open &open)
     {
         open.receive_time = std::chrono::system_clock::now();
-        open.time =  parse_date(msg.get_value_of_key(sajson::string("time", 4)).as_string());
+        open.time =  parse_date(msg.get_value_of_key(sajson::string("time", 4)));
         open.product_id = exchange::coinbase::convert_product_id(msg.get_value_of_key(sajson::string("product_id", 10)).as_string());
         msg.get_value_of_key(sajson::string("sequence",8)).get_int53_value(&open.sequence);
         strcpy(open.order_id, msg.get_value_of_key(sajson::string("order_id",8)).as_cstring());
-        open.price = std::stod(msg.get_value_of_key(sajson::string("price",5)).as_string());
-        open.remaining_size = std::stod(msg.get_value_of_key(sajson::string("remaining_size",14)).as_string());
+        open.price = parse_decimal(msg.get_value_of_key(sajson::string("price",5)));
+        open.remaining_size = parse_decimal(msg.get_value_of_key(sajson::string("remaining_size",14)));
         open.side = exchange::coinbase::convert_side_type(msg.get_value_of_key(sajson::string("side", 4)).as_string());
     }
 
@@ -192,7 +199,7 @@ namespace exchange { namespace coinbase { namespace websocket {
     void parse_json_full_done(const sajson::value &msg, exchange::coinbase::ws_full_channel_done &done)
     {
         done.receive_time = std::chrono::system_clock::now();
-        done.time = parse_date(msg.get_value_of_key(sajson::string("time", 4)).as_string());
+        done.time = parse_date(msg.get_value_of_key(sajson::string("time", 4)));
         done.product_id = exchange::coinbase::convert_product_id(msg.get_value_of_key(sajson::string("product_id", 10)).as_string());
         msg.get_value_of_key(sajson::string("sequence",8)).get_int53_value(&done.sequence);
         strcpy(done.order_id, msg.get_value_of_key(sajson::string("order_id",8)).as_cstring());
@@ -204,9 +211,9 @@ namespace exchange { namespace coinbase { namespace websocket {
         const sajson::value res1 = msg.get_value_of_key(remaining_size);
         const sajson::value res2 = msg.get_value_of_key(price);
         if (res1.get_type() != sajson::type::TYPE_NULL)
-            done.remaining_size = std::stod(msg.get_value_of_key(sajson::string("remaining_size",14)).as_string());
+            done.remaining_size = parse_decimal(msg.get_value_of_key(sajson::string("remaining_size",14)));
         if (res2.get_type() != sajson::type::TYPE_NULL)
-            done.price = std::stod(msg.get_value_of_key(sajson::string("price",5)).as_string());
+            done.price = parse_decimal(msg.get_value_of_key(sajson::string("price",5)));
     }
 
     //{"type": "match","trade_id": 10,"sequence": 50,"maker_order_id": "ac928c66-ca53-498f-9c13-a110027a60e8","taker_order_id": "132fb6ae-456b-4654-b4e0-d681ac05cea1","time": "2014-11-07T08:19:27.028459Z","product_id": "BTC-USD","size": "5.23512","price": "400.23","side": "sell"}
@@ -217,10 +224,10 @@ namespace exchange { namespace coinbase { namespace websocket {
         msg.get_value_of_key(sajson::string("sequence",8)).get_int53_value(&match.sequence);
         strcpy(match.maker_order_id, msg.get_value_of_key(sajson::string("maker_order_id",14)).as_cstring());
         strcpy(match.taker_order_id, msg.get_value_of_key(sajson::string("taker_order_id",14)).as_cstring());
-        match.time = parse_date(msg.get_value_of_key(sajson::string("time", 4)).as_string());
+        match.time = parse_date(msg.get_value_of_key(sajson::string("time", 4)));
         match.product_id = exchange::coinbase::convert_product_id(msg.get_value_of_key(sajson::string("product_id", 10)).as_string());
-        match.size = std::stod(msg.get_value_of_key(sajson::string("size",4)).as_string());
-        match.price = std::stod(msg.get_value_of_key(sajson::string("price",5)).as_string());
+        match.size = parse_decimal(msg.get_value_of_key(sajson::string("size",4)));
+        match.price = parse_decimal(msg.get_value_of_key(sajson::string("price",5)));
         match.side = exchange::coinbase::convert_side_type(msg.get_value_of_key(sajson::string("side", 4)).as_string());
     }
 
@@ -228,37 +235,37 @@ namespace exchange { namespace coinbase { namespace websocket {
     void parse_json_full_change(const sajson::value &msg, exchange::coinbase::ws_full_channel_change &change)
     {
         change.receive_time = std::chrono::system_clock::now();
-        change.time = parse_date(msg.get_value_of_key(sajson::string("time", 4)).as_string());
+        change.time = parse_date(msg.get_value_of_key(sajson::string("time", 4)));
         msg.get_value_of_key(sajson::string("sequence",8)).get_int53_value(&change.sequence); 
         strcpy(change.order_id, msg.get_value_of_key(sajson::string("order_id",8)).as_cstring());
         change.product_id = exchange::coinbase::convert_product_id(msg.get_value_of_key(sajson::string("product_id", 10)).as_string());
-        change.price = std::stod(msg.get_value_of_key(sajson::string("price",5)).as_string());
+        change.price = parse_decimal(msg.get_value_of_key(sajson::string("price",5)));
         change.side = exchange::coinbase::convert_side_type(msg.get_value_of_key(sajson::string("side", 4)).as_string());
         // change can either have 
         //      new size and old_Size 
         //  or
         //      new_funds and old_funds
         //      TODO this is a bit smeely here ... 
-        change.new_size = std::stod(msg.get_value_of_key(sajson::string("new_size",8)).as_string());
-        change.old_size = std::stod(msg.get_value_of_key(sajson::string("old_size",8)).as_string());
-        change.new_funds = std::stod(msg.get_value_of_key(sajson::string("new_funds",9)).as_string());
-        change.old_funds = std::stod(msg.get_value_of_key(sajson::string("old_funds",9)).as_string());
+        change.new_size = parse_decimal(msg.get_value_of_key(sajson::string("new_size",8)));
+        change.old_size = parse_decimal(msg.get_value_of_key(sajson::string("old_size",8)));
+        change.new_funds = parse_decimal(msg.get_value_of_key(sajson::string("new_funds",9)));
+        change.old_funds = parse_decimal(msg.get_value_of_key(sajson::string("old_funds",9)));
     }
 
     // {"type": "activate","product_id": "test-product","timestamp": "1483736448.299000","user_id": "12","profile_id": "30000727-d308-cf50-7b1c-c06deb1934fc","order_id": "7b52009b-64fd-0a2a-49e6-d8a939753077","stop_type": "entry","side": "buy","stop_price": "80","size": "2","funds": "50","taker_fee_rate": "0.0025","private": true}
     void parse_json_full_activate(const sajson::value &msg, exchange::coinbase::ws_full_channel_margin_activate &activate)
     {
         activate.product_id = exchange::coinbase::convert_product_id(msg.get_value_of_key(sajson::string("product_id", 10)).as_string());        
-        activate.timestamp = std::stod(msg.get_value_of_key(sajson::string("timestamp",9)).as_string());
+        activate.timestamp = parse_decimal(msg.get_value_of_key(sajson::string("timestamp",9)));
         strcpy(activate.user_id, msg.get_value_of_key(sajson::string("user_id",7)).as_cstring());
         strcpy(activate.profile_id, msg.get_value_of_key(sajson::string("profile_id",10)).as_cstring());
         strcpy(activate.order_id, msg.get_value_of_key(sajson::string("order_id",8)).as_cstring());
         activate.stop_of_type = exchange::coinbase::stop_type::entry;
         activate.side = exchange::coinbase::convert_side_type(msg.get_value_of_key(sajson::string("side", 4)).as_string());
-        activate.stop_price = std::stod(msg.get_value_of_key(sajson::string("stop_price",10)).as_string());
-        activate.size = std::stod(msg.get_value_of_key(sajson::string("size",4)).as_string());
-        activate.funds = std::stod(msg.get_value_of_key(sajson::string("funds",5)).as_string());
-        activate.taker_fee_rate = std::stod(msg.get_value_of_key(sajson::string("taker_fee_rate",14)).as_string());
+        activate.stop_price = parse_decimal(msg.get_value_of_key(sajson::string("stop_price",10)));
+        activate.size = parse_decimal(msg.get_value_of_key(sajson::string("size",4)));
+        activate.funds = parse_decimal(msg.get_value_of_key(sajson::string("funds",5)));
+        activate.taker_fee_rate = parse_decimal(msg.get_value_of_key(sajson::string("taker_fee_rate",14)));
         // this last one can either be  true or a false 
         if (msg.get_value_of_key(sajson::string("private",7)).get_type() == sajson::TYPE_TRUE)
             activate.margin_private = true;
@@ -0,0 +1,297 @@
+/*
+ * decimal.hpp
+ *
+ * Purpose: decimal string to double / scaled int64 conversion for feed
+ * handlers. Prices and sizes come in as json strings like "4388.01000000",
+ * this avoids the locale, errno and c_str() copies of strtod/std::stod.
+ *
+ * parse_double is exact: any decimal with at most 19 significant digits and
+ * a value m * 10^e where m <= 2^53 and |e| <= 22 is converted with a single
+ * correctly rounded multiply or divide (Clinger's fast path). Every price and
+ * size the exchanges send falls in there, anything else goes to
+ * std::from_chars, which is locale independent and does not allocate.
+ *
+ * parse_scaled converts straight to an integer count of 10^-decimals units,
+ * ie ticks or lots for an instrument quoted to that many decimals.
+ *
+ * Author:
+ *
+ * Mirror of miye_trading/libcore/math/decimal.hpp, keep the two in sync.
+ */
+
+#pragma once
+
+#include <charconv>
+#include <limits>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace dinobot { namespace math {
+
+namespace detail {
+
+static constexpr double EXACT_POW10[23] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                           1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                           1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+static constexpr uint64_t POW10_U64[20] = {1ULL,
+                                           10ULL,
+                                           100ULL,
+                                           1000ULL,
+                                           10000ULL,
+                                           100000ULL,
+                                           1000000ULL,
+                                           10000000ULL,
+                                           100000000ULL,
+                                           1000000000ULL,
+                                           10000000000ULL,
+                                           100000000000ULL,
+                                           1000000000000ULL,
+                                           10000000000000ULL,
+                                           100000000000000ULL,
+                                           1000000000000000ULL,
+                                           10000000000000000ULL,
+                                           100000000000000000ULL,
+                                           1000000000000000000ULL,
+                                           10000000000000000000ULL};
+
+static constexpr int MAX_DIGITS = 19;
+static constexpr uint64_t MAX_EXACT_MANTISSA = 1ULL << 53;
+
+// decimal split into mantissa * 10^exponent
+struct decimal_t
+{
+    uint64_t mantissa{0};
+    int32_t exponent{0};
+    int32_t digits{0};     // significant digits held in mantissa
+    bool negative{false};
+    bool truncated{false}; // more than MAX_DIGITS significant digits
+};
+
+inline uint64_t load8(const char* p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// true if all 8 bytes of a little endian load are '0'..'9'
+inline bool is_eight_digits(uint64_t v)
+{
+    return ((v & 0xF0F0F0F0F0F0F0F0ULL) | (((v + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ==
+           0x3333333333333333ULL;
+}
+
+// 8 ascii digits to their value in three multiplies
+inline uint32_t parse_eight_digits(uint64_t v)
+{
+    const uint64_t mask = 0x000000FF000000FFULL;
+    const uint64_t mul1 = 100 + (1000000ULL << 32);
+    const uint64_t mul2 = 1 + (10000ULL << 32);
+    v -= 0x3030303030303030ULL;
+    v = (v * 10) + (v >> 8);
+    v = (((v & mask) * mul1) + (((v >> 16) & mask) * mul2)) >> 32;
+    return uint32_t(v);
+}
+
+// accumulates a run of digits into d, returns the first non digit.
+// frac tells whether the digits are after the decimal point.
+inline const char* scan_digits(const char* p, const char* end, decimal_t& d, bool frac)
+{
+    // leading zeros are not significant
+    if (d.digits == 0)
+    {
+        while (p != end && *p == '0')
+        {
+            ++p;
+            d.exponent -= frac;
+        }
+    }
+
+    while (end - p >= 8 && d.digits + 8 <= MAX_DIGITS)
+    {
+        const uint64_t v = load8(p);
+        if (!is_eight_digits(v))
+            break;
+        d.mantissa = d.mantissa * 100000000ULL + parse_eight_digits(v);
+        d.digits += 8;
+        d.exponent -= 8 * frac;
+        p += 8;
+    }
+
+    for (; p != end; ++p)
+    {
+        const unsigned c = uint8_t(*p - '0');
+        if (c > 9)
+            break;
+        if (d.digits < MAX_DIGITS)
+        {
+            d.mantissa = d.mantissa * 10 + c;
+            d.exponent -= frac;
+            if (d.mantissa)
+                ++d.digits;
+        }
+        else
+        {
+            d.truncated |= c != 0;
+            d.exponent += !frac;
+        }
+    }
+    return p;
+}
+
+// parses [-+]digits[.digits][(e|E)[-+]digits] covering the whole range
+inline bool scan_decimal(const char* p, const char* end, decimal_t& d) noexcept
+{
+    if (p == end)
+        return false;
+
+    if (*p == '-' || *p == '+')
+    {
+        d.negative = *p == '-';
+        ++p;
+    }
+
+    const char* start = p;
+    p = scan_digits(p, end, d, false);
+    bool any = p != start;
+
+    if (p != end && *p == '.')
+    {
+        ++p;
+        start = p;
+        p = scan_digits(p, end, d, true);
+        any |= p != start;
+    }
+    if (!any)
+        return false;
+
+    if (p != end && (*p == 'e' || *p == 'E'))
+    {
+        ++p;
+        bool neg = false;
+        if (p != end && (*p == '-' || *p == '+'))
+        {
+            neg = *p == '-';
+            ++p;
+        }
+        if (p == end)
+            return false;
+        int32_t e = 0;
+        for (; p != end; ++p)
+        {
+            const unsigned c = uint8_t(*p - '0');
+            if (c > 9)
+                return false;
+            if (e < 100000)
+                e = e * 10 + int32_t(c);
+        }
+        d.exponent += neg ? -e : e;
+    }
+    return p == end;
+}
+
+// [begin, end) already passed scan_decimal into d
+inline bool from_chars_fallback(const char* begin, const char* end, const decimal_t& d, double& out) noexcept
+{
+    // from_chars takes no leading '+'
+    if (*begin == '+')
+        ++begin;
+    double v;
+    const auto res = std::from_chars(begin, end, v);
+    if (res.ptr != end)
+        return false;
+    if (res.ec == std::errc::result_out_of_range)
+    {
+        // a positive exponent can only overflow, strtod would give inf or 0
+        v = d.exponent > 0 ? std::numeric_limits<double>::infinity() : 0.0;
+        v = d.negative ? -v : v;
+    }
+    out = v;
+    return true;
+}
+
+} // namespace detail
+
+/*
+ * converts the decimal string [begin, end) to a double, correctly rounded.
+ * returns false and leaves out untouched if the string is not a number.
+ */
+inline bool parse_double(const char* begin, const char* end, double& out) noexcept
+{
+    detail::decimal_t d;
+    if (!detail::scan_decimal(begin, end, d))
+        return false;
+
+    if (!d.truncated && d.mantissa <= detail::MAX_EXACT_MANTISSA && d.exponent >= -22 &&
+               d.exponent <= 22)
+    {
+        // both operands are exact so the result is correctly rounded
+        double v = double(d.mantissa);
+        v = d.exponent < 0 ? v / detail::EXACT_POW10[-d.exponent] : v * detail::EXACT_POW10[d.exponent];
+        out = d.negative ? -v : v;
+        return true;
+    }
+    if (d.mantissa == 0)
+    {
+        out = d.negative ? -0.0 : 0.0;
+        return true;
+    }
+    return detail::from_chars_fallback(begin, end, d, out);
+}
+
+inline bool parse_double(const char* str, size_t len, double& out) noexcept
+{
+    return parse_double(str, str + len, out);
+}
+
+/*
+ * converts the decimal string [begin, end) to an integer number of
+ * 10^-decimals units, eg "4388.01" with 2 decimals gives 438801.
+ * returns false if the string is not a number, has non zero digits past
+ * the requested precision or does not fit in an int64.
+ */
+inline bool parse_scaled(const char* begin, const char* end, int32_t decimals, int64_t& out) noexcept
+{
+    detail::decimal_t d;
+    if (!detail::scan_decimal(begin, end, d) || d.truncated)
+        return false;
+
+    if (d.mantissa == 0)
+    {
+        out = 0;
+        return true;
+    }
+
+    const int32_t scale = d.exponent + decimals;
+    uint64_t v = d.mantissa;
+    if (scale >= 0)
+    {
+        if (scale >= 20 || v > uint64_t(INT64_MAX) / detail::POW10_U64[scale])
+            return false;
+        v *= detail::POW10_U64[scale];
+    }
+    else
+    {
+        // only trailing zeros may go past the precision
+        if (-scale >= 20)
+            return false;
+        const uint64_t div = detail::POW10_U64[-scale];
+        if (v % div != 0)
+            return false;
+        v /= div;
+    }
+    if (v > uint64_t(INT64_MAX))
+        return false;
+
+    out = d.negative ? -int64_t(v) : int64_t(v);
+    return true;
+}
+
+inline bool parse_scaled(const char* str, size_t len, int32_t decimals, int64_t& out) noexcept
+{
+    return parse_scaled(str, str + len, decimals, out);
+}
+
+}}
@@ -1,16 +1,22 @@
 /**
  *  TODO PUSHER integration 
  */
+#include <algorithm>
 #include <thread>
 #include <iostream>
 #include "websocket.h"
 
 namespace dinobot { namespace lib { namespace websocket {
 
+// reconnect backoff, doubles on every failed attempt
+static const int reconnect_min_ms = 100;
+static const int reconnect_max_ms = 5000;
+
 websocket::websocket(uint16_t max_con, std::string & ring_fn, int ring_size, int ring_elems, int ring_readers)
     : started_(false)
     , max_subs_per_connection_((!max_con) ? (uint16_t)65535 : max_con )
     , curr_connection_id_(0)
+    , max_reconnect_attempts_(0)
 {
     out_ = std::make_unique<lib::shm::ring_writer>(ring_fn, ring_size, ring_elems, ring_readers);
 }
@@ -76,27 +82,29 @@ void websocket::init()
 
     on_message();
 
-    // loop through connections 
+    // reconnects are scheduled from these, they must be set up once, before run()
+    on_disconnect();
+
+    on_error();
+
+    // loop through connections, a stream gets a socket of its own
     for (auto &u : uri_)
     {
         auto id = u.first;
-        auto uri = u.second;
-        
+
         if (streams_[id].size() > 0)
         {
             for (auto &s: streams_[id])
-            {
-                ws_.connect(s, nullptr); // TODO maybe a better way than this 
-            }
+                targets_.push_back(std::make_unique<connection_target>(connection_target{this, id, s, 0}));
         }
-        else 
+        else
         {
-            ws_.connect(uri, (void *) (uint64_t) id);
+            targets_.push_back(std::make_unique<connection_target>(connection_target{this, id, u.second, 0}));
         }
     }
 
-    // set the dissconnect handler TODO // fix what happens if we get dissconnected
-    on_disconnect();
+    for (auto &target : targets_)
+        ws_.connect(target->uri, target.get());
 
     std::cout << "starting to run the websocket server" << std::endl;
     ws_.run();
@@ -106,8 +114,10 @@ void websocket::on_connection()
 {
     ws_.onConnection([&subscriptions_ = subscriptions_, &uri_ = uri_](uWS::WebSocket<uWS::CLIENT> *ws, uWS::HttpRequest req) {
         (void)req;
-        auto conn_type = (uint32_t) (uint64_t) ws->getUserData();
-        
+        auto target = static_cast<connection_target *>(ws->getUserData());
+        auto conn_type = target->id;
+        target->failures = 0;
+
         for (auto &subs: subscriptions_[conn_type])
         {
             std::cout << "subscribing to " << uri_[conn_type] << " " << subs << std::endl;
@@ -138,15 +148,57 @@ void websocket::on_message()
 void websocket::on_disconnect()
 {
     ws_.onDisconnection([this](uWS::WebSocket<uWS::CLIENT> *ws, int code, char *message, size_t length) {
-        std::cout << "Client got disconnected with data: " << ws->getUserData() << ", code: " << code << ", message: <" << std::string(message, length) << ">" << std::endl;
-        while(true)
-        {
-            std::this_thread::sleep_for(std::chrono::milliseconds(2000));
-            // lets try to init
-            init();
-        }
+        auto target = static_cast<connection_target *>(ws->getUserData());
+        std::cout << "websocket::on_disconnect: " << target->uri << " code: " << code << ", message: <" << std::string(message, length) << ">" << std::endl;
+        reconnect(target);
+    });
+}
+
+void websocket::on_error()
+{
+    // a connect that failed, the user data is what we passed to connect()
+    ws_.onError([this](void *user) {
+        auto target = static_cast<connection_target *>(user);
+        std::cerr << "websocket::on_error: failed to connect to " << target->uri << std::endl;
+        reconnect(target);
     });
 }
 
+/**
+ *  Reconnects the one socket that went away, after a backoff so a feed that
+ *  is down is not hammered. The wait is a timer on the hub's loop, the other
+ *  sockets keep running meanwhile and nothing is set up again: the handlers
+ *  are the ones init() installed and on_connection resubscribes.
+ */
+void websocket::reconnect(connection_target *target)
+{
+    if (max_reconnect_attempts_ && target->failures >= max_reconnect_attempts_)
+    {
+        std::cerr << "websocket::reconnect: giving up on " << target->uri << " after " << target->failures << " attempts" << std::endl;
+        return;
+    }
+
+    int delay_ms = reconnect_min_ms;
+    for (uint32_t i = 0; i < target->failures && delay_ms < reconnect_max_ms; ++i)
+        delay_ms *= 2;
+    delay_ms = std::min(delay_ms, reconnect_max_ms);
+    ++target->failures;
+
+    std::cout << "websocket::reconnect: " << target->uri << " in " << delay_ms << "ms, attempt " << target->failures << std::endl;
+
+    // same as uWS does for its connect timeouts, the timer closes itself when it fires
+    auto timer = new uS::Timer(ws_.getLoop());
+    timer->setData(target);
+    timer->start(&websocket::on_reconnect_timer, delay_ms, 0);
+}
+
+void websocket::on_reconnect_timer(uS::Timer *timer)
+{
+    auto target = static_cast<connection_target *>(timer->getData());
+    timer->stop();
+    timer->close();
+
+    target->owner->ws_.connect(target->uri, target);
+}
 
 }}}// dinobot::lib
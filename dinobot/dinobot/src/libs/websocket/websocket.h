@@ -2,6 +2,7 @@
 #define _DINOBOT_WEBSOCKET_H
 
 #include <map>
+#include <memory>
 #include <vector>
 #include <thread>
 
@@ -29,14 +30,30 @@ public:
     bool add_stream(uint32_t, const std::string &);
     bool add_subscription(uint32_t, const std::string &);
 
+    // 0 (the default) keeps reconnecting forever
+    void set_max_reconnect_attempts(uint32_t n) { max_reconnect_attempts_ = n; }
+
     virtual void start() = 0;
     virtual void unsubscribe() = 0;
     virtual void parse_json(char *, size_t, uint64_t) = 0;
 
 private:
+    // one per socket we open, the uWS user data of that socket so a dropped
+    // socket knows what to reconnect to
+    struct connection_target
+    {
+        websocket * owner;
+        uint32_t id;
+        std::string uri;
+        uint32_t failures;
+    };
+
     void on_connection();
     void on_message();
     void on_disconnect();
+    void on_error();
+    void reconnect(connection_target *);
+    static void on_reconnect_timer(uS::Timer *);
 
 protected:
     void init();
@@ -61,6 +78,9 @@ private:
     // rate limits etc)
     std::map<uint32_t, std::vector<std::string>> streams_;
     std::map<uint32_t, std::vector<std::string>> subscriptions_;
+
+    std::vector<std::unique_ptr<connection_target>> targets_;
+    uint32_t max_reconnect_attempts_;
 };
 
 }}}  // dinobot :: lib ::  websocket
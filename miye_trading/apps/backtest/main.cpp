@@ -0,0 +1,34 @@
+/*
+ * backtest: replays the configured days through the exchange simulator
+ * with a strategy that never trades
+ *
+ * It measures the replay itself, md_events and elapsed_ms per day in the
+ * report show the data coverage and the throughput a real strategy's
+ * backtest starts from. A strategy's own backtest binary is this file with
+ * its class in place of NullStrategy.
+ *
+ * usage: backtest backtest.ini, the ini as in trading/backtest/backtest_main.hpp
+ */
+#include "trading/backtest/backtest_main.hpp"
+
+namespace
+{
+using namespace miye::trading::backtest;
+
+class NullStrategy
+{
+  public:
+    using sink_t = order_sink<miye::time::replay_clock>;
+
+    NullStrategy(const job_t&, const ini::IniFile&) {}
+
+    void on_quote(const message::quote&, sink_t&) {}
+    void on_response(const message::order_msg&, sink_t&) {}
+    void on_end(sink_t&) {}
+};
+} // namespace
+
+int main(int argc, char** argv)
+{
+    return miye::trading::backtest::main<NullStrategy>(argc, argv);
+}
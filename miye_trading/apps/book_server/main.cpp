@@ -0,0 +1,52 @@
+/*
+ * book_server: one set of market data connections for every strategy on the box
+ *
+ * Builds the books with MarketMain and publishes them to shared memory,
+ * strategies read them through a BookClient.
+ *
+ * usage: book_server config.ini
+ *
+ * [global]
+ * symbol_list = BINANCE:FTMUSDT,FTX:FTM-PERP
+ *
+ * [markets.binance] / [markets.ftx] as for perp_ftx
+ *
+ * [book_server]
+ * log_file  = /tmp/book_server.log
+ * shm_name  = /miye_books
+ * ring_size = 65536
+ */
+#include "market_data/book_server.h"
+
+#include <iostream>
+
+namespace
+{
+// books in [global] symbol_list, MarketMain is sized at compile time
+constexpr size_t BookServerSymbols = 2;
+} // namespace
+
+int main(int argc, char** argv)
+{
+    using namespace miye;
+
+    if (argc < 2)
+    {
+        std::cerr << "usage: " << argv[0] << " config.ini" << std::endl;
+        return 1;
+    }
+
+    trading::BookServer<BookServerSymbols> server;
+    auto iniFile = ini::IniFile(argv[1]);
+    server.marketMain.createLogger(iniFile["book_server"]["log_file"].as<std::string>());
+    if (server.init(argv[1]) != 0)
+    {
+        std::cerr << "failed to init book server" << std::endl;
+        return 1;
+    }
+    while (1)
+    {
+        server.poll();
+    }
+    return 0;
+}
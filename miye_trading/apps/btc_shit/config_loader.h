@@ -29,8 +29,8 @@ struct ConfigLoader
         const std::string symbol{"markets.ftx.instrument.shit-perp"};
 
         instrument.symbol           = iniFile[symbol]["symbol"].as<std::string>();
-        instrument.tickSize         = iniFile[symbol]["tick_size"].as<double>();
-        instrument.qtyStep          = iniFile[symbol]["qty_step"].as<double>();
+        instrument.tickSize         = Price::fromDouble(iniFile[symbol]["tick_size"].as<double>());
+        instrument.qtyStep          = Qty::fromDouble(iniFile[symbol]["qty_step"].as<double>());
         instrument.imfFactor        = iniFile[symbol]["imf_factor"].as<double>();
         auto const positionLimitWgt = iniFile[symbol]["position_limit_wgt"];
         if (positionLimitWgt.as<std::string>() != "na")
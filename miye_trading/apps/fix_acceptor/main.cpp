@@ -0,0 +1,202 @@
+/*
+ * fix_acceptor: local stand-in for the FTX FIX endpoint
+ *
+ * Accepts one client session at a time and answers it with a FixAcceptor:
+ * acks, cancels and fills after configurable latencies, against a SimBook
+ * seeded from config and optionally moved by a replayed FTX websocket
+ * capture. Point order_gateway's [fix] endpoint at it for round trip and
+ * throughput tests without an exchange.
+ *
+ * usage: fix_acceptor fix_acceptor.ini
+ *
+ * [log]
+ * log_file = /tmp/fix_acceptor.log
+ *
+ * [acceptor]
+ * endpoint        = tcp_l:127.0.0.1:9880
+ * sender_comp_id  = FTX
+ * ack_latency_us  = 0
+ * fill_latency_us = 0
+ * price_precision = 8
+ * market_data     = /data/md/ftx.ws.20210901.json
+ * md_interval_us  = 100
+ *
+ * [instrument.BTC-PERP]
+ * symbol = BTC-PERP
+ * bid    = 47000
+ * ask    = 47001
+ */
+#include "apps/fix_acceptor/md_replay.h"
+#include "libcore/essential/app.hpp"
+#include "libcore/qstream/tcp_listener.hpp"
+#include "libcore/time/clock.hpp"
+#include "libs/inifile/inicpp.h"
+#include "libs/logger/logger.hpp"
+#include "order_entry/ftx_fix/fix_acceptor.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <iostream>
+#include <memory>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+namespace miye::trading
+{
+class FixAcceptorApp : public essential::app<FixAcceptorApp>
+{
+  public:
+    using Clock_t     = time::variant_clock;
+    using listener_t  = qstream::tcp_listener<Clock_t>;
+    using md_replay_t = fix::sim::MdReplay<16>;
+
+    constexpr static const char* InstrumentSection = "instrument.";
+    constexpr static const size_t ReadBufferSize   = 1 << 20;
+
+  public:
+    int run(int argc, char** argv)
+    {
+        if (argc < 2)
+        {
+            std::cerr << "usage: " << argv[0] << " fix_acceptor.ini" << std::endl;
+            return 1;
+        }
+        ini::IniFile config(argv[1]);
+
+        Clock_t clk("real_clock");
+        log_ = logger::createLogger(config["log"]["log_file"].as<std::string>());
+        // the md processor logs every message at info
+        log_->set_level(spdlog::level::warn);
+
+        auto& section = config["acceptor"];
+        config_.senderCompId   = section["sender_comp_id"].as<std::string>();
+        config_.ackLatencyNs   = section["ack_latency_us"].as<uint64_t>() * 1000;
+        config_.fillLatencyNs  = section["fill_latency_us"].as<uint64_t>() * 1000;
+        config_.pricePrecision = section["price_precision"].as<uint32_t>();
+        if (section.count("market_data"))
+        {
+            market_data_    = section["market_data"].as<std::string>();
+            md_interval_ns_ = section["md_interval_us"].as<uint64_t>() * 1000;
+        }
+
+        listener_t listener(clk, section["endpoint"].as<std::string>());
+        while (!end())
+        {
+            auto const plc  = listener.read();
+            auto const* con = reinterpret_cast<const qstream::new_connection*>(plc.start);
+            if (con->new_fd < 0)
+            {
+                continue;
+            }
+            log_->warn("client connected ip:{} port:{}", con->ip, con->port);
+            serve(clk, config, con->new_fd);
+            ::close(con->new_fd);
+        }
+        log_->flush();
+        return 0;
+    }
+
+  private:
+    // one session, with a fresh book so every client starts from config prices
+    void serve(Clock_t& clk, ini::IniFile& config, int fd)
+    {
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+        fix::sim::SimBook book;
+        for (auto& section : config)
+        {
+            if (section.first.rfind(InstrumentSection, 0) != 0)
+            {
+                continue;
+            }
+            auto& s = section.second;
+            book.addInstrument(s["symbol"].as<std::string>(), s["bid"].as<double>(), s["ask"].as<double>());
+        }
+        fix::sim::FixAcceptor acceptor(config_, book);
+
+        std::unique_ptr<md_replay_t> replay;
+        if (!market_data_.empty())
+        {
+            replay = std::make_unique<md_replay_t>(acceptor, book, log_.get());
+            if (!replay->open(market_data_))
+            {
+                log_->error("cannot open market data:{}", market_data_);
+                replay.reset();
+            }
+        }
+
+        std::vector<char> buffer(ReadBufferSize);
+        uint64_t next_md = clk.now();
+        while (!end())
+        {
+            auto const n   = ::recv(fd, buffer.data(), buffer.size(), 0);
+            auto const now = clk.now();
+            if (n > 0)
+            {
+                if (!acceptor.consume(buffer.data(), size_t(n), now))
+                {
+                    flush(fd, acceptor);
+                    break;
+                }
+            }
+            else if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+            {
+                break;
+            }
+
+            acceptor.poll(now);
+            if (replay && now >= next_md)
+            {
+                if (!replay->next(now))
+                {
+                    log_->warn("market data replay finished");
+                    replay.reset();
+                }
+                next_md = now + md_interval_ns_;
+            }
+            if (!flush(fd, acceptor))
+            {
+                break;
+            }
+        }
+        log_->warn("client disconnected in:{} out:{} resting:{}", acceptor.messagesIn(), acceptor.messagesOut(),
+                   book.size());
+    }
+
+    // everything rendered since the last read goes out in one send
+    bool flush(int fd, fix::sim::FixAcceptor& acceptor)
+    {
+        const char* p = acceptor.outData();
+        size_t left   = acceptor.outSize();
+        while (left)
+        {
+            auto const n = ::send(fd, p, left, MSG_NOSIGNAL);
+            if (n < 0)
+            {
+                if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+                {
+                    continue;
+                }
+                return false;
+            }
+            p += n;
+            left -= size_t(n);
+        }
+        acceptor.clearOut();
+        return true;
+    }
+
+  private:
+    std::shared_ptr<logger::Logger> log_;
+    fix::sim::FixAcceptor::Config config_;
+    std::string market_data_;
+    uint64_t md_interval_ns_{};
+};
+} // namespace miye::trading
+
+int main(int argc, char** argv)
+{
+    miye::trading::FixAcceptorApp app;
+    return app.main(argc, argv);
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "libs/logger/logger.hpp"
+#include "market_data/book/order_book_store.hpp"
+#include "market_data/exchanges/ftx/ftx_md_processor.h"
+#include "order_entry/ftx_fix/fix_acceptor.hpp"
+#include "trading/md_listener.h"
+
+#include <fstream>
+#include <json/json.hpp>
+#include <string>
+#include <vector>
+
+namespace miye::trading::fix::sim
+{
+
+/*
+ * Replays a capture of the FTX websocket feed, one json message per line,
+ * through the same FtxMdProcessor the strategies use. Every book update and
+ * trade of a symbol the acceptor lists is passed on as the new market.
+ */
+template <size_t SYM_SIZE>
+class MdReplay : public MDListener
+{
+  public:
+    MdReplay(FixAcceptor& acceptor, const SimBook& book, logger::Logger* logger, int32_t bookDepth = 20)
+        : acceptor_(acceptor), processor_(store_)
+    {
+        std::vector<symbol_t> symbols(SYM_SIZE);
+        for (size_t i = 0; i < book.instrumentCount() && i < SYM_SIZE; ++i)
+        {
+            symbols[i] = OrderBookStore<SYM_SIZE>::buildSymbol(Exchange::FTX, book.symbol(i));
+            store_.orderBooks_[i].init(bookDepth);
+        }
+        store_.setSymbols(symbols);
+        instrumentCount_ = std::min(book.instrumentCount(), SYM_SIZE);
+
+        processor_.setLogger(logger);
+        processor_.setMdListener(this);
+    }
+
+    bool open(const std::string& file)
+    {
+        in_.open(file);
+        return in_.is_open();
+    }
+
+    // one message, false at the end of the capture
+    bool next(uint64_t now)
+    {
+        if (!std::getline(in_, line_))
+        {
+            return false;
+        }
+        now_    = now;
+        auto j = nlohmann::json::parse(line_, nullptr, false);
+        if (!j.is_discarded())
+        {
+            processor_.onMessageCB(j);
+        }
+        return true;
+    }
+
+    int32_t onSnapshotFinished(int32_t cid) override { return onBookChange(cid); }
+
+    int32_t onBookChange(int32_t cid) override
+    {
+        if (cid < 0 || size_t(cid) >= instrumentCount_)
+        {
+            return 0;
+        }
+        auto const bbo = store_.getBook(cid).getBBO();
+        acceptor_.onMarket(uint32_t(cid), toPrice(bbo.bidPx), toPrice(bbo.askPx), now_);
+        return 0;
+    }
+
+    int32_t onTrade(uint64_t, int32_t cid, uint64_t, Side, Price price, Qty, bool) override
+    {
+        if (cid < 0 || size_t(cid) >= instrumentCount_)
+        {
+            return 0;
+        }
+        acceptor_.onTrade(uint32_t(cid), toPrice(price), now_);
+        return 0;
+    }
+
+    int32_t onTick(int32_t) override { return 0; }
+
+  private:
+    static price_t toPrice(Price px) { return px.isValid() ? px.toDouble() : 0; }
+
+  private:
+    FixAcceptor& acceptor_;
+    OrderBookStore<SYM_SIZE> store_;
+    ftx::FtxMdProcessor<OrderBookStore<SYM_SIZE>> processor_;
+    size_t instrumentCount_{};
+    std::ifstream in_;
+    std::string line_;
+    uint64_t now_{};
+};
+
+} // namespace miye::trading::fix::sim
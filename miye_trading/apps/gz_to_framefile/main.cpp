@@ -0,0 +1,94 @@
+/*
+ * gz_to_framefile: convert a gzipped mmfile into a framefile
+ *
+ * usage: gz_to_framefile in.md.gz out.md.qf [frame_kb=1024] [level=6]
+ *
+ * Plain mmfiles convert as well, zlib reads them through unchanged.
+ * Only the records up to the write_offset of the source are kept.
+ */
+#include "libcore/qstream/framefile_writer.hpp"
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace miye::qstream;
+
+namespace
+{
+
+bool read_exact(gzFile in, void* buf, size_t bytes)
+{
+    return gzread(in, buf, bytes) == int(bytes);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        std::cerr << "usage: " << argv[0] << " in.gz out.qf [frame_kb=1024] [level=6]" << std::endl;
+        return 1;
+    }
+    uint32_t frame_size = argc > 3 ? std::stoul(argv[3]) * 1024 : framefile_default_frame_size;
+    int level = argc > 4 ? std::stoi(argv[4]) : Z_DEFAULT_COMPRESSION;
+
+    gzFile in = gzopen(argv[1], "rb");
+    if (!in)
+    {
+        std::cerr << "cannot open " << argv[1] << std::endl;
+        return 1;
+    }
+    gzbuffer(in, 1024 * 1024);
+
+    auto header = std::make_unique<mmap_header>();
+    if (!read_exact(in, header.get(), sizeof(*header)) || header->magic != mmap_magic)
+    {
+        std::cerr << "not an mmfile: " << argv[1] << std::endl;
+        return 1;
+    }
+
+    framefile_writer out(argv[2], *header, frame_size, level);
+    const size_t alignment = CACHE_LINE_SIZE;
+    const size_t rec_header_size = header->rec_size ? sizeof(record_header<false>) : sizeof(record_header<true>);
+    std::vector<char> record(mmap_max_recordsize + alignment);
+    uint64_t offset = sizeof(*header);
+    bool truncated = false;
+
+    while (offset < header->write_offset)
+    {
+        if (!read_exact(in, record.data(), rec_header_size))
+        {
+            truncated = true;
+            break;
+        }
+        size_t size = header->rec_size ? header->rec_size
+                                       : reinterpret_cast<record_header<true>*>(record.data())->rec_size;
+        size_t bytes = ROUND_UP(size + rec_header_size, alignment);
+        if (bytes > record.size())
+        {
+            std::cerr << "record of " << size << " bytes at offset " << offset << " is corrupt" << std::endl;
+            return 1;
+        }
+        if (!read_exact(in, record.data() + rec_header_size, bytes - rec_header_size))
+        {
+            truncated = true;
+            break;
+        }
+        out.append(record.data(), bytes);
+        offset += bytes;
+    }
+    gzclose(in);
+    out.close();
+
+    if (truncated)
+    {
+        std::cerr << "source ends at offset " << offset << " before its write_offset " << header->write_offset
+                  << ", kept the whole records" << std::endl;
+    }
+    std::cout << argv[2] << " records:" << out.records() << " frames:" << out.frames()
+              << " raw_bytes:" << out.raw_bytes() << " bytes:" << out.bytes_written() << std::endl;
+    return 0;
+}
@@ -0,0 +1,221 @@
+/*
+ * md_replay: feed captured websocket traffic back through the md processors
+ *
+ * usage: md_replay -x binance|ftx -s SYM1,SYM2 [-m original|scaled|max] [-r speed]
+ *                  [-d depth] [-l log_file] capture...
+ *
+ * The captures (ring_logger text, plain json lines or mmfiles, see
+ * CaptureReader) are replayed in order through the BinanceMdProcessor or
+ * FtxMdProcessor the strategies use, -m original keeps the captured gaps,
+ * -m scaled divides them by -r, -m max (the default) does not wait. -d is
+ * the book depth, 5 for binance and 20 for ftx unless given. At the
+ * end it prints msgs/sec, the parse and process latency histograms and the
+ * checksum of every book, two parser versions that agree print the same.
+ * The processors log at warn and above so the log stays off the numbers.
+ */
+#include "libs/logger/logger.hpp"
+#include "market_data/book/order_book_store.hpp"
+#include "market_data/exchanges/binance/binance_md_processor.h"
+#include "market_data/exchanges/ftx/ftx_md_processor.h"
+#include "market_data/replay/md_replayer.h"
+#include "trading/md_listener.h"
+
+#include <iostream>
+#include <json/json.hpp>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace miye;
+using namespace miye::trading;
+
+namespace
+{
+
+constexpr size_t MdReplaySymbols = 16;
+using Store                      = OrderBookStore<MdReplaySymbols>;
+
+class ReplayListener : public MDListener
+{
+  public:
+    int32_t onSnapshotFinished(int32_t) override
+    {
+        ++snapshots;
+        return 0;
+    }
+    int32_t onBookChange(int32_t) override
+    {
+        ++bookChanges;
+        return 0;
+    }
+    int32_t onTrade(uint64_t, int32_t, uint64_t, Side, Price, Qty, bool) override
+    {
+        ++trades;
+        return 0;
+    }
+    int32_t onTick(int32_t) override { return 0; }
+
+    uint64_t snapshots{0};
+    uint64_t bookChanges{0};
+    uint64_t trades{0};
+};
+
+// json parse and processor timed apart, sink of replayCapture
+template <typename Processor>
+struct ProcessorSink
+{
+    void operator()(const char* data, size_t len, uint64_t)
+    {
+        auto const t0 = mdNowNs();
+        auto j        = nlohmann::json::parse(data, data + len, nullptr, false);
+        auto const t1 = mdNowNs();
+        parseNs.record(t1 - t0);
+        if (j.is_discarded())
+        {
+            ++parseErrors;
+            return;
+        }
+        processor.onMessageCB(j);
+        processNs.record(mdNowNs() - t1);
+    }
+
+    Processor& processor;
+    ReplayHistogram parseNs;
+    ReplayHistogram processNs;
+    uint64_t parseErrors{0};
+};
+
+template <typename Processor>
+int32_t replay(Exchange exchange, const std::vector<std::string>& symbols, const std::vector<std::string>& captures,
+               ReplayMode mode, double speed, int32_t depth, logger::Logger* logger)
+{
+    Store store;
+    std::vector<symbol_t> fullSymbols(MdReplaySymbols);
+    for (size_t i = 0; i < symbols.size(); ++i)
+    {
+        fullSymbols[i] = Store::buildSymbol(exchange, symbols[i]);
+        store.orderBooks_[i].init(depth);
+    }
+    store.setSymbols(fullSymbols);
+
+    ReplayListener listener;
+    Processor processor(store);
+    processor.setLogger(logger);
+    processor.setMdListener(&listener);
+
+    ProcessorSink<Processor> sink{processor};
+    ReplayPacer pacer(mode, speed);
+    ReplayStats stats;
+    for (auto const& capture : captures)
+    {
+        CaptureReader reader;
+        if (reader.open(capture) != 0)
+        {
+            return -1;
+        }
+        replayCapture(reader, pacer, sink, stats);
+    }
+
+    printReplayStats(std::cout, stats);
+    printHistogram(std::cout, "parse_ns", sink.parseNs);
+    printHistogram(std::cout, "process_ns", sink.processNs);
+    std::cout << "parse_errors:" << sink.parseErrors << " snapshots:" << listener.snapshots
+              << " book_changes:" << listener.bookChanges << " trades:" << listener.trades << std::endl;
+    for (size_t i = 0; i < symbols.size(); ++i)
+    {
+        auto const& book = store.getBook(int32_t(i));
+        auto const bbo   = book.getBBO();
+        std::cout << "book " << fullSymbols[i] << " checksum:" << std::hex << bookChecksum(book) << std::dec
+                  << " bid:" << bbo.bidQty << "@" << bbo.bidPx << " ask:" << bbo.askQty << "@" << bbo.askPx
+                  << std::endl;
+    }
+    return 0;
+}
+
+void usage(const char* name)
+{
+    std::cerr << "usage: " << name
+              << " -x binance|ftx -s SYM1,SYM2 [-m original|scaled|max] [-r speed] [-d depth] [-l log_file] capture..."
+              << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::string exchange;
+    std::vector<std::string> symbols;
+    ReplayMode mode = ReplayMode::MAX_SPEED;
+    double speed    = 1.0;
+    int32_t depth   = 0;
+    std::string logFile{"/tmp/md_replay.log"};
+
+    int opt;
+    while ((opt = getopt(argc, argv, "x:s:m:r:d:l:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'x':
+            exchange = optarg;
+            break;
+        case 's':
+        {
+            std::stringstream ss(optarg);
+            std::string symbol;
+            while (std::getline(ss, symbol, ','))
+            {
+                symbols.push_back(symbol);
+            }
+            break;
+        }
+        case 'm':
+            if (parseReplayMode(optarg, mode) != 0)
+            {
+                return 1;
+            }
+            break;
+        case 'r':
+            speed = std::stod(optarg);
+            break;
+        case 'd':
+            depth = std::stoi(optarg);
+            break;
+        case 'l':
+            logFile = optarg;
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (optind >= argc || symbols.empty() || symbols.size() > MdReplaySymbols)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    const std::vector<std::string> captures(argv + optind, argv + argc);
+
+    auto logger = logger::createLogger(logFile);
+    logger->set_level(spdlog::level::warn);
+
+    int32_t ret;
+    if (exchange == "binance")
+    {
+        // the processor writes depth5 snapshots, as MarketMain's BinanceBookDepth
+        depth = depth ? depth : 5;
+        ret   = replay<binance::BinanceMdProcessor<Store>>(Exchange::BINANCE, symbols, captures, mode, speed, depth,
+                                                         logger.get());
+    }
+    else if (exchange == "ftx")
+    {
+        depth = depth ? depth : 20;
+        ret   = replay<ftx::FtxMdProcessor<Store>>(Exchange::FTX, symbols, captures, mode, speed, depth, logger.get());
+    }
+    else
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    return ret == 0 ? 0 : 1;
+}
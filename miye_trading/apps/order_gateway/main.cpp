@@ -0,0 +1,320 @@
+/*
+ * order_gateway: one FIX session shared by the strategies on this box
+ *
+ * Strategies write order_insert/order_cancel/order_replace records to their
+ * request streams and read receipts, acks, fills and rejects from their
+ * response streams, they never touch a socket. Requests go through
+ * pre-trade risk inline before they are rendered onto the session.
+ *
+ * usage: order_gateway order_gateway.ini
+ *
+ * [log]
+ * log_file = /data/log/order_gateway.log
+ *
+ * [fix]
+ * sender_comp_id = ...
+ * target_comp_id = FTX
+ * password       = ...
+ * endpoint       = tcp:127.0.0.1:9880
+ * store          = /data/fix/ftx.store
+ * fix_log        = mmap:/data/fix/ftx.log
+ * heartbeat      = 30
+ * time_in_force  = gtc
+ *
+ * [risk]
+ * max_order_rate          = 100
+ * max_repeated_order_rate = 20
+ *
+ * [strategy.1]
+ * requests  = mmap:/dev/shm/requests.1@follow,recordsize=64
+ * responses = mmap:/dev/shm/responses.1@recordsize=64
+ *
+ * [instrument.BTC-PERP]
+ * symbol                  = BTC-PERP
+ * id                      = 1
+ * tick_size               = 1
+ * precision               = 0
+ * qty_precision           = 3   # optional, qty digits on the wire, 0 if absent
+ * max_order_size          = 1
+ * max_order_rate          = 10
+ * max_repeated_order_rate = 5
+ * max_position            = 3   # optional, |position + open orders| on the order's side
+ * max_open                = 2   # optional, open qty per side
+ *
+ * Positions start flat at every start and follow the fills of this
+ * gateway's orders.
+ */
+#include "libcore/essential/app.hpp"
+#include "libcore/qstream/arbiter.hpp"
+#include "libcore/qstream/kernel_arbiter.hpp"
+#include "libcore/qstream/mmap_reader.hpp"
+#include "libcore/qstream/mmap_writer.hpp"
+#include "libcore/qstream/tcp_reader.hpp"
+#include "libcore/qstream/tcp_writer.hpp"
+#include "libcore/time/clock.hpp"
+#include "libs/inifile/inicpp.h"
+#include "libs/logger/logger.hpp"
+#include "order_entry/ftx_fix/order_handler.hpp"
+
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace miye::trading
+{
+class OrderGateway : public essential::app<OrderGateway>
+{
+  public:
+    using Clock_t           = time::variant_clock;
+    using mm_reader_t       = qstream::mmap_reader<Clock_t>;
+    using mm_writer_t       = qstream::mmap_writer<Clock_t>;
+    using tcp_reader_t      = qstream::tcp_reader<Clock_t>;
+    using tcp_writer_t      = qstream::tcp_writer<Clock_t>;
+    using request_arbiter_t = qstream::arbiter<Clock_t, mm_reader_t, 16>;
+    using fix_arbiter_t     = qstream::kernel_arbiter<Clock_t>;
+    using order_handler_t   = fix::order_handler_t<Clock_t>;
+
+    constexpr static const char* StrategySection   = "strategy.";
+    constexpr static const char* InstrumentSection = "instrument.";
+
+    // rate breaches time out after risk::TimeoutWindow, the states are rolled well within it
+    constexpr static const uint64_t RiskUpdateInterval = 100'000'000;
+
+  public:
+    int run(int argc, char** argv)
+    {
+        if (argc < 2)
+        {
+            std::cerr << "usage: " << argv[0] << " order_gateway.ini" << std::endl;
+            return 1;
+        }
+        ini::IniFile config(argv[1]);
+
+        Clock_t clk("real_clock");
+        log_ = logger::createLogger(config["log"]["log_file"].as<std::string>());
+
+        init_risk(config);
+        init_fix(clk, config);
+        if (init_instruments(config) != 0)
+        {
+            log_->flush();
+            return 1;
+        }
+        init_strategies(clk, config);
+
+        request_arbiter_t request_arb(clk);
+        fix_arbiter_t fix_arb(clk);
+        init_arb(request_arb, fix_arb);
+
+        handler->logon();
+        loop(clk, request_arb, fix_arb, config["fix"]["heartbeat"].as<uint64_t>() * 1'000'000'000ull);
+        handler->logout();
+
+        log_->info("order gateway exit, live orders:{}", handler->live_orders());
+        log_->flush();
+        return 0;
+    }
+
+  private:
+    void loop(Clock_t& clk, request_arbiter_t& request_arb, fix_arbiter_t& fix_arb, uint64_t heartbeat_interval)
+    {
+        uint64_t next_heartbeat   = clk.now() + heartbeat_interval;
+        uint64_t next_risk_update = clk.now() + RiskUpdateInterval;
+        while (!end())
+        {
+            // fix first: acks and fills free up the order slots requests need
+            auto const fix_id = fix_arb.ruling();
+            if (fix_id < qstream::arbiter_error::end)
+            {
+                auto const plc = fix_reader->read();
+                fix_arb.read_complete(fix_id);
+                if (plc.is_eof())
+                {
+                    log_->error("fix connection closed");
+                    handler->on_logout();
+                    stop();
+                    break;
+                }
+                handler->consume_tcp_buffer(plc);
+            }
+
+            auto const request_id = request_arb.ruling();
+            if (request_id < qstream::arbiter_error::end)
+            {
+                auto const plc = request_readers[request_id - 1]->read();
+                request_arb.read_complete(request_id);
+                handler->on_request(plc, clk.now());
+            }
+
+            auto const now = clk.now();
+            if (UNLIKELY(now > next_risk_update))
+            {
+                risk->updateState(time::NanoTime{std::chrono::nanoseconds(now)});
+                next_risk_update = now + RiskUpdateInterval;
+            }
+            if (UNLIKELY(now > next_heartbeat))
+            {
+                handler->send_heartbeat();
+                next_heartbeat = now + heartbeat_interval;
+            }
+        }
+    }
+
+    void init_arb(request_arbiter_t& request_arb, fix_arbiter_t& fix_arb)
+    {
+        for (size_t i = 0; i != request_readers.size(); ++i)
+        {
+            auto const request_idx = request_arb.submit(request_readers[i].get());
+            INVARIANT(request_idx == i + 1);
+        }
+        request_arb.submission_complete();
+
+        /*
+         * skip existing messages in order request files, they were for a
+         * previous gateway
+         */
+        for (auto id = request_arb.ruling(); id < qstream::arbiter_error::end; id = request_arb.ruling())
+        {
+            request_readers[id - 1]->read();
+            request_arb.read_complete(id);
+        }
+
+        fix_arb.submit(fix_reader->get_fd());
+        fix_arb.submission_complete();
+    }
+
+    void init_risk(ini::IniFile& config)
+    {
+        for (auto const& section : config)
+        {
+            if (section.first.rfind(InstrumentSection, 0) == 0)
+            {
+                symbols.push_back(section.second.at("symbol").as<std::string>());
+            }
+        }
+        risk = std::make_unique<risk::Risk>(positions, symbols);
+        risk->init(log_.get());
+        risk->globalRisk.setMaxOrderRate(config["risk"]["max_order_rate"].as<uint16_t>());
+        risk->globalRisk.maxRepeatedOrderRate = config["risk"]["max_repeated_order_rate"].as<int32_t>();
+        risk->globalRisk.init();
+        risk->symbolRisks.resize(symbols.size());
+    }
+
+    void init_fix(Clock_t& clk, ini::IniFile& config)
+    {
+        auto& section = config["fix"];
+        fix::fix_config_t fix_config;
+        fix_config.sender_comp_id = section["sender_comp_id"].as<std::string>();
+        fix_config.target_comp_id = section["target_comp_id"].as<std::string>();
+        fix_config.password       = section["password"].as<std::string>();
+
+        time_in_force = section["time_in_force"].as<std::string>() == "day" ? fix::TimeInforceEnum::Day
+                                                                             : fix::TimeInforceEnum::GoodTillCancel;
+
+        tcp_writer = std::make_unique<tcp_writer_t>(clk, section["endpoint"].as<std::string>(), false);
+        fix_reader = std::make_unique<tcp_reader_t>(clk, tcp_writer->get_fd(), section["endpoint"].as<std::string>());
+        fix_log    = std::make_unique<mm_writer_t>(clk, section["fix_log"].as<std::string>());
+        session    = std::make_unique<fix::ftx::FixSession>(fix_config, "ftx", section["store"].as<std::string>(),
+                                                         out_buffer);
+        handler = std::make_unique<order_handler_t>(instruments, *session, out_buffer, tcp_writer.get(), fix_log.get(),
+                                                    *risk, log_.get());
+    }
+
+    int32_t init_instruments(ini::IniFile& config)
+    {
+        int32_t risk_id = 0;
+        for (auto& section : config)
+        {
+            if (section.first.rfind(InstrumentSection, 0) != 0)
+            {
+                continue;
+            }
+            auto& s = section.second;
+            fix::instrument_t ins;
+            ins.instrument_id = s["id"].as<types::instrument_id_t>();
+            ins.symbol        = s["symbol"].as<std::string>();
+            ins.tick_size     = Price::fromDouble(s["tick_size"].as<double>());
+            auto const precision     = s["precision"].as<int32_t>();
+            auto const qty_precision = s.count("qty_precision") ? s["qty_precision"].as<int32_t>() : 0;
+            if (precision < 0 || precision > Price::decimals || qty_precision < 0 || qty_precision > Qty::decimals)
+            {
+                log_->error("instrument symbol:{} precision:{} qty_precision:{} out of range 0..{}", ins.symbol,
+                            precision, qty_precision, Price::decimals);
+                return -1;
+            }
+            ins.precision     = uint32_t(precision);
+            ins.qty_precision = uint32_t(qty_precision);
+            ins.risk_id       = risk_id++;
+            session->initTemplate(ins.new_order[0], ins.symbol, fix::SideEnum::Buy, fix::OrderTypeEnum::Limitorder,
+                                  time_in_force, ins.precision, ins.qty_precision);
+            session->initTemplate(ins.new_order[1], ins.symbol, fix::SideEnum::Sell, fix::OrderTypeEnum::Limitorder,
+                                  time_in_force, ins.precision, ins.qty_precision);
+            ins.risk_order.symbol = ins.symbol;
+            ins.risk_order.cid    = ins.risk_id;
+
+            risk::SymbolRisk sr{};
+            sr.maxOrderSize         = Qty::fromDouble(s["max_order_size"].as<double>());
+            sr.maxRepeatedOrderRate = s["max_repeated_order_rate"].as<int32_t>();
+            sr.setMaxOrderRate(s["max_order_rate"].as<int32_t>());
+            if (s.count("max_position"))
+            {
+                sr.minmax = Qty::fromDouble(s["max_position"].as<double>());
+            }
+            if (s.count("max_open"))
+            {
+                sr.maxOpen = Qty::fromDouble(s["max_open"].as<double>());
+            }
+            risk->setSymbolRisk(ins.risk_id, sr);
+
+            log_->info("instrument id:{} symbol:{} tick_size:{}", ins.instrument_id, ins.symbol,
+                       ins.tick_size.toDouble());
+            instruments.emplace(ins.instrument_id, std::move(ins));
+        }
+        return 0;
+    }
+
+    void init_strategies(Clock_t& clk, ini::IniFile& config)
+    {
+        for (auto& section : config)
+        {
+            if (section.first.rfind(StrategySection, 0) != 0)
+            {
+                continue;
+            }
+            auto const strategy =
+                static_cast<types::strategy_id_t>(std::stoul(section.first.substr(std::strlen(StrategySection))));
+            auto& s = section.second;
+            request_readers.push_back(std::make_unique<mm_reader_t>(clk, s["requests"].as<std::string>()));
+            response_writers.push_back(std::make_unique<mm_writer_t>(clk, s["responses"].as<std::string>()));
+            handler->add_strategy(strategy, response_writers.back().get());
+
+            log_->info("strategy:{} requests:{} responses:{}", strategy, s["requests"].as<std::string>(),
+                       s["responses"].as<std::string>());
+        }
+    }
+
+  private:
+    std::shared_ptr<logger::Logger> log_;
+    position::PortforlioPositions positions{};
+    std::vector<symbol_t> symbols;
+    std::unique_ptr<risk::Risk> risk;
+
+    fix::TimeInforceEnum time_in_force{fix::TimeInforceEnum::GoodTillCancel};
+    char out_buffer[fix::ftx::FixSession::OutBufferSize]{};
+    std::unique_ptr<tcp_writer_t> tcp_writer;
+    std::unique_ptr<tcp_reader_t> fix_reader;
+    std::unique_ptr<mm_writer_t> fix_log;
+    std::unique_ptr<fix::ftx::FixSession> session;
+    order_handler_t::instrument_map_t instruments;
+    std::unique_ptr<order_handler_t> handler;
+
+    std::vector<std::unique_ptr<mm_reader_t>> request_readers;
+    std::vector<std::unique_ptr<mm_writer_t>> response_writers;
+};
+} // namespace miye::trading
+
+int main(int argc, char** argv)
+{
+    miye::trading::OrderGateway app;
+    return app.main(argc, argv);
+}
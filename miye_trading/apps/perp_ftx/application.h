@@ -3,6 +3,7 @@
 #include "config_loader.h"
 #include "cxxopts.hpp"
 #include "libcore/essential/app.hpp"
+#include "libcore/time/span_tracer.hpp"
 #include "market_data/market_main.h"
 #include "perp_ftx.h"
 
@@ -73,6 +74,8 @@ struct PerpFtxApp : public essential::app<PerpFtxApp>
         auto const logFile = ftx::ConfigLoader::getLogFile(date, configFile);
 
         auto* logger = marketMain.createLogger(logFile);
+        // md and orders share the polling thread, one span log covers both
+        SPAN_OPEN("spans-perp_ftx-" + date);
         if (perpFtx_.init(logger, configFile) != 0)
         {
             logger->info("failed to init perpFtx object");
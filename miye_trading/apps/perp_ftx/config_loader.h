@@ -27,8 +27,9 @@ struct ConfigLoader
         instrument_t instrument{};
 
         instrument.symbol           = iniFile["markets.ftx.instrument.ftm-perp"]["symbol"].as<std::string>();
-        instrument.tickSize         = iniFile["markets.ftx.instrument.ftm-perp"]["tick_size"].as<double>();
-        instrument.qtyStep          = iniFile["markets.ftx.instrument.ftm-perp"]["qty_step"].as<double>();
+        instrument.tickSize =
+            Price::fromDouble(iniFile["markets.ftx.instrument.ftm-perp"]["tick_size"].as<double>());
+        instrument.qtyStep = Qty::fromDouble(iniFile["markets.ftx.instrument.ftm-perp"]["qty_step"].as<double>());
         instrument.imfFactor        = iniFile["markets.ftx.instrument.ftm-perp"]["imf_factor"].as<double>();
         auto const positionLimitWgt = iniFile["markets.ftx.instrument.ftm-perp"]["position_limit_wgt"];
         if (positionLimitWgt.as<std::string>() != "na")
@@ -23,7 +23,7 @@ struct PerpFtx : public MDListener
         return 0;
     }
 
-    int32_t onTrade(uint64_t timestamp, int32_t cid, uint64_t tradeId, Side side, price_t price, quantity_t qty,
+    int32_t onTrade(uint64_t timestamp, int32_t cid, uint64_t tradeId, Side side, Price price, Qty qty,
                     bool isDone) override
     {
         auto const& symbol = context.symbols[cid];
@@ -0,0 +1,30 @@
+/*
+ * span_report: per stage latency and flame breakdown of span_tracer logs
+ *
+ * usage: span_report spans-perp_ftx.0 [spans-perp_ftx.1 ...]
+ */
+#include "libcore/time/span_analyzer.hpp"
+
+#include <iostream>
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: " << argv[0] << " span_log [span_log ...]" << std::endl;
+        return 1;
+    }
+
+    miye::time::span_analyzer analyzer;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!analyzer.load(argv[i]))
+        {
+            std::cerr << "not a span log: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+    analyzer.process();
+    std::cout << analyzer.to_str();
+    return 0;
+}
@@ -0,0 +1,266 @@
+/*
+ * capture_normalizer.h
+ * Purpose: turn the lines of a dinobot ring_logger capture into tick_events
+ *
+ * A capture line is "<writer_timestamp ns> <raw json>". Coinbase level2 and
+ * matches and binance diff depth, partial depth and (agg)trades come out as
+ * rows, combined stream wrappers ({"stream":..,"data":..}) are unwrapped.
+ * Partial depth is told from diff depth by the stream name, so it needs the
+ * combined stream wrapper.
+ * Anything else (tickers, heartbeats, subscription acks, klines) is counted
+ * as skipped.
+ */
+#pragma once
+
+#include "libcore/math/decimal.hpp"
+#include "libcore/tickstore/tick_event.hpp"
+#include "libcore/time/iso8601.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <json/json.hpp>
+#include <string>
+
+namespace miye
+{
+namespace tickstore
+{
+
+class capture_normalizer
+{
+  public:
+    using json = nlohmann::json;
+
+    /*
+     * sink(symbol, type, event, checkpoint) for each row of the line, the
+     * event's type column is left to the sink, it owns the dictionary
+     */
+    template <typename Sink>
+    void normalize(const char* line, size_t len, Sink& sink)
+    {
+        ++lines_;
+        auto const end = line + len;
+        auto space = std::find(line, end, ' ');
+        uint64_t ts = 0;
+        if (space == end || std::from_chars(line, space, ts).ec != std::errc())
+        {
+            ++errors_;
+            return;
+        }
+        auto msg = json::parse(space + 1, end, nullptr, false);
+        if (msg.is_discarded() || !msg.is_object())
+        {
+            ++errors_;
+            return;
+        }
+
+        std::string stream;
+        if (msg.count("stream") && msg.count("data"))
+        {
+            stream = msg.at("stream").get<std::string>();
+            json data = std::move(msg.at("data"));
+            msg = std::move(data);
+        }
+
+        bool ok = true;
+        try
+        {
+            if (msg.count("type"))
+            {
+                ok = coinbase(ts, msg, sink);
+            }
+            else if (msg.count("e"))
+            {
+                ok = binance(ts, stream, msg, sink);
+            }
+            else if (msg.count("lastUpdateId") && msg.count("bids") && !stream.empty())
+            {
+                ok = binance_partial(ts, stream, msg, sink);
+            }
+            else
+            {
+                ++skipped_;
+            }
+        }
+        catch (const json::exception&)
+        {
+            // a field missing or of the wrong type, rows emitted before it stay
+            ok = false;
+        }
+        if (!ok)
+        {
+            ++errors_;
+        }
+    }
+
+    uint64_t lines() const { return lines_; }
+    uint64_t rows() const { return rows_; }
+    uint64_t skipped() const { return skipped_; }
+    uint64_t errors() const { return errors_; }
+
+  private:
+    template <typename Sink>
+    bool coinbase(uint64_t ts, const json& msg, Sink& sink)
+    {
+        auto const& type = msg.at("type").get_ref<const std::string&>();
+        if (type != "snapshot" && type != "l2update" && type != "match" && type != "last_match")
+        {
+            ++skipped_;
+            return true;
+        }
+        auto const& symbol = msg.at("product_id").get_ref<const std::string&>();
+        int64_t lag = 0;
+        if (msg.count("time"))
+        {
+            auto const& stamp = msg.at("time").get_ref<const std::string&>();
+            uint64_t nanos;
+            if (time::parse_iso8601(stamp.data(), stamp.size(), nanos))
+            {
+                lag = int64_t(ts - nanos);
+            }
+        }
+
+        if (type == "snapshot")
+        {
+            emit(sink, symbol, type, make(ts, lag, tick_kind::clear, tick_side::bid, 0, 0), true);
+            return levels(sink, symbol, type, ts, lag, tick_side::bid, msg.at("bids")) &&
+                   levels(sink, symbol, type, ts, lag, tick_side::ask, msg.at("asks"));
+        }
+        if (type == "l2update")
+        {
+            for (auto const& change : msg.at("changes"))
+            {
+                auto side = change.at(0).get_ref<const std::string&>() == "buy" ? tick_side::bid : tick_side::ask;
+                if (!level(sink, symbol, type, ts, lag, tick_kind::level, side, change.at(1), change.at(2)))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+        // a match's side is the maker's
+        auto side = msg.at("side").get_ref<const std::string&>() == "buy" ? tick_side::ask : tick_side::bid;
+        return level(sink, symbol, type, ts, lag, tick_kind::trade, side, msg.at("price"), msg.at("size"));
+    }
+
+    template <typename Sink>
+    bool binance(uint64_t ts, const std::string& stream, const json& msg, Sink& sink)
+    {
+        auto const& type = msg.at("e").get_ref<const std::string&>();
+        if (type != "depthUpdate" && type != "trade" && type != "aggTrade")
+        {
+            ++skipped_;
+            return true;
+        }
+        auto const& symbol = msg.at("s").get_ref<const std::string&>();
+        int64_t lag = msg.count("E") ? int64_t(ts - msg.at("E").get<uint64_t>() * 1000000) : 0;
+
+        if (type == "depthUpdate")
+        {
+            // futures <symbol>@depth<levels>@<speed> say depthUpdate too but are top of the book snapshots
+            if (partial_depth(stream))
+            {
+                return top_of_book(sink, symbol, ts, lag, msg.at("b"), msg.at("a"));
+            }
+            return levels(sink, symbol, type, ts, lag, tick_side::bid, msg.at("b")) &&
+                   levels(sink, symbol, type, ts, lag, tick_side::ask, msg.at("a"));
+        }
+        // m is the buyer being the maker
+        auto side = msg.at("m").get<bool>() ? tick_side::ask : tick_side::bid;
+        return level(sink, symbol, type, ts, lag, tick_kind::trade, side, msg.at("p"), msg.at("q"));
+    }
+
+    // spot <symbol>@depth<levels> snapshots of the top of the book
+    template <typename Sink>
+    bool binance_partial(uint64_t ts, const std::string& stream, const json& msg, Sink& sink)
+    {
+        std::string symbol = stream.substr(0, stream.find('@'));
+        std::transform(symbol.begin(), symbol.end(), symbol.begin(), ::toupper);
+        return top_of_book(sink, symbol, ts, 0, msg.at("bids"), msg.at("asks"));
+    }
+
+    // "btcusdt@depth5@0ms" is a partial stream, "btcusdt@depth@100ms" a diff one
+    static bool partial_depth(const std::string& stream)
+    {
+        auto const at = stream.find("@depth");
+        auto const next = at + 6;
+        return at != std::string::npos && next < stream.size() && stream[next] >= '0' && stream[next] <= '9';
+    }
+
+    // a whole top of the book replaces the previous one, rows typed "depth"
+    template <typename Sink>
+    bool top_of_book(Sink& sink, const std::string& symbol, uint64_t ts, int64_t lag, const json& bids,
+                     const json& asks)
+    {
+        static const std::string type{"depth"};
+        emit(sink, symbol, type, make(ts, lag, tick_kind::clear, tick_side::bid, 0, 0), true);
+        return levels(sink, symbol, type, ts, lag, tick_side::bid, bids) &&
+               levels(sink, symbol, type, ts, lag, tick_side::ask, asks);
+    }
+
+    // [[price, qty], ...]
+    template <typename Sink>
+    bool levels(Sink& sink, const std::string& symbol, const std::string& type, uint64_t ts, int64_t lag,
+                tick_side side, const json& lvls)
+    {
+        for (auto const& lvl : lvls)
+        {
+            if (!level(sink, symbol, type, ts, lag, tick_kind::level, side, lvl.at(0), lvl.at(1)))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename Sink>
+    bool level(Sink& sink, const std::string& symbol, const std::string& type, uint64_t ts, int64_t lag,
+               tick_kind kind, tick_side side, const json& price, const json& qty)
+    {
+        int64_t px, q;
+        if (!scaled(price, px) || !scaled(qty, q))
+        {
+            return false;
+        }
+        emit(sink, symbol, type, make(ts, lag, kind, side, px, q), false);
+        return true;
+    }
+
+    static bool scaled(const json& value, int64_t& out)
+    {
+        if (!value.is_string())
+        {
+            return false;
+        }
+        auto const& str = value.get_ref<const std::string&>();
+        return math::parse_scaled(str.data(), str.size(), tick_decimals, out);
+    }
+
+    static tick_event make(uint64_t ts, int64_t lag, tick_kind kind, tick_side side, int64_t price, int64_t qty)
+    {
+        tick_event ev;
+        ev.timestamp = ts;
+        ev.exchange_lag = lag;
+        ev.kind = uint8_t(kind);
+        ev.side = uint8_t(side);
+        ev.price = price;
+        ev.qty = qty;
+        return ev;
+    }
+
+    template <typename Sink>
+    void emit(Sink& sink, const std::string& symbol, const std::string& type, tick_event ev, bool checkpoint)
+    {
+        ++rows_;
+        sink(symbol, type, ev, checkpoint);
+    }
+
+  private:
+    uint64_t lines_{0};
+    uint64_t rows_{0};
+    uint64_t skipped_{0};
+    uint64_t errors_{0};
+};
+
+} // namespace tickstore
+} // namespace miye
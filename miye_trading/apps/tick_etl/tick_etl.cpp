@@ -0,0 +1,157 @@
+/*
+ * tick_etl: normalize dinobot recorder captures into per symbol tickfiles
+ *
+ * usage: tick_etl [-j threads] [-b block_rows] out_dir capture...
+ *
+ * Each capture is read by one worker, the workers take the next capture
+ * as they finish, -j defaults to the number of cores. The ticks of symbol
+ * S in capture dir/name.log go to out_dir/name.S.ticks.
+ */
+#include "capture_normalizer.h"
+#include "libcore/tickstore/tickfile_writer.hpp"
+
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+using namespace miye::tickstore;
+
+namespace
+{
+
+struct capture_result
+{
+    uint64_t lines{0};
+    uint64_t rows{0};
+    uint64_t skipped{0};
+    uint64_t errors{0};
+    uint64_t bytes_in{0};
+    uint64_t bytes_out{0};
+    size_t symbols{0};
+};
+
+std::string stem(const std::string& path)
+{
+    auto name = path.substr(path.find_last_of('/') + 1);
+    return name.substr(0, name.find('.'));
+}
+
+capture_result convert(const std::string& capture, const std::string& out_dir, uint32_t block_rows)
+{
+    capture_result result;
+    std::ifstream in(capture);
+    if (!in)
+    {
+        std::cerr << "cannot open " << capture << std::endl;
+        ++result.errors;
+        return result;
+    }
+
+    auto const prefix = out_dir + "/" + stem(capture) + ".";
+    std::unordered_map<std::string, std::unique_ptr<tickfile_writer<tick_event>>> writers;
+    auto sink = [&](const std::string& symbol, const std::string& type, tick_event& ev, bool checkpoint) {
+        auto& writer = writers[symbol];
+        if (!writer)
+        {
+            writer = std::make_unique<tickfile_writer<tick_event>>(prefix + symbol + ".ticks", symbol, block_rows);
+        }
+        ev.type = writer->intern(type);
+        writer->append(ev, checkpoint);
+    };
+
+    capture_normalizer normalizer;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        result.bytes_in += line.size() + 1;
+        if (!line.empty())
+        {
+            normalizer.normalize(line.data(), line.size(), sink);
+        }
+    }
+
+    for (auto& w : writers)
+    {
+        w.second->close();
+        result.bytes_out += w.second->bytes_written();
+    }
+    result.lines = normalizer.lines();
+    result.rows = normalizer.rows();
+    result.skipped = normalizer.skipped();
+    result.errors += normalizer.errors();
+    result.symbols = writers.size();
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    uint32_t threads = std::max(1u, std::thread::hardware_concurrency());
+    uint32_t block_rows = tickfile_default_block_rows;
+    int opt;
+    while ((opt = getopt(argc, argv, "j:b:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'j':
+            threads = std::max(1ul, std::stoul(optarg));
+            break;
+        case 'b':
+            block_rows = std::stoul(optarg);
+            break;
+        default:
+            std::cerr << "usage: " << argv[0] << " [-j threads] [-b block_rows] out_dir capture..." << std::endl;
+            return 1;
+        }
+    }
+    if (argc - optind < 2 || block_rows == 0)
+    {
+        std::cerr << "usage: " << argv[0] << " [-j threads] [-b block_rows] out_dir capture..." << std::endl;
+        return 1;
+    }
+
+    const std::string out_dir = argv[optind];
+    const std::vector<std::string> captures(argv + optind + 1, argv + argc);
+    threads = std::min<uint32_t>(threads, captures.size());
+
+    std::atomic<size_t> next{0};
+    std::mutex print_mutex;
+    capture_result total;
+    std::vector<std::thread> workers;
+    for (uint32_t t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&] {
+            for (size_t i = next++; i < captures.size(); i = next++)
+            {
+                auto r = convert(captures[i], out_dir, block_rows);
+                std::lock_guard<std::mutex> lk(print_mutex);
+                std::cout << captures[i] << ": lines=" << r.lines << " rows=" << r.rows << " skipped=" << r.skipped
+                          << " errors=" << r.errors << " symbols=" << r.symbols << " bytes_in=" << r.bytes_in
+                          << " bytes_out=" << r.bytes_out << std::endl;
+                total.lines += r.lines;
+                total.rows += r.rows;
+                total.skipped += r.skipped;
+                total.errors += r.errors;
+                total.bytes_in += r.bytes_in;
+                total.bytes_out += r.bytes_out;
+            }
+        });
+    }
+    for (auto& w : workers)
+    {
+        w.join();
+    }
+
+    std::cout << "total: captures=" << captures.size() << " lines=" << total.lines << " rows=" << total.rows
+              << " skipped=" << total.skipped << " errors=" << total.errors << " bytes_in=" << total.bytes_in
+              << " bytes_out=" << total.bytes_out << std::endl;
+    return 0;
+}
@@ -0,0 +1,97 @@
+/*
+ * tick_query: look into a tickfile written by tick_etl
+ *
+ * usage: tick_query file.ticks info
+ *        tick_query file.ticks scan from_ns to_ns
+ *        tick_query file.ticks bbo ts_ns...
+ *
+ * info prints the layout, the blocks and the dictionary, scan the rows of
+ * [from, to), bbo the best bid and offer as of each timestamp.
+ */
+#include "libcore/tickstore/tick_event.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace miye::tickstore;
+
+namespace
+{
+
+const char* encoding_name(column_encoding e)
+{
+    switch (e)
+    {
+    case column_encoding::delta:
+        return "delta";
+    case column_encoding::packed:
+        return "packed";
+    case column_encoding::dict:
+        return "dict";
+    }
+    return "?";
+}
+
+void info(tickfile<tick_event>& file)
+{
+    std::cout << "symbol=" << file.symbol() << " rows=" << file.rows() << " blocks=" << file.blocks()
+              << " first_ts=" << file.first_ts() << " last_ts=" << file.last_ts() << " bytes=" << file.file_size()
+              << " bytes/row=" << (file.rows() ? double(file.file_size()) / file.rows() : 0.0) << std::endl;
+    for (auto const& c : file.layout())
+    {
+        std::cout << "column " << c.name << " " << encoding_name(c.encoding) << " " << (c.is_signed ? "int" : "uint")
+                  << int(c.value_size) * 8 << std::endl;
+    }
+    for (size_t i = 0; i < file.dictionary().size(); ++i)
+    {
+        std::cout << "type " << i << " " << file.dictionary()[i] << std::endl;
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        std::cerr << "usage: " << argv[0] << " file.ticks info|scan from to|bbo ts..." << std::endl;
+        return 1;
+    }
+    tickfile<tick_event> file(argv[1]);
+    const std::string command = argv[2];
+
+    if (command == "info")
+    {
+        info(file);
+    }
+    else if (command == "scan" && argc == 5)
+    {
+        auto const& types = file.dictionary();
+        file.scan(std::stoull(argv[3]), std::stoull(argv[4]), [&](const tick_event& ev) {
+            std::cout << ev.timestamp << " " << types[ev.type] << " kind=" << int(ev.kind) << " side=" << int(ev.side)
+                      << " price=" << ev.price / tick_scale << " qty=" << ev.qty / tick_scale
+                      << " lag=" << ev.exchange_lag << std::endl;
+        });
+    }
+    else if (command == "bbo" && argc > 3)
+    {
+        std::vector<uint64_t> timestamps;
+        for (int i = 3; i < argc; ++i)
+        {
+            timestamps.push_back(std::stoull(argv[i]));
+        }
+        std::sort(timestamps.begin(), timestamps.end());
+        bbo_at(file, timestamps, [](const tick_bbo& b) {
+            std::cout << b.timestamp << " " << b.bid_qty / tick_scale << "@" << b.bid_price / tick_scale << " "
+                      << b.ask_qty / tick_scale << "@" << b.ask_price / tick_scale << std::endl;
+        });
+    }
+    else
+    {
+        std::cerr << "usage: " << argv[0] << " file.ticks info|scan from to|bbo ts..." << std::endl;
+        return 1;
+    }
+    return 0;
+}
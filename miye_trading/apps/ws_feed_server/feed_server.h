@@ -0,0 +1,383 @@
+#pragma once
+
+#include "market_data/replay/md_replayer.h"
+#include "subscription_filter.h"
+
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <websocketpp/config/asio.hpp>
+#include <websocketpp/server.hpp>
+
+namespace miye
+{
+namespace trading
+{
+
+struct FeedServerConfig
+{
+    std::string capture;
+    ReplayMode mode{ReplayMode::ORIGINAL};
+    double speed{1.0};
+    bool sendAll{false};            // start on connect and skip the subscription filter
+    uint64_t disconnectAfter{0};    // messages sent, then close the connection, 0 never
+    bool dropConnection{false};     // cut the tcp connection instead of a close handshake
+    uint64_t stallEvery{0};         // messages between stalls, 0 never
+    uint64_t stallMs{0};            // how long a stall holds the feed back
+    uint64_t burstEvery{0};         // messages between bursts, 0 never
+    uint64_t burstSize{0};          // messages of a burst sent at once, whenever they are due
+    uint64_t gapEvery{0};           // every n-th wanted message is dropped, 0 never
+    size_t maxBuffered{16 << 20};   // bytes queued on a connection before the feed waits for it
+};
+
+struct FeedSessionStats
+{
+    uint64_t sent{0};
+    uint64_t bytes{0};
+    uint64_t filtered{0}; // not subscribed
+    uint64_t gaps{0};
+    uint64_t stalls{0};
+    uint64_t bursts{0};
+    uint64_t backpressure{0}; // waits for the client to drain
+};
+
+/*
+ * A local stand-in for an exchange websocket feed. Every connection gets
+ * its own replay of the capture, from its start, paced like md_replay
+ * (original or scaled capture gaps, or as fast as the socket takes it)
+ * and filtered to what the connection subscribed to. Faults are counted
+ * in messages sent on the connection so a run is reproducible: a close
+ * or dropped connection after n messages, stalls, bursts of messages sent
+ * before they are due and gaps of dropped messages.
+ *
+ * Config is websocketpp::config::asio or asio_tls, everything runs on the
+ * one thread that calls run().
+ */
+template <typename Config>
+class FeedServer
+{
+  public:
+    using Server        = websocketpp::server<Config>;
+    using ConnectionPtr = typename Server::connection_ptr;
+    using MessagePtr    = typename Server::message_ptr;
+    using Hdl           = websocketpp::connection_hdl;
+    using Timer         = websocketpp::lib::asio::steady_timer;
+    using json          = nlohmann::json;
+
+    static const constexpr size_t PumpBatch{256};
+
+    explicit FeedServer(const FeedServerConfig& config) : config_(config)
+    {
+        server_.set_access_channels(websocketpp::log::alevel::none);
+        server_.set_error_channels(websocketpp::log::elevel::warn);
+        server_.init_asio();
+        server_.set_reuse_addr(true);
+        server_.set_open_handler([this](Hdl hdl) { onOpen(hdl); });
+        server_.set_close_handler([this](Hdl hdl) { onClose(hdl); });
+        server_.set_fail_handler([this](Hdl hdl) { onClose(hdl); });
+        server_.set_message_handler([this](Hdl hdl, MessagePtr msg) { onMessage(hdl, msg); });
+    }
+
+    Server& getServer() { return server_; }
+
+    int32_t run(uint16_t port)
+    {
+        websocketpp::lib::error_code ec;
+        server_.listen(port, ec);
+        if (ec)
+        {
+            std::cout << "ERROR cannot listen on port:" << port << " " << ec.message() << std::endl;
+            return -1;
+        }
+        server_.start_accept();
+        std::cout << "feed server listening on port:" << port << " capture:" << config_.capture << std::endl;
+        server_.run();
+        return 0;
+    }
+
+  private:
+    struct Session
+    {
+        explicit Session(websocketpp::lib::asio::io_service& io) : timer(io) {}
+
+        uint64_t id{0};
+        ConnectionPtr con;
+        CaptureReader reader;
+        SubscriptionFilter filter;
+        Timer timer;
+        bool started{false};
+        bool closed{false};
+        bool pending{false}; // msg holds a wanted message not sent yet
+        std::string msg;
+        uint64_t msgTimestamp{0};
+        uint64_t firstTimestamp{0};
+        uint64_t wallStart{0};
+        uint64_t wanted{0};
+        uint64_t burstLeft{0};
+        FeedSessionStats stats;
+    };
+    using SessionPtr = std::shared_ptr<Session>;
+
+    void onOpen(Hdl hdl)
+    {
+        auto session = std::make_shared<Session>(server_.get_io_service());
+        session->id  = ++sessionCount_;
+        session->con = server_.get_con_from_hdl(hdl);
+        if (session->reader.open(config_.capture) != 0)
+        {
+            session->con->close(websocketpp::close::status::internal_endpoint_error, "no capture");
+            return;
+        }
+        session->filter.addResource(session->con->get_resource());
+        sessions_[hdl] = session;
+        std::cout << "session:" << session->id << " open resource:" << session->con->get_resource() << std::endl;
+        if (config_.sendAll || session->filter.hasSubscriptions())
+        {
+            start(session);
+        }
+    }
+
+    void onClose(Hdl hdl)
+    {
+        auto it = sessions_.find(hdl);
+        if (it == sessions_.end())
+        {
+            return;
+        }
+        auto& session = it->second;
+        session->closed = true;
+        session->timer.cancel();
+        printStats(*session, "closed");
+        sessions_.erase(it);
+    }
+
+    void onMessage(Hdl hdl, MessagePtr msg)
+    {
+        auto it = sessions_.find(hdl);
+        if (it == sessions_.end())
+        {
+            return;
+        }
+        auto session = it->second;
+        auto j       = json::parse(msg->get_payload(), nullptr, false);
+        if (j.is_discarded())
+        {
+            return;
+        }
+        // ftx keeps the connection alive with its own pings
+        if (j.is_object() && j.value("op", std::string()) == "ping")
+        {
+            session->con->send(std::string(R"({"type":"pong"})"), websocketpp::frame::opcode::text);
+            return;
+        }
+        std::vector<std::string> replies;
+        try
+        {
+            if (!session->filter.onClientMessage(j, replies))
+            {
+                return;
+            }
+        }
+        catch (const json::exception& e)
+        {
+            std::cout << "session:" << session->id << " bad subscription:" << msg->get_payload() << " " << e.what()
+                      << std::endl;
+            return;
+        }
+        for (auto const& reply : replies)
+        {
+            session->con->send(reply, websocketpp::frame::opcode::text);
+        }
+        std::cout << "session:" << session->id << " subscriptions:" << session->filter.getSubscriptionCount()
+                  << std::endl;
+        if (!session->started)
+        {
+            start(session);
+        }
+    }
+
+    void start(const SessionPtr& session)
+    {
+        session->started   = true;
+        session->wallStart = mdNowNs();
+        pump(session);
+    }
+
+    // sends what is due, at most PumpBatch messages before it yields to the io loop
+    void pump(const SessionPtr& session)
+    {
+        for (size_t batch = 0; batch < PumpBatch; ++batch)
+        {
+            if (session->closed)
+            {
+                return;
+            }
+            if (!session->pending && !nextWanted(*session))
+            {
+                printStats(*session, "capture done");
+                session->con->close(websocketpp::close::status::normal, "capture done");
+                return;
+            }
+
+            auto const now = mdNowNs();
+            auto const due = dueNs(*session);
+            if (!session->burstLeft && due > now)
+            {
+                schedule(session, due - now);
+                return;
+            }
+            if (session->con->get_buffered_amount() > config_.maxBuffered)
+            {
+                ++session->stats.backpressure;
+                schedule(session, 1'000'000);
+                return;
+            }
+
+            session->pending = false;
+            if (config_.gapEvery && ++session->wanted % config_.gapEvery == 0)
+            {
+                ++session->stats.gaps;
+                continue;
+            }
+            session->con->send(session->msg, websocketpp::frame::opcode::text);
+            auto const sent = ++session->stats.sent;
+            session->stats.bytes += session->msg.size();
+            if (session->burstLeft)
+            {
+                --session->burstLeft;
+            }
+
+            if (config_.disconnectAfter && sent == config_.disconnectAfter)
+            {
+                disconnect(session);
+                return;
+            }
+            if (config_.burstEvery && sent % config_.burstEvery == 0)
+            {
+                ++session->stats.bursts;
+                session->burstLeft = config_.burstSize;
+            }
+            if (config_.stallEvery && sent % config_.stallEvery == 0)
+            {
+                ++session->stats.stalls;
+                schedule(session, config_.stallMs * 1'000'000);
+                return;
+            }
+        }
+        schedule(session, 0);
+    }
+
+    // reads up to the next message the session subscribed to
+    bool nextWanted(Session& session)
+    {
+        CaptureMessage msg;
+        while (session.reader.next(msg))
+        {
+            if (!config_.sendAll)
+            {
+                auto j = json::parse(msg.data, msg.data + msg.len, nullptr, false);
+                if (!j.is_discarded() && !session.filter.wants(j))
+                {
+                    ++session.stats.filtered;
+                    continue;
+                }
+            }
+            session.msg.assign(msg.data, msg.len);
+            session.msgTimestamp = msg.timestamp;
+            if (!session.firstTimestamp)
+            {
+                session.firstTimestamp = msg.timestamp;
+            }
+            session.pending = true;
+            return true;
+        }
+        return false;
+    }
+
+    uint64_t dueNs(const Session& session) const
+    {
+        if (config_.mode == ReplayMode::MAX_SPEED || !session.msgTimestamp ||
+            session.msgTimestamp <= session.firstTimestamp)
+        {
+            return 0;
+        }
+        auto const speed = config_.mode == ReplayMode::SCALED && config_.speed > 0 ? config_.speed : 1.0;
+        return session.wallStart + uint64_t((session.msgTimestamp - session.firstTimestamp) / speed);
+    }
+
+    void schedule(const SessionPtr& session, uint64_t delayNs)
+    {
+        std::weak_ptr<Session> weak = session;
+        session->timer.expires_after(std::chrono::nanoseconds(delayNs));
+        session->timer.async_wait([this, weak](const websocketpp::lib::asio::error_code& ec) {
+            auto session = weak.lock();
+            if (!ec && session)
+            {
+                pump(session);
+            }
+        });
+    }
+
+    void disconnect(const SessionPtr& session)
+    {
+        printStats(*session, config_.dropConnection ? "dropping" : "disconnecting");
+        if (config_.dropConnection)
+        {
+            drop(session, false);
+        }
+        else
+        {
+            session->con->close(websocketpp::close::status::going_away, "disconnect injected");
+        }
+    }
+
+    /*
+     * the messages sent so far go out first, then the socket is closed
+     * under websocketpp so the client sees the connection go without a
+     * close frame. The queue is empty once the last write has started, the
+     * socket is closed a millisecond later for it to finish.
+     */
+    void drop(const SessionPtr& session, bool drained)
+    {
+        if (session->closed)
+        {
+            return;
+        }
+        if (drained)
+        {
+            websocketpp::lib::asio::error_code ec;
+            session->con->get_raw_socket().close(ec);
+            return;
+        }
+        drained = session->con->get_buffered_amount() == 0;
+        std::weak_ptr<Session> weak = session;
+        session->timer.expires_after(std::chrono::milliseconds(1));
+        session->timer.async_wait([this, weak, drained](const websocketpp::lib::asio::error_code& ec) {
+            auto session = weak.lock();
+            if (!ec && session)
+            {
+                drop(session, drained);
+            }
+        });
+    }
+
+    void printStats(const Session& session, const char* what) const
+    {
+        auto const& s = session.stats;
+        std::cout << "session:" << session.id << " " << what << " sent:" << s.sent << " bytes:" << s.bytes
+                  << " filtered:" << s.filtered << " gaps:" << s.gaps << " stalls:" << s.stalls
+                  << " bursts:" << s.bursts << " backpressure:" << s.backpressure << std::endl;
+    }
+
+  private:
+    FeedServerConfig config_;
+    Server server_;
+    std::map<Hdl, SessionPtr, std::owner_less<Hdl>> sessions_;
+    uint64_t sessionCount_{0};
+};
+
+} // namespace trading
+} // namespace miye
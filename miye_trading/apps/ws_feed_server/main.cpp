@@ -0,0 +1,157 @@
+/*
+ * ws_feed_server: a local websocket server standing in for an exchange feed
+ *
+ * usage: ws_feed_server -c capture [-p port] [-t -k cert.pem -K key.pem]
+ *                       [-m original|scaled|max] [-r speed] [-a]
+ *                       [-D n] [-T] [-S n -w ms] [-B n -b k] [-G n] [-q bytes]
+ *
+ * Every connection is replayed the capture (see CaptureReader) from its
+ * start once it subscribes, in the ftx, binance or coinbase dialect, or
+ * right away for binance stream urls and with -a, which also sends every
+ * message whatever the subscriptions. -m original keeps the captured gaps
+ * (the default), -m scaled divides them by -r, -m max sends as fast as
+ * the connection drains, up to -q bytes queued.
+ *
+ * Faults, counted in messages sent on the connection:
+ *  -D n      close the connection after n messages, -T drops the tcp
+ *            connection without a close frame instead
+ *  -S n -w   stall every n messages for -w ms
+ *  -B n -b   after every n messages send the next k at once
+ *  -G n      drop every n-th message, a sequence gap for the client
+ *
+ * -t serves wss with the pem certificate and key given by -k and -K, a
+ * self signed pair does for local runs:
+ *   openssl req -x509 -newkey rsa:2048 -nodes -days 365 -subj /CN=localhost \
+ *       -keyout key.pem -out cert.pem
+ */
+#include "feed_server.h"
+
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+using namespace miye::trading;
+
+namespace
+{
+
+using TlsContextPtr = websocketpp::lib::shared_ptr<websocketpp::lib::asio::ssl::context>;
+
+TlsContextPtr makeTlsContext(const std::string& cert, const std::string& key)
+{
+    namespace ssl = websocketpp::lib::asio::ssl;
+    auto ctx      = websocketpp::lib::make_shared<ssl::context>(ssl::context::tls_server);
+    try
+    {
+        ctx->set_options(ssl::context::default_workarounds | ssl::context::no_sslv2 | ssl::context::no_sslv3 |
+                         ssl::context::single_dh_use);
+        ctx->use_certificate_chain_file(cert);
+        ctx->use_private_key_file(key, ssl::context::pem);
+    }
+    catch (const std::exception& e)
+    {
+        std::cout << "ERROR tls context cert:" << cert << " key:" << key << " " << e.what() << std::endl;
+        return nullptr;
+    }
+    return ctx;
+}
+
+void usage(const char* name)
+{
+    std::cerr << "usage: " << name
+              << " -c capture [-p port] [-t -k cert.pem -K key.pem] [-m original|scaled|max] [-r speed] [-a]"
+                 " [-D n] [-T] [-S n -w ms] [-B n -b k] [-G n] [-q bytes]"
+              << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    FeedServerConfig config;
+    uint16_t port = 9443;
+    bool tls      = false;
+    std::string cert;
+    std::string key;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "c:p:tk:K:m:r:aD:TS:w:B:b:G:q:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'c':
+            config.capture = optarg;
+            break;
+        case 'p':
+            port = uint16_t(std::stoi(optarg));
+            break;
+        case 't':
+            tls = true;
+            break;
+        case 'k':
+            cert = optarg;
+            break;
+        case 'K':
+            key = optarg;
+            break;
+        case 'm':
+            if (parseReplayMode(optarg, config.mode) != 0)
+            {
+                return 1;
+            }
+            break;
+        case 'r':
+            config.speed = std::stod(optarg);
+            break;
+        case 'a':
+            config.sendAll = true;
+            break;
+        case 'D':
+            config.disconnectAfter = std::stoull(optarg);
+            break;
+        case 'T':
+            config.dropConnection = true;
+            break;
+        case 'S':
+            config.stallEvery = std::stoull(optarg);
+            break;
+        case 'w':
+            config.stallMs = std::stoull(optarg);
+            break;
+        case 'B':
+            config.burstEvery = std::stoull(optarg);
+            break;
+        case 'b':
+            config.burstSize = std::stoull(optarg);
+            break;
+        case 'G':
+            config.gapEvery = std::stoull(optarg);
+            break;
+        case 'q':
+            config.maxBuffered = std::stoull(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (config.capture.empty() || (tls && (cert.empty() || key.empty())))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (tls)
+    {
+        auto ctx = makeTlsContext(cert, key);
+        if (!ctx)
+        {
+            return 1;
+        }
+        FeedServer<websocketpp::config::asio_tls> server(config);
+        server.getServer().set_tls_init_handler([ctx](websocketpp::connection_hdl) { return ctx; });
+        return server.run(port) == 0 ? 0 : 1;
+    }
+    FeedServer<websocketpp::config::asio> server(config);
+    return server.run(port) == 0 ? 0 : 1;
+}
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <algorithm>
+#include <json/json.hpp>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace miye
+{
+namespace trading
+{
+
+/*
+ * What a feed server connection has subscribed to, in the dialect of the
+ * exchange the capture came from:
+ *  - ftx      {"op":"subscribe","channel":"orderbook","market":"BTC-PERP"}
+ *  - binance  {"method":"SUBSCRIBE","params":["btcusdt@depth5"],"id":1}
+ *             or the streams of a /stream?streams=a/b or /ws/a url
+ *  - coinbase {"type":"subscribe","product_ids":[..],"channels":[..]}
+ * A captured message is wanted when its channel and symbol are subscribed,
+ * messages that name neither (pongs, acks) always are.
+ */
+class SubscriptionFilter
+{
+  public:
+    using json = nlohmann::json;
+
+    // binance takes its streams in the url too
+    void addResource(const std::string& resource)
+    {
+        std::string streams;
+        auto const combined = resource.find("streams=");
+        if (combined != std::string::npos)
+        {
+            streams = resource.substr(combined + 8);
+        }
+        else if (resource.compare(0, 4, "/ws/") == 0)
+        {
+            streams = resource.substr(4);
+        }
+        size_t start = 0;
+        while (start < streams.size())
+        {
+            auto end = std::min(streams.find('/', start), streams.size());
+            if (end > start)
+            {
+                keys_.insert(lower(streams.substr(start, end - start)));
+            }
+            start = end + 1;
+        }
+    }
+
+    /*
+     * false if msg is not a (un)subscribe, otherwise the subscriptions are
+     * updated and the exchange's acknowledgement appended to replies
+     */
+    bool onClientMessage(const json& msg, std::vector<std::string>& replies)
+    {
+        if (!msg.is_object())
+        {
+            return false;
+        }
+        if (msg.count("op") && msg.count("channel"))
+        {
+            auto const& op = msg["op"].get_ref<const std::string&>();
+            if (op != "subscribe" && op != "unsubscribe")
+            {
+                return false;
+            }
+            auto const market = msg.value("market", std::string());
+            auto const key    = msg["channel"].get<std::string>() + ":" + market;
+            update(op == "subscribe", key);
+            replies.push_back(json{{"type", op == "subscribe" ? "subscribed" : "unsubscribed"},
+                                   {"channel", msg["channel"]},
+                                   {"market", market}}
+                                  .dump());
+            return true;
+        }
+        if (msg.count("method") && msg.count("params"))
+        {
+            auto const& method = msg["method"].get_ref<const std::string&>();
+            if (method != "SUBSCRIBE" && method != "UNSUBSCRIBE")
+            {
+                return false;
+            }
+            for (auto const& stream : msg["params"])
+            {
+                update(method == "SUBSCRIBE", lower(stream.get<std::string>()));
+            }
+            replies.push_back(json{{"result", nullptr}, {"id", msg.value("id", json())}}.dump());
+            return true;
+        }
+        if (msg.count("type") && msg.count("channels"))
+        {
+            auto const& type = msg["type"].get_ref<const std::string&>();
+            if (type != "subscribe" && type != "unsubscribe")
+            {
+                return false;
+            }
+            auto const products = msg.value("product_ids", json::array());
+            for (auto const& channel : msg["channels"])
+            {
+                // a channel is a name for all the products or {"name":..,"product_ids":[..]}
+                auto const name = channel.is_string() ? channel.get<std::string>() : channel["name"].get<std::string>();
+                auto const& ids = channel.is_object() && channel.count("product_ids") ? channel["product_ids"] : products;
+                for (auto const& id : ids)
+                {
+                    update(type == "subscribe", name + ":" + id.get<std::string>());
+                }
+            }
+            replies.push_back(json{{"type", "subscriptions"}, {"channels", msg["channels"]}}.dump());
+            return true;
+        }
+        return false;
+    }
+
+    bool hasSubscriptions() const { return !keys_.empty(); }
+    size_t getSubscriptionCount() const { return keys_.size(); }
+
+    bool wants(const json& msg) const
+    {
+        if (!msg.is_object())
+        {
+            return true;
+        }
+        // ftx
+        if (msg.count("channel") && msg.count("market"))
+        {
+            return keys_.count(msg["channel"].get<std::string>() + ":" + msg["market"].get<std::string>()) > 0;
+        }
+        // binance combined stream
+        if (msg.count("stream"))
+        {
+            return keys_.count(lower(msg["stream"].get<std::string>())) > 0;
+        }
+        // binance raw stream, the event names the stream up to its options
+        if (msg.count("e") && msg.count("s"))
+        {
+            auto const prefix = lower(msg["s"].get<std::string>()) + "@" + binanceStream(msg["e"].get<std::string>());
+            auto const it     = keys_.lower_bound(prefix);
+            return it != keys_.end() && it->compare(0, prefix.size(), prefix) == 0;
+        }
+        // coinbase
+        if (msg.count("type") && msg.count("product_id"))
+        {
+            auto const channel = coinbaseChannel(msg["type"].get<std::string>());
+            return keys_.count(channel + ":" + msg["product_id"].get<std::string>()) > 0;
+        }
+        return true;
+    }
+
+  private:
+    void update(bool subscribe, const std::string& key)
+    {
+        if (subscribe)
+        {
+            keys_.insert(key);
+        }
+        else
+        {
+            keys_.erase(key);
+        }
+    }
+
+    static std::string lower(std::string s)
+    {
+        std::transform(s.begin(), s.end(), s.begin(), ::tolower);
+        return s;
+    }
+
+    static std::string binanceStream(const std::string& event)
+    {
+        if (event == "depthUpdate")
+        {
+            return "depth";
+        }
+        if (event == "aggTrade")
+        {
+            return "aggtrade";
+        }
+        if (event == "24hrTicker")
+        {
+            return "ticker";
+        }
+        return lower(event);
+    }
+
+    static std::string coinbaseChannel(const std::string& type)
+    {
+        if (type == "snapshot" || type == "l2update")
+        {
+            return "level2";
+        }
+        if (type == "match" || type == "last_match")
+        {
+            return "matches";
+        }
+        if (type == "received" || type == "open" || type == "done" || type == "change" || type == "activate")
+        {
+            return "full";
+        }
+        return type; // ticker, heartbeat, status
+    }
+
+  private:
+    std::set<std::string> keys_;
+};
+
+} // namespace trading
+} // namespace miye
@@ -16,11 +16,13 @@ namespace miye { namespace essential {
 #if !defined (__tune_haswell__)
 inline uint64_t rdtscp()
 {
+    // cpuid serialises and clobbers eax/ebx/ecx/edx, rdtsc returns in edx:eax
     uint64_t lo, hi;
     __asm__ volatile( "cpuid\n\t"
                       "rdtsc\n\t"
-                      :
-                      "=r" (hi), "=r" (lo));
+                      : "=a" (lo), "=d" (hi)
+                      : "a" (0)
+                      : "%rbx", "%rcx");
     return ((uint64_t)lo) | (((uint64_t)hi) << 32);
 }
 
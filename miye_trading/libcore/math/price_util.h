@@ -53,6 +53,34 @@ inline double roundLot(double qty, double lotSize)
     return std::floor(qty / lotSize) * lotSize;
 }
 
+/*
+ * fixed-point versions, exact integer rounding with no epsilon
+ */
+inline Price roundToBid(Price price, Price tickSize) noexcept { return price.floorTo(tickSize); }
+
+inline Price roundToAsk(Price price, Price tickSize) noexcept { return price.ceilTo(tickSize); }
+
+inline Price roundToTick(Side side, Price price, Price tickSize) noexcept
+{
+    assert(tickSize > Price{});
+
+    if (side == Side::BUY)
+    {
+        return roundToBid(price, tickSize);
+    }
+    if (side == Side::SELL || side == Side::SHORT_SELL)
+    {
+        return roundToAsk(price, tickSize);
+    }
+    return price;
+}
+
+inline Qty roundLot(Qty qty, Qty lotSize)
+{
+    assert(lotSize > Qty{});
+    return qty.floorTo(lotSize);
+}
+
 } // namespace math
 } // namespace trading
 } // namespace miye
@@ -0,0 +1,76 @@
+#include "benchmark/benchmark.h"
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#include "libcore/math/decimal.hpp"
+
+// prices and sizes from coinbase ticker/l2update and binance depth captures
+static const char* decimals[] = {
+    "4388.01000000", "0.03000000", "4388",       "4388.01",        "6500.09",
+    "0.84702376",    "6507.00",    "1.88933140", "6505.54",        "0",
+    "1.12386524",    "38.2",       "0.00215900", "57120.31000000", "0.00000100",
+};
+static const size_t decimal_count = sizeof(decimals) / sizeof(decimals[0]);
+
+static size_t lengths[decimal_count];
+static const bool lengths_init = [] {
+    for (size_t i = 0; i < decimal_count; ++i)
+        lengths[i] = strlen(decimals[i]);
+    return true;
+}();
+
+static void parse_double(benchmark::State& state)
+{
+    size_t i = 0;
+    double d = 0;
+    while (state.KeepRunning())
+    {
+        auto const n = i++ % decimal_count;
+        benchmark::DoNotOptimize(miye::math::parse_double(decimals[n], lengths[n], d));
+        benchmark::DoNotOptimize(d);
+    }
+}
+
+BENCHMARK(parse_double);
+
+static void parse_scaled(benchmark::State& state)
+{
+    size_t i = 0;
+    int64_t v = 0;
+    while (state.KeepRunning())
+    {
+        auto const n = i++ % decimal_count;
+        benchmark::DoNotOptimize(miye::math::parse_scaled(decimals[n], lengths[n], 8, v));
+        benchmark::DoNotOptimize(v);
+    }
+}
+
+BENCHMARK(parse_scaled);
+
+static void std_strtod(benchmark::State& state)
+{
+    size_t i = 0;
+    char* end;
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(strtod(decimals[i++ % decimal_count], &end));
+    }
+}
+
+BENCHMARK(std_strtod);
+
+// what the coinbase handler did before, the string copy is part of the cost
+static void std_stod(benchmark::State& state)
+{
+    size_t i = 0;
+    while (state.KeepRunning())
+    {
+        auto const n = i++ % decimal_count;
+        benchmark::DoNotOptimize(std::stod(std::string(decimals[n], lengths[n])));
+    }
+}
+
+BENCHMARK(std_stod);
+
+BENCHMARK_MAIN();
@@ -9,7 +9,9 @@
 #include "message/command_nologging.hpp"
 #include "message/message.hpp"
 #include <algorithm>
+#include <cmath>
 #include <deque>
+#include <limits>
 
 #include "message/english.hpp"
 
@@ -25,6 +27,8 @@ using namespace types;
 typedef std::deque<message::any_order> responses_t;
 
 constexpr static const fp_t TICK_EPSILON = 0.0000001;
+constexpr static const uint32_t NO_QUEUE_LEVEL =
+    std::numeric_limits<uint32_t>::max();
 
 struct om
 {
@@ -36,7 +40,8 @@ struct om
               market_traded_volume_through_limit(0), open_qty(o->volume),
               exec_qty(0), price(o->price), last_quote_volume(0),
               session(o->session), side(o->side),
-              first_tick_after_latency(false)
+              first_tick_after_latency(false), queue_level(NO_QUEUE_LEVEL),
+              queue_raw(0)
         {
         }
 
@@ -53,6 +58,26 @@ struct om
         session_t session;
         message::side_t side;
         bool first_tick_after_latency;
+        // queue mode: index into queue_levels once the order rests
+        uint32_t queue_level;
+        fp_t queue_raw;
+    };
+
+    /*
+     * queue mode keeps one of these per price our orders rest at. volume
+     * ahead of an order is queue_raw * scale + shift, so a trade (shift) or
+     * a proportional cancel (scale and shift) moves the whole queue in one
+     * step, whatever the number of orders at the price
+     */
+    struct queue_level
+    {
+        price_t price;
+        message::side_t side;
+        fp_t displayed; // market volume at price on the last quote
+        fp_t scale;
+        fp_t shift;
+        fp_t min_raw; // front of our orders, nothing fills before it does
+        uint32_t orders;
     };
 
     uint64_t latency;
@@ -65,6 +90,7 @@ struct om
     message::exchange_sim_type_t type;
 
     std::vector<order> orders;
+    std::vector<queue_level> queue_levels;
 
     om(instrument_id_t inst_id, strategy_id_t strategy, uint64_t latency,
        message::exchange_sim_type_t type, bool synthesise_book, fp_t tick_size)
@@ -98,7 +124,7 @@ struct om
             INVARIANT_MSG(false,
                           "Sim exchange handling dupe insert " << o->order_key);
         }
-        if (orders.size() > 1)
+        if (type != message::exchange_sim_type_t::queue && orders.size() > 1)
         {
             INVARIANT_MSG(false,
                           "Sim exchange currently handles only one live order "
@@ -164,6 +190,9 @@ struct om
         case message::exchange_sim_type_t::continuous:
             process_continuous_cancel(now, o, output);
             break;
+        case message::exchange_sim_type_t::queue:
+            process_queue_cancel(now, o, output);
+            break;
         default:
             INVARIANT_FAIL("Unsupported exchange simulator type: " << type);
             break;
@@ -185,6 +214,8 @@ struct om
             return process_sim(now, quote, output);
         case message::exchange_sim_type_t::continuous:
             return process_continuous(now, quote, output);
+        case message::exchange_sim_type_t::queue:
+            return process_queue(now, quote, output);
         default:
             break;
         }
@@ -610,6 +641,346 @@ struct om
         return false;
     }
 
+    /*
+    queue mode, for passive strategies: an order that crosses when it gets to
+    the market takes liquidity as in sim mode, what is left joins the back of
+    the queue at its price. from then on
+    1 trades at our price eat the volume ahead of us, anything beyond it
+      fills us at our price
+    2 trades through our price, or the other side of the book reaching it,
+      fill us whatever was ahead
+    3 volume leaving our price without trading is taken as cancels spread
+      evenly over the queue, so what is ahead shrinks in proportion. volume
+      joining goes behind us
+    each quote costs O(1) per price we rest at, orders are only walked when
+    something fills
+    */
+    inline bool process_queue(uint64_t now, const message::quote* quote,
+                              responses_t& output)
+    {
+        if (orders.empty() || quote->instrument != inst_id ||
+            !quote->is_tradeable())
+        {
+            return false;
+        }
+
+        auto const fills = sequence;
+        uint32_t resting = 0;
+        for (uint32_t l = 0; l < queue_levels.size(); ++l)
+        {
+            if (queue_levels[l].orders > 0)
+            {
+                update_queue_level(l, quote, output);
+                resting += queue_levels[l].orders;
+            }
+        }
+
+        // levels first, an order joining on this quote is behind its volume
+        if (resting < orders.size())
+        {
+            for (auto& o : orders)
+            {
+                if (o.queue_level == NO_QUEUE_LEVEL && o.open_qty > 0 &&
+                    now - o.arrival_time >= latency)
+                {
+                    fill(&o, quote, output, 0,
+                         message::quote::MAX_BOOK_LEVELS - 1);
+                    if (o.open_qty > 0)
+                    {
+                        join_queue(o, std::max(displayed_at(quote, o.side,
+                                                            o.price),
+                                               fp_t(0.0)));
+                    }
+                }
+            }
+        }
+
+        if (fills != sequence)
+        {
+            for (auto it = orders.begin(); it != orders.end();)
+            {
+                if (it->open_qty == 0)
+                {
+                    leave_queue(*it);
+                    it = orders.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+        return true;
+    }
+
+    inline void update_queue_level(uint32_t l, const message::quote* quote,
+                                   responses_t& output)
+    {
+        queue_level& level = queue_levels[l];
+        bool const buy = level.side == message::side_t::buy;
+        fp_t expected = level.displayed;
+
+        if (quote->type == message::msg_type_t::trade_summary_quote)
+        {
+            const message::trade_summary_quote* ts =
+                reinterpret_cast<const message::trade_summary_quote*>(quote);
+            price_t const px = buy ? ts->trade_buy_px : ts->trade_sell_px;
+            quantity_t const qty = buy ? ts->trade_buy_qty : ts->trade_sell_qty;
+            if (qty > 0)
+            {
+                if (same_level(px, level.price))
+                {
+                    fill_queue(l, qty, output, false);
+                    level.shift -= qty;
+                    expected -= qty;
+                }
+                else if (buy ? px < level.price : px > level.price)
+                {
+                    fill_queue(l, qty, output, true);
+                    clear_queue(l);
+                    expected = 0;
+                }
+            }
+        }
+
+        fp_t const crossing = crossing_volume(quote, level);
+        if (crossing > 0)
+        {
+            fill_queue(l, crossing, output, true);
+            clear_queue(l);
+            expected = 0;
+        }
+
+        fp_t const displayed = displayed_at(quote, level.side, level.price);
+        if (displayed < 0)
+        {
+            // our price is beyond the levels the quote carries
+            level.displayed = std::max(expected, fp_t(0.0));
+            return;
+        }
+        if (expected > 0 && displayed < expected)
+        {
+            fp_t const remaining = displayed / expected;
+            level.scale *= remaining;
+            level.shift *= remaining;
+        }
+        level.displayed = displayed;
+    }
+
+    /*
+    our orders at level l fill in arrival order from volume traded there,
+    after the market volume ahead of each unless the level traded through
+    */
+    inline void fill_queue(uint32_t l, fp_t volume, responses_t& output,
+                           bool through)
+    {
+        queue_level const& level = queue_levels[l];
+        if (!through && volume <= level.min_raw * level.scale + level.shift)
+        {
+            return;
+        }
+        for (auto& o : orders)
+        {
+            if (o.queue_level != l || o.open_qty == 0)
+            {
+                continue;
+            }
+            fp_t const available =
+                through ? volume
+                        : volume - std::max(queue_ahead(o), fp_t(0.0));
+            if (available >= fp_t(1.0))
+            {
+                quantity_t exec_qty =
+                    send_fill(output, &o, quantity_t(available), o.price);
+                o.open_qty -= exec_qty;
+                o.exec_qty += exec_qty;
+                volume -= exec_qty;
+            }
+        }
+    }
+
+    // nothing ahead of any of our orders at level l
+    inline void clear_queue(uint32_t l)
+    {
+        queue_levels[l].scale = 0;
+        queue_levels[l].shift = 0;
+    }
+
+    inline fp_t queue_ahead(const order& o) const
+    {
+        queue_level const& level = queue_levels[o.queue_level];
+        return o.queue_raw * level.scale + level.shift;
+    }
+
+    inline void join_queue(order& o, fp_t ahead)
+    {
+        uint32_t l = 0;
+        for (; l < queue_levels.size(); ++l)
+        {
+            queue_level const& level = queue_levels[l];
+            if (level.orders > 0 && level.side == o.side &&
+                same_level(level.price, o.price))
+            {
+                break;
+            }
+        }
+        if (l == queue_levels.size())
+        {
+            // reuse a level nothing rests at any more
+            l = 0;
+            while (l < queue_levels.size() && queue_levels[l].orders > 0)
+            {
+                ++l;
+            }
+            if (l == queue_levels.size())
+            {
+                queue_levels.emplace_back();
+            }
+            queue_levels[l] = queue_level{o.price,
+                                          o.side,
+                                          ahead,
+                                          fp_t(1.0),
+                                          fp_t(0.0),
+                                          std::numeric_limits<fp_t>::max(),
+                                          0};
+        }
+
+        queue_level& level = queue_levels[l];
+        if (level.scale < TICK_EPSILON)
+        {
+            renormalise_queue(l);
+        }
+        o.queue_level = l;
+        o.queue_raw = (ahead - level.shift) / level.scale;
+        level.min_raw = std::min(level.min_raw, o.queue_raw);
+        ++level.orders;
+    }
+
+    inline void leave_queue(order& o)
+    {
+        if (o.queue_level == NO_QUEUE_LEVEL)
+        {
+            return;
+        }
+        uint32_t const l = o.queue_level;
+        o.queue_level = NO_QUEUE_LEVEL;
+        if (--queue_levels[l].orders > 0 &&
+            o.queue_raw <= queue_levels[l].min_raw)
+        {
+            update_min_raw(l);
+        }
+    }
+
+    /*
+    a queue that emptied leaves scale at 0, where a new order cannot be
+    placed. bake what is ahead of each order back into queue_raw
+    */
+    inline void renormalise_queue(uint32_t l)
+    {
+        queue_level& level = queue_levels[l];
+        for (auto& o : orders)
+        {
+            if (o.queue_level == l)
+            {
+                o.queue_raw = std::max(queue_ahead(o), fp_t(0.0));
+            }
+        }
+        level.scale = fp_t(1.0);
+        level.shift = fp_t(0.0);
+        update_min_raw(l);
+    }
+
+    inline void update_min_raw(uint32_t l)
+    {
+        fp_t min_raw = std::numeric_limits<fp_t>::max();
+        for (auto const& o : orders)
+        {
+            if (o.queue_level == l)
+            {
+                min_raw = std::min(min_raw, o.queue_raw);
+            }
+        }
+        queue_levels[l].min_raw = min_raw;
+    }
+
+    /*
+    market volume at px on a side of the quote, 0 when px is inside the book
+    but empty, -1 when it is beyond the levels the quote carries
+    */
+    inline fp_t displayed_at(const message::quote* quote, message::side_t side,
+                             price_t px) const
+    {
+        bool const buy = side == message::side_t::buy;
+        for (size_t level = 0; level < message::quote::MAX_BOOK_LEVELS;
+             ++level)
+        {
+            price_t const level_px =
+                buy ? quote->bid_px[level] : quote->ask_px[level];
+            quantity_t const level_qty =
+                buy ? quote->bid_qty[level] : quote->ask_qty[level];
+            if (level_qty == 0)
+            {
+                break;
+            }
+            if (same_level(level_px, px))
+            {
+                return level_qty;
+            }
+            if (buy ? level_px < px : level_px > px)
+            {
+                return 0;
+            }
+        }
+        return -1;
+    }
+
+    /*
+     * prices on the same tick, within half a tick of each other.
+     * approximatelyEqual's tolerance is relative to the price, at 100 a
+     * tick of 0.01 would match a hundred ticks either side
+     */
+    inline bool same_level(fp_t a, fp_t b) const
+    {
+        return std::fabs(a - b) < tick_size / fp_t(2.0);
+    }
+
+    // volume on the other side at or through our price
+    inline fp_t crossing_volume(const message::quote* quote,
+                                queue_level const& level) const
+    {
+        bool const buy = level.side == message::side_t::buy;
+        fp_t volume = 0;
+        for (size_t l = 0; l < message::quote::MAX_BOOK_LEVELS; ++l)
+        {
+            price_t const px = buy ? quote->ask_px[l] : quote->bid_px[l];
+            quantity_t const qty = buy ? quote->ask_qty[l] : quote->bid_qty[l];
+            if (qty == 0 ||
+                (buy ? px > level.price + tick_size / fp_t(2.0)
+                     : px < level.price - tick_size / fp_t(2.0)))
+            {
+                break;
+            }
+            volume += qty;
+        }
+        return volume;
+    }
+
+    inline void process_queue_cancel(uint64_t now,
+                                     const message::order_cancel* o,
+                                     responses_t& output)
+    {
+        std::vector<order>::iterator it = find(o->order_key);
+        if (it == orders.end())
+        {
+            INVARIANT_MSG(false,
+                          "Sim exchange cannot find for cancel order key "
+                              << o->order_key);
+        }
+        leave_queue(*it);
+        send_cancel(&(*it), o, output);
+        orders.erase(it);
+    }
+
     inline void send_cancel(order* it, const message::order_cancel* o,
                             responses_t& output)
     {
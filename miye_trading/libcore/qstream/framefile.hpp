@@ -0,0 +1,445 @@
+/*
+ * framefile.hpp
+ * Purpose: read a framefile - archival analysis, seekable
+ *
+ * framefile_r:/data/md/20210901/ftx.md.qf@timed,threads=2,ahead=8
+ *
+ * The file is mapped and a pool of threads inflates the frames ahead of the
+ * reader into a ring of buffers, so a replay costs the reader no more than
+ * walking an mmfile. threads=0 inflates on the reading thread. seek() finds
+ * the frame of a timestamp from the index and restarts the pool there.
+ *
+ * A place returned by read() stays valid until the next read().
+ */
+#pragma once
+
+#include "zlib.h"
+
+#include "arbiter_common.hpp"
+#include "framefile_headers.hpp"
+#include "libcore/essential/assert.hpp"
+#include "libcore/utils/syscalls_files.hpp"
+#include "libcore/utils/syscalls_misc.hpp"
+#include "libcore/utils/syscalls_mmap.hpp"
+#include "qstream_common.hpp"
+#include "qstream_reader_interface.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <sys/mman.h>
+#include <thread>
+#include <vector>
+
+//#LINKFLAGS=-lz -lpthread
+
+namespace miye
+{
+namespace qstream
+{
+
+template <typename Clock>
+class framefile : public qstream_reader_interface<framefile<Clock>>
+{
+    struct free_deleter
+    {
+        void operator()(char* p) const { free(p); }
+    };
+
+    struct slot
+    {
+        std::unique_ptr<char, free_deleter> data;
+        uint64_t frame{0};
+        bool ready{false};
+    };
+
+  public:
+    framefile(const framefile&) = delete;
+    framefile& operator=(const framefile&) = delete;
+
+    framefile(Clock& clk_, const std::string& description_)
+        : clk(clk_), description(description_)
+    {
+        initialize();
+    }
+    ~framefile()
+    {
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            stopping_ = true;
+        }
+        work_cv_.notify_all();
+        for (auto& t : workers_)
+        {
+            t.join();
+        }
+        inflateEnd(&inline_stream_);
+        syscalls::munmap(membase_, file_size_);
+        syscalls::close(fd_);
+    }
+
+    void initialize()
+    {
+        timed = is_timed(extract_streamoptions(description));
+        auto path = extract_path(description);
+        fd_ = syscalls::open(path.c_str(), O_RDONLY);
+        struct stat st;
+        INVARIANT(::fstat(fd_, &st) == 0);
+        file_size_ = st.st_size;
+        INVARIANT_MSG(file_size_ >= sizeof(framefile_header) + sizeof(mmap_header) +
+                                        sizeof(framefile_trailer),
+                      "too short for a framefile " << DUMP(path) << DUMP(file_size_));
+
+        membase_ = static_cast<char*>(
+            syscalls::mmap64(0, file_size_, PROT_READ, MAP_SHARED, fd_, 0));
+        ::madvise(membase_, file_size_, MADV_SEQUENTIAL);
+
+        header_ = reinterpret_cast<const framefile_header*>(membase_);
+        INVARIANT_MSG(header_->magic == framefile_magic,
+                      " bad framefile header " << std::hex << DUMP(header_->magic)
+                                               << " " DUMP(framefile_magic));
+        INVARIANT_MSG(header_->version == framefile_version, DUMP(header_->version));
+
+        auto trailer = reinterpret_cast<const framefile_trailer*>(
+            membase_ + file_size_ - sizeof(framefile_trailer));
+        INVARIANT_MSG(trailer->magic == framefile_magic,
+                      "framefile has no index, was it closed? " << DUMP(path));
+        frame_count_ = trailer->frame_count;
+        record_count_ = trailer->record_count;
+        index_ = reinterpret_cast<const frame_index_entry*>(membase_ + trailer->index_offset);
+
+        rec_size = extract_recordsize(description);
+        if (rec_size == 0)
+        {
+            rec_size = header_->rec_size;
+        }
+        INVARIANT_MSG(rec_size == header_->rec_size,
+                      "record size check mismatch provided option vs in file"
+                          << DUMP(rec_size) << DUMP(header_->rec_size));
+
+        auto threads_val = extract_val_for_key(description, "threads=");
+        auto ahead_val = extract_val_for_key(description, "ahead=");
+        uint32_t threads = threads_val.empty() ? 2 : std::stoul(threads_val);
+        depth_ = ahead_val.empty() ? 2 * threads + 2 : std::stoul(ahead_val);
+        depth_ = std::max(depth_, 2u);
+
+        uint32_t max_raw = 0;
+        for (uint64_t f = 0; f < frame_count_; ++f)
+        {
+            max_raw = std::max(max_raw, index_[f].raw_size);
+        }
+        slots_.resize(depth_);
+        for (auto& s : slots_)
+        {
+            void* allocated;
+            syscalls::posix_memalign(&allocated, CACHE_LINE_SIZE, std::max(max_raw, 1u));
+            s.data.reset(static_cast<char*>(allocated));
+        }
+
+        init_stream(inline_stream_);
+        for (uint32_t i = 0; i < threads; ++i)
+        {
+            workers_.emplace_back([this] { work(); });
+        }
+        restart(0);
+    }
+
+    const place read(bool fast_forwarding = false)
+    {
+        // the record handed out last is done with, its frame can be reused
+        release(frame_);
+        if (!ensure())
+        {
+            return place::eof();
+        }
+        uint64_t timestamp = reinterpret_cast<const record_header<false>*>(cursor_)->timestamp;
+        size_t this_rec_size = rec_size;
+        char* p;
+        if (!rec_size)
+        {
+            auto r = reinterpret_cast<record_header<true>*>(cursor_);
+            this_rec_size = r->rec_size;
+            p = r->payload;
+        }
+        else
+        {
+            p = reinterpret_cast<record_header<false>*>(cursor_)->payload;
+        }
+        cursor_ += record_bytes(cursor_);
+
+        if (timed && !fast_forwarding)
+        {
+            clk.set(timestamp);
+        }
+        return place(p, this_rec_size);
+    }
+
+    void slow_attest(uint64_t* next_ts)
+    {
+        attest(next_ts);
+    }
+
+    void attest(uint64_t* next_timestamp)
+    {
+        if (!ensure())
+        {
+            // ready to return eof
+            if (*next_timestamp != withdrawn_timestamp)
+            {
+                *next_timestamp = clk.now();
+            }
+            return;
+        }
+        *next_timestamp = reinterpret_cast<const record_header<false>*>(cursor_)->timestamp;
+    }
+
+    // the next read() returns the first record at or after ts, log(frames) to find its frame
+    void seek(uint64_t ts)
+    {
+        auto f = std::lower_bound(index_, index_ + frame_count_, ts,
+                                  [](const frame_index_entry& e, uint64_t t) { return e.last_ts < t; }) -
+                 index_;
+        if (loaded_ && uint64_t(f) == frame_)
+        {
+            cursor_ = slots_[frame_ % depth_].data.get();
+        }
+        else
+        {
+            restart(f);
+        }
+        skip_to(ts);
+    }
+
+    void fast_forward(uint64_t stop_ts = 0)
+    {
+        if (!stop_ts)
+        {
+            stop_ts = last_write_ts();
+        }
+        if (!ensure())
+        {
+            return;
+        }
+        if (index_[frame_].last_ts < stop_ts)
+        {
+            seek(stop_ts);
+        }
+        else
+        {
+            skip_to(stop_ts);
+        }
+    }
+
+    uint64_t last_write_ts()
+    {
+        return header_->write_timestamp;
+    }
+
+    uint64_t frame_count() const { return frame_count_; }
+    uint64_t record_count() const { return record_count_; }
+
+    Clock& clk;
+    const std::string description;
+
+  private:
+    static const uint64_t entry_alignment = CACHE_LINE_SIZE;
+
+    size_t record_bytes(const char* r) const
+    {
+        if (!rec_size)
+        {
+            return ROUND_UP(reinterpret_cast<const record_header<true>*>(r)->rec_size +
+                                sizeof(record_header<true>),
+                            entry_alignment);
+        }
+        return ROUND_UP(rec_size + sizeof(record_header<false>), entry_alignment);
+    }
+
+    void skip_to(uint64_t ts)
+    {
+        while (ensure() && reinterpret_cast<const record_header<false>*>(cursor_)->timestamp < ts)
+        {
+            cursor_ += record_bytes(cursor_);
+        }
+    }
+
+    // true when cursor_ is on a record, moves to the next frame at the end of one
+    bool ensure()
+    {
+        while (cursor_ == end_)
+        {
+            if (!loaded_)
+            {
+                if (frame_ >= frame_count_)
+                {
+                    return false;
+                }
+                load(frame_);
+            }
+            else if (frame_ + 1 >= frame_count_)
+            {
+                return false;
+            }
+            else
+            {
+                load(frame_ + 1);
+            }
+        }
+        return true;
+    }
+
+    void load(uint64_t f)
+    {
+        auto& s = slots_[f % depth_];
+        if (workers_.empty())
+        {
+            inflate_frame(inline_stream_, f, s.data.get());
+        }
+        else
+        {
+            std::unique_lock<std::mutex> lk(mutex_);
+            ready_cv_.wait(lk, [&] { return s.ready && s.frame == f; });
+        }
+        frame_ = f;
+        loaded_ = true;
+        cursor_ = s.data.get();
+        end_ = cursor_ + index_[f].raw_size;
+    }
+
+    void release(uint64_t f)
+    {
+        if (workers_.empty() || f <= released_)
+        {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            released_ = f;
+        }
+        work_cv_.notify_all();
+    }
+
+    // drops whatever the pool has inflated and starts it again at frame f
+    void restart(uint64_t f)
+    {
+        if (!workers_.empty())
+        {
+            std::unique_lock<std::mutex> lk(mutex_);
+            ++generation_;
+            ready_cv_.wait(lk, [&] { return busy_ == 0; });
+            for (auto& s : slots_)
+            {
+                s.ready = false;
+            }
+            next_claim_ = f;
+            released_ = f;
+            lk.unlock();
+            work_cv_.notify_all();
+        }
+        frame_ = f;
+        loaded_ = false;
+        cursor_ = end_ = nullptr;
+    }
+
+    // a worker takes the next frame once the reader is done with the one in its slot
+    void work()
+    {
+        z_stream stream;
+        init_stream(stream);
+        std::unique_lock<std::mutex> lk(mutex_);
+        for (;;)
+        {
+            work_cv_.wait(lk, [&] {
+                return stopping_ || (next_claim_ < frame_count_ && next_claim_ < released_ + depth_);
+            });
+            if (stopping_)
+            {
+                break;
+            }
+            auto f = next_claim_++;
+            auto generation = generation_;
+            auto& s = slots_[f % depth_];
+            s.ready = false;
+            ++busy_;
+            lk.unlock();
+
+            inflate_frame(stream, f, s.data.get());
+
+            lk.lock();
+            --busy_;
+            if (generation == generation_)
+            {
+                s.frame = f;
+                s.ready = true;
+            }
+            ready_cv_.notify_all();
+        }
+        inflateEnd(&stream);
+    }
+
+    void init_stream(z_stream& stream)
+    {
+        stream.zalloc = Z_NULL;
+        stream.zfree = Z_NULL;
+        stream.opaque = Z_NULL;
+        stream.avail_in = 0;
+        stream.next_in = Z_NULL;
+        int ret = inflateInit2(&stream, -MAX_WBITS);
+        INVARIANT(ret == Z_OK);
+    }
+
+    void inflate_frame(z_stream& stream, uint64_t f, char* out)
+    {
+        auto& entry = index_[f];
+        auto frame = reinterpret_cast<const frame_header*>(membase_ + entry.offset);
+        INVARIANT_MSG(frame->raw_size == entry.raw_size && frame->first_ts == entry.first_ts,
+                      "frame header does not match index " << DUMP(f) << DUMP(description));
+
+        inflateReset(&stream);
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(membase_) + entry.offset +
+                                                  sizeof(frame_header));
+        stream.avail_in = frame->compressed_size;
+        stream.next_out = reinterpret_cast<Bytef*>(out);
+        stream.avail_out = frame->raw_size;
+        int ret = inflate(&stream, Z_FINISH);
+        INVARIANT_MSG(ret == Z_STREAM_END && stream.avail_out == 0,
+                      "corrupt frame " << DUMP(f) << DUMP(ret) << DUMP(description));
+        INVARIANT_MSG(crc32(0L, reinterpret_cast<Bytef*>(out), frame->raw_size) == frame->crc,
+                      "frame crc mismatch " << DUMP(f) << DUMP(description));
+    }
+
+  private:
+    uint64_t rec_size{0};
+    bool timed{false};
+    int fd_{-1};
+    char* membase_{nullptr};
+    size_t file_size_{0};
+    const framefile_header* header_{nullptr};
+    const frame_index_entry* index_{nullptr};
+    uint64_t frame_count_{0};
+    uint64_t record_count_{0};
+
+    // reader side
+    uint64_t frame_{0};
+    bool loaded_{false};
+    char* cursor_{nullptr};
+    char* end_{nullptr};
+    z_stream inline_stream_;
+
+    // the pool, under mutex_
+    uint32_t depth_{0};
+    std::vector<slot> slots_;
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable ready_cv_;
+    uint64_t next_claim_{0};
+    uint64_t released_{0};
+    uint64_t generation_{0};
+    uint32_t busy_{0};
+    bool stopping_{false};
+};
+
+} // namespace qstream
+} // namespace miye
@@ -0,0 +1,73 @@
+/*
+ * framefile_headers.hpp
+ * Purpose: on disk layout of a framefile, a seekable compressed mmfile
+ *
+ * [framefile_header][mmap_header of the source mmfile]
+ * [frame_header][deflated records] ... one per frame
+ * [frame_index_entry] ... one per frame
+ * [framefile_trailer]
+ *
+ * A frame holds whole records exactly as they sit in the mmfile, header,
+ * payload and padding to the entry alignment, so a reader walks an inflated
+ * frame the same way mmap_reader walks the mapping. Frames are deflated on
+ * their own, any frame can be inflated without the ones before it.
+ */
+#pragma once
+
+#include "mmap_headers.hpp"
+
+#include <cstdint>
+
+namespace miye
+{
+namespace qstream
+{
+
+// "qframes1" as a little endian 64bit int
+static const uint64_t framefile_magic = 0x3173656d61726671;
+static const uint32_t framefile_version = 1;
+static const uint32_t framefile_default_frame_size = 1024 * 1024;
+
+struct framefile_header
+{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t frame_size; // raw bytes the writer aimed for per frame
+    uint64_t rec_size;   // 0 is variable size records
+    uint64_t write_timestamp;
+    uint64_t reserved[4];
+};
+static_assert(sizeof(framefile_header) == 64, "framefile header size");
+
+struct frame_header
+{
+    uint64_t first_ts;
+    uint64_t last_ts;
+    uint32_t records;
+    uint32_t raw_size;
+    uint32_t compressed_size;
+    uint32_t crc; // crc32 of the inflated records
+};
+static_assert(sizeof(frame_header) == 32, "frame header size");
+
+struct frame_index_entry
+{
+    uint64_t offset; // of the frame_header in the file
+    uint64_t first_ts;
+    uint64_t last_ts;
+    uint32_t records;
+    uint32_t raw_size;
+};
+static_assert(sizeof(frame_index_entry) == 32, "frame index entry size");
+
+struct framefile_trailer
+{
+    uint64_t index_offset;
+    uint64_t frame_count;
+    uint64_t record_count;
+    uint64_t magic;
+};
+static_assert(sizeof(framefile_trailer) == 32, "framefile trailer size");
+
+} // namespace qstream
+} // namespace miye
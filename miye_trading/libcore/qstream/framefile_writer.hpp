@@ -0,0 +1,153 @@
+/*
+ * framefile_writer.hpp
+ * Purpose: build a framefile from the records of an mmfile
+ * offline archival, not latency critical
+ */
+#pragma once
+
+#include "zlib.h"
+
+#include "framefile_headers.hpp"
+#include "libcore/essential/assert.hpp"
+#include "libcore/utils/syscalls_files.hpp"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+//#LINKFLAGS=-lz
+
+namespace miye
+{
+namespace qstream
+{
+
+class framefile_writer
+{
+  public:
+    // source is the header of the mmfile the records come from
+    framefile_writer(const std::string& path, const mmap_header& source,
+                     uint32_t frame_size = framefile_default_frame_size,
+                     int level = Z_DEFAULT_COMPRESSION)
+        : frame_size_(frame_size), level_(level)
+    {
+        fd_ = syscalls::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+        framefile_header header{};
+        header.magic = framefile_magic;
+        header.version = framefile_version;
+        header.frame_size = frame_size_;
+        header.rec_size = source.rec_size;
+        header.write_timestamp = source.write_timestamp;
+        put(&header, sizeof(header));
+        put(&source, sizeof(source));
+
+        raw_.reserve(frame_size_ + mmap_max_recordsize);
+    }
+    ~framefile_writer()
+    {
+        close();
+    }
+
+    // a whole record with its record_header and padding as it is in the mmfile
+    void append(const void* record, size_t bytes)
+    {
+        auto ts = reinterpret_cast<const record_header<false>*>(record)->timestamp;
+        if (!frame_.records)
+        {
+            frame_.first_ts = ts;
+        }
+        frame_.last_ts = ts;
+        ++frame_.records;
+        auto p = static_cast<const char*>(record);
+        raw_.insert(raw_.end(), p, p + bytes);
+        if (raw_.size() >= frame_size_)
+        {
+            flush();
+        }
+    }
+
+    // writes the last frame, the index and the trailer
+    void close()
+    {
+        if (fd_ < 0)
+        {
+            return;
+        }
+        flush();
+        framefile_trailer trailer;
+        trailer.index_offset = offset_;
+        trailer.frame_count = index_.size();
+        trailer.record_count = records_;
+        trailer.magic = framefile_magic;
+        put(index_.data(), index_.size() * sizeof(frame_index_entry));
+        put(&trailer, sizeof(trailer));
+        syscalls::close(fd_);
+        fd_ = -1;
+    }
+
+    uint64_t frames() const { return index_.size(); }
+    uint64_t records() const { return records_; }
+    uint64_t raw_bytes() const { return raw_bytes_; }
+    uint64_t bytes_written() const { return offset_; }
+
+  private:
+    void flush()
+    {
+        if (!frame_.records)
+        {
+            return;
+        }
+        z_stream stream{};
+        int ret = deflateInit2(&stream, level_, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+        INVARIANT_MSG(ret == Z_OK, "deflateInit2 failed " << DUMP(ret));
+        compressed_.resize(deflateBound(&stream, raw_.size()));
+        stream.next_in = reinterpret_cast<Bytef*>(raw_.data());
+        stream.avail_in = raw_.size();
+        stream.next_out = reinterpret_cast<Bytef*>(compressed_.data());
+        stream.avail_out = compressed_.size();
+        ret = deflate(&stream, Z_FINISH);
+        INVARIANT_MSG(ret == Z_STREAM_END, "deflate failed " << DUMP(ret));
+        deflateEnd(&stream);
+
+        frame_.raw_size = raw_.size();
+        frame_.compressed_size = stream.total_out;
+        frame_.crc = crc32(0L, reinterpret_cast<Bytef*>(raw_.data()), raw_.size());
+        index_.push_back(
+            {offset_, frame_.first_ts, frame_.last_ts, frame_.records, frame_.raw_size});
+        put(&frame_, sizeof(frame_));
+        put(compressed_.data(), frame_.compressed_size);
+
+        records_ += frame_.records;
+        raw_bytes_ += raw_.size();
+        frame_ = frame_header{};
+        raw_.clear();
+    }
+
+    void put(const void* data, size_t bytes)
+    {
+        auto p = static_cast<const char*>(data);
+        while (bytes)
+        {
+            auto written = syscalls::write(fd_, p, bytes);
+            p += written;
+            bytes -= written;
+            offset_ += written;
+        }
+    }
+
+  private:
+    int fd_;
+    uint32_t frame_size_;
+    int level_;
+    uint64_t offset_{0};
+    uint64_t records_{0};
+    uint64_t raw_bytes_{0};
+    frame_header frame_{};
+    std::vector<char> raw_;
+    std::vector<char> compressed_;
+    std::vector<frame_index_entry> index_;
+};
+
+} // namespace qstream
+} // namespace miye
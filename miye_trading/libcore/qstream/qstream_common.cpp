@@ -235,6 +235,10 @@ qstream_type_t from_str(std::string stream_type_desc)
     {
         qstream_type = qstream_type_t::gzfile;
     }
+    else if (!stream_type_desc.compare("framefile_r"))
+    {
+        qstream_type = qstream_type_t::framefile;
+    }
     else if (!stream_type_desc.compare("exchangesim_r"))
     {
         qstream_type = qstream_type_t::exchangesim_reader;
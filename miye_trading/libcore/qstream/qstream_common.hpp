@@ -82,6 +82,7 @@ enum class qstream_type_t : uint8_t
     exchangesim_reader = 8,
     pcap_reader = 9,
     ctp_csv_reader = 10,
+    framefile = 11,
     /* writers */
     mmap_writer = 0x80,
     tcp_writer = 0x82,
@@ -124,6 +125,9 @@ OS& operator<<(OS& os, qstream_type_t q)
     case qstream_type_t::gzfile:
         os << "gzfile";
         break;
+    case qstream_type_t::framefile:
+        os << "framefile";
+        break;
     case qstream_type_t::exchangesim_reader:
         os << "exchangesim_r";
         break;
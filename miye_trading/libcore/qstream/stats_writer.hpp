@@ -18,6 +18,7 @@
 #include "libcore/qstream/mmap_headers.hpp"
 #include "libcore/qstream/qstream_writer_interface.hpp"
 #include "libcore/time/clock.hpp"
+#include "libcore/time/metrics.hpp"
 #include "libcore/time/timeutils.hpp"
 #include "message/message.hpp"
 #include "trading/adapter/cme/md/mdp3/AnalysisMessageReaders.hpp"
@@ -42,8 +43,8 @@ class stats_writer : public qstream_writer_interface<stats_writer<Clock>>
           collect_packet_timing_(false), pcap_info_(false),
           bin_width_(time::millis(1)), previous_time_(0),
           min_interval_(std::numeric_limits<uint64_t>::max()),
-          last_sequence_(0), cme_time(nullptr), cme_seq(nullptr),
-          cme_drift(nullptr), md_analysis(nullptr)
+          last_sequence_(0), packet_timing_(nullptr), cme_time(nullptr),
+          cme_seq(nullptr), cme_drift(nullptr), md_analysis(nullptr)
     {
         if (description.find("packet_timing") != std::string::npos)
         {
@@ -55,6 +56,8 @@ class stats_writer : public qstream_writer_interface<stats_writer<Clock>>
                 bin_width_ =
                     time::parse_nano_interval(description.substr(pos + 14));
             }
+            packet_timing_ = &time::metrics_registry::instance().histogram(
+                "qstream.inter_packet_ns");
         }
         if (description.find("pcap") != std::string::npos)
         {
@@ -130,14 +133,20 @@ class stats_writer : public qstream_writer_interface<stats_writer<Clock>>
         if (collect_packet_timing_)
         {
             std::cout << "Inter packet timing distribution:" << std::endl;
-            for (size_t i = 0; i < timing_bins_.size(); ++i)
+            const auto& h = *packet_timing_;
+            std::map<uint64_t, uint64_t> bins;
+            h.for_each_bucket([&](uint64_t lowest, uint64_t, uint64_t count) {
+                bins[lowest / bin_width_] += count;
+            });
+            for (const auto& bin : bins)
             {
-                if (timing_bins_[i] > 0)
-                {
-                    std::cout << time::format_nano_interval(i * bin_width_)
-                              << " : " << timing_bins_[i] << std::endl;
-                }
+                std::cout << time::format_nano_interval(bin.first * bin_width_)
+                          << " : " << bin.second << std::endl;
             }
+            std::cout << "   p50: " << h.value_at_percentile(50.0)
+                      << "ns  p99: " << h.value_at_percentile(99.0)
+                      << "ns  p99.9: " << h.value_at_percentile(99.9)
+                      << "ns  max: " << h.max() << "ns" << std::endl;
         }
         if (pcap_info_)
         {
@@ -198,13 +207,7 @@ class stats_writer : public qstream_writer_interface<stats_writer<Clock>>
         }
         if (collect_packet_timing_ && previous_time_ != 0)
         {
-            uint64_t time_since_last_write = last_time_ - previous_time_;
-            size_t bin_index = time_since_last_write / bin_width_;
-            if (timing_bins_.size() < bin_index)
-            {
-                timing_bins_.resize(bin_index + 1, 0);
-            }
-            ++timing_bins_[bin_index];
+            packet_timing_->record(last_time_ - previous_time_);
         }
         if (pcap_info_)
         {
@@ -285,7 +288,7 @@ class stats_writer : public qstream_writer_interface<stats_writer<Clock>>
     uint64_t min_interval_;
     uint32_t last_sequence_;
 
-    vector<size_t> timing_bins_;
+    time::histogram_recorder* packet_timing_; // shared via the registry
     std::map<std::string, uint64_t> pkt_counts;
 
     std::shared_ptr<trading::cme::mdp3_time_delta_handler> cme_time;
@@ -8,6 +8,7 @@
 #include "cycletimer.hpp"
 #include "exchangesim_reader.hpp"
 #include "exchangesim_writer.hpp"
+#include "framefile.hpp"
 #include "gzfile.hpp"
 #include "libcore/essential/assert.hpp"
 #include "mmap_reader.hpp"
@@ -45,6 +46,7 @@ struct variantqstream_reader : public qstream_reader_interface<variantqstream_re
     typedef cycletimer<Clock> cycletimer_t;
     typedef nulltimer<Clock> nulltimer_t;
     typedef gzfile<Clock> gzfile_t;
+    typedef framefile<Clock> framefile_t;
     typedef exchangesim_reader<Clock> exchangesim_reader_t;
     typedef exchangesim_writer<Clock> exchangesim_writer_t;
     typedef variantqstream_writer<Clock> variantqstream_writer_t;
@@ -85,6 +87,9 @@ struct variantqstream_reader : public qstream_reader_interface<variantqstream_re
         case qstream_type_t::gzfile:
             qstream_obj.reset(new gzfile_t(clock, descrip));
             break;
+        case qstream_type_t::framefile:
+            qstream_obj.reset(new framefile_t(clock, descrip));
+            break;
         case qstream_type_t::pcap_reader:
             qstream_obj.reset(new pcap_t(clock, descrip));
             break;
@@ -128,6 +133,17 @@ struct variantqstream_reader : public qstream_reader_interface<variantqstream_re
         {
             reinterpret_cast<mmap_reader_t*>(qstream_obj.get())->fast_forward(stop_ts);
         }
+        else if (qstream_type == qstream_type_t::framefile)
+        {
+            reinterpret_cast<framefile_t*>(qstream_obj.get())->fast_forward(stop_ts);
+        }
+    }
+
+    // only framefiles can go back
+    void seek(uint64_t ts)
+    {
+        INVARIANT_MSG(qstream_type == qstream_type_t::framefile, "seek() on " << DUMP(qstream_type));
+        reinterpret_cast<framefile_t*>(qstream_obj.get())->seek(ts);
     }
 
     const std::string& describe() const
@@ -158,6 +174,9 @@ struct variantqstream_reader : public qstream_reader_interface<variantqstream_re
         case qstream_type_t::gzfile:
             return reinterpret_cast<gzfile_t*>(qstream_obj.get())->describe();
             break;
+        case qstream_type_t::framefile:
+            return reinterpret_cast<framefile_t*>(qstream_obj.get())->describe();
+            break;
         case qstream_type_t::exchangesim_reader:
             return reinterpret_cast<exchangesim_reader_t*>(qstream_obj.get())->describe();
             break;
@@ -202,6 +221,9 @@ struct variantqstream_reader : public qstream_reader_interface<variantqstream_re
         case qstream_type_t::gzfile:
             return reinterpret_cast<gzfile_t*>(qstream_obj.get())->read();
             break;
+        case qstream_type_t::framefile:
+            return reinterpret_cast<framefile_t*>(qstream_obj.get())->read();
+            break;
         case qstream_type_t::exchangesim_reader:
             return reinterpret_cast<exchangesim_reader_t*>(qstream_obj.get())->read();
             break;
@@ -257,6 +279,9 @@ struct variantqstream_reader : public qstream_reader_interface<variantqstream_re
         case qstream_type_t::gzfile:
             reinterpret_cast<gzfile_t*>(qstream_obj.get())->attest(next_timestamp);
             break;
+        case qstream_type_t::framefile:
+            reinterpret_cast<framefile_t*>(qstream_obj.get())->attest(next_timestamp);
+            break;
         case qstream_type_t::exchangesim_reader:
             reinterpret_cast<exchangesim_reader_t*>(qstream_obj.get())->attest(next_timestamp);
             break;
@@ -276,7 +301,7 @@ struct variantqstream_reader : public qstream_reader_interface<variantqstream_re
     {
         return qstream_type != qstream_type_t::mmap_reader && qstream_type != qstream_type_t::nulltimer &&
                qstream_type != qstream_type_t::timer && qstream_type != qstream_type_t::cycletimer &&
-               qstream_type != qstream_type_t::gzfile
+               qstream_type != qstream_type_t::gzfile && qstream_type != qstream_type_t::framefile
 #if !defined(KERNEL_LEVEL_PCAP_ARBITRATION)
                && qstream_type != qstream_type_t::pcap_reader
 #endif
@@ -284,6 +309,7 @@ struct variantqstream_reader : public qstream_reader_interface<variantqstream_re
     }
     bool is_mmap() { return qstream_type == qstream_type_t::mmap_reader; }
     bool is_gzfile() { return qstream_type == qstream_type_t::gzfile; }
+    bool is_framefile() { return qstream_type == qstream_type_t::framefile; }
     bool is_tcp_listener() { return qstream_type == qstream_type_t::tcp_listener; }
     qstream_type_t get_type() { return qstream_type; }
     bool is_valid() { return get_type() != qstream_type_t::undefined; }
@@ -326,6 +352,9 @@ struct variantqstream_reader : public qstream_reader_interface<variantqstream_re
         case qstream_type_t::gzfile:
             return reinterpret_cast<gzfile_t*>(qstream_obj.get())->last_write_ts();
             break;
+        case qstream_type_t::framefile:
+            return reinterpret_cast<framefile_t*>(qstream_obj.get())->last_write_ts();
+            break;
         default:
             return 0;
             break;
@@ -0,0 +1,287 @@
+/*
+ * tick_columns.hpp
+ * Purpose: describe a tickfile row as a visitable struct of columns
+ *
+ * struct my_row
+ * {
+ *     VISITOR
+ *     {
+ *         VISIT(timestamp);
+ *         VISIT(price);
+ *     }
+ *     delta_column<uint64_t> timestamp;
+ *     delta_column<int64_t> price;
+ * };
+ *
+ * The member types pick the encoding, the visit order is the column order.
+ * column_layout<my_row>() is what the writer puts in the file and what the
+ * reader checks the file against. Every row needs a timestamp column, the
+ * block index is by it. Prices and sizes go in as scaled integers.
+ */
+#pragma once
+
+#include "libcore/parsing/visit.hpp"
+#include "tickfile_headers.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace miye
+{
+namespace tickstore
+{
+
+template <column_encoding E, typename T>
+struct column
+{
+    static_assert(std::is_integral<T>::value, "columns hold integers, scale prices and sizes");
+    using value_type = T;
+    static constexpr column_encoding encoding = E;
+
+    column() = default;
+    column(T v) : value(v) {}
+    operator T() const { return value; }
+
+    T value{};
+};
+
+template <typename T>
+using delta_column = column<column_encoding::delta, T>;
+template <typename T>
+using packed_column = column<column_encoding::packed, T>;
+template <typename T>
+using dict_column = column<column_encoding::dict, T>;
+
+namespace detail
+{
+
+template <typename T>
+struct not_a_column : std::false_type
+{
+};
+
+struct layout_visitor
+{
+    template <column_encoding E, typename T>
+    void visit(const char* name, const column<E, T>&)
+    {
+        column_desc desc{};
+        strncpy(desc.name, name, sizeof(desc.name) - 1);
+        desc.encoding = E;
+        desc.value_size = sizeof(T);
+        desc.is_signed = std::is_signed<T>::value;
+        columns.push_back(desc);
+    }
+
+    template <typename T>
+    void visit(const char*, const T&)
+    {
+        static_assert(not_a_column<T>::value, "tickfile rows are made of delta/packed/dict columns only");
+    }
+
+    std::vector<column_desc> columns;
+};
+
+// appends the row's values to one vector per column
+struct gather_visitor
+{
+    template <column_encoding E, typename T>
+    void visit(const char*, const column<E, T>& c)
+    {
+        (*columns)[index++].push_back(int64_t(c.value));
+    }
+
+    std::vector<std::vector<int64_t>>* columns;
+    size_t index;
+};
+
+// sets the row's values from row `row` of the decoded columns
+struct scatter_visitor
+{
+    template <column_encoding E, typename T>
+    void visit(const char*, column<E, T>& c)
+    {
+        c.value = T((*columns)[index++][row]);
+    }
+
+    const std::vector<std::vector<int64_t>>* columns;
+    size_t row;
+    size_t index;
+};
+
+} // namespace detail
+
+template <typename Row>
+std::vector<column_desc> column_layout()
+{
+    static_assert(Row::visitable, "tickfile rows are VISITOR structs");
+    Row row{};
+    detail::layout_visitor v;
+    Row::visit(&row, &v);
+    return v.columns;
+}
+
+// index of the column called name in the layout, -1 if there is none
+inline int32_t column_index(const std::vector<column_desc>& layout, const char* name)
+{
+    for (size_t i = 0; i < layout.size(); ++i)
+    {
+        if (strncmp(layout[i].name, name, sizeof(layout[i].name)) == 0)
+        {
+            return int32_t(i);
+        }
+    }
+    return -1;
+}
+
+inline bool same_layout(const std::vector<column_desc>& a, const std::vector<column_desc>& b)
+{
+    return a.size() == b.size() && memcmp(a.data(), b.data(), a.size() * sizeof(column_desc)) == 0;
+}
+
+template <typename Row>
+void gather(const Row& row, std::vector<std::vector<int64_t>>& columns)
+{
+    detail::gather_visitor v{&columns, 0};
+    Row::visit(&row, &v);
+}
+
+template <typename Row>
+void scatter(const std::vector<std::vector<int64_t>>& columns, size_t index, Row& row)
+{
+    detail::scatter_visitor v{&columns, index, 0};
+    Row::visit(&row, &v);
+}
+
+/*
+ * bit packing, value i takes bits [i*bits, (i+1)*bits) of the little endian
+ * word stream, a value may straddle two words
+ */
+inline uint32_t packed_words(size_t count, uint32_t bits)
+{
+    return uint32_t((count * bits + 63) / 64);
+}
+
+inline void pack_bits(const uint64_t* in, size_t count, uint32_t bits, uint64_t* out)
+{
+    memset(out, 0, packed_words(count, bits) * sizeof(uint64_t));
+    if (!bits)
+    {
+        return;
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto const pos = i * bits;
+        auto const word = pos / 64;
+        auto const shift = pos % 64;
+        out[word] |= in[i] << shift;
+        if (shift + bits > 64)
+        {
+            out[word + 1] |= in[i] >> (64 - shift);
+        }
+    }
+}
+
+inline void unpack_bits(const uint64_t* in, size_t count, uint32_t bits, uint64_t* out)
+{
+    if (!bits)
+    {
+        memset(out, 0, count * sizeof(uint64_t));
+        return;
+    }
+    auto const mask = bits == 64 ? ~uint64_t(0) : (uint64_t(1) << bits) - 1;
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto const pos = i * bits;
+        auto const word = pos / 64;
+        auto const shift = pos % 64;
+        auto v = in[word] >> shift;
+        if (shift + bits > 64)
+        {
+            v |= in[word + 1] << (64 - shift);
+        }
+        out[i] = v & mask;
+    }
+}
+
+inline uint64_t zigzag(uint64_t v)
+{
+    return (v << 1) ^ uint64_t(int64_t(v) >> 63);
+}
+
+inline uint64_t unzigzag(uint64_t v)
+{
+    return (v >> 1) ^ (~(v & 1) + 1);
+}
+
+// the column's values of one block as a chunk and its words
+inline column_chunk encode_column(column_encoding encoding, const std::vector<int64_t>& values,
+                                  std::vector<uint64_t>& scratch, std::vector<uint64_t>& words)
+{
+    column_chunk chunk{};
+    scratch.resize(values.size());
+    if (values.empty())
+    {
+        return chunk;
+    }
+    uint64_t all = 0;
+    if (encoding == column_encoding::delta)
+    {
+        chunk.base = values[0];
+        uint64_t prev = values[0];
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            scratch[i] = zigzag(uint64_t(values[i]) - prev);
+            prev = values[i];
+            all |= scratch[i];
+        }
+    }
+    else
+    {
+        chunk.base = values[0];
+        for (auto v : values)
+        {
+            chunk.base = std::min(chunk.base, v);
+        }
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            scratch[i] = uint64_t(values[i]) - uint64_t(chunk.base);
+            all |= scratch[i];
+        }
+    }
+    chunk.bits = all ? 64 - __builtin_clzll(all) : 0;
+    chunk.words = packed_words(values.size(), chunk.bits);
+    words.resize(chunk.words);
+    pack_bits(scratch.data(), values.size(), chunk.bits, words.data());
+    return chunk;
+}
+
+inline void decode_column(column_encoding encoding, const column_chunk& chunk, const uint64_t* words,
+                          size_t count, std::vector<int64_t>& values)
+{
+    values.resize(count);
+    auto out = reinterpret_cast<uint64_t*>(values.data());
+    unpack_bits(words, count, chunk.bits, out);
+    if (encoding == column_encoding::delta)
+    {
+        uint64_t prev = chunk.base;
+        for (size_t i = 0; i < count; ++i)
+        {
+            prev += unzigzag(out[i]);
+            out[i] = prev;
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            out[i] += uint64_t(chunk.base);
+        }
+    }
+}
+
+} // namespace tickstore
+} // namespace miye
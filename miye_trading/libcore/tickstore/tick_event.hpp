@@ -0,0 +1,162 @@
+/*
+ * tick_event.hpp
+ * Purpose: the normalized market data row of the tick store
+ *
+ * One row per book level change, snapshot level or trade, whatever the
+ * exchange sent them as. A snapshot is a clear row followed by its levels,
+ * the clear is written as a checkpoint so bbo_at() starts from the last
+ * snapshot before the first timestamp it is asked for.
+ */
+#pragma once
+
+#include "tickfile.hpp"
+
+#include <functional>
+#include <map>
+
+namespace miye
+{
+namespace tickstore
+{
+
+// prices and sizes are integer counts of 1e-8, like FixedPoint<Tag, 8>
+static const int32_t tick_decimals = 8;
+static const double tick_scale = 1e8;
+
+enum class tick_kind : uint8_t
+{
+    clear = 0, // the book is replaced by the levels that follow
+    level,     // qty at price on side is now qty, 0 removes the level
+    trade      // side is the aggressor
+};
+
+enum class tick_side : uint8_t
+{
+    bid = 0, // buy for a trade
+    ask      // sell for a trade
+};
+
+struct tick_event
+{
+    VISITOR
+    {
+        VISIT(timestamp);
+        VISIT(exchange_lag);
+        VISIT(type);
+        VISIT(kind);
+        VISIT(side);
+        VISIT(price);
+        VISIT(qty);
+    }
+
+    delta_column<uint64_t> timestamp;   // capture time, ns
+    packed_column<int64_t> exchange_lag; // capture minus exchange time, ns, 0 if the message had none
+    dict_column<uint32_t> type;         // the exchange's message type, "l2update", "depthUpdate", ...
+    packed_column<uint8_t> kind;
+    packed_column<uint8_t> side;
+    delta_column<int64_t> price;
+    packed_column<int64_t> qty;
+};
+
+struct tick_bbo
+{
+    uint64_t timestamp{0}; // asked for
+    int64_t bid_price{0};
+    int64_t bid_qty{0};
+    int64_t ask_price{0};
+    int64_t ask_qty{0};
+};
+
+// the book rebuilt from level rows
+class tick_book
+{
+  public:
+    void apply(const tick_event& ev)
+    {
+        switch (tick_kind(ev.kind.value))
+        {
+        case tick_kind::clear:
+            bids_.clear();
+            asks_.clear();
+            break;
+        case tick_kind::level:
+            if (tick_side(ev.side.value) == tick_side::bid)
+            {
+                set(bids_, ev.price, ev.qty);
+            }
+            else
+            {
+                set(asks_, ev.price, ev.qty);
+            }
+            break;
+        case tick_kind::trade:
+            break;
+        }
+    }
+
+    tick_bbo bbo(uint64_t timestamp) const
+    {
+        tick_bbo b;
+        b.timestamp = timestamp;
+        if (!bids_.empty())
+        {
+            b.bid_price = bids_.begin()->first;
+            b.bid_qty = bids_.begin()->second;
+        }
+        if (!asks_.empty())
+        {
+            b.ask_price = asks_.begin()->first;
+            b.ask_qty = asks_.begin()->second;
+        }
+        return b;
+    }
+
+  private:
+    template <typename Side>
+    static void set(Side& side, int64_t price, int64_t qty)
+    {
+        if (qty == 0)
+        {
+            side.erase(price);
+        }
+        else
+        {
+            side[price] = qty;
+        }
+    }
+
+    std::map<int64_t, int64_t, std::greater<int64_t>> bids_;
+    std::map<int64_t, int64_t> asks_;
+};
+
+/*
+ * fn(const tick_bbo&) with the book as it was at each of the sorted
+ * timestamps, rows at a timestamp included. One pass from the checkpoint
+ * before the first timestamp.
+ */
+template <typename F>
+uint64_t bbo_at(tickfile<tick_event>& file, const std::vector<uint64_t>& timestamps, F&& fn)
+{
+    if (timestamps.empty())
+    {
+        return 0;
+    }
+    tick_book book;
+    size_t next = 0;
+    auto replayed = file.replay(file.find_checkpoint(timestamps.front()), timestamps.back() + 1,
+                                [&](const tick_event& ev) {
+                                    while (next < timestamps.size() && ev.timestamp > timestamps[next])
+                                    {
+                                        fn(book.bbo(timestamps[next++]));
+                                    }
+                                    book.apply(ev);
+                                });
+    while (next < timestamps.size())
+    {
+        fn(book.bbo(timestamps[next++]));
+    }
+    return replayed;
+}
+
+} // namespace tickstore
+} // namespace miye
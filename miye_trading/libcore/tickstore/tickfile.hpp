@@ -0,0 +1,196 @@
+/*
+ * tickfile.hpp
+ * Purpose: read a tickfile - research queries over the ticks of one symbol
+ *
+ * The file is mapped read only, nothing is decoded until a query touches a
+ * block. scan() finds the blocks of a time range from the index and decodes
+ * only those, one column chunk at a time, into rows of the layout the file
+ * was written with. Opening a file with a different row layout fails.
+ */
+#pragma once
+
+#include "libcore/essential/assert.hpp"
+#include "libcore/utils/syscalls_files.hpp"
+#include "libcore/utils/syscalls_mmap.hpp"
+#include "tick_columns.hpp"
+
+#include <algorithm>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <vector>
+
+namespace miye
+{
+namespace tickstore
+{
+
+template <typename Row>
+class tickfile
+{
+  public:
+    tickfile(const tickfile&) = delete;
+    tickfile& operator=(const tickfile&) = delete;
+
+    explicit tickfile(const std::string& path)
+    {
+        fd_ = syscalls::open(path.c_str(), O_RDONLY);
+        struct stat st;
+        INVARIANT(::fstat(fd_, &st) == 0);
+        file_size_ = st.st_size;
+        INVARIANT_MSG(file_size_ >= sizeof(tickfile_header) + sizeof(tickfile_trailer),
+                      "too short for a tickfile " << DUMP(path) << DUMP(file_size_));
+
+        membase_ = static_cast<char*>(syscalls::mmap64(0, file_size_, PROT_READ, MAP_SHARED, fd_, 0));
+
+        header_ = reinterpret_cast<const tickfile_header*>(membase_);
+        INVARIANT_MSG(header_->magic == tickfile_magic,
+                      " bad tickfile header " << std::hex << DUMP(header_->magic) << " " DUMP(tickfile_magic));
+        INVARIANT_MSG(header_->version == tickfile_version, DUMP(header_->version));
+
+        auto columns = reinterpret_cast<const column_desc*>(membase_ + sizeof(tickfile_header));
+        layout_.assign(columns, columns + header_->columns);
+        INVARIANT_MSG(same_layout(layout_, column_layout<Row>()),
+                      "tickfile was written with another row layout " << DUMP(path));
+        ts_column_ = column_index(layout_, "timestamp");
+
+        trailer_ = reinterpret_cast<const tickfile_trailer*>(membase_ + file_size_ - sizeof(tickfile_trailer));
+        INVARIANT_MSG(trailer_->magic == tickfile_magic, "tickfile has no index, was it closed? " << DUMP(path));
+        index_ = reinterpret_cast<const block_index_entry*>(membase_ + trailer_->index_offset);
+
+        auto p = membase_ + trailer_->dictionary_offset;
+        uint32_t count;
+        memcpy(&count, p, sizeof(count));
+        p += sizeof(count);
+        dictionary_.reserve(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            uint16_t len;
+            memcpy(&len, p, sizeof(len));
+            p += sizeof(len);
+            dictionary_.emplace_back(p, len);
+            p += len;
+        }
+        columns_.resize(layout_.size());
+    }
+    ~tickfile()
+    {
+        syscalls::munmap(membase_, file_size_);
+        syscalls::close(fd_);
+    }
+
+    std::string symbol() const
+    {
+        return std::string(header_->symbol, strnlen(header_->symbol, sizeof(header_->symbol)));
+    }
+    uint64_t rows() const { return trailer_->row_count; }
+    uint64_t blocks() const { return trailer_->block_count; }
+    uint64_t first_ts() const { return trailer_->first_ts; }
+    uint64_t last_ts() const { return trailer_->last_ts; }
+    uint64_t file_size() const { return file_size_; }
+    const std::vector<column_desc>& layout() const { return layout_; }
+    const block_index_entry& block(uint64_t b) const { return index_[b]; }
+
+    const std::vector<std::string>& dictionary() const { return dictionary_; }
+    // id of name in the dictionary, -1 if the file never saw it
+    int32_t lookup(const std::string& name) const
+    {
+        auto it = std::find(dictionary_.begin(), dictionary_.end(), name);
+        return it == dictionary_.end() ? -1 : int32_t(it - dictionary_.begin());
+    }
+
+    // the rows of block b, out is reused
+    void decode(uint64_t b, std::vector<Row>& out)
+    {
+        auto const& entry = index_[b];
+        auto p = membase_ + entry.offset;
+        for (size_t c = 0; c < layout_.size(); ++c)
+        {
+            column_chunk chunk;
+            memcpy(&chunk, p, sizeof(chunk));
+            p += sizeof(chunk);
+            decode_column(layout_[c].encoding, chunk, reinterpret_cast<const uint64_t*>(p), entry.rows, columns_[c]);
+            p += chunk.words * sizeof(uint64_t);
+        }
+        out.resize(entry.rows);
+        for (size_t r = 0; r < entry.rows; ++r)
+        {
+            scatter(columns_, r, out[r]);
+        }
+    }
+
+    // first block that can hold a row at or after ts
+    uint64_t find_block(uint64_t ts) const
+    {
+        return std::lower_bound(index_, index_ + blocks(), ts,
+                                [](const block_index_entry& e, uint64_t t) { return e.last_ts < t; }) -
+               index_;
+    }
+
+    // the last checkpoint block starting at or before ts, 0 if there is none
+    uint64_t find_checkpoint(uint64_t ts) const
+    {
+        for (uint64_t b = std::min(find_block(ts), blocks() ? blocks() - 1 : 0); b > 0; --b)
+        {
+            if (index_[b].checkpoint && index_[b].first_ts <= ts)
+            {
+                return b;
+            }
+        }
+        return 0;
+    }
+
+    // fn(const Row&) for each row with from <= timestamp < to, returns the rows visited
+    template <typename F>
+    uint64_t scan(uint64_t from, uint64_t to, F&& fn)
+    {
+        return scan_blocks(find_block(from), from, to, fn);
+    }
+
+    // fn(const Row&) for each row of block first on with timestamp < to, state rebuilds start here
+    template <typename F>
+    uint64_t replay(uint64_t first, uint64_t to, F&& fn)
+    {
+        return scan_blocks(first, 0, to, fn);
+    }
+
+  private:
+    template <typename F>
+    uint64_t scan_blocks(uint64_t first, uint64_t from, uint64_t to, F& fn)
+    {
+        uint64_t visited = 0;
+        for (uint64_t b = first; b < blocks() && index_[b].first_ts < to; ++b)
+        {
+            decode(b, rows_);
+            auto const& ts = columns_[ts_column_];
+            for (size_t r = 0; r < rows_.size(); ++r)
+            {
+                if (uint64_t(ts[r]) >= to)
+                {
+                    return visited;
+                }
+                if (uint64_t(ts[r]) >= from)
+                {
+                    fn(rows_[r]);
+                    ++visited;
+                }
+            }
+        }
+        return visited;
+    }
+
+    int fd_{-1};
+    char* membase_{nullptr};
+    size_t file_size_{0};
+    const tickfile_header* header_{nullptr};
+    const tickfile_trailer* trailer_{nullptr};
+    const block_index_entry* index_{nullptr};
+    std::vector<column_desc> layout_;
+    int32_t ts_column_{-1};
+    std::vector<std::string> dictionary_;
+    std::vector<std::vector<int64_t>> columns_;
+    std::vector<Row> rows_;
+};
+
+} // namespace tickstore
+} // namespace miye
@@ -0,0 +1,93 @@
+/*
+ * tickfile_headers.hpp
+ * Purpose: on disk layout of a tickfile, the columnar ticks of one symbol
+ *
+ * [tickfile_header]
+ * [column_desc] ... one per column, the layout of the row type
+ * [block] ... one per block_rows rows (fewer at a checkpoint or the end)
+ * [block_index_entry] ... one per block
+ * [dictionary] uint32 count, then count x (uint16 length, bytes)
+ * [tickfile_trailer]
+ *
+ * A block stores each column as a column_chunk followed by its words of
+ * bit packed values, the columns in layout order. Every block decodes on
+ * its own, the index finds the blocks of a time range without touching
+ * the others.
+ */
+#pragma once
+
+#include <cstdint>
+
+namespace miye
+{
+namespace tickstore
+{
+
+// "qticks01" as a little endian 64bit int
+static const uint64_t tickfile_magic = 0x3130736b63697471;
+static const uint32_t tickfile_version = 1;
+static const uint32_t tickfile_default_block_rows = 4096;
+static const uint32_t tickfile_name_size = 24;
+
+enum class column_encoding : uint8_t
+{
+    delta = 1, // zigzag of the difference to the previous row, bit packed
+    packed,    // difference to the block minimum, bit packed
+    dict       // id into the file dictionary, bit packed
+};
+
+struct tickfile_header
+{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t columns;
+    uint32_t block_rows;
+    uint32_t reserved0;
+    char symbol[32];
+    uint64_t reserved[2];
+};
+static_assert(sizeof(tickfile_header) == 72, "tickfile header size");
+
+struct column_desc
+{
+    char name[tickfile_name_size];
+    column_encoding encoding;
+    uint8_t value_size; // bytes of the integer in the row
+    uint8_t is_signed;
+    uint8_t reserved[5];
+};
+static_assert(sizeof(column_desc) == 32, "column desc size");
+
+struct column_chunk
+{
+    int64_t base;   // the first value for delta, the minimum otherwise
+    uint32_t bits;  // 0 when every value is base
+    uint32_t words; // uint64 words of packed values that follow
+};
+static_assert(sizeof(column_chunk) == 16, "column chunk size");
+
+struct block_index_entry
+{
+    uint64_t offset; // of the first column_chunk in the file
+    uint64_t first_ts;
+    uint64_t last_ts;
+    uint32_t rows;
+    uint32_t checkpoint; // 1 if the block starts at a checkpoint row
+};
+static_assert(sizeof(block_index_entry) == 32, "block index entry size");
+
+struct tickfile_trailer
+{
+    uint64_t index_offset;
+    uint64_t block_count;
+    uint64_t row_count;
+    uint64_t dictionary_offset;
+    uint64_t first_ts;
+    uint64_t last_ts;
+    uint64_t reserved;
+    uint64_t magic;
+};
+static_assert(sizeof(tickfile_trailer) == 64, "tickfile trailer size");
+
+} // namespace tickstore
+} // namespace miye
@@ -0,0 +1,177 @@
+/*
+ * tickfile_writer.hpp
+ * Purpose: write the rows of one symbol into a tickfile
+ * offline etl, not latency critical
+ *
+ * Rows are appended in timestamp order. A checkpoint row starts a new block
+ * so a reader can rebuild state (a book after a snapshot) from that block
+ * on without decoding anything before it.
+ */
+#pragma once
+
+#include "libcore/essential/assert.hpp"
+#include "libcore/utils/syscalls_files.hpp"
+#include "tick_columns.hpp"
+
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace miye
+{
+namespace tickstore
+{
+
+template <typename Row>
+class tickfile_writer
+{
+  public:
+    tickfile_writer(const tickfile_writer&) = delete;
+    tickfile_writer& operator=(const tickfile_writer&) = delete;
+
+    tickfile_writer(const std::string& path, const std::string& symbol,
+                    uint32_t block_rows = tickfile_default_block_rows)
+        : layout_(column_layout<Row>()), block_rows_(block_rows), columns_(layout_.size())
+    {
+        ts_column_ = column_index(layout_, "timestamp");
+        INVARIANT_MSG(ts_column_ >= 0, "a tickfile row needs a timestamp column");
+        INVARIANT_MSG(block_rows_ > 0, DUMP(block_rows_));
+
+        fd_ = syscalls::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+        tickfile_header header{};
+        header.magic = tickfile_magic;
+        header.version = tickfile_version;
+        header.columns = layout_.size();
+        header.block_rows = block_rows_;
+        strncpy(header.symbol, symbol.c_str(), sizeof(header.symbol) - 1);
+        put(&header, sizeof(header));
+        put(layout_.data(), layout_.size() * sizeof(column_desc));
+    }
+    ~tickfile_writer()
+    {
+        close();
+    }
+
+    // id of name in the file dictionary, what a dict column holds
+    uint32_t intern(const std::string& name)
+    {
+        auto it = dictionary_ids_.find(name);
+        if (it != dictionary_ids_.end())
+        {
+            return it->second;
+        }
+        INVARIANT_MSG(name.size() <= UINT16_MAX, DUMP(name.size()));
+        auto id = uint32_t(dictionary_.size());
+        dictionary_.push_back(name);
+        dictionary_ids_.emplace(name, id);
+        return id;
+    }
+
+    void append(const Row& row, bool checkpoint = false)
+    {
+        if (checkpoint && rows_)
+        {
+            flush();
+        }
+        if (!rows_)
+        {
+            checkpoint_ = checkpoint;
+        }
+        gather(row, columns_);
+        if (++rows_ == block_rows_)
+        {
+            flush();
+        }
+    }
+
+    // writes the last block, the index, the dictionary and the trailer
+    void close()
+    {
+        if (fd_ < 0)
+        {
+            return;
+        }
+        flush();
+        tickfile_trailer trailer{};
+        trailer.index_offset = offset_;
+        trailer.block_count = index_.size();
+        trailer.row_count = row_count_;
+        trailer.first_ts = index_.empty() ? 0 : index_.front().first_ts;
+        trailer.last_ts = index_.empty() ? 0 : index_.back().last_ts;
+        trailer.magic = tickfile_magic;
+        put(index_.data(), index_.size() * sizeof(block_index_entry));
+
+        trailer.dictionary_offset = offset_;
+        uint32_t count = dictionary_.size();
+        put(&count, sizeof(count));
+        for (auto& name : dictionary_)
+        {
+            uint16_t len = name.size();
+            put(&len, sizeof(len));
+            put(name.data(), len);
+        }
+        put(&trailer, sizeof(trailer));
+        syscalls::close(fd_);
+        fd_ = -1;
+    }
+
+    const std::vector<column_desc>& layout() const { return layout_; }
+    uint64_t blocks() const { return index_.size(); }
+    uint64_t rows() const { return row_count_ + rows_; }
+    uint64_t bytes_written() const { return offset_; }
+
+  private:
+    void flush()
+    {
+        if (!rows_)
+        {
+            return;
+        }
+        auto& ts = columns_[ts_column_];
+        block_index_entry entry{offset_, uint64_t(ts.front()), uint64_t(ts.back()), rows_, checkpoint_};
+        for (size_t c = 0; c < layout_.size(); ++c)
+        {
+            auto chunk = encode_column(layout_[c].encoding, columns_[c], scratch_, words_);
+            put(&chunk, sizeof(chunk));
+            put(words_.data(), chunk.words * sizeof(uint64_t));
+            columns_[c].clear();
+        }
+        index_.push_back(entry);
+        row_count_ += rows_;
+        rows_ = 0;
+        checkpoint_ = false;
+    }
+
+    void put(const void* data, size_t bytes)
+    {
+        auto p = static_cast<const char*>(data);
+        while (bytes)
+        {
+            auto written = syscalls::write(fd_, p, bytes);
+            p += written;
+            bytes -= written;
+            offset_ += written;
+        }
+    }
+
+  private:
+    int fd_{-1};
+    std::vector<column_desc> layout_;
+    int32_t ts_column_{-1};
+    uint32_t block_rows_;
+    std::vector<std::vector<int64_t>> columns_;
+    std::vector<uint64_t> scratch_;
+    std::vector<uint64_t> words_;
+    uint32_t rows_{0};
+    uint32_t checkpoint_{0};
+    uint64_t row_count_{0};
+    uint64_t offset_{0};
+    std::vector<block_index_entry> index_;
+    std::vector<std::string> dictionary_;
+    std::unordered_map<std::string, uint32_t> dictionary_ids_;
+};
+
+} // namespace tickstore
+} // namespace miye
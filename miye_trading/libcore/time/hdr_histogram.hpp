@@ -0,0 +1,158 @@
+/*
+ * hdr_histogram.hpp
+ *
+ * Purpose: log-linear (HDR style) latency histogram. Values below
+ * 2^SubBucketBits get a bucket each, above that every power of two range
+ * is split into 2^(SubBucketBits-1) linear buckets, so the relative error
+ * of any recorded value is below 2^-(SubBucketBits-1) (0.8% for the
+ * default 8 bits) whatever its magnitude. Values past 2^MaxBits are clamped
+ * to the top bucket.
+ *
+ * record() is a count leading zeros, a shift and an add on a fixed array,
+ * no allocation. Histograms with the same parameters merge by adding
+ * counts, which is how per thread recorders are combined. CountType lets a
+ * recorder keep its counts in single writer atomics (see metrics.hpp) so
+ * another thread may read them while it records.
+ *
+ * Author:
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <stdint.h>
+
+#include "libcore/essential/platform_defs.hpp"
+
+namespace miye { namespace time {
+
+template<uint32_t SubBucketBits = 8, uint32_t MaxBits = 40, typename CountType = uint64_t>
+class hdr_histogram
+{
+    static_assert(SubBucketBits >= 2 && SubBucketBits < MaxBits && MaxBits <= 63, "hdr_histogram bits out of range");
+
+public:
+    static constexpr uint64_t sub_bucket_count = 1ULL << SubBucketBits;
+    static constexpr uint64_t half_count = sub_bucket_count / 2;
+    static constexpr uint64_t max_value = (1ULL << MaxBits) - 1;
+    static constexpr size_t bucket_count = size_t(sub_bucket_count + (MaxBits - SubBucketBits) * half_count);
+
+    ALWAYS_INLINE static size_t index_of(uint64_t value)
+    {
+        if (value < sub_bucket_count) {
+            return size_t(value);
+        }
+        value = std::min(value, max_value);
+        // value >> shift lands in [half_count, sub_bucket_count)
+        const uint32_t shift = 64 - __builtin_clzll(value) - SubBucketBits;
+        return size_t(sub_bucket_count + (shift - 1) * half_count + ((value >> shift) - half_count));
+    }
+
+    static uint64_t lowest_equivalent(size_t index)
+    {
+        if (index < sub_bucket_count) {
+            return index;
+        }
+        const uint64_t shift = (index - sub_bucket_count) / half_count + 1;
+        const uint64_t sub = (index - sub_bucket_count) % half_count + half_count;
+        return sub << shift;
+    }
+
+    static uint64_t highest_equivalent(size_t index)
+    {
+        if (index < sub_bucket_count) {
+            return index;
+        }
+        const uint64_t shift = (index - sub_bucket_count) / half_count + 1;
+        return lowest_equivalent(index) + (1ULL << shift) - 1;
+    }
+
+    ALWAYS_INLINE void record(uint64_t value, uint64_t n = 1)
+    {
+        counts_[index_of(value)] += n;
+        total_ += n;
+        sum_ += value * n;
+        if (value < min_) {
+            min_ = value;
+        }
+        if (value > max_) {
+            max_ = value;
+        }
+    }
+
+    template<typename RhsCountType>
+    void merge(const hdr_histogram<SubBucketBits, MaxBits, RhsCountType>& rhs)
+    {
+        if (rhs.count() == 0) {
+            return;
+        }
+        for (size_t i = 0; i < bucket_count; ++i) {
+            counts_[i] += rhs.count_at(i);
+        }
+        total_ += rhs.count();
+        sum_ += rhs.sum();
+        min_ = std::min<uint64_t>(min_, rhs.min());
+        max_ = std::max<uint64_t>(max_, rhs.max());
+    }
+
+    void reset()
+    {
+        for (auto& c : counts_) {
+            c = 0;
+        }
+        total_ = 0;
+        sum_ = 0;
+        min_ = std::numeric_limits<uint64_t>::max();
+        max_ = 0;
+    }
+
+    uint64_t count() const { return total_; }
+    uint64_t sum() const { return sum_; }
+    uint64_t min() const { return total_ != 0 ? uint64_t(min_) : 0; }
+    uint64_t max() const { return max_; }
+    double mean() const { return total_ ? double(sum_) / double(total_) : 0.0; }
+    uint64_t count_at(size_t index) const { return counts_[index]; }
+
+    // smallest bucket upper bound with at least pct percent of the values
+    // at or below it, clamped to the exact min/max
+    uint64_t value_at_percentile(double pct) const
+    {
+        if (total_ == 0) {
+            return 0;
+        }
+        pct = std::min(std::max(pct, 0.0), 100.0);
+        const uint64_t rank = std::max<uint64_t>(1, uint64_t(pct / 100.0 * double(total_) + 0.5));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < bucket_count; ++i) {
+            seen += counts_[i];
+            if (seen >= rank) {
+                return std::max<uint64_t>(min_, std::min<uint64_t>(max_, highest_equivalent(i)));
+            }
+        }
+        return max_;
+    }
+
+    // calls f(lowest, highest, count) for every non empty bucket
+    template<typename F>
+    void for_each_bucket(F&& f) const
+    {
+        for (size_t i = 0; i < bucket_count; ++i) {
+            if (counts_[i]) {
+                f(lowest_equivalent(i), highest_equivalent(i), counts_[i]);
+            }
+        }
+    }
+
+private:
+    std::array<CountType, bucket_count> counts_ {};
+    CountType total_ {0};
+    CountType sum_ {0};
+    CountType min_ {std::numeric_limits<uint64_t>::max()};
+    CountType max_ {0};
+};
+
+using latency_histogram = hdr_histogram<>;
+
+}}
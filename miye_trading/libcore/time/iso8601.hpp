@@ -0,0 +1,217 @@
+/*
+ * iso8601.hpp
+ *
+ * Purpose: fixed format YYYY-MM-DDTHH:MM:SS[.f{1,9}][Z|+00:00] timestamp
+ * parser for feed handlers. Converts straight to epoch nanos without
+ * going through strptime/date::parse.
+ *
+ * The 16 byte date/hour/minute prefix is validated with one SSE2 compare,
+ * the day start is cached so consecutive timestamps from the same UTC day
+ * only pay for the time of day part.
+ *
+ * dinobot/dinobot/src/libcore/time/iso8601.hpp is a copy for the dinobot
+ * tree, which does not see this one, keep the two in sync.
+ *
+ * Author:
+ */
+
+#pragma once
+
+#include <emmintrin.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "libcore/essential/platform_defs.hpp"
+
+namespace miye { namespace time {
+
+// days since 1970-01-01 of a proleptic gregorian date
+// http://howardhinnant.github.io/date_algorithms.html#days_from_civil
+inline constexpr int64_t days_from_civil(int64_t y, unsigned m, unsigned d) noexcept
+{
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+// days in a month of a proleptic gregorian year, month in [1, 12]
+inline constexpr unsigned days_in_month(unsigned y, unsigned m) noexcept
+{
+    if (m != 2)
+        return m == 4 || m == 6 || m == 9 || m == 11 ? 30 : 31;
+    return (y % 4 == 0 && (y % 100 != 0 || y % 400 == 0)) ? 29 : 28;
+}
+
+namespace detail {
+
+static constexpr uint64_t NANOS_PER_SEC = 1000000000ULL;
+static constexpr uint64_t NANOS_PER_DAY = 86400ULL * NANOS_PER_SEC;
+
+// scale for a fraction of n digits, n in [0, 9]
+static constexpr uint32_t FRACTION_SCALE[10] = {
+    1000000000, 100000000, 10000000, 1000000, 100000, 10000, 1000, 100, 10, 1};
+
+// byte positions of the separators in "YYYY-MM-DDTHH:MM"
+static constexpr uint32_t ISO8601_SEP_MASK   = (1u << 4) | (1u << 7) | (1u << 10) | (1u << 13);
+static constexpr uint32_t ISO8601_DIGIT_MASK = 0xffffu & ~ISO8601_SEP_MASK;
+
+inline unsigned two_digits(const uint8_t* d) { return d[0] * 10u + d[1]; }
+
+// validates "YYYY-MM-DDTHH:MM" in one pass and writes the 16 bytes less '0'
+// into digits. separators end up as garbage in digits and are never read.
+ALWAYS_INLINE bool iso8601_prefix(const char* begin, uint8_t* digits) noexcept
+{
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    const __m128i seps = _mm_setr_epi8('0', '0', '0', '0', '-', '0', '0', '-',
+                                       '0', '0', 'T', '0', '0', ':', '0', '0');
+    const __m128i d = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+    // d <= 9 as unsigned <=> max(d, 9) == 9
+    const __m128i nine = _mm_set1_epi8(9);
+    const uint32_t is_digit = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(d, nine), nine));
+    const uint32_t is_sep = _mm_movemask_epi8(_mm_cmpeq_epi8(v, seps));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(digits), d);
+    return ((is_digit & ISO8601_DIGIT_MASK) | (is_sep & ISO8601_SEP_MASK)) == 0xffffu;
+}
+
+// parses ":SS[.f{1,9}][Z|+00:00]" following the prefix, returns the nanos
+// into the minute or -1 on malformed input
+ALWAYS_INLINE int64_t iso8601_seconds(const char* p, const char* end) noexcept
+{
+    if (UNLIKELY(end - p < 3 || p[0] != ':'))
+        return -1;
+    const unsigned s1 = uint8_t(p[1] - '0');
+    const unsigned s0 = uint8_t(p[2] - '0');
+    if (UNLIKELY(s1 > 9 || s0 > 9 || s1 * 10 + s0 > 60))
+        return -1;
+    int64_t nanos = (s1 * 10 + s0) * int64_t(NANOS_PER_SEC);
+    p += 3;
+
+    if (p != end && *p == '.')
+    {
+        ++p;
+        uint32_t frac = 0;
+        int n = 0;
+        while (p != end && n < 9)
+        {
+            const unsigned c = uint8_t(*p - '0');
+            if (c > 9)
+                break;
+            frac = frac * 10 + c;
+            ++p;
+            ++n;
+        }
+        // anything past nanosecond precision is truncated
+        while (p != end && uint8_t(*p - '0') <= 9)
+            ++p;
+        if (UNLIKELY(n == 0))
+            return -1;
+        nanos += int64_t(frac) * FRACTION_SCALE[n];
+    }
+
+    if (p == end)
+        return nanos;
+    if (*p == 'Z' && p + 1 == end)
+        return nanos;
+    if (end - p == 6 && (!memcmp(p, "+00:00", 6) || !memcmp(p, "-00:00", 6)))
+        return nanos;
+    return -1;
+}
+
+} // namespace detail
+
+/*
+ * parses YYYY-MM-DDTHH:MM:SS[.f{1,9}][Z|+00:00] into epoch nanos.
+ * only UTC timestamps are accepted, which is all the exchanges send.
+ * returns false and leaves nanos untouched on malformed input.
+ */
+inline bool parse_iso8601(const char* begin, size_t len, uint64_t& nanos) noexcept
+{
+    if (UNLIKELY(len < 19))
+        return false;
+
+    alignas(16) uint8_t d[16];
+    if (UNLIKELY(!detail::iso8601_prefix(begin, d)))
+        return false;
+
+    const int64_t sec_nanos = detail::iso8601_seconds(begin + 16, begin + len);
+    if (UNLIKELY(sec_nanos < 0))
+        return false;
+
+    const unsigned year = detail::two_digits(d) * 100 + detail::two_digits(d + 2);
+    const unsigned month = detail::two_digits(d + 5);
+    const unsigned day = detail::two_digits(d + 8);
+    const unsigned hour = detail::two_digits(d + 11);
+    const unsigned minute = detail::two_digits(d + 14);
+    if (UNLIKELY(year < 1970 || month - 1 > 11 || day - 1 > 30 || hour > 23 || minute > 59))
+        return false;
+    if (UNLIKELY(day > days_in_month(year, month)))
+        return false;
+
+    const int64_t days = days_from_civil(year, month, day);
+    nanos = uint64_t(days) * detail::NANOS_PER_DAY + (hour * 3600ULL + minute * 60ULL) * detail::NANOS_PER_SEC +
+            uint64_t(sec_nanos);
+    return true;
+}
+
+/*
+ * stateful version of parse_iso8601, remembers the start of the last UTC day
+ * it saw so a stream of same day timestamps skips the calendar arithmetic.
+ * one instance per feed thread, it is not thread safe.
+ */
+class iso8601_parser
+{
+  public:
+    bool parse(const char* begin, size_t len, uint64_t& nanos) noexcept
+    {
+        if (UNLIKELY(len < 19))
+            return false;
+
+        alignas(16) uint8_t d[16];
+        if (UNLIKELY(!detail::iso8601_prefix(begin, d)))
+            return false;
+
+        const int64_t sec_nanos = detail::iso8601_seconds(begin + 16, begin + len);
+        if (UNLIKELY(sec_nanos < 0))
+            return false;
+
+        const unsigned hour = detail::two_digits(d + 11);
+        const unsigned minute = detail::two_digits(d + 14);
+        if (UNLIKELY(hour > 23 || minute > 59))
+            return false;
+
+        uint64_t key_lo;
+        uint16_t key_hi;
+        memcpy(&key_lo, begin, sizeof(key_lo));
+        memcpy(&key_hi, begin + 8, sizeof(key_hi));
+        if (UNLIKELY(key_lo != day_key_lo_ || key_hi != day_key_hi_))
+        {
+            const unsigned year = detail::two_digits(d) * 100 + detail::two_digits(d + 2);
+            const unsigned month = detail::two_digits(d + 5);
+            const unsigned day = detail::two_digits(d + 8);
+            if (UNLIKELY(year < 1970 || month - 1 > 11 || day - 1 > 30))
+                return false;
+            if (UNLIKELY(day > days_in_month(year, month)))
+                return false;
+            day_nanos_ = uint64_t(days_from_civil(year, month, day)) * detail::NANOS_PER_DAY;
+            day_key_lo_ = key_lo;
+            day_key_hi_ = key_hi;
+        }
+
+        nanos = day_nanos_ + (hour * 3600ULL + minute * 60ULL) * detail::NANOS_PER_SEC + uint64_t(sec_nanos);
+        return true;
+    }
+
+    uint64_t day_start() const { return day_nanos_; }
+
+  private:
+    // first 10 bytes of the last parsed timestamp, ie "YYYY-MM-DD"
+    uint64_t day_key_lo_{0};
+    uint16_t day_key_hi_{0};
+    uint64_t day_nanos_{0};
+};
+
+}}
@@ -0,0 +1,432 @@
+/*
+ * metrics.hpp
+ *
+ * Purpose: process wide metrics: latency histograms, counters and gauges
+ * registered by name, merged periodically by a metrics_writer thread and
+ * written out as a qstream of metric_record or a Prometheus text
+ * exposition file.
+ *
+ * Recording is per thread and never uses a locked instruction. A thread
+ * asks the registry for its own histogram_recorder/counter under a name
+ * (cold path, takes the registry mutex, the same thread asking again gets
+ * the same one) and keeps the reference. Their
+ * fields are single_writer values: a relaxed load and store, the same
+ * mov/add a plain integer compiles to, which snapshot() may read from any
+ * thread at any time. A snapshot can see one bucket of a record() that is
+ * still in flight, which is fine for monitoring. Gauges are shared, last
+ * writer wins.
+ *
+ * Author:
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <thread>
+
+#include "libcore/essential/platform_defs.hpp"
+#include "libcore/time/hdr_histogram.hpp"
+
+namespace miye { namespace time {
+
+/*
+ * a value with one writing thread and any number of readers
+ */
+template<typename T>
+class single_writer
+{
+public:
+    single_writer(T v = T()) : value_(v) {}
+    single_writer(const single_writer& rhs) : value_(rhs.load()) {}
+
+    single_writer& operator=(const single_writer& rhs)
+    {
+        store(rhs.load());
+        return *this;
+    }
+
+    ALWAYS_INLINE single_writer& operator=(T v)
+    {
+        store(v);
+        return *this;
+    }
+
+    ALWAYS_INLINE single_writer& operator+=(T n)
+    {
+        store(load() + n);
+        return *this;
+    }
+
+    ALWAYS_INLINE operator T() const
+    {
+        return load();
+    }
+
+    ALWAYS_INLINE T load() const
+    {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+    ALWAYS_INLINE void store(T v)
+    {
+        value_.store(v, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<T> value_;
+};
+
+class counter
+{
+public:
+    ALWAYS_INLINE void add(uint64_t n = 1)
+    {
+        value_ += n;
+    }
+
+    uint64_t value() const
+    {
+        return value_;
+    }
+
+private:
+    single_writer<uint64_t> value_ {0};
+};
+
+class gauge
+{
+public:
+    ALWAYS_INLINE void set(double v)
+    {
+        value_.store(v, std::memory_order_relaxed);
+    }
+
+    double value() const
+    {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<double> value_ {0.0};
+};
+
+// owned and recorded into by one thread, merged by snapshot()
+using histogram_recorder = hdr_histogram<8, 40, single_writer<uint64_t>>;
+
+struct metrics_snapshot
+{
+    uint64_t timestamp {0};
+    std::map<std::string, latency_histogram> histograms;
+    std::map<std::string, uint64_t> counters;
+    std::map<std::string, double> gauges;
+};
+
+/*
+ * fixed size record for the qstream writer, one per metric.
+ * histogram fields are zero for counters and gauges.
+ */
+struct metric_record
+{
+    enum kind_t : uint8_t
+    {
+        counter_kind = 0,
+        gauge_kind,
+        histogram_kind
+    };
+
+    uint64_t timestamp;
+    char name[55];
+    kind_t kind;
+    double value; // counter/gauge value, histogram mean
+    uint64_t count;
+    uint64_t min;
+    uint64_t max;
+    uint64_t p50;
+    uint64_t p90;
+    uint64_t p99;
+    uint64_t p999;
+    uint64_t p9999;
+};
+
+class metrics_registry
+{
+public:
+    static metrics_registry& instance()
+    {
+        static metrics_registry registry;
+        return registry;
+    }
+
+    // the calling thread's recorder of that name, created on first use, keep the reference
+    histogram_recorder& histogram(const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return per_thread(histograms_[name]);
+    }
+
+    // the calling thread's counter of that name, summed with the other threads'
+    counter& get_counter(const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return per_thread(counters_[name]);
+    }
+
+    gauge& get_gauge(const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& g = gauges_[name];
+        if (!g) {
+            g.reset(new gauge());
+        }
+        return *g;
+    }
+
+    // merges every recorder of a name, values are totals since startup
+    metrics_snapshot snapshot(uint64_t now)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        metrics_snapshot snap;
+        snap.timestamp = now;
+        for (auto& kv : histograms_) {
+            auto& total = snap.histograms[kv.first];
+            for (auto& r : kv.second) {
+                total.merge(*r.metric);
+            }
+        }
+        for (auto& kv : counters_) {
+            uint64_t sum = 0;
+            for (auto& c : kv.second) {
+                sum += c.metric->value();
+            }
+            snap.counters.emplace(kv.first, sum);
+        }
+        for (auto& kv : gauges_) {
+            snap.gauges.emplace(kv.first, kv.second->value());
+        }
+        return snap;
+    }
+
+private:
+    template<typename T>
+    struct owned
+    {
+        std::thread::id owner;
+        std::unique_ptr<T> metric;
+    };
+
+    template<typename T>
+    static T& per_thread(std::deque<owned<T>>& metrics)
+    {
+        const auto self = std::this_thread::get_id();
+        for (auto& m : metrics) {
+            if (m.owner == self) {
+                return *m.metric;
+            }
+        }
+        metrics.push_back(owned<T> {self, std::unique_ptr<T>(new T())});
+        return *metrics.back().metric;
+    }
+
+    std::mutex mutex_;
+    std::map<std::string, std::deque<owned<histogram_recorder>>> histograms_;
+    std::map<std::string, std::deque<owned<counter>>> counters_;
+    std::map<std::string, std::unique_ptr<gauge>> gauges_;
+};
+
+namespace detail {
+
+inline void fill_name(metric_record& r, const std::string& name)
+{
+    const size_t n = std::min(name.size(), sizeof(r.name) - 1);
+    memcpy(r.name, name.data(), n);
+    r.name[n] = '\0';
+}
+
+// prometheus metric names allow [a-zA-Z0-9_:]
+inline std::string prometheus_name(const std::string& name)
+{
+    std::string out(name);
+    for (auto& c : out) {
+        const bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == ':';
+        if (!ok) {
+            c = '_';
+        }
+    }
+    return out;
+}
+
+}
+
+// one metric_record per metric onto any qstream writer (pledge/announce)
+template<typename StreamType>
+void write_metrics(StreamType& stream, const metrics_snapshot& snap)
+{
+    for (const auto& kv : snap.counters) {
+        metric_record r {};
+        r.timestamp = snap.timestamp;
+        detail::fill_name(r, kv.first);
+        r.kind = metric_record::counter_kind;
+        r.value = double(kv.second);
+        r.count = kv.second;
+        stream.write(&r, sizeof(r));
+    }
+    for (const auto& kv : snap.gauges) {
+        metric_record r {};
+        r.timestamp = snap.timestamp;
+        detail::fill_name(r, kv.first);
+        r.kind = metric_record::gauge_kind;
+        r.value = kv.second;
+        stream.write(&r, sizeof(r));
+    }
+    for (const auto& kv : snap.histograms) {
+        const auto& h = kv.second;
+        metric_record r {};
+        r.timestamp = snap.timestamp;
+        detail::fill_name(r, kv.first);
+        r.kind = metric_record::histogram_kind;
+        r.value = h.mean();
+        r.count = h.count();
+        r.min = h.min();
+        r.max = h.max();
+        r.p50 = h.value_at_percentile(50.0);
+        r.p90 = h.value_at_percentile(90.0);
+        r.p99 = h.value_at_percentile(99.0);
+        r.p999 = h.value_at_percentile(99.9);
+        r.p9999 = h.value_at_percentile(99.99);
+        stream.write(&r, sizeof(r));
+    }
+}
+
+// prometheus text exposition, histograms as summaries
+inline std::string to_prometheus(const metrics_snapshot& snap)
+{
+    std::ostringstream oss;
+    for (const auto& kv : snap.counters) {
+        const auto name = detail::prometheus_name(kv.first);
+        oss << "# TYPE " << name << " counter\n" << name << " " << kv.second << "\n";
+    }
+    for (const auto& kv : snap.gauges) {
+        const auto name = detail::prometheus_name(kv.first);
+        oss << "# TYPE " << name << " gauge\n" << name << " " << kv.second << "\n";
+    }
+    static const double quantiles[] = {0.5, 0.9, 0.99, 0.999, 0.9999};
+    for (const auto& kv : snap.histograms) {
+        const auto name = detail::prometheus_name(kv.first);
+        const auto& h = kv.second;
+        oss << "# TYPE " << name << " summary\n";
+        for (double q : quantiles) {
+            oss << name << "{quantile=\"" << q << "\"} " << h.value_at_percentile(q * 100.0) << "\n";
+        }
+        oss << name << "_sum " << h.sum() << "\n" << name << "_count " << h.count() << "\n";
+    }
+    return oss.str();
+}
+
+// written to a temp file and renamed so a scraper never sees half a file
+inline bool write_prometheus(const std::string& path, const metrics_snapshot& snap)
+{
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        out << to_prometheus(snap);
+        if (!out) {
+            return false;
+        }
+    }
+    return ::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+/*
+ * snapshots the registry every interval on its own thread and hands it to
+ * sink, e.g. write_prometheus() to the file a scraper reads. stop() takes
+ * a last snapshot so short runs are not lost.
+ */
+class metrics_writer
+{
+public:
+    using sink_t = std::function<void(const metrics_snapshot&)>;
+
+    metrics_writer(sink_t sink, std::chrono::milliseconds interval,
+                   metrics_registry& registry = metrics_registry::instance())
+    : sink_(std::move(sink))
+    , interval_(interval)
+    , registry_(registry)
+    {}
+
+    metrics_writer(const metrics_writer&) = delete;
+    metrics_writer& operator=(const metrics_writer&) = delete;
+
+    ~metrics_writer()
+    {
+        stop();
+    }
+
+    void start()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (thread_.joinable()) {
+            return;
+        }
+        stopping_ = false;
+        thread_ = std::thread([this] { run(); });
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!thread_.joinable()) {
+                return;
+            }
+            stopping_ = true;
+        }
+        wakeup_.notify_all();
+        thread_.join();
+        write();
+    }
+
+    // one snapshot to the sink now, from the calling thread
+    void write()
+    {
+        const auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch());
+        sink_(registry_.snapshot(uint64_t(now.count())));
+    }
+
+private:
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!wakeup_.wait_for(lock, interval_, [this] { return stopping_; })) {
+            lock.unlock();
+            write();
+            lock.lock();
+        }
+    }
+
+    sink_t sink_;
+    std::chrono::milliseconds interval_;
+    metrics_registry& registry_;
+    std::mutex mutex_;
+    std::condition_variable wakeup_;
+    bool stopping_ {false};
+    std::thread thread_;
+};
+
+}}
@@ -1,9 +1,11 @@
 #pragma once
 
+#include <array>
 #include <stdint.h>
 #include <time.h>
 
 #include "libcore/qstream/variantqstream_writer.hpp"
+#include "libcore/time/metrics.hpp"
 #include "libcore/time/profiler_types.hpp"
 #include "libcore/time/rdtsc.hpp"
 #include "libcore/time/timeutils.hpp"
@@ -76,6 +78,7 @@ public:
             auto plc = performance_log_->pledge(types::message::profiler::msg_size);
             new (plc.start) types::message::profiler (trig, cycles, cycles * ticks2ns, uint64_data, uint32_data, uint16_data, uint8_data, uint8_data2);
             performance_log_->announce(plc);
+            trigger_histogram(trig).record(uint64_t(cycles * ticks2ns));
         }
     }
 
@@ -88,12 +91,25 @@ public:
         }
     }
 private:
+    static constexpr size_t max_triggers = 64;
+
+    // per trigger latency, registered on first use as profiler.<trigger>
+    histogram_recorder& trigger_histogram(profiler_trigger const& trig)
+    {
+        const size_t idx = std::min(static_cast<size_t>(trig), max_triggers - 1);
+        if(UNLIKELY(histograms_[idx] == nullptr)) {
+            histograms_[idx] = &metrics_registry::instance().histogram(std::string("profiler.") + c_str(trig));
+        }
+        return *histograms_[idx];
+    }
+
     uint64_t mask_;
     StreamType *performance_log_;
     ClkType& clk_;
     bool profiling_enabled_;
     std::string file_name_;
     double ticks2ns;
+    std::array<histogram_recorder*, max_triggers> histograms_ {};
 };
 
 #ifdef PROFILING
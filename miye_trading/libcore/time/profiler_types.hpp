@@ -25,7 +25,11 @@ enum class profiler_trigger: uint32_t {
     engine_traded_time,
     engine_send_time,
     om_fix_msg_prep,
-    om_msg_sent
+    om_msg_sent,
+    md_ws_receive,
+    md_msg_parsed,
+    md_book_updated,
+    om_order_decision
 
 };
 
@@ -43,6 +47,10 @@ inline const char* c_str(profiler_trigger t)
     case profiler_trigger::engine_send_time:    return  "engine_send_time";
     case profiler_trigger::om_fix_msg_prep:     return  "om_fix_msg_prep";
     case profiler_trigger::om_msg_sent:         return  "om_msg_sent";
+    case profiler_trigger::md_ws_receive:       return  "md_ws_receive";
+    case profiler_trigger::md_msg_parsed:       return  "md_msg_parsed";
+    case profiler_trigger::md_book_updated:     return  "md_book_updated";
+    case profiler_trigger::om_order_decision:   return  "om_order_decision";
     }
     return ENUM_UNKNOWN;
 }
@@ -82,6 +90,18 @@ OStream& operator<<(OStream& os, profiler_trigger t)
     case profiler_trigger::om_msg_sent:
         os << "om_msg_sent";
         break;
+    case profiler_trigger::md_ws_receive:
+        os << "md_ws_receive";
+        break;
+    case profiler_trigger::md_msg_parsed:
+        os << "md_msg_parsed";
+        break;
+    case profiler_trigger::md_book_updated:
+        os << "md_book_updated";
+        break;
+    case profiler_trigger::om_order_decision:
+        os << "om_order_decision";
+        break;
     }
     return os;
 }
@@ -110,6 +130,14 @@ inline profiler_trigger from_str<profiler_trigger>(const char* s)
         return profiler_trigger::om_fix_msg_prep;
     } else if (!::strncmp("om_msg_sent", s, strlen(s))) {
         return profiler_trigger::om_msg_sent;
+    } else if (!::strncmp("md_ws_receive", s, strlen(s))) {
+        return profiler_trigger::md_ws_receive;
+    } else if (!::strncmp("md_msg_parsed", s, strlen(s))) {
+        return profiler_trigger::md_msg_parsed;
+    } else if (!::strncmp("md_book_updated", s, strlen(s))) {
+        return profiler_trigger::md_book_updated;
+    } else if (!::strncmp("om_order_decision", s, strlen(s))) {
+        return profiler_trigger::om_order_decision;
     }
     return profiler_trigger::none;
 }
@@ -0,0 +1,177 @@
+/*
+ * span_analyzer.hpp
+ *
+ * Purpose: offline side of span_tracer. Loads one or more span logs, joins
+ * the stamps of each span id and reports the latency of every stage
+ * (consecutive stamps of a span) plus a flame style breakdown of where the
+ * time of a whole tick-to-trade path goes.
+ *
+ * Author:
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <fcntl.h>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdint.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <utility>
+#include <vector>
+
+#include "libcore/time/hdr_histogram.hpp"
+#include "libcore/time/profiler_types.hpp"
+#include "libcore/time/span_tracer.hpp"
+#include "libcore/utils/syscalls_files.hpp"
+#include "libcore/utils/syscalls_mmap.hpp"
+
+namespace miye { namespace time {
+
+class span_analyzer
+{
+    // ticks2ns comes from the file the stamp was read from, each log is
+    // calibrated on its own
+    struct stamp
+    {
+        uint64_t tsc;
+        double ticks2ns;
+        profiler_trigger trigger;
+    };
+
+    // span ids restart in every process, the pid keeps them apart
+    using span_key = std::pair<uint32_t, uint64_t>;
+
+    struct path_stats
+    {
+        uint64_t count {0};
+        uint64_t total {0};
+        std::vector<uint64_t> stage_total;
+        std::vector<std::string> stage_names;
+    };
+
+public:
+    // adds the spans of one log file, false if it is not a span log
+    bool load(const std::string& path)
+    {
+        const int fd = syscalls::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat64 st;
+        syscalls::fstat64(fd, &st);
+        if (size_t(st.st_size) < sizeof(span_log_header)) {
+            syscalls::close(fd);
+            return false;
+        }
+        void* base = syscalls::mmap64(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        syscalls::close(fd);
+        if (base == MAP_FAILED) {
+            return false;
+        }
+
+        const auto* header = static_cast<const span_log_header*>(base);
+        const bool valid = header->magic == span_log_header::MAGIC && header->record_size == sizeof(span_record);
+        if (valid) {
+            const auto* records = reinterpret_cast<const span_record*>(header + 1);
+            const uint64_t n = std::min(header->count, header->capacity);
+            add(records, n, header->ticks2ns, header->pid);
+            dropped_ += header->dropped;
+        }
+        syscalls::munmap(base, st.st_size);
+        return valid;
+    }
+
+    void add(const span_record* records, uint64_t n, double ticks2ns, uint32_t pid)
+    {
+        for (uint64_t i = 0; i < n; ++i) {
+            spans_[span_key {pid, records[i].span_id}].push_back(
+                stamp {records[i].tsc, ticks2ns, records[i].trigger});
+        }
+    }
+
+    // joins the stamps into stage latencies, call once after loading
+    void process()
+    {
+        for (auto& kv : spans_) {
+            auto& stamps = kv.second;
+            if (stamps.size() < 2) {
+                continue;
+            }
+            std::sort(stamps.begin(), stamps.end(), [](const stamp& a, const stamp& b) { return a.tsc < b.tsc; });
+
+            std::string path = c_str(stamps.front().trigger);
+            std::vector<uint64_t> stage_nanos;
+            for (size_t i = 1; i < stamps.size(); ++i) {
+                const uint64_t ns = uint64_t((stamps[i].tsc - stamps[i - 1].tsc) * stamps[i].ticks2ns);
+                stages_[stage_name(stamps[i - 1].trigger, stamps[i].trigger)].record(ns);
+                stage_nanos.push_back(ns);
+                path += std::string(" > ") + c_str(stamps[i].trigger);
+            }
+
+            auto& p = paths_[path];
+            if (p.stage_total.empty()) {
+                p.stage_total.resize(stage_nanos.size());
+                for (size_t i = 1; i < stamps.size(); ++i) {
+                    p.stage_names.push_back(stage_name(stamps[i - 1].trigger, stamps[i].trigger));
+                }
+            }
+            for (size_t i = 0; i < stage_nanos.size(); ++i) {
+                p.stage_total[i] += stage_nanos[i];
+                p.total += stage_nanos[i];
+            }
+            ++p.count;
+        }
+    }
+
+    std::string to_str() const
+    {
+        std::ostringstream oss;
+        oss << "spans: " << spans_.size() << " dropped stamps: " << dropped_ << "\n\n";
+
+        oss << std::left << std::setw(40) << "stage" << std::right << std::setw(10) << "count" << std::setw(10)
+            << "mean" << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99"
+            << std::setw(10) << "p99.9" << std::setw(10) << "max" << "\n";
+        for (const auto& kv : stages_) {
+            const auto& h = kv.second;
+            oss << std::left << std::setw(40) << kv.first << std::right << std::setw(10) << h.count()
+                << std::setw(10) << uint64_t(h.mean()) << std::setw(10) << h.value_at_percentile(50.0)
+                << std::setw(10) << h.value_at_percentile(90.0) << std::setw(10) << h.value_at_percentile(99.0)
+                << std::setw(10) << h.value_at_percentile(99.9) << std::setw(10) << h.max() << "\n";
+        }
+
+        // flame style: share of the path's mean time spent in each stage
+        const size_t bar_width = 50;
+        for (const auto& kv : paths_) {
+            const auto& p = kv.second;
+            oss << "\n" << kv.first << "\n  spans: " << p.count << " mean: " << p.total / p.count << "ns\n";
+            size_t pos = 0;
+            for (size_t i = 0; i < p.stage_total.size(); ++i) {
+                const double share = p.total ? double(p.stage_total[i]) / double(p.total) : 0.0;
+                const size_t len = std::max<size_t>(1, size_t(share * bar_width + 0.5));
+                oss << "  " << std::string(pos, ' ') << std::string(len, '#')
+                    << std::string(bar_width + 1 - std::min(bar_width, pos + len), ' ') << std::fixed
+                    << std::setprecision(1) << share * 100.0 << "% " << p.stage_total[i] / p.count << "ns "
+                    << p.stage_names[i] << "\n";
+                pos = std::min(bar_width, pos + len);
+            }
+        }
+        return oss.str();
+    }
+
+private:
+    static std::string stage_name(profiler_trigger from, profiler_trigger to)
+    {
+        return std::string(c_str(from)) + " > " + c_str(to);
+    }
+
+    uint64_t dropped_ {0};
+    std::map<span_key, std::vector<stamp>> spans_;
+    std::map<std::string, latency_histogram> stages_;
+    std::map<std::string, path_stats> paths_;
+};
+
+}}
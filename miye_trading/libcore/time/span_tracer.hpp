@@ -0,0 +1,228 @@
+/*
+ * span_tracer.hpp
+ *
+ * Purpose: tick-to-trade span tracing. A span id is taken when a websocket
+ * message is received and every later stage of the same call chain (parse,
+ * book update, order decision, FIX render, send) stamps it with the TSC.
+ * The md -> strategy -> om path runs on the polling thread, so the open
+ * span lives in the thread's tracer and the stages only name themselves.
+ *
+ * Stamps go to a per thread mmap file of fixed size span_record entries,
+ * span_analyzer.hpp reads them back. With PROFILING off the SPAN_ macros
+ * expand to nothing.
+ *
+ * Author:
+ */
+
+#pragma once
+
+#include <atomic>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "libcore/essential/arch.hpp"
+#include "libcore/time/profiler_types.hpp"
+#include "libcore/time/rdtsc.hpp"
+#include "libcore/utils/syscalls_files.hpp"
+#include "libcore/utils/syscalls_mmap.hpp"
+
+namespace miye { namespace time {
+
+struct span_record
+{
+    uint64_t span_id;
+    uint64_t tsc;
+    profiler_trigger trigger;
+    uint32_t aux; // stage specific, eg the cid of the book
+};
+static_assert(sizeof(span_record) == 24, "span_record is a file format");
+
+struct alignas(64) span_log_header
+{
+    static constexpr uint64_t MAGIC = 0x32474f4c4e415053ULL; // "SPANLOG2"
+
+    uint64_t magic;
+    uint32_t record_size;
+    uint32_t thread_slot;
+    uint32_t pid; // span ids are only unique within one process
+    uint32_t reserved;
+    uint64_t capacity;
+    uint64_t count;   // records written, readers may follow it
+    uint64_t dropped; // stamps lost once the file was full
+    double ticks2ns;
+};
+
+/*
+ * fixed capacity mmap file of span records, one writer.
+ */
+class span_log
+{
+public:
+    span_log() = default;
+    span_log(const span_log&) = delete;
+    span_log& operator=(const span_log&) = delete;
+
+    ~span_log()
+    {
+        close();
+    }
+
+    bool open(const std::string& path, uint64_t capacity, uint32_t thread_slot)
+    {
+        close();
+        const int fd = syscalls::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            return false;
+        }
+        mapping_size_ = sizeof(span_log_header) + capacity * sizeof(span_record);
+        if (syscalls::ftruncate64(fd, mapping_size_) < 0) {
+            syscalls::close(fd);
+            return false;
+        }
+        void* base = syscalls::mmap64(nullptr, mapping_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        syscalls::close(fd);
+        if (base == MAP_FAILED) {
+            return false;
+        }
+
+        header_ = static_cast<span_log_header*>(base);
+        records_ = reinterpret_cast<span_record*>(header_ + 1);
+        header_->magic = span_log_header::MAGIC;
+        header_->record_size = sizeof(span_record);
+        header_->thread_slot = thread_slot;
+        header_->pid = uint32_t(::getpid());
+        header_->reserved = 0;
+        header_->capacity = capacity;
+        header_->count = 0;
+        header_->dropped = 0;
+        header_->ticks2ns = calibrate_ticks();
+        return true;
+    }
+
+    void close()
+    {
+        if (header_) {
+            syscalls::munmap(header_, mapping_size_);
+            header_ = nullptr;
+            records_ = nullptr;
+        }
+    }
+
+    bool is_open() const
+    {
+        return header_ != nullptr;
+    }
+
+    ALWAYS_INLINE void write(uint64_t span_id, uint64_t tsc, profiler_trigger trig, uint32_t aux)
+    {
+        const uint64_t n = header_->count;
+        if (UNLIKELY(n == header_->capacity)) {
+            ++header_->dropped;
+            return;
+        }
+        span_record& r = records_[n];
+        r.span_id = span_id;
+        r.tsc = tsc;
+        r.trigger = trig;
+        r.aux = aux;
+        header_->count = n + 1;
+    }
+
+private:
+    span_log_header* header_ {nullptr};
+    span_record* records_ {nullptr};
+    size_t mapping_size_ {0};
+};
+
+/*
+ * per thread span state. open() once at startup on every thread that
+ * receives market data or sends orders, until then all calls are no-ops.
+ */
+class span_tracer
+{
+public:
+    static constexpr uint64_t default_capacity = 1ULL << 22; // 96MB
+
+    static span_tracer& instance()
+    {
+        static thread_local span_tracer tracer;
+        return tracer;
+    }
+
+    // path gets the thread slot appended, eg spans-perp_ftx.0
+    bool open(const std::string& path, uint64_t capacity = default_capacity)
+    {
+        static std::atomic<uint32_t> next_slot {0};
+        const uint32_t slot = next_slot.fetch_add(1, std::memory_order_relaxed);
+        if (!log_.open(path + "." + std::to_string(slot), capacity, slot)) {
+            return false;
+        }
+        // ids carry the slot so spans from several threads never collide,
+        // other processes are told apart by the pid in the log header
+        next_id_ = uint64_t(slot) << 48;
+        current_ = 0;
+        return true;
+    }
+
+    // starts a new span and makes it the thread's current one
+    ALWAYS_INLINE uint64_t begin(profiler_trigger trig, uint32_t aux = 0)
+    {
+        if (!log_.is_open()) {
+            return 0;
+        }
+        current_ = ++next_id_;
+        log_.write(current_, essential::rdtscp(), trig, aux);
+        return current_;
+    }
+
+    ALWAYS_INLINE void stamp(profiler_trigger trig, uint32_t aux = 0)
+    {
+        if (current_) {
+            log_.write(current_, essential::rdtscp(), trig, aux);
+        }
+    }
+
+    ALWAYS_INLINE void end(profiler_trigger trig, uint32_t aux = 0)
+    {
+        stamp(trig, aux);
+        current_ = 0;
+    }
+
+    // hand a span over to another thread: read current() on one side,
+    // resume() with it on the other
+    uint64_t current() const
+    {
+        return current_;
+    }
+
+    void resume(uint64_t span_id)
+    {
+        current_ = log_.is_open() ? span_id : 0;
+    }
+
+private:
+    span_log log_;
+    uint64_t next_id_ {0};
+    uint64_t current_ {0};
+};
+
+#ifdef PROFILING
+
+#define SPAN_OPEN(path) ::miye::time::span_tracer::instance().open(path)
+#define SPAN_BEGIN(trig, aux) ::miye::time::span_tracer::instance().begin(trig, aux)
+#define SPAN_STAMP(trig, aux) ::miye::time::span_tracer::instance().stamp(trig, aux)
+#define SPAN_END(trig, aux) ::miye::time::span_tracer::instance().end(trig, aux)
+
+#else
+
+#define SPAN_OPEN(path)
+#define SPAN_BEGIN(trig, aux)
+#define SPAN_STAMP(trig, aux)
+#define SPAN_END(trig, aux)
+
+#endif
+
+}}
@@ -1,7 +1,7 @@
 /*
  * stats.hpp
  *
- * Purpose: streaming mean, sd and simple histogram output
+ * Purpose: streaming mean, sd, percentiles and simple histogram output
  *
  * Author: 
  */
@@ -12,12 +12,22 @@
 #include <sstream>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <vector>
 
+#include "libcore/time/hdr_histogram.hpp"
+
 
 namespace miye { namespace time {
 
 
+/*
+ * mean/sd by Welford, percentiles from an hdr histogram of the values
+ * (relative error < 1%). Percentiles only see values >= 0, which is what
+ * latencies and intervals are. The histogram is ~35KB, it is allocated on
+ * the first such value so stats_t that never record stay small to copy,
+ * and moves never copy it.
+ */
 struct stats_t
 {
     stats_t()
@@ -26,14 +36,38 @@ struct stats_t
     , N(0)
     {}
 
+    stats_t(const stats_t& rhs)
+    : mean(rhs.mean)
+    , m2(rhs.m2)
+    , high(rhs.high)
+    , low(rhs.low)
+    , N(rhs.N)
+    , hist(rhs.hist ? new latency_histogram(*rhs.hist) : nullptr)
+    {}
+
+    stats_t(stats_t&&) = default;
+    stats_t& operator=(stats_t&&) = default;
+
+    stats_t& operator=(const stats_t& rhs)
+    {
+        if (this != &rhs)
+            *this = stats_t(rhs);
+        return *this;
+    }
+
     void add(double value)
     {
         ++N;
         high = std::max(value, high);
         low = std::min(value, low);
-        float delta = value - mean;
+        double delta = value - mean;
         mean += delta/N;
         m2 += delta * (value - mean);
+        if (value >= 0) {
+            if (!hist)
+                hist.reset(new latency_histogram());
+            hist->record(uint64_t(value));
+        }
     }
 
     double get_stddev() const {
@@ -58,6 +92,15 @@ struct stats_t
         return N;
     }
 
+    uint64_t get_percentile(double pct) const {
+        return hist ? hist->value_at_percentile(pct) : 0;
+    }
+
+    const latency_histogram& get_histogram() const {
+        static const latency_histogram empty;
+        return hist ? *hist : empty;
+    }
+
     void reset()
     {
         mean = 0.0;
@@ -65,6 +108,8 @@ struct stats_t
         high = -std::numeric_limits<double>::max();
         low = std::numeric_limits<double>::max();
         N = 0;
+        if (hist)
+            hist->reset();
     }
 
     std::string to_str() const
@@ -74,21 +119,25 @@ struct stats_t
             << "   High: " << high << std::endl
             << "    Low: " << low << std::endl
             << "   Mean: " << mean << std::endl
-            << " StdDev: " << get_stddev() << std::endl;
+            << " StdDev: " << get_stddev() << std::endl
+            << "    p50: " << get_percentile(50.0) << std::endl
+            << "    p99: " << get_percentile(99.0) << std::endl
+            << "  p99.9: " << get_percentile(99.9) << std::endl;
         return oss.str();
     }
 
     static std::string csv_header()
     {
         std::ostringstream oss;
-        oss << "N,low,high,mean,stddev";
+        oss << "N,low,high,mean,stddev,p50,p99,p99.9";
         return oss.str();
     }
 
     std::string to_csv() const
     {
         std::ostringstream oss;
-        oss << N << "," << low << "," << high << "," << mean << "," << get_stddev();
+        oss << N << "," << low << "," << high << "," << mean << "," << get_stddev() << ","
+            << get_percentile(50.0) << "," << get_percentile(99.0) << "," << get_percentile(99.9);
         return oss.str();
     }
 
@@ -97,8 +146,8 @@ private:
     double       m2;
     double       high {-std::numeric_limits<double>::max()};
     double       low {std::numeric_limits<double>::max()};
-    double       std {std::numeric_limits<double>::max()};
     uint32_t     N;
+    std::unique_ptr<latency_histogram> hist;
 
 };
 
@@ -0,0 +1,63 @@
+#include "benchmark/benchmark.h"
+#include <chrono>
+#include <sstream>
+#include <string.h>
+#include <string>
+
+#include "date/date.h"
+#include "libcore/time/iso8601.hpp"
+
+// coinbase ticker/full channel timestamps
+static const char* timestamps[] = {
+    "2017-09-02T17:05:49.250000Z",
+    "2017-09-02T17:05:49.253117Z",
+    "2017-09-02T17:05:50.001962Z",
+    "2017-09-02T17:05:51.930455Z",
+};
+static const size_t timestamp_count = sizeof(timestamps) / sizeof(timestamps[0]);
+
+static void iso8601_parser_cached(benchmark::State& state)
+{
+    miye::time::iso8601_parser parser;
+    size_t i = 0;
+    uint64_t nanos = 0;
+    while (state.KeepRunning())
+    {
+        auto const* ts = timestamps[i++ % timestamp_count];
+        benchmark::DoNotOptimize(parser.parse(ts, 27, nanos));
+        benchmark::DoNotOptimize(nanos);
+    }
+}
+
+BENCHMARK(iso8601_parser_cached);
+
+static void parse_iso8601(benchmark::State& state)
+{
+    size_t i = 0;
+    uint64_t nanos = 0;
+    while (state.KeepRunning())
+    {
+        auto const* ts = timestamps[i++ % timestamp_count];
+        benchmark::DoNotOptimize(miye::time::parse_iso8601(ts, 27, nanos));
+        benchmark::DoNotOptimize(nanos);
+    }
+}
+
+BENCHMARK(parse_iso8601);
+
+// what the coinbase/bitmex handlers did before
+static void date_parse(benchmark::State& state)
+{
+    size_t i = 0;
+    while (state.KeepRunning())
+    {
+        std::stringstream datestr(timestamps[i++ % timestamp_count]);
+        date::sys_time<std::chrono::nanoseconds> tp;
+        datestr >> date::parse("%FT%T", tp);
+        benchmark::DoNotOptimize(tp);
+    }
+}
+
+BENCHMARK(date_parse);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,95 @@
+#include "benchmark/benchmark.h"
+#include <stdint.h>
+
+#include "libcore/time/metrics.hpp"
+#include "libcore/time/stats.hpp"
+
+// latencies in ns, mostly small with a tail
+static uint64_t next_value(uint64_t& x)
+{
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return (x & 0xff) < 250 ? 200 + (x & 0x3ff) : 5000 + (x & 0xfffff);
+}
+
+static void hdr_histogram_record(benchmark::State& state)
+{
+    miye::time::latency_histogram hist;
+    uint64_t x = 88172645463325252ULL;
+    while (state.KeepRunning())
+    {
+        hist.record(next_value(x));
+    }
+    benchmark::DoNotOptimize(hist.count());
+}
+
+BENCHMARK(hdr_histogram_record);
+
+static void histogram_recorder_record(benchmark::State& state)
+{
+    auto& recorder = miye::time::metrics_registry::instance().histogram("bench.recorder");
+    uint64_t x = 88172645463325252ULL;
+    while (state.KeepRunning())
+    {
+        recorder.record(next_value(x));
+    }
+}
+
+BENCHMARK(histogram_recorder_record);
+
+static void counter_add(benchmark::State& state)
+{
+    auto& c = miye::time::metrics_registry::instance().get_counter("bench.counter");
+    while (state.KeepRunning())
+    {
+        c.add();
+    }
+    benchmark::DoNotOptimize(c.value());
+}
+
+BENCHMARK(counter_add);
+
+static void stats_add(benchmark::State& state)
+{
+    miye::time::stats_t stats;
+    uint64_t x = 88172645463325252ULL;
+    while (state.KeepRunning())
+    {
+        stats.add(double(next_value(x)));
+    }
+    benchmark::DoNotOptimize(stats.get_mean());
+}
+
+BENCHMARK(stats_add);
+
+static void percentile_p99(benchmark::State& state)
+{
+    miye::time::latency_histogram hist;
+    uint64_t x = 88172645463325252ULL;
+    for (int i = 0; i < 1000000; ++i)
+    {
+        hist.record(next_value(x));
+    }
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(hist.value_at_percentile(99.0));
+    }
+}
+
+BENCHMARK(percentile_p99);
+
+static void registry_snapshot(benchmark::State& state)
+{
+    auto& registry = miye::time::metrics_registry::instance();
+    registry.histogram("bench.snapshot").record(1000);
+    uint64_t now = 0;
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(registry.snapshot(++now));
+    }
+}
+
+BENCHMARK(registry_snapshot);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,249 @@
+/*
+ * fixed_point.hpp
+ *
+ * Purpose: strongly typed fixed-point Price/Qty. The value is an int64
+ * count of 10^-Decimals units so equality, ordering and hashing are exact
+ * integer operations, no epsilon compares on the hot path.
+ *
+ * Decimals is fixed per type (8, enough for every crypto venue). The
+ * instrument's own precision only matters at the edges: rounding to its
+ * tick/lot and rendering to the wire with its number of decimals.
+ *
+ * Author:
+ */
+
+#pragma once
+
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "libcore/math/decimal.hpp"
+
+namespace miye
+{
+
+namespace fixed_point_detail
+{
+
+static constexpr int64_t POW10[19] = {1LL,
+                                      10LL,
+                                      100LL,
+                                      1000LL,
+                                      10000LL,
+                                      100000LL,
+                                      1000000LL,
+                                      10000000LL,
+                                      100000000LL,
+                                      1000000000LL,
+                                      10000000000LL,
+                                      100000000000LL,
+                                      1000000000000LL,
+                                      10000000000000LL,
+                                      100000000000000LL,
+                                      1000000000000000LL,
+                                      10000000000000000LL,
+                                      100000000000000000LL,
+                                      1000000000000000000LL};
+
+// floor(a / b) for b > 0
+inline constexpr int64_t floorDiv(int64_t a, int64_t b)
+{
+    return a / b - (a % b != 0 && a < 0);
+}
+
+} // namespace fixed_point_detail
+
+template <typename Tag, int32_t Decimals>
+class FixedPoint
+{
+    static_assert(Decimals >= 0 && Decimals <= 18, "FixedPoint decimals out of range");
+
+  public:
+    static constexpr int32_t decimals = Decimals;
+    static constexpr int64_t scale    = fixed_point_detail::POW10[Decimals];
+
+    constexpr FixedPoint() = default;
+    explicit constexpr FixedPoint(int64_t units) : units_(units) {}
+
+    static constexpr FixedPoint fromUnits(int64_t units) { return FixedPoint(units); }
+    static constexpr FixedPoint invalid() { return FixedPoint(std::numeric_limits<int64_t>::min()); }
+
+    // rounds to the nearest unit, nan/inf give invalid()
+    static FixedPoint fromDouble(double v)
+    {
+        auto const scaled = v * double(scale);
+        if (!std::isfinite(scaled) || std::fabs(scaled) >= 9.2e18)
+        {
+            return invalid();
+        }
+        return FixedPoint(std::llround(scaled));
+    }
+
+    // "4388.01000000" straight to units, false on malformed input or
+    // non zero digits past Decimals
+    static bool fromString(const char* str, size_t len, FixedPoint& out)
+    {
+        int64_t units{};
+        if (!math::parse_scaled(str, len, Decimals, units))
+        {
+            return false;
+        }
+        out = FixedPoint(units);
+        return true;
+    }
+
+    constexpr int64_t units() const { return units_; }
+    constexpr bool isValid() const { return units_ != std::numeric_limits<int64_t>::min(); }
+    double toDouble() const { return isValid() ? double(units_) / double(scale) : NAN; }
+
+    // number of whole steps, ie ticks for a price or lots for a qty
+    constexpr int64_t steps(FixedPoint step) const { return units_ / step.units_; }
+
+    constexpr FixedPoint floorTo(FixedPoint step) const
+    {
+        return FixedPoint(fixed_point_detail::floorDiv(units_, step.units_) * step.units_);
+    }
+    constexpr FixedPoint ceilTo(FixedPoint step) const
+    {
+        return FixedPoint(-fixed_point_detail::floorDiv(-units_, step.units_) * step.units_);
+    }
+    constexpr bool isMultipleOf(FixedPoint step) const { return units_ % step.units_ == 0; }
+
+    // decimals needed to print the value exactly, eg 2 for a 0.01 tick
+    constexpr int32_t significantDecimals() const
+    {
+        int32_t d = Decimals;
+        for (int64_t u = units_; d > 0 && u % 10 == 0; u /= 10)
+        {
+            --d;
+        }
+        return d;
+    }
+
+    /*
+     * renders with exactly `digits` decimals (digits <= Decimals), finer
+     * digits are truncated so round to the tick first. no terminator is
+     * written, returns the length. out needs 21 + digits bytes.
+     */
+    size_t toChars(char* out, int32_t digits) const
+    {
+        int64_t const v = units_ / fixed_point_detail::POW10[Decimals - digits];
+        uint64_t u      = v < 0 ? uint64_t(0) - uint64_t(v) : uint64_t(v);
+
+        char tmp[24];
+        char* p = tmp + sizeof(tmp);
+        for (int32_t i = 0; i < digits; ++i)
+        {
+            *--p = char('0' + u % 10);
+            u /= 10;
+        }
+        if (digits > 0)
+        {
+            *--p = '.';
+        }
+        do
+        {
+            *--p = char('0' + u % 10);
+            u /= 10;
+        } while (u);
+        if (v < 0)
+        {
+            *--p = '-';
+        }
+
+        size_t const len = size_t(tmp + sizeof(tmp) - p);
+        for (size_t i = 0; i < len; ++i)
+        {
+            out[i] = p[i];
+        }
+        return len;
+    }
+
+    constexpr FixedPoint operator-() const { return FixedPoint(-units_); }
+    constexpr FixedPoint operator+(FixedPoint rhs) const { return FixedPoint(units_ + rhs.units_); }
+    constexpr FixedPoint operator-(FixedPoint rhs) const { return FixedPoint(units_ - rhs.units_); }
+    constexpr FixedPoint operator*(int64_t n) const { return FixedPoint(units_ * n); }
+    FixedPoint& operator+=(FixedPoint rhs)
+    {
+        units_ += rhs.units_;
+        return *this;
+    }
+    FixedPoint& operator-=(FixedPoint rhs)
+    {
+        units_ -= rhs.units_;
+        return *this;
+    }
+
+    // found by adl only so it does not hide ::abs for plain doubles
+    friend constexpr FixedPoint abs(FixedPoint v) { return v.units_ < 0 ? -v : v; }
+
+    constexpr bool operator==(FixedPoint rhs) const { return units_ == rhs.units_; }
+    constexpr bool operator!=(FixedPoint rhs) const { return units_ != rhs.units_; }
+    constexpr bool operator<(FixedPoint rhs) const { return units_ < rhs.units_; }
+    constexpr bool operator<=(FixedPoint rhs) const { return units_ <= rhs.units_; }
+    constexpr bool operator>(FixedPoint rhs) const { return units_ > rhs.units_; }
+    constexpr bool operator>=(FixedPoint rhs) const { return units_ >= rhs.units_; }
+
+  private:
+    int64_t units_{0};
+};
+
+// prints the shortest exact form, "4388.01", "0.03"
+template <typename OS, typename Tag, int32_t Decimals>
+OS& operator<<(OS& os, FixedPoint<Tag, Decimals> v)
+{
+    if (!v.isValid())
+    {
+        os << "nan";
+        return os;
+    }
+    char buf[48];
+    auto len = v.toChars(buf, Decimals);
+    if (Decimals > 0)
+    {
+        while (buf[len - 1] == '0')
+        {
+            --len;
+        }
+        if (buf[len - 1] == '.')
+        {
+            --len;
+        }
+    }
+    buf[len] = '\0';
+    os << buf;
+    return os;
+}
+
+struct PriceTag
+{
+};
+struct QtyTag
+{
+};
+
+using Price = FixedPoint<PriceTag, 8>;
+using Qty   = FixedPoint<QtyTag, 8>;
+
+// price * qty in quote currency. kept in double, the exact product of two
+// 8 decimal values does not fit in an int64
+inline double notional(Price price, Qty qty)
+{
+    return price.toDouble() * qty.toDouble();
+}
+
+} // namespace miye
+
+namespace std
+{
+
+template <typename Tag, int32_t Decimals>
+struct hash<miye::FixedPoint<Tag, Decimals>>
+{
+    size_t operator()(miye::FixedPoint<Tag, Decimals> v) const { return std::hash<int64_t>()(v.units()); }
+};
+
+} // namespace std
@@ -9,6 +9,7 @@
 #include "libcore/essential/platform_defs.hpp"
 #include "libcore/math/fast-math.hpp"
 #include "libcore/parsing/visit.hpp"
+#include "libcore/types/fixed_point.hpp"
 #include "libcore/utils/nano_time.h"
 
 #define ENUM_UNKNOWN "unknown"
@@ -76,8 +77,8 @@ inline Side fromSideStr(const std::string& v)
 
 struct trade_t
 {
-    price_t price{};
-    quantity_t qty{};
+    Price price{};
+    Qty qty{};
     Side side{};
 };
 
@@ -133,25 +134,25 @@ struct order_t
     symbol_t symbol{};
     uint32_t seqnum{};
     Side side{Side::UNKNOWN};
-    price_t price{NAN};
-    quantity_t qty{NAN};
+    Price price{Price::invalid()};
+    Qty qty{Qty::invalid()};
 
     int32_t clientOrderId{};
     uint8_t status{};
     int32_t cid{0};
-    quantity_t entrySize{0.0};
-    quantity_t size{0.0};
-    quantity_t canceledSize{0.0};
+    Qty entrySize{};
+    Qty size{};
+    Qty canceledSize{};
 
-    price_t entryPrice{0.0};
+    Price entryPrice{};
     OrderType orderType{};
     time::NanoTime entryTime{};
     time::NanoTime updateTime{};
-    quantity_t filled{0.0};
+    Qty filled{};
     uint64_t mktId{0}; // is exchangeId always int?
 
-    quantity_t getCanceledSize() const { return canceledSize; }
-    void setCanceledSize(quantity_t canceledSize) { this->canceledSize = canceledSize; }
+    Qty getCanceledSize() const { return canceledSize; }
+    void setCanceledSize(Qty canceledSize) { this->canceledSize = canceledSize; }
 
     int32_t getCid() const { return cid; }
     void setCid(int32_t cid) { this->cid = cid; }
@@ -159,29 +160,29 @@ struct order_t
     int32_t getClientOrderId() const { return clientOrderId; }
     void setClientOrderId(int32_t clientOrderId) { this->clientOrderId = clientOrderId; }
 
-    price_t getPrice() const { return price; }
-    void setPrice(price_t price) { this->price = price; }
+    Price getPrice() const { return price; }
+    void setPrice(Price price) { this->price = price; }
 
-    price_t getEntryPrice() const { return entryPrice; }
-    void setEntryPrice(price_t entryPrice) { this->entryPrice = entryPrice; }
+    Price getEntryPrice() const { return entryPrice; }
+    void setEntryPrice(Price entryPrice) { this->entryPrice = entryPrice; }
 
-    price_t getSize() const { return size; }
-    void setSize(price_t size) { this->size = size; }
+    Qty getSize() const { return size; }
+    void setSize(Qty size) { this->size = size; }
 
-    quantity_t getEntrySize() const { return entrySize; }
-    void setEntrySize(quantity_t entrySize) { this->entrySize = entrySize; }
+    Qty getEntrySize() const { return entrySize; }
+    void setEntrySize(Qty entrySize) { this->entrySize = entrySize; }
 
     const time::NanoTime& getEntryTime() const { return entryTime; }
     void setEntryTime(const time::NanoTime& entryTime) { this->entryTime = entryTime; }
 
-    quantity_t getFilled() const { return filled; }
-    void setFilled(quantity_t filled) { this->filled = filled; }
+    Qty getFilled() const { return filled; }
+    void setFilled(Qty filled) { this->filled = filled; }
 
     uint64_t getMarketId() const { return mktId; }
     void setMarketId(uint64_t marketId) { this->mktId = marketId; }
 
-    quantity_t getQty() const { return qty; }
-    void setQty(quantity_t qty) { this->qty = qty; }
+    Qty getQty() const { return qty; }
+    void setQty(Qty qty) { this->qty = qty; }
 
     uint32_t getSeqnum() const { return seqnum; }
     void setSeqnum(uint32_t seqnum) { this->seqnum = seqnum; }
@@ -267,6 +268,7 @@ struct order_key_t
 {
     using key_t = uint64_t;
 
+    order_key_t() : key(0) {}
     explicit order_key_t(const order_key_t::key_t key) : key(key) {}
 
     explicit order_key_t(const session_t session, const strategy_id_t strategy, const order_ref_t ref)
@@ -4,6 +4,8 @@
 #include <sstream>
 #include <string>
 
+#include "libcore/math/decimal.hpp"
+
 namespace miye
 {
 namespace number_utils
@@ -46,10 +48,16 @@ inline T toInt(const std::string& data)
     return val;
 }
 
+inline double toDouble(const char* data, size_t len)
+{
+    double val{};
+    math::parse_double(data, len, val);
+    return val;
+}
+
 inline double toDouble(const std::string& data)
 {
-    char* end;
-    return std::strtod(data.c_str(), &end);
+    return toDouble(data.data(), data.size());
 }
 
 inline bool onlyContainsNumber(const std::string& str)
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "libcore/utils/nano_time.h"
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+
+namespace miye::utils
+{
+
+/*
+ * token bucket as a generic cell rate algorithm: rate events per window with
+ * bursts of up to `burst`. the whole state is the theoretical arrival time of
+ * the next event, so a check is a compare and an add on the caller's
+ * timestamp, no clock read, no queue.
+ *
+ * tryAcquire is a cas loop on that one word and safe to share between
+ * threads. unconfigured (rate <= 0) rejects everything.
+ */
+class RateLimiter
+{
+  public:
+    RateLimiter() = default;
+    RateLimiter(const RateLimiter& rhs) { *this = rhs; }
+    RateLimiter& operator=(const RateLimiter& rhs)
+    {
+        interval_  = rhs.interval_;
+        tolerance_ = rhs.tolerance_;
+        tat_.store(rhs.tat_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
+
+    template <typename Duration>
+    int32_t init(int32_t rate, Duration window, int32_t burst = 0)
+    {
+        if (rate <= 0)
+        {
+            interval_  = 0;
+            tolerance_ = -1;
+            return 0;
+        }
+        burst      = burst > 0 ? burst : rate;
+        interval_  = std::chrono::duration_cast<time::NanoDuration>(window).count() / rate;
+        tolerance_ = interval_ * (burst - 1);
+        tat_.store(0, std::memory_order_relaxed);
+        return 0;
+    }
+
+    bool tryAcquire(time::NanoTime timestamp)
+    {
+        auto const now = timestamp.time_since_epoch().count();
+        auto tat       = tat_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            auto const start = tat > now ? tat : now;
+            if (start - now > tolerance_)
+            {
+                return false;
+            }
+            if (tat_.compare_exchange_weak(tat, start + interval_, std::memory_order_relaxed))
+            {
+                return true;
+            }
+        }
+    }
+
+    // events that would pass right now
+    int32_t available(time::NanoTime timestamp) const
+    {
+        if (tolerance_ < 0)
+        {
+            return 0;
+        }
+        auto const now   = timestamp.time_since_epoch().count();
+        auto const tat   = tat_.load(std::memory_order_relaxed);
+        auto const ahead = tat > now ? tat - now : 0;
+        if (ahead > tolerance_)
+        {
+            return 0;
+        }
+        return interval_ ? int32_t((tolerance_ - ahead) / interval_) + 1 : 1;
+    }
+
+    void reset() { tat_.store(0, std::memory_order_relaxed); }
+
+  private:
+    int64_t interval_{0};
+    int64_t tolerance_{-1};
+    std::atomic<int64_t> tat_{0};
+};
+
+} // namespace miye::utils
@@ -1,51 +1,112 @@
 #pragma once
 
 #include "libcore/utils/nano_time.h"
+#include <cassert>
 #include <chrono>
-#include <queue>
+#include <memory>
+#include <stdint.h>
 
 namespace miye::utils
 {
 
+/*
+ * timestamps of the events in the last window, eg orders sent in the last
+ * second. a power of two ring allocated once in init, append/roll never
+ * allocate. capacity must exceed the rate limit checked against getSize,
+ * append on a full queue asserts and is refused, the caller fails closed.
+ */
 class RollingQueue
 {
   private:
-    std::queue<time::NanoTime> container;
-    std::chrono::milliseconds window{999};
+    std::unique_ptr<time::NanoTime[]> container;
+    uint64_t mask{0};
+    uint64_t head{0}; // oldest
+    uint64_t tail{0}; // one past newest
+    time::NanoDuration window{std::chrono::milliseconds(999)};
 
   public:
-    uint32_t roll(time::NanoTime timestamp)
+    static constexpr size_t DefaultCapacity = 1024;
+
+    RollingQueue() = default;
+    RollingQueue(const RollingQueue& rhs) { *this = rhs; }
+    RollingQueue& operator=(const RollingQueue& rhs)
     {
-        if (container.empty())
-        {
-            return 0;
-        }
-        uint32_t count{};
-        while (!container.empty())
+        if (this != &rhs)
         {
-            auto const& elem = container.front();
-            if (elem + window <= timestamp)
+            window = rhs.window;
+            if (!rhs.container)
             {
-                container.pop();
-                count++;
+                container.reset();
+                mask = head = tail = 0;
+                return *this;
             }
-            else
+            reserve(rhs.capacity());
+            for (auto i = rhs.head; i != rhs.tail; ++i)
             {
-                break;
+                append(rhs.container[i & rhs.mask]);
             }
         }
+        return *this;
+    }
+
+    uint32_t roll(time::NanoTime timestamp)
+    {
+        uint32_t count{};
+        while (head != tail && container[head & mask] + window <= timestamp)
+        {
+            ++head;
+            ++count;
+        }
         return count;
     }
 
-    void append(time::NanoTime timestamp) { container.push(timestamp); }
-    size_t getSize() const { return container.size(); }
-    std::chrono::milliseconds getRollWindow() const { return window; }
+    // false when full, the timestamp is not queued
+    bool append(time::NanoTime timestamp)
+    {
+        if (!container)
+        {
+            reserve(DefaultCapacity);
+        }
+        if (tail - head > mask)
+        {
+            assert(!"rolling queue full, capacity below the rate checked against it");
+            return false;
+        }
+        container[tail++ & mask] = timestamp;
+        return true;
+    }
+
+    size_t getSize() const { return tail - head; }
+    size_t capacity() const { return container ? mask + 1 : 0; }
+    std::chrono::milliseconds getRollWindow() const
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(window);
+    }
+
+    // oldest timestamp still in the window
+    time::NanoTime front() const { return container[head & mask]; }
+
     template <typename Duration>
-    int32_t init(Duration window)
+    int32_t init(Duration window, size_t capacity = DefaultCapacity)
     {
-        this->window = window;
+        this->window = std::chrono::duration_cast<time::NanoDuration>(window);
+        reserve(capacity);
         return 0;
     }
+
+  private:
+    // rounds up to a power of two and drops whatever was queued
+    void reserve(size_t capacity)
+    {
+        size_t size = 1;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+        container.reset(new time::NanoTime[size]);
+        mask = size - 1;
+        head = tail = 0;
+    }
 };
 
 } // namespace miye::utils
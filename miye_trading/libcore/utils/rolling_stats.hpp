@@ -0,0 +1,397 @@
+/*
+ * rolling_stats.hpp
+ *
+ * Purpose: incremental statistics over a time and/or count bounded window.
+ * Every update is O(1) amortized, nothing walks the window:
+ *
+ *  RollingStats       - count, sum, abs sum, mean, variance, min, max
+ *  RollingCorrelation - covariance/correlation of two series sampled together
+ *  RollingVwap        - volume weighted average price
+ *  Ewma               - time decayed exponential moving average
+ *
+ * Windows follow utils::Queue: window_size_nanos limits the age of the
+ * oldest item relative to the newest timestamp seen, max_items limits the
+ * item count, zero disables either. Mean/variance use Welford's update and
+ * downdate so the window can run for days without the drift of a running
+ * sum of squares. Min/max are monotonic deques on top of dequecontig.
+ *
+ * Author:
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <stdint.h>
+
+#include "libcore/essential/assert.hpp"
+#include "libcore/utils/dequecontig.hpp"
+#include "libcore/utils/queue.hpp"
+
+namespace miye
+{
+namespace utils
+{
+
+namespace detail
+{
+
+// window bookkeeping shared by the rolling classes: the items with their
+// timestamps plus the sequence number of the oldest one
+template <typename E>
+class RollingWindow
+{
+  public:
+    struct Entry
+    {
+        uint64_t nanos{};
+        uint64_t seq{};
+        E val{};
+    };
+
+    void init(uint64_t win_sz_nanos, size_t max_sz = 0)
+    {
+        items_.clear();
+        window_size_nanos_ = win_sz_nanos;
+        max_items_         = max_sz;
+        head_seq_          = 0;
+        next_seq_          = 0;
+        if (max_sz)
+        {
+            items_.reserve(int32_t(max_sz + 2));
+        }
+    }
+
+    uint64_t push(uint64_t now, const E& val)
+    {
+        INVARIANT(max_items_ | window_size_nanos_);
+        INVARIANT_MSG(!items_.size() || (items_.back().nanos <= now), DUMP(items_.back().nanos) << DUMP(now));
+        Entry e;
+        e.nanos = now;
+        e.seq   = next_seq_++;
+        e.val   = val;
+        items_.push_back(e);
+        return e.seq;
+    }
+
+    // true and the evicted entry in out if the oldest item is outside the window
+    bool expire(uint64_t now, Entry& out)
+    {
+        if (items_.empty())
+        {
+            return false;
+        }
+        auto const& front = items_.front();
+        bool const too_old  = window_size_nanos_ && now >= window_size_nanos_ && front.nanos < now - window_size_nanos_;
+        bool const too_many = max_items_ && items_.size() > max_items_;
+        if (!too_old && !too_many)
+        {
+            return false;
+        }
+        out = items_.pop_front();
+        ++head_seq_;
+        return true;
+    }
+
+    size_t size() const { return items_.size(); }
+    bool empty() const { return items_.empty(); }
+    uint64_t head_seq() const { return head_seq_; }
+    const Entry& operator[](size_t index) const { return items_[int32_t(index)]; }
+
+  private:
+    fundamentals::dequecontig<Entry> items_;
+    uint64_t window_size_nanos_{0};
+    size_t max_items_{0};
+    uint64_t head_seq_{0};
+    uint64_t next_seq_{0};
+};
+
+// monotonic deque, front is the min (Less = true) or max of the window
+template <bool Less>
+class MonotonicDeque
+{
+    struct Entry
+    {
+        uint64_t seq{};
+        double val{};
+    };
+
+  public:
+    void clear() { items_.clear(); }
+
+    void push(uint64_t seq, double val)
+    {
+        while (!items_.empty() && (Less ? items_.back().val >= val : items_.back().val <= val))
+        {
+            items_.pop_back();
+        }
+        Entry e;
+        e.seq = seq;
+        e.val = val;
+        items_.push_back(e);
+    }
+
+    // drop the front if it left the window
+    void expire(uint64_t head_seq)
+    {
+        while (!items_.empty() && items_.front().seq < head_seq)
+        {
+            items_.pop_front();
+        }
+    }
+
+    bool empty() const { return items_.empty(); }
+    double front() const { return items_.front().val; }
+
+  private:
+    fundamentals::dequecontig<Entry> items_;
+};
+
+} // namespace detail
+
+class RollingStats
+{
+  public:
+    void init(uint64_t win_sz_nanos, size_t max_sz = 0)
+    {
+        window_.init(win_sz_nanos, max_sz);
+        min_.clear();
+        max_.clear();
+        sum_     = 0.0;
+        abs_sum_ = 0.0;
+        mean_    = 0.0;
+        m2_      = 0.0;
+    }
+
+    inline void add(uint64_t now, double val)
+    {
+        auto const seq = window_.push(now, val);
+        sum_ += val;
+        abs_sum_ += std::fabs(val);
+
+        auto const n     = double(window_.size());
+        auto const delta = val - mean_;
+        mean_ += delta / n;
+        m2_ += delta * (val - mean_);
+
+        min_.push(seq, val);
+        max_.push(seq, val);
+        touch(now);
+    }
+
+    // evicts everything older than the window, call on timer/book events so
+    // the stats decay without new samples
+    inline void touch(uint64_t now)
+    {
+        detail::RollingWindow<double>::Entry e;
+        bool evicted = false;
+        while (window_.expire(now, e))
+        {
+            remove(e.val);
+            evicted = true;
+        }
+        if (evicted)
+        {
+            min_.expire(window_.head_seq());
+            max_.expire(window_.head_seq());
+        }
+    }
+
+    size_t count() const { return window_.size(); }
+    bool empty() const { return window_.empty(); }
+    double sum() const { return sum_; }
+    double abs_sum() const { return abs_sum_; }
+    double mean() const { return window_.empty() ? NAN : mean_; }
+
+    // population variance of the window
+    double variance() const { return window_.empty() ? NAN : std::max(0.0, m2_ / double(window_.size())); }
+    double sample_variance() const
+    {
+        return window_.size() < 2 ? NAN : std::max(0.0, m2_ / double(window_.size() - 1));
+    }
+    double stddev() const { return std::sqrt(variance()); }
+
+    double min() const { return min_.empty() ? NAN : min_.front(); }
+    double max() const { return max_.empty() ? NAN : max_.front(); }
+
+    // oldest first
+    double operator[](size_t index) const { return window_[index].val; }
+
+  private:
+    inline void remove(double val)
+    {
+        sum_ -= val;
+        abs_sum_ -= std::fabs(val);
+
+        auto const n = window_.size();
+        if (n == 0)
+        {
+            // start from exact zero again instead of carrying rounding error
+            sum_     = 0.0;
+            abs_sum_ = 0.0;
+            mean_    = 0.0;
+            m2_      = 0.0;
+            return;
+        }
+        auto const delta = val - mean_;
+        mean_ -= delta / double(n);
+        m2_ -= delta * (val - mean_);
+    }
+
+    detail::RollingWindow<double> window_;
+    detail::MonotonicDeque<true> min_;
+    detail::MonotonicDeque<false> max_;
+    double sum_{0.0};
+    double abs_sum_{0.0};
+    double mean_{0.0};
+    double m2_{0.0};
+};
+
+/*
+ * rolling covariance/correlation of two series sampled at the same time,
+ * eg mid returns of two books
+ */
+class RollingCorrelation
+{
+    struct Pair
+    {
+        double x{};
+        double y{};
+    };
+
+  public:
+    void init(uint64_t win_sz_nanos, size_t max_sz = 0)
+    {
+        window_.init(win_sz_nanos, max_sz);
+        mean_x_ = mean_y_ = 0.0;
+        m2_x_ = m2_y_ = c_xy_ = 0.0;
+    }
+
+    inline void add(uint64_t now, double x, double y)
+    {
+        Pair p;
+        p.x = x;
+        p.y = y;
+        window_.push(now, p);
+
+        auto const n  = double(window_.size());
+        auto const dx = x - mean_x_;
+        auto const dy = y - mean_y_;
+        mean_x_ += dx / n;
+        mean_y_ += dy / n;
+        m2_x_ += dx * (x - mean_x_);
+        m2_y_ += dy * (y - mean_y_);
+        c_xy_ += dx * (y - mean_y_);
+        touch(now);
+    }
+
+    inline void touch(uint64_t now)
+    {
+        detail::RollingWindow<Pair>::Entry e;
+        while (window_.expire(now, e))
+        {
+            remove(e.val.x, e.val.y);
+        }
+    }
+
+    size_t count() const { return window_.size(); }
+    double covariance() const { return window_.empty() ? NAN : c_xy_ / double(window_.size()); }
+    double correlation() const
+    {
+        auto const denom = std::sqrt(m2_x_ * m2_y_);
+        return window_.size() < 2 || denom <= 0.0 ? NAN : c_xy_ / denom;
+    }
+
+  private:
+    inline void remove(double x, double y)
+    {
+        auto const n = window_.size();
+        if (n == 0)
+        {
+            mean_x_ = mean_y_ = 0.0;
+            m2_x_ = m2_y_ = c_xy_ = 0.0;
+            return;
+        }
+        auto const dx = x - mean_x_;
+        auto const dy = y - mean_y_;
+        mean_x_ -= dx / double(n);
+        mean_y_ -= dy / double(n);
+        m2_x_ -= dx * (x - mean_x_);
+        m2_y_ -= dy * (y - mean_y_);
+        c_xy_ -= dx * (y - mean_y_);
+    }
+
+    detail::RollingWindow<Pair> window_;
+    double mean_x_{0.0};
+    double mean_y_{0.0};
+    double m2_x_{0.0};
+    double m2_y_{0.0};
+    double c_xy_{0.0};
+};
+
+/*
+ * rolling vwap, the running (price * qty, qty) pair is exactly what
+ * Queue's state_sum maintains
+ */
+class RollingVwap
+{
+  public:
+    void init(uint64_t win_sz_nanos) { notional_.init(win_sz_nanos); }
+
+    inline void add(uint64_t now, double price, double qty)
+    {
+        notional_.add(now, tf_item<double, double>(price * qty, qty));
+    }
+    inline void touch(uint64_t now) { notional_.touch(now); }
+
+    double volume() const { return notional_.sum().second; }
+    double vwap() const
+    {
+        auto const s = notional_.sum();
+        return s.second > 0.0 ? s.first / s.second : NAN;
+    }
+
+  private:
+    Queue<tf_item<double, double>> notional_;
+};
+
+/*
+ * exponential moving average decaying with elapsed time rather than sample
+ * count, half_life_nanos is the time for an old sample's weight to halve
+ */
+class Ewma
+{
+  public:
+    void init(uint64_t half_life_nanos)
+    {
+        inv_tau_ = std::log(2.0) / double(half_life_nanos);
+        value_   = NAN;
+        last_    = 0;
+    }
+
+    inline void add(uint64_t now, double val)
+    {
+        if (std::isnan(value_))
+        {
+            value_ = val;
+        }
+        else
+        {
+            auto const dt    = now > last_ ? double(now - last_) : 0.0;
+            auto const alpha = 1.0 - std::exp(-dt * inv_tau_);
+            value_ += alpha * (val - value_);
+        }
+        last_ = now;
+    }
+
+    double value() const { return value_; }
+    bool is_valid() const { return !std::isnan(value_); }
+
+  private:
+    double inv_tau_{0.0};
+    double value_{NAN};
+    uint64_t last_{0};
+};
+
+} // namespace utils
+} // namespace miye
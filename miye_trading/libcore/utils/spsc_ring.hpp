@@ -0,0 +1,83 @@
+#pragma once
+#include "libcore/essential/platform_defs.hpp"
+
+#include <array>
+#include <atomic>
+#include <stddef.h>
+
+// bounded single producer single consumer queue
+namespace miye
+{
+namespace utils
+{
+
+/*
+ * one thread pushes, one other thread reads in place and pops. Each side
+ * keeps a copy of the other's index so it only touches the shared cache
+ * line when the ring looks full or empty.
+ */
+template <typename T, size_t Capacity>
+class spsc_ring
+{
+    static_assert(Capacity && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+  public:
+    spsc_ring() = default;
+    spsc_ring(const spsc_ring&) = delete;
+    spsc_ring& operator=(const spsc_ring&) = delete;
+
+    // producer, false when full
+    bool try_push(const T& item) noexcept
+    {
+        auto const tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ == Capacity)
+        {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ == Capacity)
+            {
+                return false;
+            }
+        }
+        items_[tail & (Capacity - 1)] = item;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer, the oldest item or nullptr when empty, valid until pop()
+    const T* front() noexcept
+    {
+        auto const head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_)
+        {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_)
+            {
+                return nullptr;
+            }
+        }
+        return &items_[head & (Capacity - 1)];
+    }
+
+    // consumer, after front() returned an item
+    void pop() noexcept { head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    bool empty() const noexcept
+    {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+    size_t size() const noexcept
+    {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+    static constexpr size_t capacity() noexcept { return Capacity; }
+
+  private:
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_{0};
+    size_t cached_tail_{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_{0};
+    size_t cached_head_{0};
+    alignas(CACHE_LINE_SIZE) std::array<T, Capacity> items_{};
+};
+
+} // namespace utils
+} // namespace miye
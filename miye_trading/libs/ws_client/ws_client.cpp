@@ -78,6 +78,14 @@ void WSClient::subscribe_ticker(std::string symbol)
     subscriptions.push_back(std::make_pair(symbol, "ticker"));
 }
 
+void WSClient::resubscribe_orderbook(std::string symbol)
+{
+    ws.send(
+        {{"op", "unsubscribe"}, {"channel", "orderbook"}, {"market", symbol}});
+    ws.send(
+        {{"op", "subscribe"}, {"channel", "orderbook"}, {"market", symbol}});
+}
+
 void WSClient::ping() { ws.ping(); }
 
 void WSClient::pong() { ws.pong(); }
@@ -50,6 +50,9 @@ class WSClient
     void subscribe_trades(std::string symbol);
     void subscribe_ticker(std::string symbol);
 
+    // on a live connection, unsubscribe and subscribe again for a fresh partial
+    void resubscribe_orderbook(std::string symbol);
+
     void setLogger(logger::Logger* logger)
     {
         this->logger_ = logger;
@@ -1,4 +1,5 @@
 #include "../ws_util/WS.h"
+#include "libcore/time/span_tracer.hpp"
 
 namespace miye
 {
@@ -25,7 +26,9 @@ WS::WS()
 
     wsclient.set_message_handler(
         [this](websocketpp::connection_hdl, WSClient::message_ptr msg) {
+            SPAN_BEGIN(time::profiler_trigger::md_ws_receive, 0);
             json j = json::parse(msg->get_raw_payload().c_str());
+            SPAN_STAMP(time::profiler_trigger::md_msg_parsed, 0);
             on_message_cb(j);
         });
 
@@ -108,6 +111,12 @@ void WS::pong()
     wsclient.pong(connection, "pong");
 }
 
+void WS::send(const json& msg)
+{
+    logger()->info("sending to uri:{} msg:{}", uri, msg);
+    wsclient.send(connection, msg.dump(), websocketpp::frame::opcode::text);
+}
+
 void WS::poll() { wsclient.poll(); }
 
 } // namespace ws_util
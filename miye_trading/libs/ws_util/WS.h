@@ -30,6 +30,7 @@ class WS
     void poll();
     void pong();
     void ping();
+    void send(const json& msg);
 
     void setLogger(logger::Logger* logger) { logger_ = logger; }
 
@@ -1,5 +1,4 @@
 #pragma once
-#include "libcore/math/math_utils.hpp"
 #include "libcore/types/types.hpp"
 #include "spdlog/common.h"
 
@@ -12,17 +11,17 @@ namespace trading
 
 struct BBO
 {
-    price_t bidPx{};
-    price_t askPx{};
-    quantity_t bidQty{};
-    quantity_t askQty{};
+    Price bidPx{};
+    Price askPx{};
+    Qty bidQty{};
+    Qty askQty{};
 
     BBO() = default;
     double mid() const noexcept
     {
         if (isValid())
         {
-            return (bidPx + askPx) / 2;
+            return (bidPx.toDouble() + askPx.toDouble()) / 2;
         }
         return NAN;
     }
@@ -31,23 +30,25 @@ struct BBO
     {
         if (isValid())
         {
-            return (bidPx * askQty + askPx * bidQty) / (bidQty + askQty);
+            auto const bidQ = bidQty.toDouble();
+            auto const askQ = askQty.toDouble();
+            return (bidPx.toDouble() * askQ + askPx.toDouble() * bidQ) / (bidQ + askQ);
         }
         return NAN;
     }
 
     bool isLocked() const
     {
-        return math::floatEqual(bidPx, askPx);
+        return bidPx == askPx;
     }
     bool isCrossed() const
     {
-        return math::lessEqual(askPx, bidPx);
+        return askPx < bidPx;
     }
     bool isValid() const
     {
-        return bidQty > 0 && askQty > 0 && !std::isnan(bidPx) &&
-               !std::isnan(askPx) && !isCrossedOrLocked();
+        return bidQty > Qty{} && askQty > Qty{} && bidPx.isValid() &&
+               askPx.isValid() && !isCrossedOrLocked();
     }
     std::string toString() const
     {
@@ -63,7 +64,7 @@ struct BBO
     // boook is crossed when bidPx > askPx
     bool isCrossedOrLocked() const
     {
-        return math::lessEqual(askPx, bidPx);
+        return askPx <= bidPx;
     }
 };
 
@@ -90,10 +91,10 @@ struct fmt_lib::formatter<miye::trading::BBO> : fmt_lib::formatter<std::string>
         return fmt_lib::format_to(ctx.out(),
                                   "bbo bidPx={} bidQty={} askPx={} asxQty={} "
                                   "mikd={} smid={} is_valid={}",
-                                  bbo.bidPx,
-                                  bbo.bidQty,
-                                  bbo.askPx,
-                                  bbo.askQty,
+                                  bbo.bidPx.toDouble(),
+                                  bbo.bidQty.toDouble(),
+                                  bbo.askPx.toDouble(),
+                                  bbo.askQty.toDouble(),
                                   bbo.mid(),
                                   bbo.smid(),
                                   bbo.isValid());
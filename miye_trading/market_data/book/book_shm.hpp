@@ -0,0 +1,468 @@
+#pragma once
+#include "bbo.h"
+#include "book_side.hpp"
+#include "exchange.h"
+#include "libcore/essential/platform_defs.hpp"
+#include "order_book.h"
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <fcntl.h>
+#include <immintrin.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace miye
+{
+namespace trading
+{
+
+/*
+ * Books of one book server shared with the strategy processes on the box.
+ *
+ * [BookShmHeader][symbols][BookShmSlot per cid][BookShmEvent ring]
+ *
+ * Every book is a seqlock: the server makes seq odd, writes the top
+ * Depth levels, bbo and last trade, then makes it even again. A reader
+ * copies the slot and keeps the copy when seq was even and unchanged over
+ * the copy, it never blocks the server.
+ *
+ * The event ring tells readers which cid changed and carries trades, each
+ * reader follows it with its own cursor. A reader that falls a whole ring
+ * behind loses the events but not the books, the slots always hold the
+ * latest state.
+ */
+
+const constexpr uint64_t BookShmMagic{0x6d6873736b6f6f62}; // "booksshm"
+const constexpr uint32_t BookShmVersion{1};
+const constexpr size_t BookShmSymbolLen{32};
+const constexpr size_t BookShmDefaultDepth{10};
+// pauses a reader waits on a slot held mid-write, a server that died there never releases it
+const constexpr uint32_t BookShmMaxSnapshotSpins{1u << 16};
+
+enum class BookShmEventType : uint8_t
+{
+    BOOK_CHANGE = 0,
+    SNAPSHOT_FINISHED,
+    TRADE,
+    TICK
+};
+
+struct alignas(CACHE_LINE_SIZE) BookShmHeader
+{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t depth;
+    uint32_t symbolNum;
+    uint32_t ringSize; // power of two
+    uint64_t slotSize;
+    uint64_t eventSize;
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> ringHead; // next event to be written
+};
+
+template <size_t Depth>
+struct BookShmSnapshot
+{
+    uint64_t timestamp{}; // server clock at the update
+    uint64_t updates{};
+    int32_t cid{INVALID_CID};
+    uint32_t bidLevels{};
+    uint32_t askLevels{};
+    BBO bbo{};
+    std::array<PriceLevel<Price>, Depth> bids{}; // best first
+    std::array<PriceLevel<Price>, Depth> asks{};
+    uint64_t lastTradeTimestamp{};
+    uint64_t lastTradeId{};
+    Side lastTradeSide{Side::UNKNOWN};
+    Price lastTradePrice{};
+    Qty lastTradeQty{};
+
+    const PriceLevel<Price>& getLevel(Side side, int32_t idx) const
+    {
+        assert(idx < int32_t(Depth));
+        return side == Side::BUY ? bids[idx] : asks[idx];
+    }
+    uint32_t getLevelCount(Side side) const { return side == Side::BUY ? bidLevels : askLevels; }
+    const BBO& getBBO() const { return bbo; }
+};
+
+template <size_t Depth>
+struct alignas(CACHE_LINE_SIZE) BookShmSlot
+{
+    std::atomic<uint64_t> seq;
+    BookShmSnapshot<Depth> book;
+};
+
+struct alignas(CACHE_LINE_SIZE) BookShmEvent
+{
+    std::atomic<uint64_t> pos; // ring position of the event, InvalidPos while it is written
+    uint64_t timestamp;
+    uint64_t tradeId;
+    Price price;
+    Qty qty;
+    int32_t cid;
+    BookShmEventType type;
+    Side side;
+    bool isDone;
+
+    static const constexpr uint64_t InvalidPos{~0ULL};
+};
+
+template <size_t Depth>
+struct BookShmLayout
+{
+    static size_t symbolsOffset() { return sizeof(BookShmHeader); }
+    static size_t slotsOffset(uint32_t symbolNum)
+    {
+        return ROUND_UP(symbolsOffset() + symbolNum * BookShmSymbolLen, CACHE_LINE_SIZE);
+    }
+    static size_t ringOffset(uint32_t symbolNum)
+    {
+        return slotsOffset(symbolNum) + symbolNum * sizeof(BookShmSlot<Depth>);
+    }
+    static size_t size(uint32_t symbolNum, uint32_t ringSize)
+    {
+        return ringOffset(symbolNum) + ringSize * sizeof(BookShmEvent);
+    }
+};
+
+/*
+ * server side, the only writer of a region
+ */
+template <size_t Depth = BookShmDefaultDepth>
+class BookShmWriter
+{
+    using Layout = BookShmLayout<Depth>;
+
+  public:
+    BookShmWriter() = default;
+    BookShmWriter(const BookShmWriter&) = delete;
+    BookShmWriter& operator=(const BookShmWriter&) = delete;
+    ~BookShmWriter() { close(); }
+
+    int32_t create(const std::string& name, const std::vector<symbol_t>& symbols, uint32_t ringSize)
+    {
+        if (ringSize == 0 || (ringSize & (ringSize - 1)) != 0)
+        {
+            std::cout << "ERROR book shm ring size must be a power of two:" << ringSize << std::endl;
+            return -1;
+        }
+        auto const symbolNum = uint32_t(symbols.size());
+        size_                = Layout::size(symbolNum, ringSize);
+
+        // a fresh region, readers of a previous server keep their old mapping
+        ::shm_unlink(name.c_str());
+        auto const fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0)
+        {
+            std::cout << "ERROR shm_open " << name << " failed:" << strerror(errno) << std::endl;
+            return -1;
+        }
+        if (::ftruncate(fd, size_) != 0)
+        {
+            std::cout << "ERROR ftruncate " << name << " failed:" << strerror(errno) << std::endl;
+            ::close(fd);
+            return -1;
+        }
+        auto* base = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (base == MAP_FAILED)
+        {
+            std::cout << "ERROR mmap " << name << " failed:" << strerror(errno) << std::endl;
+            return -1;
+        }
+        base_  = static_cast<char*>(base);
+        name_  = name;
+        mask_  = ringSize - 1;
+        slots_ = reinterpret_cast<BookShmSlot<Depth>*>(base_ + Layout::slotsOffset(symbolNum));
+        ring_  = reinterpret_cast<BookShmEvent*>(base_ + Layout::ringOffset(symbolNum));
+
+        header_            = reinterpret_cast<BookShmHeader*>(base_);
+        header_->version   = BookShmVersion;
+        header_->depth     = Depth;
+        header_->symbolNum = symbolNum;
+        header_->ringSize  = ringSize;
+        header_->slotSize  = sizeof(BookShmSlot<Depth>);
+        header_->eventSize = sizeof(BookShmEvent);
+        header_->ringHead.store(0, std::memory_order_relaxed);
+        for (uint32_t cid = 0; cid < symbolNum; ++cid)
+        {
+            strncpy(base_ + Layout::symbolsOffset() + cid * BookShmSymbolLen, symbols[cid].c_str(),
+                    BookShmSymbolLen - 1);
+            slots_[cid].book.cid = cid;
+        }
+        for (uint32_t i = 0; i < ringSize; ++i)
+        {
+            ring_[i].pos.store(BookShmEvent::InvalidPos, std::memory_order_relaxed);
+        }
+        // readers attach once the magic is there
+        std::atomic_thread_fence(std::memory_order_release);
+        reinterpret_cast<std::atomic<uint64_t>*>(&header_->magic)->store(BookShmMagic, std::memory_order_release);
+        return 0;
+    }
+
+    void close()
+    {
+        if (base_)
+        {
+            ::munmap(base_, size_);
+            ::shm_unlink(name_.c_str());
+            base_ = nullptr;
+        }
+    }
+
+    void publishBook(int32_t cid, const OrderBook& book, uint64_t timestamp)
+    {
+        auto& slot     = slots_[cid];
+        auto& snap     = slot.book;
+        auto const seq = beginWrite(slot);
+
+        snap.timestamp = timestamp;
+        ++snap.updates;
+        snap.bbo       = book.getBBO();
+        snap.bidLevels = copySide(book, Side::BUY, snap.bids);
+        snap.askLevels = copySide(book, Side::SELL, snap.asks);
+
+        endWrite(slot, seq);
+    }
+
+    void publishTrade(int32_t cid, uint64_t timestamp, uint64_t tradeId, Side side, Price price, Qty qty)
+    {
+        auto& slot     = slots_[cid];
+        auto& snap     = slot.book;
+        auto const seq = beginWrite(slot);
+
+        snap.lastTradeTimestamp = timestamp;
+        snap.lastTradeId        = tradeId;
+        snap.lastTradeSide      = side;
+        snap.lastTradePrice     = price;
+        snap.lastTradeQty       = qty;
+
+        endWrite(slot, seq);
+    }
+
+    void notify(BookShmEventType type, int32_t cid, uint64_t timestamp = 0, uint64_t tradeId = 0,
+                Side side = Side::UNKNOWN, Price price = Price{}, Qty qty = Qty{}, bool isDone = true)
+    {
+        auto const pos = head_++;
+        auto& event    = ring_[pos & mask_];
+        event.pos.store(BookShmEvent::InvalidPos, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        event.timestamp = timestamp;
+        event.tradeId   = tradeId;
+        event.price     = price;
+        event.qty       = qty;
+        event.cid       = cid;
+        event.type      = type;
+        event.side      = side;
+        event.isDone    = isDone;
+        event.pos.store(pos, std::memory_order_release);
+        header_->ringHead.store(head_, std::memory_order_release);
+    }
+
+  private:
+    uint64_t beginWrite(BookShmSlot<Depth>& slot)
+    {
+        auto const seq = slot.seq.load(std::memory_order_relaxed);
+        slot.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        return seq;
+    }
+
+    void endWrite(BookShmSlot<Depth>& slot, uint64_t seq) { slot.seq.store(seq + 2, std::memory_order_release); }
+
+    static uint32_t copySide(const OrderBook& book, Side side, std::array<PriceLevel<Price>, Depth>& levels)
+    {
+        auto const count = std::min(book.getLevelCount(side), Depth);
+        for (size_t i = 0; i < count; ++i)
+        {
+            levels[i] = book.getLevel(side, i);
+        }
+        for (size_t i = count; i < Depth; ++i)
+        {
+            levels[i] = PriceLevel<Price>{};
+        }
+        return count;
+    }
+
+  private:
+    std::string name_;
+    char* base_{nullptr};
+    size_t size_{0};
+    BookShmHeader* header_{nullptr};
+    BookShmSlot<Depth>* slots_{nullptr};
+    BookShmEvent* ring_{nullptr};
+    uint64_t mask_{0};
+    uint64_t head_{0};
+};
+
+/*
+ * strategy side, any number of readers attach to one region read only
+ */
+template <size_t Depth = BookShmDefaultDepth>
+class BookShmReader
+{
+    using Layout = BookShmLayout<Depth>;
+
+  public:
+    BookShmReader() = default;
+    BookShmReader(const BookShmReader&) = delete;
+    BookShmReader& operator=(const BookShmReader&) = delete;
+    ~BookShmReader()
+    {
+        if (base_)
+        {
+            ::munmap(base_, size_);
+        }
+    }
+
+    int32_t attach(const std::string& name)
+    {
+        auto const fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0)
+        {
+            std::cout << "ERROR shm_open " << name << " failed:" << strerror(errno) << std::endl;
+            return -1;
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(BookShmHeader))
+        {
+            std::cout << "ERROR book shm " << name << " is not initialised" << std::endl;
+            ::close(fd);
+            return -1;
+        }
+        size_      = st.st_size;
+        auto* base = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (base == MAP_FAILED)
+        {
+            std::cout << "ERROR mmap " << name << " failed:" << strerror(errno) << std::endl;
+            return -1;
+        }
+        base_   = static_cast<char*>(base);
+        header_ = reinterpret_cast<const BookShmHeader*>(base_);
+
+        auto const magic =
+            reinterpret_cast<const std::atomic<uint64_t>*>(&header_->magic)->load(std::memory_order_acquire);
+        if (magic != BookShmMagic || header_->version != BookShmVersion || header_->depth != Depth ||
+            header_->slotSize != sizeof(BookShmSlot<Depth>) || header_->eventSize != sizeof(BookShmEvent) ||
+            size_ < Layout::size(header_->symbolNum, header_->ringSize))
+        {
+            std::cout << "ERROR book shm " << name << " layout mismatch, depth:" << header_->depth
+                      << " expected:" << Depth << std::endl;
+            return -1;
+        }
+
+        mask_  = header_->ringSize - 1;
+        slots_ = reinterpret_cast<const BookShmSlot<Depth>*>(base_ + Layout::slotsOffset(header_->symbolNum));
+        ring_  = reinterpret_cast<const BookShmEvent*>(base_ + Layout::ringOffset(header_->symbolNum));
+        for (uint32_t cid = 0; cid < header_->symbolNum; ++cid)
+        {
+            symbols_.emplace_back(base_ + Layout::symbolsOffset() + cid * BookShmSymbolLen);
+        }
+        cursor_ = header_->ringHead.load(std::memory_order_acquire);
+        return 0;
+    }
+
+    /*
+     * consistent copy of a book, false until the server has published it
+     * or when the slot stays mid-write for BookShmMaxSnapshotSpins
+     */
+    bool snapshot(int32_t cid, BookShmSnapshot<Depth>& out) const
+    {
+        auto const& slot = slots_[cid];
+        for (uint32_t spins = 0; spins < BookShmMaxSnapshotSpins; ++spins)
+        {
+            auto const before = slot.seq.load(std::memory_order_acquire);
+            if (before & 1)
+            {
+                _mm_pause();
+                continue;
+            }
+            memcpy(&out, &slot.book, sizeof(out));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) == before)
+            {
+                return before != 0;
+            }
+        }
+        return false;
+    }
+
+    // empty BBO when no consistent snapshot could be taken
+    BBO getBBO(int32_t cid) const
+    {
+        BookShmSnapshot<Depth> snap;
+        if (!snapshot(cid, snap))
+        {
+            return BBO{};
+        }
+        return snap.bbo;
+    }
+
+    bool isPublished(int32_t cid) const { return slots_[cid].seq.load(std::memory_order_acquire) != 0; }
+
+    /*
+     * next event for this reader, false when there is none. lapped is set
+     * when the server has overwritten events this reader had not seen, the
+     * cursor then jumps to the oldest event still in the ring
+     */
+    bool next(BookShmEvent& out, bool& lapped)
+    {
+        lapped          = false;
+        auto const head = header_->ringHead.load(std::memory_order_acquire);
+        if (cursor_ == head)
+        {
+            return false;
+        }
+        if (head - cursor_ > header_->ringSize)
+        {
+            lapped  = true;
+            cursor_ = head - header_->ringSize;
+            return false;
+        }
+
+        auto const& event = ring_[cursor_ & mask_];
+        auto const pos    = event.pos.load(std::memory_order_acquire);
+        out.timestamp     = event.timestamp;
+        out.tradeId       = event.tradeId;
+        out.price         = event.price;
+        out.qty           = event.qty;
+        out.cid           = event.cid;
+        out.type          = event.type;
+        out.side          = event.side;
+        out.isDone        = event.isDone;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (pos != cursor_ || event.pos.load(std::memory_order_relaxed) != pos)
+        {
+            // overwritten under us, start again from the oldest event left
+            lapped  = true;
+            cursor_ = std::max(cursor_ + 1, header_->ringHead.load(std::memory_order_acquire) - header_->ringSize);
+            return false;
+        }
+        ++cursor_;
+        return true;
+    }
+
+    const std::vector<symbol_t>& getSymbols() const { return symbols_; }
+    size_t getSymbolNum() const { return symbols_.size(); }
+
+  private:
+    char* base_{nullptr};
+    size_t size_{0};
+    const BookShmHeader* header_{nullptr};
+    const BookShmSlot<Depth>* slots_{nullptr};
+    const BookShmEvent* ring_{nullptr};
+    uint64_t mask_{0};
+    uint64_t cursor_{0};
+    std::vector<symbol_t> symbols_;
+};
+
+} // namespace trading
+} // namespace miye
@@ -1,8 +1,8 @@
 #pragma once
-#include "libcore/math/math_utils.hpp"
 #include "libcore/types/types.hpp"
 
 #include <algorithm>
+#include <cassert>
 #include <functional>
 
 namespace miye
@@ -26,12 +26,12 @@ namespace trading
 //    SHORT_SELL
 //};
 
-template <typename Price = price_t>
+template <typename Price = ::miye::Price>
 struct PriceLevel
 {
 
     PriceLevel() = default;
-    PriceLevel(Price price, quantity_t quantity)
+    PriceLevel(Price price, Qty quantity)
         : price_(price), quantity_(quantity)
     {
     }
@@ -46,11 +46,11 @@ struct PriceLevel
         price_ = price;
     }
 
-    quantity_t getQuantity() const noexcept
+    Qty getQuantity() const noexcept
     {
         return quantity_;
     }
-    void setQuantity(quantity_t quantity) noexcept
+    void setQuantity(Qty quantity) noexcept
     {
         quantity_ = quantity;
     }
@@ -59,12 +59,12 @@ struct PriceLevel
                            const PriceLevel<Price>& rhs)
     {
         return lhs.getQuantity() == rhs.getQuantity() &&
-               math::floatEqual(lhs.getPrice(), rhs.getPrice());
+               lhs.getPrice() == rhs.getPrice();
     }
 
     bool isValid() const
     {
-        return !std::isnan(quantity_) && !std::isnan(price_) && quantity_ > 0.0;
+        return quantity_.isValid() && price_.isValid() && quantity_ > Qty{};
     }
 
     template <typename OS>
@@ -76,17 +76,17 @@ struct PriceLevel
 
   private:
     Price price_{};
-    quantity_t quantity_{};
+    Qty quantity_{};
 };
 
 /*
  * use vector to quickly build orderbook, improve the performance later
  */
-template <typename Price = price_t>
+template <typename Price = ::miye::Price>
 class BookSide
 {
   public:
-    size_t getLevels() noexcept
+    size_t getLevels() const noexcept
     {
         return levels_.size();
     }
@@ -107,25 +107,27 @@ class BookSide
         return levels_[lvlNum - lvlIdx - 1];
     }
 
-    void removeLevel(Price price)
+    /*
+     * searches from the top of the book, where most changes land. A diff
+     * stream deletes levels it never sent us, logMissing=false keeps quiet
+     * about those
+     */
+    bool removeLevel(Price price, bool logMissing = true)
     {
+        auto it = std::find_if(levels_.rbegin(), levels_.rend(), [price](const PriceLevel<Price>& lvl) {
+            return lvl.getPrice() == price;
+        });
 
-        auto it =
-            std::find_if(levels_.begin(),
-                         levels_.end(),
-                         [price](const PriceLevel<Price>& lvl) {
-                             return math::floatEqual(lvl.getPrice(), price);
-                         });
-
-        if (it == levels_.end())
+        if (it == levels_.rend())
         {
-            std::cout << "remove level:" << price
-                      << " found:" << (it != levels_.end()) << std::endl;
-        }
-        if (it != levels_.end())
-        {
-            levels_.erase(it);
+            if (logMissing)
+            {
+                std::cout << "remove level:" << price << " found:0" << std::endl;
+            }
+            return false;
         }
+        levels_.erase(std::next(it).base());
+        return true;
     }
 
     //    void setOrInsertBidLevel(Price price, quantity_t quantity)
@@ -159,7 +161,7 @@ class BookSide
     //        // std::cout << "bookside:" << toString() << std::endl;
     //    }
 
-    void setOrInsertLevel(Price price, quantity_t quantity)
+    void setOrInsertLevel(Price price, Qty quantity)
     {
         if (levels_.empty() || op_(price, levels_.back().getPrice()))
         {
@@ -189,12 +191,22 @@ class BookSide
         // std::cout << "bookside:" << toString() << std::endl;
     }
 
-    void setLevel(int32_t idx, Price price, quantity_t quantity)
+    void setLevel(int32_t idx, Price price, Qty quantity)
     {
         assert(idx < levels_.size());
         levels_[idx] = PriceLevel<Price>{price, quantity};
     }
 
+    // replaces the side with count levels, best first
+    void setLevels(const PriceLevel<Price>* levels, size_t count)
+    {
+        levels_.resize(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            levels_[count - i - 1] = levels[i];
+        }
+    }
+
     bool isValid() const
     {
         if (levels_.empty())
@@ -248,7 +260,7 @@ class BookSide
         for (int32_t i = levels_.size() - 1; i >= 0; --i)
         {
             auto const& lvl = levels_[i];
-            ss << std::fixed << lvl.getPrice() << '@' << lvl.getQuantity()
+            ss << lvl.getPrice() << '@' << lvl.getQuantity()
                << '\n';
         }
         return ss.str();
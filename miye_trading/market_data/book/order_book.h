@@ -1,7 +1,6 @@
 #pragma once
 #include "bbo.h"
 #include "book_side.hpp"
-#include "libcore/math/math_utils.hpp"
 #include "libcore/types/types.hpp"
 
 #include <algorithm>
@@ -21,13 +20,13 @@ class OrderBook
     {
         std::cout << "orderbook set op for bid/ask" << std::endl;
         auto& bidSide = sides_[to_underlying(Side::BUY)];
-        bidSide.setPriceOp(std::greater<price_t>());
+        bidSide.setPriceOp(std::greater<Price>());
         auto& askSide = sides_[to_underlying(Side::SELL)];
-        askSide.setPriceOp(std::less<price_t>());
+        askSide.setPriceOp(std::less<Price>());
     }
 
   public:
-    void setOrInsertLevel(Side side, price_t price, quantity_t quantity)
+    void setOrInsertLevel(Side side, Price price, Qty quantity)
     {
         auto& bookSide = sides_[to_underlying(side)];
         bookSide.setOrInsertLevel(price, quantity);
@@ -44,25 +43,37 @@ class OrderBook
         //        }
     }
 
-    void removeLevel(Side side, price_t price)
+    bool removeLevel(Side side, Price price, bool logMissing = true)
     {
         auto& bookSide = sides_[to_underlying(side)];
-        bookSide.removeLevel(price);
+        return bookSide.removeLevel(price, logMissing);
     }
 
-    void setLevel(Side side, int32_t idx, price_t price, quantity_t quantity)
+    void setLevel(Side side, int32_t idx, Price price, Qty quantity)
     {
         auto& bookSide = sides_[to_underlying(side)];
         bookSide.setLevel(idx, price, quantity);
     }
 
-    const PriceLevel<price_t>& getLevel(Side side, int32_t idx) const
+    void setLevels(Side side, const PriceLevel<Price>* levels, size_t count)
+    {
+        auto& bookSide = sides_[to_underlying(side)];
+        bookSide.setLevels(levels, count);
+    }
+
+    const PriceLevel<Price>& getLevel(Side side, int32_t idx) const
     {
         // assert(idx < bookDepth_);
         auto& bookSide = sides_[to_underlying(side)];
         return bookSide.getLevel(idx);
     }
 
+    size_t getLevelCount(Side side) const
+    {
+        auto& bookSide = sides_[to_underlying(side)];
+        return bookSide.getLevels();
+    }
+
     //    void clearSide(Side side)
     //    {
     //        auto& bookSide = sides_[to_underlying(side)];
@@ -98,7 +109,7 @@ class OrderBook
     }
 
     void setLastTrade(uint64_t timestamp, uint64_t id, const trade_t& trade) { this->lastTrade_ = trade; }
-    void setLastTrade(uint64_t timestamp, uint64_t id, Side side, price_t price, quantity_t qty)
+    void setLastTrade(uint64_t timestamp, uint64_t id, Side side, Price price, Qty qty)
     {
         this->lastTradeTimestamp_ = timestamp;
         this->tradeId_            = id;
@@ -139,7 +150,7 @@ class OrderBook
     }
 
   private:
-    std::array<BookSide<price_t>, 2> sides_;
+    std::array<BookSide<Price>, 2> sides_;
     trade_t lastTrade_{};
     uint64_t tradeId_{};
     uint64_t lastTradeTimestamp_{};
@@ -174,26 +185,26 @@ struct fmt_lib::formatter<miye::trading::OrderBook> : fmt_lib::formatter<std::st
                                   "{:0.2f}@{:0.4f},{:0.2f}@{:0.4f},{:0.2f}@{:0.4f},{:0.2f}@{:0.4f},{:"
                                   "0.2f}@{:0.4f},{:0.2f}@{:0.4f},{:0.2f}@{:0.4f},{:0.2f}@{:0.4f},{:0."
                                   "2f}@{:0.4f},{:0.2f}@{:0.4f},{}",
-                                  bid_lvl_0.getQuantity(),
-                                  bid_lvl_0.getPrice(),
-                                  bid_lvl_1.getQuantity(),
-                                  bid_lvl_1.getPrice(),
-                                  bid_lvl_2.getQuantity(),
-                                  bid_lvl_2.getPrice(),
-                                  bid_lvl_3.getQuantity(),
-                                  bid_lvl_3.getPrice(),
-                                  bid_lvl_4.getQuantity(),
-                                  bid_lvl_4.getPrice(),
-                                  ask_lvl_0.getQuantity(),
-                                  ask_lvl_0.getPrice(),
-                                  ask_lvl_1.getQuantity(),
-                                  ask_lvl_1.getPrice(),
-                                  ask_lvl_2.getQuantity(),
-                                  ask_lvl_2.getPrice(),
-                                  ask_lvl_3.getQuantity(),
-                                  ask_lvl_3.getPrice(),
-                                  ask_lvl_4.getQuantity(),
-                                  ask_lvl_4.getPrice(),
+                                  bid_lvl_0.getQuantity().toDouble(),
+                                  bid_lvl_0.getPrice().toDouble(),
+                                  bid_lvl_1.getQuantity().toDouble(),
+                                  bid_lvl_1.getPrice().toDouble(),
+                                  bid_lvl_2.getQuantity().toDouble(),
+                                  bid_lvl_2.getPrice().toDouble(),
+                                  bid_lvl_3.getQuantity().toDouble(),
+                                  bid_lvl_3.getPrice().toDouble(),
+                                  bid_lvl_4.getQuantity().toDouble(),
+                                  bid_lvl_4.getPrice().toDouble(),
+                                  ask_lvl_0.getQuantity().toDouble(),
+                                  ask_lvl_0.getPrice().toDouble(),
+                                  ask_lvl_1.getQuantity().toDouble(),
+                                  ask_lvl_1.getPrice().toDouble(),
+                                  ask_lvl_2.getQuantity().toDouble(),
+                                  ask_lvl_2.getPrice().toDouble(),
+                                  ask_lvl_3.getQuantity().toDouble(),
+                                  ask_lvl_3.getPrice().toDouble(),
+                                  ask_lvl_4.getQuantity().toDouble(),
+                                  ask_lvl_4.getPrice().toDouble(),
                                   book.isValid());
     }
 };
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "libs/inifile/inicpp.h"
+#include "libs/logger/logger.hpp"
+#include "market_data/book/book_shm.hpp"
+#include "trading/md_listener.h"
+
+#include <iostream>
+#include <stdint.h>
+
+namespace miye
+{
+namespace trading
+{
+
+/*
+ * Stands in for MarketMain in a strategy process: the books come from a
+ * BookServer through shared memory and poll() drives the same MDListener
+ * callbacks. Books are read with snapshot()/getBBO() by cid, the cids are
+ * the server's, in the order of its [global] symbol_list.
+ *
+ * [book_client]
+ * shm_name = /miye_books
+ */
+template <size_t Depth = BookShmDefaultDepth>
+struct BookClient
+{
+    using Snapshot_t = BookShmSnapshot<Depth>;
+
+    int32_t poll()
+    {
+        if (!started_)
+        {
+            // books already live on the server look like fresh snapshots to a new client
+            started_ = true;
+            for (int32_t cid = 0; cid < int32_t(reader_.getSymbolNum()); ++cid)
+            {
+                if (reader_.isPublished(cid))
+                {
+                    mdListener_->onSnapshotFinished(cid);
+                }
+            }
+        }
+
+        BookShmEvent event;
+        bool lapped;
+        while (reader_.next(event, lapped) || lapped)
+        {
+            if (lapped)
+            {
+                onLapped();
+                continue;
+            }
+            dispatch(event);
+        }
+        return 0;
+    }
+
+    logger::Logger* createLogger(std::string logFile)
+    {
+        std::cout << "log path:" << logFile << std::endl;
+        logger_ = logger::createLogger(logFile);
+        logger_->info("logger path:{}", logFile);
+        return logger_.get();
+    }
+
+    // createLogger first, the client logs through it
+    int32_t init(std::string configFile, MDListener* mdListener)
+    {
+        if (!logger_)
+        {
+            std::cout << "ERROR book client has no logger, call createLogger before init" << std::endl;
+            return -1;
+        }
+        auto iniFile       = ini::IniFile(configFile);
+        auto const shmName = iniFile["book_client"]["shm_name"].as<std::string>();
+        if (reader_.attach(shmName) != 0)
+        {
+            logger()->critical("failed to attach to book shm {}", shmName);
+            return -1;
+        }
+        mdListener_ = mdListener;
+        logger()->info("attached to book shm {} books:{}", shmName, reader_.getSymbolNum());
+        return 0;
+    }
+
+    bool snapshot(int32_t cid, Snapshot_t& out) const { return reader_.snapshot(cid, out); }
+    BBO getBBO(int32_t cid) const { return reader_.getBBO(cid); }
+
+    std::vector<std::string> getSymbols() const { return reader_.getSymbols(); }
+    uint64_t getLappedCount() const { return lapped_; }
+
+    logger::Logger* logger() { return logger_.get(); }
+
+  private:
+    void dispatch(const BookShmEvent& event)
+    {
+        switch (event.type)
+        {
+        case BookShmEventType::BOOK_CHANGE:
+            mdListener_->onBookChange(event.cid);
+            break;
+        case BookShmEventType::SNAPSHOT_FINISHED:
+            mdListener_->onSnapshotFinished(event.cid);
+            break;
+        case BookShmEventType::TRADE:
+            mdListener_->onTrade(event.timestamp, event.cid, event.tradeId, event.side, event.price, event.qty,
+                                 event.isDone);
+            break;
+        case BookShmEventType::TICK:
+            mdListener_->onTick(event.cid);
+            break;
+        }
+    }
+
+    /*
+     * events were lost but the books are current, every book is reported
+     * changed once so the strategy reprices from them
+     */
+    void onLapped()
+    {
+        ++lapped_;
+        logger()->warn("book client fell behind the server, events lost, lapped:{}", lapped_);
+        for (int32_t cid = 0; cid < int32_t(reader_.getSymbolNum()); ++cid)
+        {
+            if (reader_.isPublished(cid))
+            {
+                mdListener_->onBookChange(cid);
+            }
+        }
+    }
+
+  private:
+    std::shared_ptr<logger::Logger> logger_;
+    BookShmReader<Depth> reader_;
+    MDListener* mdListener_{nullptr};
+    bool started_{false};
+    uint64_t lapped_{0};
+};
+
+} // namespace trading
+} // namespace miye
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "libcore/time/clock.hpp"
+#include "market_data/book/book_shm.hpp"
+#include "market_data/market_main.h"
+#include "trading/md_listener.h"
+
+#include <stdint.h>
+
+namespace miye
+{
+namespace trading
+{
+
+/*
+ * One process keeps the books through MarketMain and publishes them to
+ * BookShm, strategies attach with a BookClient instead of connecting
+ * their own websockets.
+ *
+ * [book_server]
+ * shm_name  = /miye_books
+ * ring_size = 65536
+ */
+template <size_t SYM_SIZE, size_t Depth = BookShmDefaultDepth>
+struct BookServer : public MDListener
+{
+    int32_t init(std::string configFile)
+    {
+        auto iniFile        = ini::IniFile(configFile);
+        auto const shmName  = iniFile["book_server"]["shm_name"].as<std::string>();
+        auto const ringSize = iniFile["book_server"]["ring_size"].as<uint32_t>();
+
+        if (marketMain.init(configFile, this) != 0)
+        {
+            return -1;
+        }
+        if (writer_.create(shmName, marketMain.getSymbols(), ringSize) != 0)
+        {
+            logger()->critical("failed to create book shm {}", shmName);
+            return -1;
+        }
+        logger()->info("publishing {} books to {} depth:{} ring:{}", marketMain.getSymbols().size(), shmName, Depth,
+                       ringSize);
+        return 0;
+    }
+
+    int32_t poll() { return marketMain.poll(); }
+
+    int32_t onSnapshotFinished(int32_t cid) override
+    {
+        auto const now = clock_.now();
+        writer_.publishBook(cid, marketMain.getBookStore().getBook(cid), now);
+        writer_.notify(BookShmEventType::SNAPSHOT_FINISHED, cid, now);
+        return 0;
+    }
+
+    int32_t onBookChange(int32_t cid) override
+    {
+        auto const now = clock_.now();
+        writer_.publishBook(cid, marketMain.getBookStore().getBook(cid), now);
+        writer_.notify(BookShmEventType::BOOK_CHANGE, cid, now);
+        return 0;
+    }
+
+    int32_t onTrade(uint64_t timestamp, int32_t cid, uint64_t tradeId, Side side, Price price, Qty qty,
+                    bool isDone) override
+    {
+        writer_.publishTrade(cid, timestamp, tradeId, side, price, qty);
+        writer_.notify(BookShmEventType::TRADE, cid, timestamp, tradeId, side, price, qty, isDone);
+        return 0;
+    }
+
+    int32_t onTick(int32_t cid) override
+    {
+        writer_.notify(BookShmEventType::TICK, cid, clock_.now());
+        return 0;
+    }
+
+    logger::Logger* logger() { return marketMain.logger(); }
+
+    MarketMain<SYM_SIZE> marketMain{};
+
+  private:
+    time::real_clock clock_;
+    BookShmWriter<Depth> writer_;
+};
+
+} // namespace trading
+} // namespace miye
@@ -1,6 +1,8 @@
 #pragma once
 #include "../../../trading/md_listener.h"
 #include "binance_raw_msg.h"
+#include "binance_rest.h"
+#include "libcore/time/span_tracer.hpp"
 #include "libcore/types/types.hpp"
 #include "libcore/utils/number_utils.hpp"
 #include "libcore/utils/string_utils.hpp"
@@ -8,7 +10,11 @@
 #include "libs/logger/logger.hpp"
 #include "market_data/book/exchange.h"
 #include "market_data/book/order_book.h"
+#include "market_data/md_thread.h"
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <vector>
 
 namespace miye
 {
@@ -17,16 +23,41 @@ namespace trading
 namespace binance
 {
 
+/*
+ * sequencing of one symbol's diff depth stream against its REST snapshot,
+ * see "How to manage a local order book correctly" in the futures docs
+ */
+struct DepthSync
+{
+    uint64_t lastUpdateId{0}; // of the snapshot
+    uint64_t prevU{0};        // u of the last applied event, the next one's pu
+    bool hasSnapshot{false};
+    bool synced{false};
+    bool fetching{false};
+    uint64_t nextFetchNs{0}; // no new fetch before, mdNowNs()
+    uint64_t resyncs{0};
+    uint64_t fetches{0};
+    uint64_t dropped{0}; // events already in the snapshot
+    std::vector<nlohmann::json> pending; // events waiting for a snapshot, oldest first
+};
+
 template <typename OrderBookStore>
 class BinanceMdProcessor
 {
   public:
-    using json = nlohmann::json;
+    using json            = nlohmann::json;
+    using SnapshotFetcher = DepthSnapshotLoader::Fetcher;
+
+    // a symbol fetches its snapshot again at most this often, by default
+    static const constexpr uint64_t SnapshotRetryNs{1'000'000'000};
+    // events held for a snapshot, past this they are thrown away
+    static const constexpr size_t MaxPendingEvents{10000};
 
     explicit BinanceMdProcessor(OrderBookStore& orderBookStore) : orderBookStore_(orderBookStore) {}
 
     void onMessageCB(const nlohmann::json& j);
     void onSnapshot(const json& j);
+    void onDepthDiff(const json& j, int32_t cid);
     //    void onBookChange(const json& j);
     void onAggTrade(const json& j);
     void onData(const json& j);
@@ -36,11 +67,40 @@ class BinanceMdProcessor
 
     void setLogger(logger::Logger* logger) { logger_ = logger; }
 
+    /*
+     * depthUpdate events are diffs from here on, books start from the
+     * fetcher's snapshots. The fetcher runs on a thread of its own, a
+     * symbol's events are held until its snapshot is back.
+     */
+    void setDiffDepth(SnapshotFetcher fetcher)
+    {
+        loader_ = std::make_unique<DepthSnapshotLoader>(std::move(fetcher));
+        depthSync_.resize(orderBookStore_.getSymbolNum());
+    }
+    void setSnapshotRetryNs(uint64_t retryNs) { snapshotRetryNs_ = retryNs; }
+    const DepthSync& getDepthSync(int32_t cid) const { return depthSync_[cid]; }
+
+    // applies the snapshots fetched since the last call and the events held for them
+    void pollSnapshots();
+
+  private:
+    bool applyDepthEvent(const json& j, int32_t cid);
+    void requestSnapshot(const std::string& symbol, int32_t cid);
+    int32_t loadDepthSnapshot(const std::string& symbol, int32_t cid, const std::string& body);
+    void applyDepthLevels(const json& jLevels, Side side, OrderBook& orderBook);
+    int32_t parseDepthLevels(const json& jLevels, std::vector<PriceLevel<Price>>& levels);
+
   private:
     logger::Logger* logger() { return this->logger_; }
     logger::Logger* logger_{nullptr};
     OrderBookStore& orderBookStore_;
     MDListener* mdListener_{nullptr};
+
+    std::unique_ptr<DepthSnapshotLoader> loader_;
+    uint64_t snapshotRetryNs_{SnapshotRetryNs};
+    std::vector<DepthSnapshotLoader::Snapshot> snapshots_;
+    std::vector<DepthSync> depthSync_;
+    std::vector<PriceLevel<Price>> levels_;
 };
 
 template <typename OrderBookStore>
@@ -77,10 +137,15 @@ inline void BinanceMdProcessor<OrderBookStore>::onData(const json& j)
     //        "binance msg:{} msgType: {}", jEventType,
     //        to_underlying(eventType));
     auto const cid = orderBookStore_.getCid(Exchange::BINANCE, symbol);
-    if (eventType == EventType::DepthUpdate)
+    if (eventType == EventType::DepthUpdate && loader_)
+    {
+        onDepthDiff(j, cid);
+    }
+    else if (eventType == EventType::DepthUpdate)
     {
         onSnapshot(j);
 
+        SPAN_STAMP(time::profiler_trigger::md_book_updated, cid);
         if (mdListener_)
         {
             mdListener_->onBookChange(cid);
@@ -91,8 +156,8 @@ inline void BinanceMdProcessor<OrderBookStore>::onData(const json& j)
         logger()->info("binance aggTrade:{}", j);
         onAggTrade(j);
 
-        price_t price;
-        quantity_t qty{};
+        Price price{};
+        Qty qty{};
         Side side{};
         uint64_t timestamp{};
         uint64_t tradeId{};
@@ -104,8 +169,8 @@ inline void BinanceMdProcessor<OrderBookStore>::onData(const json& j)
     else if (eventType == EventType::Trade)
     {
         logger()->info("binance trade:{}", j);
-        price_t price;
-        quantity_t qty{};
+        Price price{};
+        Qty qty{};
         Side side{};
         uint64_t timestamp{};
         uint64_t tradeId{};
@@ -144,31 +209,39 @@ inline void BinanceMdProcessor<OrderBookStore>::onSnapshot(const json& j)
 
     for (auto const& [lvlIdx, level] : jBids.items())
     {
-        auto const price = level[0];
-        auto const qty   = level[1];
+        auto const& price = level[0].template get_ref<const std::string&>();
+        auto const& qty   = level[1].template get_ref<const std::string&>();
 
         //        logger()->info(
         //            "binance onBookChange, side bid, process price: {} qty:
         //            {}", price, qty);
 
-        orderBook.setLevel(Side::BUY,
-                           BookDepth - number_utils::toInt<int32_t>(lvlIdx) - 1,
-                           number_utils::toDouble(price),
-                           number_utils::toDouble(qty));
+        Price px{};
+        Qty q{};
+        if (!Price::fromString(price.data(), price.size(), px) || !Qty::fromString(qty.data(), qty.size(), q))
+        {
+            logger()->error("binance invalid level symbol:{} price:{} qty:{}", jSymbol, price, qty);
+            continue;
+        }
+        orderBook.setLevel(Side::BUY, BookDepth - number_utils::toInt<int32_t>(lvlIdx) - 1, px, q);
     }
 
     for (auto const& [lvlIdx, level] : jAsks.items())
     {
-        auto const price = level[0];
-        auto const qty   = level[1];
+        auto const& price = level[0].template get_ref<const std::string&>();
+        auto const& qty   = level[1].template get_ref<const std::string&>();
 
         //        logger()->info(
         //            "binance onBookChange, side ask, process price: {} qty:
         //            {}", price, qty);
-        orderBook.setLevel(Side::SELL,
-                           BookDepth - number_utils::toInt<int32_t>(lvlIdx) - 1,
-                           number_utils::toDouble(price),
-                           number_utils::toDouble(qty));
+        Price px{};
+        Qty q{};
+        if (!Price::fromString(price.data(), price.size(), px) || !Qty::fromString(qty.data(), qty.size(), q))
+        {
+            logger()->error("binance invalid level symbol:{} price:{} qty:{}", jSymbol, price, qty);
+            continue;
+        }
+        orderBook.setLevel(Side::SELL, BookDepth - number_utils::toInt<int32_t>(lvlIdx) - 1, px, q);
     }
 
     logBook(jSymbol, orderBook);
@@ -177,6 +250,239 @@ inline void BinanceMdProcessor<OrderBookStore>::onSnapshot(const json& j)
     //    bbo);
 }
 
+/*
+ * Only the levels in the event are parsed and touched. A symbol without a
+ * book in sync holds its events and asks for a snapshot, a gap in the
+ * stream (pu != previous u) throws the book away and starts again. The
+ * listener hears onSnapshotFinished once the book is back.
+ */
+template <typename OrderBookStore>
+inline void BinanceMdProcessor<OrderBookStore>::onDepthDiff(const json& j, int32_t cid)
+{
+    if (cid == INVALID_CID)
+    {
+        return;
+    }
+    pollSnapshots();
+
+    auto& sync = depthSync_[cid];
+    if (sync.pending.empty() && applyDepthEvent(j, cid))
+    {
+        return;
+    }
+    if (sync.pending.size() >= MaxPendingEvents)
+    {
+        // a snapshot is newer than all of them by the time it comes
+        logger()->warn("binance depth dropping {} events held for a snapshot symbol:{}", sync.pending.size(), j["s"]);
+        sync.pending.clear();
+    }
+    sync.pending.push_back(j);
+    requestSnapshot(j["s"].template get_ref<const std::string&>(), cid);
+}
+
+/*
+ * false if the event has to wait for a snapshot: there is none, or the
+ * one there is is behind the stream, or the event follows a gap
+ */
+template <typename OrderBookStore>
+inline bool BinanceMdProcessor<OrderBookStore>::applyDepthEvent(const json& j, int32_t cid)
+{
+    auto& sync             = depthSync_[cid];
+    auto const firstId     = j["U"].template get<uint64_t>();
+    auto const finalId     = j["u"].template get<uint64_t>();
+    auto const prevFinalId = j["pu"].template get<uint64_t>();
+
+    if (sync.synced && prevFinalId != sync.prevU)
+    {
+        ++sync.resyncs;
+        logger()->warn("binance depth gap symbol:{} pu:{} last u:{} resyncs:{}",
+                       j["s"],
+                       prevFinalId,
+                       sync.prevU,
+                       sync.resyncs);
+        sync.synced      = false;
+        sync.hasSnapshot = false;
+    }
+
+    if (!sync.synced)
+    {
+        if (!sync.hasSnapshot)
+        {
+            return false;
+        }
+        if (finalId < sync.lastUpdateId)
+        {
+            ++sync.dropped;
+            return true; // already in the snapshot
+        }
+        if (firstId > sync.lastUpdateId)
+        {
+            logger()->warn("binance depth snapshot behind the stream symbol:{} lastUpdateId:{} U:{}",
+                           j["s"],
+                           sync.lastUpdateId,
+                           firstId);
+            sync.hasSnapshot = false;
+            return false;
+        }
+    }
+
+    auto& orderBook = orderBookStore_.getBook(cid);
+    applyDepthLevels(j["b"], Side::BUY, orderBook);
+    applyDepthLevels(j["a"], Side::SELL, orderBook);
+    sync.prevU = finalId;
+
+    SPAN_STAMP(time::profiler_trigger::md_book_updated, cid);
+    if (!sync.synced)
+    {
+        sync.synced = true;
+        logger()->info("binance depth synced symbol:{} lastUpdateId:{} bbo:{}",
+                       j["s"],
+                       sync.lastUpdateId,
+                       orderBook.getBBO());
+        if (mdListener_)
+        {
+            mdListener_->onSnapshotFinished(cid);
+        }
+        return true;
+    }
+    if (mdListener_)
+    {
+        mdListener_->onBookChange(cid);
+    }
+    return true;
+}
+
+template <typename OrderBookStore>
+inline void BinanceMdProcessor<OrderBookStore>::requestSnapshot(const std::string& symbol, int32_t cid)
+{
+    auto& sync = depthSync_[cid];
+    auto const now = mdNowNs();
+    if (sync.fetching || now < sync.nextFetchNs)
+    {
+        return;
+    }
+    sync.fetching    = true;
+    sync.nextFetchNs = now + snapshotRetryNs_;
+    ++sync.fetches;
+    loader_->request(cid, symbol);
+}
+
+template <typename OrderBookStore>
+inline void BinanceMdProcessor<OrderBookStore>::pollSnapshots()
+{
+    if (!loader_ || !loader_->poll(snapshots_))
+    {
+        return;
+    }
+    for (auto const& snapshot : snapshots_)
+    {
+        auto& sync    = depthSync_[snapshot.cid];
+        sync.fetching = false;
+        if (snapshot.status != 0)
+        {
+            logger()->error("binance depth snapshot fetch failed symbol:{}", snapshot.symbol);
+        }
+        else if (loadDepthSnapshot(snapshot.symbol, snapshot.cid, snapshot.body) == 0)
+        {
+            auto& pending = sync.pending;
+            size_t applied{0};
+            while (applied < pending.size() && applyDepthEvent(pending[applied], snapshot.cid))
+            {
+                ++applied;
+            }
+            pending.erase(pending.begin(), pending.begin() + applied);
+        }
+        // still waiting, the snapshot failed or is behind the events held
+        if (!sync.pending.empty())
+        {
+            requestSnapshot(snapshot.symbol, snapshot.cid);
+        }
+    }
+}
+
+template <typename OrderBookStore>
+inline int32_t BinanceMdProcessor<OrderBookStore>::loadDepthSnapshot(const std::string& symbol, int32_t cid,
+                                                                    const std::string& body)
+{
+    auto& sync = depthSync_[cid];
+    auto const j = json::parse(body, nullptr, false);
+    if (j.is_discarded() || !j.contains("lastUpdateId"))
+    {
+        logger()->error("binance depth snapshot invalid symbol:{} body:{}", symbol, body);
+        return -1;
+    }
+
+    auto& orderBook = orderBookStore_.getBook(cid);
+    if (parseDepthLevels(j["bids"], levels_) != 0)
+    {
+        logger()->error("binance depth snapshot invalid bids symbol:{}", symbol);
+        return -1;
+    }
+    orderBook.setLevels(Side::BUY, levels_.data(), levels_.size());
+    if (parseDepthLevels(j["asks"], levels_) != 0)
+    {
+        logger()->error("binance depth snapshot invalid asks symbol:{}", symbol);
+        return -1;
+    }
+    orderBook.setLevels(Side::SELL, levels_.data(), levels_.size());
+
+    sync.lastUpdateId = j["lastUpdateId"].template get<uint64_t>();
+    sync.hasSnapshot  = true;
+    sync.synced       = false;
+    logger()->info("binance depth snapshot symbol:{} lastUpdateId:{} bids:{} asks:{}",
+                   symbol,
+                   sync.lastUpdateId,
+                   orderBook.getLevelCount(Side::BUY),
+                   orderBook.getLevelCount(Side::SELL));
+    return 0;
+}
+
+template <typename OrderBookStore>
+inline int32_t BinanceMdProcessor<OrderBookStore>::parseDepthLevels(const json& jLevels,
+                                                                   std::vector<PriceLevel<Price>>& levels)
+{
+    levels.clear();
+    for (auto const& level : jLevels)
+    {
+        auto const& price = level[0].template get_ref<const std::string&>();
+        auto const& qty   = level[1].template get_ref<const std::string&>();
+        Price px{};
+        Qty q{};
+        if (!Price::fromString(price.data(), price.size(), px) || !Qty::fromString(qty.data(), qty.size(), q))
+        {
+            return -1;
+        }
+        levels.emplace_back(px, q);
+    }
+    return 0;
+}
+
+template <typename OrderBookStore>
+inline void BinanceMdProcessor<OrderBookStore>::applyDepthLevels(const json& jLevels, Side side, OrderBook& orderBook)
+{
+    for (auto const& level : jLevels)
+    {
+        auto const& price = level[0].template get_ref<const std::string&>();
+        auto const& qty   = level[1].template get_ref<const std::string&>();
+        Price px{};
+        Qty q{};
+        if (!Price::fromString(price.data(), price.size(), px) || !Qty::fromString(qty.data(), qty.size(), q))
+        {
+            logger()->error("binance invalid depth level price:{} qty:{}", price, qty);
+            continue;
+        }
+        if (q > Qty{})
+        {
+            orderBook.setOrInsertLevel(side, px, q);
+        }
+        else
+        {
+            // levels beyond the snapshot are deleted too
+            orderBook.removeLevel(side, px, false);
+        }
+    }
+}
+
 template <typename OrderBookStore>
 inline void BinanceMdProcessor<OrderBookStore>::onAggTrade(const json& j)
 {
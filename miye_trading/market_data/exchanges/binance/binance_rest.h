@@ -0,0 +1,267 @@
+#pragma once
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/ssl.hpp>
+#include <boost/beast/version.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace miye
+{
+namespace trading
+{
+namespace binance
+{
+
+/*
+ * GET {restUri}/fapi/v1/depth, the snapshot a diff depth book starts from.
+ * restUri is https://fapi.binance.com, or http://127.0.0.1:8080 for a
+ * local stand-in. Blocking, resolve, connect, handshake and the exchange
+ * all have to be done within timeoutMs. The server certificate is verified
+ * against the system CAs and the host name.
+ */
+inline int32_t fetchDepthSnapshot(const std::string& restUri, const std::string& symbol, int32_t limit,
+                                  int32_t timeoutMs, std::string& body)
+{
+    namespace beast = boost::beast;
+    namespace http  = beast::http;
+    namespace net   = boost::asio;
+    namespace ssl   = net::ssl;
+    using tcp       = net::ip::tcp;
+
+    auto const schemeEnd = restUri.find("://");
+    if (schemeEnd == std::string::npos)
+    {
+        std::cout << "ERROR binance rest uri without scheme:" << restUri << std::endl;
+        return -1;
+    }
+    auto const tls     = restUri.compare(0, schemeEnd, "https") == 0;
+    auto hostPort      = restUri.substr(schemeEnd + 3);
+    hostPort           = hostPort.substr(0, hostPort.find('/'));
+    auto const colon   = hostPort.find(':');
+    auto const host    = hostPort.substr(0, colon);
+    auto const port    = colon == std::string::npos ? std::string(tls ? "443" : "80") : hostPort.substr(colon + 1);
+    auto const target  = "/fapi/v1/depth?symbol=" + symbol + "&limit=" + std::to_string(limit);
+    auto const timeout = std::chrono::milliseconds(timeoutMs);
+
+    http::request<http::string_body> req{http::verb::get, target, 11};
+    req.set(http::field::host, host);
+    req.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING);
+    http::response<http::string_body> response;
+    beast::flat_buffer buffer;
+
+    net::io_context ioc;
+    beast::error_code ec;
+    auto const failed = [&](const char* what) {
+        std::cout << "ERROR binance depth snapshot " << restUri << target << " " << what << " failed:" << ec.message()
+                  << std::endl;
+        return -1;
+    };
+    // one operation at a time, the tcp_stream's expiry bounds them
+    auto const onDone = [&ec](beast::error_code e, auto&&...) { ec = e; };
+    auto const run    = [&ioc]() {
+        ioc.restart();
+        ioc.run();
+    };
+
+    tcp::resolver resolver{ioc};
+    tcp::resolver::results_type results;
+    bool resolved{false};
+    resolver.async_resolve(host, port, [&](beast::error_code e, tcp::resolver::results_type r) {
+        ec       = e;
+        results  = std::move(r);
+        resolved = true;
+    });
+    ioc.run_for(timeout);
+    if (!resolved)
+    {
+        resolver.cancel();
+        run();
+        ec = net::error::timed_out;
+    }
+    if (ec)
+    {
+        return failed("resolve");
+    }
+
+    auto const exchange = [&](auto& stream) {
+        http::async_write(stream, req, onDone);
+        run();
+        if (ec)
+        {
+            return failed("write");
+        }
+        http::async_read(stream, buffer, response, onDone);
+        run();
+        if (ec)
+        {
+            return failed("read");
+        }
+        return 0;
+    };
+
+    if (tls)
+    {
+        ssl::context ctx{ssl::context::tlsv12_client};
+        ctx.set_default_verify_paths();
+        ctx.set_verify_mode(ssl::verify_peer);
+        beast::ssl_stream<beast::tcp_stream> stream{ioc, ctx};
+        stream.set_verify_callback(ssl::host_name_verification(host));
+        if (!SSL_set_tlsext_host_name(stream.native_handle(), host.c_str()))
+        {
+            std::cout << "ERROR binance rest failed to set SNI host:" << host << std::endl;
+            return -1;
+        }
+        auto& socket = beast::get_lowest_layer(stream);
+        socket.expires_after(timeout);
+        socket.async_connect(results, onDone);
+        run();
+        if (ec)
+        {
+            return failed("connect");
+        }
+        stream.async_handshake(ssl::stream_base::client, onDone);
+        run();
+        if (ec)
+        {
+            return failed("handshake");
+        }
+        if (exchange(stream) != 0)
+        {
+            return -1;
+        }
+        socket.close();
+    }
+    else
+    {
+        beast::tcp_stream stream{ioc};
+        stream.expires_after(timeout);
+        stream.async_connect(results, onDone);
+        run();
+        if (ec)
+        {
+            return failed("connect");
+        }
+        if (exchange(stream) != 0)
+        {
+            return -1;
+        }
+        stream.socket().shutdown(tcp::socket::shutdown_both, ec);
+    }
+
+    if (response.result() != http::status::ok)
+    {
+        std::cout << "ERROR binance depth snapshot " << restUri << target << " status:" << response.result_int()
+                  << " body:" << response.body() << std::endl;
+        return -1;
+    }
+    body = std::move(response.body());
+    return 0;
+}
+
+/*
+ * Runs a blocking snapshot fetcher on a thread of its own so a book that
+ * resyncs does not hold up the thread parsing the stream. request() queues
+ * a fetch, poll() hands back the ones done, it only takes the lock when
+ * there are some.
+ */
+class DepthSnapshotLoader
+{
+  public:
+    // REST depth snapshot body of a symbol, 0 on success
+    using Fetcher = std::function<int32_t(const std::string& symbol, std::string& body)>;
+
+    struct Snapshot
+    {
+        int32_t cid;
+        std::string symbol;
+        int32_t status;
+        std::string body;
+    };
+
+    explicit DepthSnapshotLoader(Fetcher fetcher) : fetcher_(std::move(fetcher)), thread_([this] { run(); }) {}
+    DepthSnapshotLoader(const DepthSnapshotLoader&) = delete;
+    DepthSnapshotLoader& operator=(const DepthSnapshotLoader&) = delete;
+
+    ~DepthSnapshotLoader()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+        }
+        cv_.notify_one();
+        thread_.join();
+    }
+
+    void request(int32_t cid, const std::string& symbol)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            requests_.push_back(Snapshot{cid, symbol, -1, {}});
+        }
+        cv_.notify_one();
+    }
+
+    // false if no fetch finished since the last call
+    bool poll(std::vector<Snapshot>& done)
+    {
+        if (!ready_.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        done.clear();
+        std::lock_guard<std::mutex> lock(mutex_);
+        done.swap(done_);
+        ready_.store(false, std::memory_order_relaxed);
+        return true;
+    }
+
+  private:
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            cv_.wait(lock, [this] { return !running_ || !requests_.empty(); });
+            if (!running_)
+            {
+                return;
+            }
+            auto snapshot = std::move(requests_.front());
+            requests_.pop_front();
+            lock.unlock();
+            snapshot.status = fetcher_(snapshot.symbol, snapshot.body);
+            lock.lock();
+            done_.push_back(std::move(snapshot));
+            ready_.store(true, std::memory_order_release);
+        }
+    }
+
+  private:
+    Fetcher fetcher_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Snapshot> requests_;
+    std::vector<Snapshot> done_;
+    std::atomic<bool> ready_{false};
+    bool running_{true};
+    std::thread thread_; // last, starts once the rest is there
+};
+
+} // namespace binance
+} // namespace trading
+} // namespace miye
@@ -0,0 +1,284 @@
+#define BOOST_TEST_MODULE test_binance_depth_sync
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "libs/logger/logger.hpp"
+#include "market_data/book/order_book_store.hpp"
+#include "market_data/exchanges/binance/binance_md_processor.h"
+#include "market_data/exchanges/binance/binance_rest.h"
+#include "trading/md_listener.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace miye;
+using namespace miye::trading;
+using namespace miye::trading::binance;
+
+namespace
+{
+
+namespace beast = boost::beast;
+namespace http  = beast::http;
+namespace net   = boost::asio;
+using tcp       = net::ip::tcp;
+
+/*
+ * a local stand-in for the /fapi/v1/depth endpoint, answers every request
+ * with the body set last, or holds the connection without an answer
+ */
+class SnapshotStandIn
+{
+  public:
+    SnapshotStandIn() : acceptor_(ioc_, tcp::endpoint(net::ip::make_address("127.0.0.1"), 0))
+    {
+        thread_ = std::thread([this] { serve(); });
+    }
+
+    ~SnapshotStandIn()
+    {
+        stop_ = true;
+        // wakes the accept
+        tcp::socket socket(ioc_);
+        beast::error_code ec;
+        socket.connect(acceptor_.local_endpoint(), ec);
+        thread_.join();
+    }
+
+    std::string getUri() const { return "http://127.0.0.1:" + std::to_string(acceptor_.local_endpoint().port()); }
+
+    void setBody(const std::string& body)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        body_ = body;
+    }
+    void setSilent(bool silent) { silent_ = silent; }
+    uint32_t getRequests() const { return requests_; }
+    std::string getTarget() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return target_;
+    }
+
+  private:
+    void serve()
+    {
+        while (true)
+        {
+            tcp::socket socket(ioc_);
+            beast::error_code ec;
+            acceptor_.accept(socket, ec);
+            if (stop_)
+            {
+                return;
+            }
+            if (ec)
+            {
+                continue;
+            }
+            ++requests_;
+            if (silent_)
+            {
+                held_.push_back(std::move(socket));
+                continue;
+            }
+            beast::flat_buffer buffer;
+            http::request<http::string_body> req;
+            http::read(socket, buffer, req, ec);
+            if (ec)
+            {
+                continue;
+            }
+            http::response<http::string_body> res{http::status::ok, req.version()};
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                target_   = std::string(req.target());
+                res.body() = body_;
+            }
+            res.set(http::field::content_type, "application/json");
+            res.prepare_payload();
+            http::write(socket, res, ec);
+            socket.shutdown(tcp::socket::shutdown_both, ec);
+        }
+    }
+
+  private:
+    net::io_context ioc_;
+    tcp::acceptor acceptor_;
+    std::thread thread_;
+    mutable std::mutex mutex_;
+    std::string body_;
+    std::string target_;
+    std::vector<tcp::socket> held_;
+    std::atomic<bool> stop_{false};
+    std::atomic<bool> silent_{false};
+    std::atomic<uint32_t> requests_{0};
+};
+
+std::string snapshot(uint64_t lastUpdateId, const std::string& bidPx, const std::string& askPx)
+{
+    return R"({"lastUpdateId":)" + std::to_string(lastUpdateId) + R"(,"E":1,"T":1,"bids":[[")" + bidPx +
+           R"(","2.0"],["99.0","3.0"]],"asks":[[")" + askPx + R"(","1.0"],["102.0","4.0"]]})";
+}
+
+nlohmann::json depthUpdate(uint64_t firstId, uint64_t finalId, uint64_t prevFinalId, const std::string& bids = "[]",
+                           const std::string& asks = "[]")
+{
+    return nlohmann::json::parse(R"({"e":"depthUpdate","E":1,"T":1,"s":"BTCUSDT","U":)" + std::to_string(firstId) +
+                                 R"(,"u":)" + std::to_string(finalId) + R"(,"pu":)" + std::to_string(prevFinalId) +
+                                 R"(,"b":)" + bids + R"(,"a":)" + asks + "}");
+}
+
+Price px(const std::string& s)
+{
+    Price p{};
+    Price::fromString(s.data(), s.size(), p);
+    return p;
+}
+
+class CountingListener : public MDListener
+{
+  public:
+    int32_t onSnapshotFinished(int32_t) override
+    {
+        ++snapshots;
+        return 0;
+    }
+    int32_t onBookChange(int32_t) override
+    {
+        ++bookChanges;
+        return 0;
+    }
+    int32_t onTrade(uint64_t, int32_t, uint64_t, Side, Price, Qty, bool) override { return 0; }
+    int32_t onTick(int32_t) override { return 0; }
+
+    uint32_t snapshots{0};
+    uint32_t bookChanges{0};
+};
+
+using Store = OrderBookStore<4>;
+
+// spdlog takes a logger name once per process
+logger::Logger* testLogger()
+{
+    static auto logger = logger::createLogger("/tmp/test_binance_depth_sync.log");
+    return logger.get();
+}
+
+struct Fixture
+{
+    Fixture() : processor(store)
+    {
+        std::vector<symbol_t> symbols(4);
+        symbols[0] = Store::buildSymbol(Exchange::BINANCE, "BTCUSDT");
+        store.orderBooks_[0].init(0);
+        store.setSymbols(symbols);
+        processor.setLogger(testLogger());
+        processor.setMdListener(&listener);
+        auto const uri = standIn.getUri();
+        processor.setDiffDepth([uri](const std::string& symbol, std::string& body) {
+            return fetchDepthSnapshot(uri, symbol, 1000, 1000, body);
+        });
+        processor.setSnapshotRetryNs(0);
+    }
+
+    // polls until pred holds, false after 5s
+    template <typename Pred>
+    bool waitFor(Pred pred)
+    {
+        for (int i = 0; i < 5000 && !pred(); ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            processor.pollSnapshots();
+        }
+        return pred();
+    }
+
+    const DepthSync& sync() const { return processor.getDepthSync(0); }
+    OrderBook& book() { return store.getBook(0); }
+
+    SnapshotStandIn standIn;
+    Store store;
+    CountingListener listener;
+    BinanceMdProcessor<Store> processor;
+};
+
+} // namespace
+
+// events older than the snapshot are dropped, the first one straddling it syncs the book
+BOOST_FIXTURE_TEST_CASE(TestDropAndStraddle, Fixture)
+{
+    standIn.setBody(snapshot(100, "100.0", "101.0"));
+
+    // all held, the snapshot is fetched meanwhile
+    processor.onDepthDiff(depthUpdate(90, 95, 89, R"([["100.0","9.0"]])"), 0);
+    processor.onDepthDiff(depthUpdate(96, 99, 95, R"([["100.0","8.0"]])"), 0);
+    processor.onDepthDiff(depthUpdate(99, 105, 99, R"([["100.5","1.5"]])", R"([["101.0","0"]])"), 0);
+    BOOST_CHECK(waitFor([&] { return sync().synced; }));
+
+    BOOST_CHECK_EQUAL(standIn.getTarget(), "/fapi/v1/depth?symbol=BTCUSDT&limit=1000");
+    BOOST_CHECK_EQUAL(sync().dropped, 2u);
+    BOOST_CHECK_EQUAL(sync().prevU, 105u);
+    BOOST_CHECK(sync().pending.empty());
+    BOOST_CHECK_EQUAL(listener.snapshots, 1u);
+    auto const bbo = book().getBBO();
+    BOOST_CHECK(bbo.bidPx == px("100.5"));
+    BOOST_CHECK(bbo.askPx == px("102.0"));
+
+    // in sequence from here on, applied as they come
+    processor.onDepthDiff(depthUpdate(106, 110, 105, R"([["100.5","0"]])"), 0);
+    BOOST_CHECK_EQUAL(sync().prevU, 110u);
+    BOOST_CHECK_EQUAL(listener.bookChanges, 1u);
+    BOOST_CHECK(book().getBBO().bidPx == px("100.0"));
+    BOOST_CHECK_EQUAL(standIn.getRequests(), 1u);
+}
+
+// a snapshot older than the first event held is fetched again
+BOOST_FIXTURE_TEST_CASE(TestSnapshotBehindStream, Fixture)
+{
+    standIn.setBody(snapshot(100, "100.0", "101.0"));
+    processor.onDepthDiff(depthUpdate(150, 170, 149, R"([["100.5","1.0"]])"), 0);
+    // fetched again while behind
+    BOOST_CHECK(waitFor([&] { return sync().fetches >= 2; }));
+    BOOST_CHECK(!sync().synced);
+    standIn.setBody(snapshot(160, "100.0", "101.0"));
+    BOOST_CHECK(waitFor([&] { return sync().synced; }));
+
+    BOOST_CHECK_EQUAL(sync().prevU, 170u);
+    BOOST_CHECK(book().getBBO().bidPx == px("100.5"));
+}
+
+// pu not matching the last u throws the book away, it is rebuilt from a new snapshot
+BOOST_FIXTURE_TEST_CASE(TestGapResync, Fixture)
+{
+    standIn.setBody(snapshot(100, "100.0", "101.0"));
+    processor.onDepthDiff(depthUpdate(99, 105, 98), 0);
+    BOOST_CHECK(waitFor([&] { return sync().synced; }));
+
+    standIn.setBody(snapshot(120, "99.5", "100.5"));
+    processor.onDepthDiff(depthUpdate(111, 115, 110), 0);
+    BOOST_CHECK(!sync().synced);
+    BOOST_CHECK_EQUAL(sync().resyncs, 1u);
+    processor.onDepthDiff(depthUpdate(116, 125, 115, R"([["99.75","1.0"]])"), 0);
+    BOOST_CHECK(waitFor([&] { return sync().synced; }));
+
+    BOOST_CHECK_EQUAL(sync().prevU, 125u);
+    BOOST_CHECK_EQUAL(listener.snapshots, 2u);
+    auto const bbo = book().getBBO();
+    BOOST_CHECK(bbo.bidPx == px("99.75"));
+    BOOST_CHECK(bbo.askPx == px("100.5"));
+}
+
+// a server that never answers does not hold the fetch past its timeout
+BOOST_FIXTURE_TEST_CASE(TestFetchTimeout, Fixture)
+{
+    standIn.setSilent(true);
+    std::string body;
+    auto const start = std::chrono::steady_clock::now();
+    BOOST_CHECK_EQUAL(fetchDepthSnapshot(standIn.getUri(), "BTCUSDT", 1000, 200, body), -1);
+    BOOST_CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(2));
+}
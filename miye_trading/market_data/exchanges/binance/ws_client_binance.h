@@ -1,5 +1,6 @@
 #pragma once
 #include "binance_md_processor.h"
+#include "binance_rest.h"
 #include "market_data/book/order_book.h"
 #include <libs/ws_client/ws_client.h>
 
@@ -34,7 +35,11 @@ class WSClientBinance
 
     void connect() { wsClient_.connect(); }
 
-    void poll() { return wsClient_.poll(); }
+    void poll()
+    {
+        wsClient_.poll();
+        binanceMdProcessor_.pollSnapshots();
+    }
 
     void setMdListener(MDListener* mdListener)
     {
@@ -46,6 +51,15 @@ class WSClientBinance
         wsClient_.setLogger(logger);
         binanceMdProcessor_.setLogger(logger);
     }
+    // books follow the @depth diff stream, each starting from a REST snapshot of snapshotLimit levels
+    void setDiffDepth(std::string restUri, int32_t snapshotLimit, int32_t timeoutMs)
+    {
+        binanceMdProcessor_.setDiffDepth(
+            [restUri, snapshotLimit, timeoutMs](const std::string& symbol, std::string& body) {
+                return fetchDepthSnapshot(restUri, symbol, snapshotLimit, timeoutMs, body);
+            });
+    }
+
     int32_t init(logger::Logger* logger, WSConfig wsconfig)
     {
         logger_ = logger;
@@ -0,0 +1,231 @@
+#pragma once
+#include "libcore/utils/crc32.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+namespace miye
+{
+namespace trading
+{
+namespace ftx
+{
+
+/*
+ * FTX formats prices and sizes like python's repr(float): shortest round
+ * trip digits, fixed notation with at least one decimal ("5001.0") for
+ * exponents -4..15, otherwise "1e-05", "1.5e+16". Returns the length.
+ */
+inline size_t formatFtxNumber(double value, char* out)
+{
+    char sci[32];
+    auto const res  = std::to_chars(sci, sci + sizeof(sci), value, std::chars_format::scientific);
+    char* const end = res.ptr;
+
+    char* p       = out;
+    char const* s = sci;
+    if (*s == '-')
+    {
+        *p++ = *s++;
+    }
+
+    char digits[24];
+    size_t n{0};
+    while (*s != 'e')
+    {
+        if (*s != '.')
+        {
+            digits[n++] = *s;
+        }
+        ++s;
+    }
+    int32_t exponent{0};
+    std::from_chars(s + 1 + (s[1] == '+'), end, exponent);
+    auto const decpt = exponent + 1;
+
+    if (decpt > -4 && decpt <= 16)
+    {
+        if (decpt <= 0)
+        {
+            *p++ = '0';
+            *p++ = '.';
+            for (int32_t i = decpt; i < 0; ++i)
+            {
+                *p++ = '0';
+            }
+            memcpy(p, digits, n);
+            p += n;
+        }
+        else if (size_t(decpt) >= n)
+        {
+            memcpy(p, digits, n);
+            p += n;
+            for (size_t i = n; i < size_t(decpt); ++i)
+            {
+                *p++ = '0';
+            }
+            *p++ = '.';
+            *p++ = '0';
+        }
+        else
+        {
+            memcpy(p, digits, decpt);
+            p += decpt;
+            *p++ = '.';
+            memcpy(p, digits + decpt, n - decpt);
+            p += n - decpt;
+        }
+        return p - out;
+    }
+
+    *p++ = digits[0];
+    if (n > 1)
+    {
+        *p++ = '.';
+        memcpy(p, digits + 1, n - 1);
+        p += n - 1;
+    }
+    *p++ = 'e';
+    *p++ = exponent < 0 ? '-' : '+';
+    auto const absExponent = exponent < 0 ? -exponent : exponent;
+    if (absExponent < 10)
+    {
+        *p++ = '0';
+    }
+    p = std::to_chars(p, p + 4, absExponent).ptr;
+    return p - out;
+}
+
+/*
+ * The levels of one FTX book as the text its checksum is taken over:
+ * "bidPx:bidSize:askPx:askSize:..." for the top 100 levels, a side that
+ * runs out just stops contributing. The text is kept between checksums:
+ * a size change patches its level in place and moves the rest of the text
+ * by the difference in length, a level added or removed shifts the pairing
+ * of the two sides so the text is rebuilt from that rank on at the next
+ * checksum. Each level is formatted once, when it changes.
+ */
+class FtxChecksumBook
+{
+  public:
+    static const constexpr size_t ChecksumLevels{100};
+
+    void clear()
+    {
+        bids_.clear();
+        asks_.clear();
+        built_ = 0;
+    }
+
+    // size 0 removes the level
+    void update(bool isBid, double price, double size)
+    {
+        auto& side = isBid ? bids_ : asks_;
+        // worst to best like BookSide, the top of the book is at the back
+        auto it = isBid ? std::lower_bound(side.begin(), side.end(), price,
+                                           [](const Level& lvl, double px) { return lvl.price < px; })
+                        : std::lower_bound(side.begin(), side.end(), price,
+                                           [](const Level& lvl, double px) { return lvl.price > px; });
+        auto const found = it != side.end() && it->price == price;
+        auto const rank  = size_t(side.end() - it) - (found ? 1 : 0);
+        if (size == 0)
+        {
+            if (found)
+            {
+                side.erase(it);
+                built_ = std::min(built_, rank);
+            }
+            return;
+        }
+        if (!found)
+        {
+            it        = side.insert(it, Level{});
+            it->price = price;
+            built_    = std::min(built_, rank);
+        }
+        auto const oldLen = it->len;
+        auto len          = formatFtxNumber(price, it->text);
+        it->text[len++]   = ':';
+        len += formatFtxNumber(size, it->text + len);
+        it->len = len;
+        if (found && rank < built_)
+        {
+            patch(isBid, rank, oldLen, *it);
+        }
+    }
+
+    uint32_t checksum()
+    {
+        auto const count = std::min(std::max(bids_.size(), asks_.size()), ChecksumLevels);
+        built_           = std::min(built_, count);
+        char* p          = buffer_ + offsets_[built_];
+        for (size_t i = built_; i < count; ++i)
+        {
+            if (i < bids_.size())
+            {
+                auto const& lvl = bids_[bids_.size() - i - 1];
+                // the whole text, a fixed size copy is a few moves where a lvl.len one is a call
+                memcpy(p, lvl.text, sizeof(lvl.text));
+                p += lvl.len;
+                *p++ = ':';
+            }
+            if (i < asks_.size())
+            {
+                auto const& lvl = asks_[asks_.size() - i - 1];
+                memcpy(p, lvl.text, sizeof(lvl.text));
+                p += lvl.len;
+                *p++ = ':';
+            }
+            offsets_[i + 1] = uint32_t(p - buffer_);
+        }
+        built_         = count;
+        auto const len = offsets_[count] ? offsets_[count] - 1 : 0;
+        return utils::crc32(0, buffer_, len);
+    }
+
+    size_t getLevels(bool isBid) const { return isBid ? bids_.size() : asks_.size(); }
+
+  private:
+    struct Level
+    {
+        double price{};
+        uint8_t len{};
+        char text[55]{}; // "price:size", two numbers of at most 25 chars
+    };
+
+    // the level at rank changed its text from oldLen bytes to lvl.len
+    void patch(bool isBid, size_t rank, size_t oldLen, const Level& lvl)
+    {
+        auto pos = offsets_[rank];
+        if (!isBid && rank < bids_.size())
+        {
+            pos += bids_[bids_.size() - rank - 1].len + 1;
+        }
+        auto const end = offsets_[built_];
+        if (lvl.len != oldLen)
+        {
+            memmove(buffer_ + pos + lvl.len, buffer_ + pos + oldLen, end - pos - oldLen);
+            auto const delta = int32_t(lvl.len) - int32_t(oldLen);
+            for (size_t i = rank + 1; i <= built_; ++i)
+            {
+                offsets_[i] += delta;
+            }
+        }
+        memcpy(buffer_ + pos, lvl.text, lvl.len);
+    }
+
+    std::vector<Level> bids_;
+    std::vector<Level> asks_;
+    // ranks [0, built_) of the text are current, offsets_[i] is where rank i starts
+    size_t built_{0};
+    uint32_t offsets_[ChecksumLevels + 1]{};
+    // a level advances at most 51 bytes but writes all of its text
+    char buffer_[ChecksumLevels * 2 * (sizeof(Level::text) + 1)];
+};
+
+} // namespace ftx
+} // namespace trading
+} // namespace miye
@@ -1,13 +1,18 @@
 #pragma once
 #include "../../../trading/md_listener.h"
+#include "ftx_checksum.h"
 #include "ftx_raw_msg.h"
+#include "libcore/time/iso8601.hpp"
+#include "libcore/time/span_tracer.hpp"
 #include "libcore/types/types.hpp"
 #include "libcore/utils/number_utils.hpp"
 #include "libs/json/json.hpp"
 #include "libs/logger/logger.hpp"
 #include "market_data/book/order_book.h"
 #include <chrono>
+#include <functional>
 #include <iostream>
+#include <vector>
 
 namespace miye
 {
@@ -21,9 +26,13 @@ class FtxMdProcessor
 {
   public:
     using json = nlohmann::json;
+    // asks the exchange for a fresh partial of the market
+    using ResyncHandler = std::function<void(const std::string& market)>;
 
     explicit FtxMdProcessor(OrderBookStore& orderBookStore) : orderBookStore_(orderBookStore)
     {
+        checksumBooks_.resize(orderBookStore_.getSymbolNum());
+        stale_.resize(orderBookStore_.getSymbolNum());
 
         //        // TODO:pass rollWindowNs from config
         //        // 5min
@@ -40,12 +49,24 @@ class FtxMdProcessor
     void logBook(const std::string& symbol, const OrderBook& book);
     void setMdListener(MDListener* mdListener) { mdListener_ = mdListener; }
     void setLogger(logger::Logger* logger) { logger_ = logger; }
+    void setResyncHandler(ResyncHandler resync) { resync_ = std::move(resync); }
+    uint64_t getChecksumErrors() const { return checksumErrors_; }
+
+  private:
+    void applyLevels(const json& jLevels, Side side, OrderBook& orderBook, FtxChecksumBook& checksumBook);
+    bool verifyChecksum(const json& jData, const std::string& market, int32_t cid);
 
   private:
     logger::Logger* logger() { return this->logger_; }
     logger::Logger* logger_{nullptr};
     OrderBookStore& orderBookStore_;
     MDListener* mdListener_{nullptr};
+    time::iso8601_parser timeParser_{};
+
+    std::vector<FtxChecksumBook> checksumBooks_;
+    std::vector<uint8_t> stale_; // by cid, failed its checksum, updates are dropped until the partial
+    ResyncHandler resync_;
+    uint64_t checksumErrors_{0};
 };
 
 template <typename OrderBookStore>
@@ -99,10 +120,19 @@ inline void FtxMdProcessor<OrderBookStore>::onTrade(const json& j)
         auto const& side        = fromSideStr(trade["side"]);
         auto const& id          = trade["id"];
         auto const& liquidation = trade["liquidation"];
-        auto const& price       = trade["price"];
-        auto const& qty         = trade["size"];
+        auto const price        = Price::fromDouble(trade["price"].template get<double>());
+        auto const qty          = Qty::fromDouble(trade["size"].template get<double>());
         auto const& jTime       = trade["time"];
-        uint64_t timestamp      = 123;
+        uint64_t timestamp{};
+        if (jTime.is_string())
+        {
+            // "2021-05-24T08:53:12.123456+00:00"
+            auto const& timeStr = jTime.template get_ref<const std::string&>();
+            if (!timeParser_.parse(timeStr.data(), timeStr.size(), timestamp))
+            {
+                logger()->error("ftx trade invalid time:{}", timeStr);
+            }
+        }
 
         logger()->info("ftx trade symbol:{} id:{} price:{} qty:{} side:{} "
                        "tradeTime:{} liquidation:{}",
@@ -116,6 +146,7 @@ inline void FtxMdProcessor<OrderBookStore>::onTrade(const json& j)
         trades.emplace_back(trade_t{price, qty, side});
         orderBook.setLastTrade(timestamp, id, side, price, qty);
         tradeNum--;
+        SPAN_STAMP(time::profiler_trigger::md_book_updated, cid);
         if (mdListener_)
         {
             mdListener_->onTrade(timestamp, cid, id, side, price, qty, tradeNum == 0);
@@ -143,33 +174,37 @@ inline void FtxMdProcessor<OrderBookStore>::onSnapshot(const json& j)
     //    std::cout << "ftx::snapshot symbol:" << jSymbol << " time:" << jTime
     //              << " \nasks:" << jAsks << " \nbids:" << jBids << std::endl;
 
-    auto const cid  = orderBookStore_.getCid(Exchange::FTX, jSymbol);
-    auto& orderBook = orderBookStore_.getBook(Exchange::FTX, jSymbol);
+    auto const cid     = orderBookStore_.getCid(Exchange::FTX, jSymbol);
+    auto& orderBook    = orderBookStore_.getBook(Exchange::FTX, jSymbol);
+    auto& checksumBook = checksumBooks_[cid];
 
-    for (auto const& [lvlIdx, level] : jBids.items())
-    {
-        auto const price = level[0];
-        auto const qty   = level[1];
-        // std::cout << "process price:" << price << " qty:" << qty <<
-        // std::endl;
-        orderBook.setOrInsertLevel(Side::BUY, price, qty);
-    }
+    // a partial after a resync replaces the whole book
+    orderBook.setLevels(Side::BUY, nullptr, 0);
+    orderBook.setLevels(Side::SELL, nullptr, 0);
+    checksumBook.clear();
+    stale_[cid] = false;
 
-    for (auto const& [lvlIdx, level] : jAsks.items())
-    {
-        auto const price = level[0];
-        auto const qty   = level[1];
-        orderBook.setOrInsertLevel(Side::SELL, price, qty);
-    }
+    applyLevels(jBids, Side::BUY, orderBook, checksumBook);
+    applyLevels(jAsks, Side::SELL, orderBook, checksumBook);
 
     // logger()->info("ftx onSnapshot finished");
     logBook(jSymbol, orderBook);
 
+    // asking again would likely get the same, keep the book and say so
+    auto const checksum = checksumBook.checksum();
+    if (jData.contains("checksum") && checksum != jData["checksum"].template get<uint64_t>())
+    {
+        ++checksumErrors_;
+        logger()->error("ftx partial checksum mismatch market:{} expected:{} computed:{}",
+                        jSymbol,
+                        jData["checksum"],
+                        checksum);
+    }
+
     if (mdListener_)
     {
         mdListener_->onSnapshotFinished(cid);
     }
-    // TODO: checksum check
     // orderBook.print();
 }
 
@@ -186,50 +221,85 @@ inline void FtxMdProcessor<OrderBookStore>::onBookChange(const json& j)
 
     auto const cid  = orderBookStore_.getCid(Exchange::FTX, jSymbol);
     auto& orderBook = orderBookStore_.getBook(Exchange::FTX, jSymbol);
+    if (stale_[cid])
+    {
+        return;
+    }
 
-    for (auto const& [lvlIdx, level] : jBids.items())
+    applyLevels(jBids, Side::BUY, orderBook, checksumBooks_[cid]);
+    applyLevels(jAsks, Side::SELL, orderBook, checksumBooks_[cid]);
+    if (!verifyChecksum(jData, jSymbol, cid))
     {
-        auto const price = level[0];
-        auto const qty   = level[1];
-
-        //        logger()->info("ftx onBookChange, side bid, process price: {}
-        //        qty: {}",
-        //                       price,
-        //                       qty);
-        if (qty > 0.0)
-        {
-            orderBook.setOrInsertLevel(Side::BUY, price, qty);
-        }
-        else
-        {
-            orderBook.removeLevel(Side::BUY, price);
-        }
+        return;
     }
+    logBook(jSymbol, orderBook);
 
-    for (auto const& [lvlIdx, level] : jAsks.items())
+    SPAN_STAMP(time::profiler_trigger::md_book_updated, cid);
+    if (mdListener_)
     {
-        auto const price = level[0];
-        auto const qty   = level[1];
-
-        //        logger()->info("ftx onBookChange, side ask, process price: {}
-        //        qty: {}",
-        //                       price,
-        //                       qty);
-        if (qty > 0.0)
+        mdListener_->onBookChange(cid);
+    }
+}
+
+template <typename OrderBookStore>
+inline void FtxMdProcessor<OrderBookStore>::applyLevels(const json& jLevels,
+                                                        Side side,
+                                                        OrderBook& orderBook,
+                                                        FtxChecksumBook& checksumBook)
+{
+    for (auto const& level : jLevels)
+    {
+        auto const px   = level[0].template get<double>();
+        auto const size = level[1].template get<double>();
+        auto const qty  = Qty::fromDouble(size);
+        checksumBook.update(side == Side::BUY, px, size);
+        if (qty > Qty{})
         {
-            orderBook.setOrInsertLevel(Side::SELL, price, qty);
+            orderBook.setOrInsertLevel(side, Price::fromDouble(px), qty);
         }
         else
         {
-            orderBook.removeLevel(Side::SELL, price);
+            orderBook.removeLevel(side, Price::fromDouble(px));
         }
     }
-    logBook(jSymbol, orderBook);
+}
 
-    if (mdListener_)
+/*
+ * FTX checksums the top 100 levels after every update. On a mismatch the
+ * book is stale: its updates are dropped and no onBookChange goes out until
+ * a partial replaces it. Only this market is resubscribed, without a resync
+ * handler it stays stale until the exchange sends a partial on its own.
+ */
+template <typename OrderBookStore>
+inline bool FtxMdProcessor<OrderBookStore>::verifyChecksum(const json& jData, const std::string& market, int32_t cid)
+{
+    if (!jData.contains("checksum"))
     {
-        mdListener_->onBookChange(cid);
+        return true;
+    }
+    auto const expected = jData["checksum"].template get<uint64_t>();
+    auto const checksum = checksumBooks_[cid].checksum();
+    if (checksum == expected)
+    {
+        return true;
+    }
+
+    ++checksumErrors_;
+    logger()->warn("ftx checksum mismatch market:{} expected:{} computed:{} errors:{}, resync",
+                   market,
+                   expected,
+                   checksum,
+                   checksumErrors_);
+    stale_[cid] = true;
+    if (resync_)
+    {
+        resync_(market);
+    }
+    else
+    {
+        logger()->error("ftx no resync handler, market:{} is stale until the next partial", market);
     }
+    return false;
 }
 
 template <typename OrderBookStore>
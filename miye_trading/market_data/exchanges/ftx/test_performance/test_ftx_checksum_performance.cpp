@@ -0,0 +1,107 @@
+#include "benchmark/benchmark.h"
+#include <stdint.h>
+#include <vector>
+#include <zlib.h>
+
+#include "libcore/utils/crc32.hpp"
+#include "market_data/exchanges/ftx/ftx_checksum.h"
+
+// a 150 level a side perp book around 100.0, ~2.5KB of checksum text
+static miye::trading::ftx::FtxChecksumBook make_book()
+{
+    miye::trading::ftx::FtxChecksumBook book;
+    for (int i = 0; i < 150; ++i)
+    {
+        book.update(true, 100.0 - (i + 1) * 0.05, 10.5 + i * 1.25);
+        book.update(false, 100.0 + i * 0.05, 3.125 + i * 0.75);
+    }
+    return book;
+}
+
+static std::vector<uint8_t> make_text()
+{
+    std::vector<uint8_t> text(2600);
+    for (size_t i = 0; i < text.size(); ++i)
+        text[i] = "0123456789.:"[i % 12];
+    return text;
+}
+
+static void crc32_zlib(benchmark::State& state)
+{
+    auto const text = make_text();
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(::crc32(0, text.data(), text.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+BENCHMARK(crc32_zlib);
+
+static void crc32_pclmul(benchmark::State& state)
+{
+    auto const text = make_text();
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(miye::utils::crc32(0, text.data(), text.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+BENCHMARK(crc32_pclmul);
+
+static void format_ftx_number(benchmark::State& state)
+{
+    static const double numbers[] = {100.05, 0.0001, 1234.5, 5e-05, 17.0, 0.3};
+    char out[32];
+    size_t i = 0;
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(miye::trading::ftx::formatFtxNumber(numbers[i++ % 6], out));
+    }
+}
+
+BENCHMARK(format_ftx_number);
+
+// what an orderbook update costs on top of the book: a changed level plus the checksum
+static void update_and_checksum(benchmark::State& state)
+{
+    auto book = make_book();
+    size_t i  = 0;
+    while (state.KeepRunning())
+    {
+        auto const level = i++ % 5;
+        book.update(level & 1, level & 1 ? 99.95 - level * 0.05 : 100.0 + level * 0.05, 1.0 + (i % 100) * 0.5);
+        benchmark::DoNotOptimize(book.checksum());
+    }
+}
+
+BENCHMARK(update_and_checksum);
+
+// a level near the top added or removed, the text is rebuilt from that rank on
+static void insert_remove_and_checksum(benchmark::State& state)
+{
+    auto book = make_book();
+    size_t i  = 0;
+    while (state.KeepRunning())
+    {
+        auto const level = (i / 2) % 5;
+        book.update(false, 100.0 + level * 0.05, i++ & 1 ? 3.125 + level * 0.75 : 0.0);
+        benchmark::DoNotOptimize(book.checksum());
+    }
+}
+
+BENCHMARK(insert_remove_and_checksum);
+
+static void checksum_only(benchmark::State& state)
+{
+    auto book = make_book();
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(book.checksum());
+    }
+}
+
+BENCHMARK(checksum_only);
+
+BENCHMARK_MAIN();
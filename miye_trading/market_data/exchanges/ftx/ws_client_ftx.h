@@ -74,6 +74,8 @@ class WSClientFtx
     {
         logger_ = logger;
         ftxMdProcessor_.setLogger(logger);
+        ftxMdProcessor_.setResyncHandler(
+            [this](const std::string& market) { wsClient_.resubscribe_orderbook(market); });
         setMsgProcessor();
         wsClient_.init(logger, wsconfig);
         return 0;
@@ -7,7 +7,10 @@
 #include "market_data/book/order_book_store.hpp"
 #include "market_data/exchanges/binance/ws_client_binance.h"
 #include "market_data/exchanges/ftx/ws_client_ftx.h"
+#include "market_data/md_conflator.h"
+#include "market_data/md_thread.h"
 
+#include <memory>
 #include <stdint.h>
 
 namespace miye
@@ -15,16 +18,52 @@ namespace miye
 namespace trading
 {
 
+/*
+ * By default every venue is polled on the caller's thread, one after the
+ * other, which keeps a run deterministic. With
+ *
+ * [global]
+ * md_threads = true
+ *
+ * [markets.binance] / [markets.ftx]
+ * cpu = 3          # optional, pins the venue thread
+ *
+ * each venue runs on its own thread and poll() applies their updates to
+ * the books here, oldest first, before calling the MDListener. The books
+ * then hold the top MdEventDepth levels of the venue's book.
+ *
+ * [global]
+ * conflate = true
+ *
+ * [conflation]                   # optional
+ * every_update = FTX:FTM-PERP    # books whose every change is still passed on
+ *
+ * gives the MDListener one onBookChange per changed book per poll(),
+ * trades are never conflated.
+ */
 template <size_t SYM_SIZE>
 struct MarketMain
 {
     using OrderBookStore_t = OrderBookStore<SYM_SIZE>;
+    using BinanceClient_t  = binance::WSClientBinance<OrderBookStore_t>;
+    using FtxClient_t      = ftx::WSClientFtx<OrderBookStore_t>;
     static const constexpr int32_t BinanceBookDepth{5};
 
     int32_t poll()
     {
-        binanceWSClient.poll();
-        ftxWSClient.poll();
+        if (mdThreads_)
+        {
+            drain();
+        }
+        else
+        {
+            binanceWSClient.poll();
+            ftxWSClient.poll();
+        }
+        if (conflate_)
+        {
+            conflator_.flush();
+        }
         return 0;
     }
 
@@ -52,13 +91,31 @@ struct MarketMain
 
         /*
          * FTX is defaulted to full bookdepth
-         * Binance book depth is decided by stream param
+         * Binance book depth is decided by stream param, or full depth with
+         * [markets.binance]
+         * diff_depth     = true
+         * rest_uri       = https://fapi.binance.com   # snapshots, optional
+         * snapshot_limit = 1000                       # optional
+         * snapshot_timeout_ms = 5000                   # optional
          */
         std::cout << "init binance book to depth:" << BinanceBookDepth << std::endl;
         bookStore_.initBook(trading::Exchange::BINANCE, BinanceBookDepth);
 
-        initBinanceMd(configFile, mdListener);
-        initFtxMd(configFile, mdListener);
+        conflate_ = iniFile["global"].count("conflate") && iniFile["global"]["conflate"].as<bool>();
+        if (conflate_)
+        {
+            initConflation(iniFile, mdListener);
+            mdListener = &conflator_;
+        }
+
+        mdThreads_ = iniFile["global"].count("md_threads") && iniFile["global"]["md_threads"].as<bool>();
+        if (mdThreads_)
+        {
+            return initMdThreads(configFile, symbols, mdListener);
+        }
+
+        initBinanceMd(configFile, binanceWSClient, mdListener);
+        initFtxMd(configFile, ftxWSClient, mdListener);
 
         binanceWSClient.connect();
         ftxWSClient.connect();
@@ -66,50 +123,179 @@ struct MarketMain
         return 0;
     }
 
-    int32_t initFtxMd(std::string configFile, MDListener* mdListener)
+    template <typename Client>
+    int32_t initFtxMd(std::string configFile, Client& client, MDListener* mdListener)
     {
         auto iniFile          = ini::IniFile(configFile);
         const std::string uri = iniFile["markets.ftx"]["uri"].as<std::string>();
         WSConfig wsconfig{uri};
 
-        ftxWSClient.init(logger_.get(), wsconfig);
-        ftxWSClient.setMdListener(mdListener);
+        client.init(logger_.get(), wsconfig);
+        client.setMdListener(mdListener);
 
         auto const ftx_symbol = iniFile["markets.ftx"]["symbol_list"].as<std::string>();
 
-        ftxWSClient.subscribeOrderbook(ftx_symbol);
+        client.subscribeOrderbook(ftx_symbol);
         logger_->info("subscribe to ftx orderbook symbol:{}", ftx_symbol);
-        ftxWSClient.subscribeTrades(ftx_symbol);
+        client.subscribeTrades(ftx_symbol);
         logger_->info("subscribe to ftx trades symbol:{}", ftx_symbol);
-        ftxWSClient.subscribeTicker(ftx_symbol);
+        client.subscribeTicker(ftx_symbol);
         logger_->info("subscribe to ftx ticker symbol:{}", ftx_symbol);
 
         return 0;
     }
 
-    int32_t initBinanceMd(std::string configFile, MDListener* mdListener)
+    template <typename Client>
+    int32_t initBinanceMd(std::string configFile, Client& client, MDListener* mdListener)
     {
-        auto iniFile      = ini::IniFile(configFile);
-        auto const symbol = iniFile["markets.binance"]["symbol_list"].as<std::string>();
-        WSConfig wsconfig{"wss://fstream.binance.com:443/stream?streams=" + symbol + "@depth" +
-                          std::to_string(BinanceBookDepth) + "@0ms/" + symbol + "@aggTrade/" + symbol +
-                          "@markPrice@1s"};
-
-        binanceWSClient.init(logger_.get(), wsconfig);
-        binanceWSClient.setMdListener(mdListener);
+        auto iniFile         = ini::IniFile(configFile);
+        auto& section        = iniFile["markets.binance"];
+        auto const symbol    = section["symbol_list"].as<std::string>();
+        auto const diffDepth = section.count("diff_depth") && section["diff_depth"].as<bool>();
+        auto const depthStream =
+            diffDepth ? std::string("@depth@0ms/") : "@depth" + std::to_string(BinanceBookDepth) + "@0ms/";
+        WSConfig wsconfig{"wss://fstream.binance.com:443/stream?streams=" + symbol + depthStream + symbol +
+                          "@aggTrade/" + symbol + "@markPrice@1s"};
+
+        client.init(logger_.get(), wsconfig);
+        client.setMdListener(mdListener);
+        if (diffDepth)
+        {
+            auto const restUri =
+                section.count("rest_uri") ? section["rest_uri"].as<std::string>() : "https://fapi.binance.com";
+            auto const snapshotLimit =
+                section.count("snapshot_limit") ? section["snapshot_limit"].as<int32_t>() : 1000;
+            auto const timeoutMs =
+                section.count("snapshot_timeout_ms") ? section["snapshot_timeout_ms"].as<int32_t>() : 5000;
+            client.setDiffDepth(restUri, snapshotLimit, timeoutMs);
+            logger_->info("binance diff depth, snapshots from {} limit:{} timeout:{}ms", restUri, snapshotLimit,
+                          timeoutMs);
+        }
         return 0;
     }
 
     std::vector<std::string> getSymbols() const { return bookStore_.getSymbols(); }
+    const OrderBookStore_t& getBookStore() const { return bookStore_; }
+    const MdConflator<SYM_SIZE>& getConflator() const { return conflator_; }
 
     logger::Logger* logger() { return logger_.get(); }
 
+  private:
+    void initConflation(ini::IniFile& iniFile, MDListener* mdListener)
+    {
+        conflator_.setListener(mdListener);
+        conflator_.setMode(ConflationMode::LATEST);
+        if (iniFile.count("conflation") && iniFile["conflation"].count("every_update"))
+        {
+            auto const symbols = string_utils::split(iniFile["conflation"]["every_update"].as<std::string>(), ',');
+            for (auto const& symbol : symbols)
+            {
+                auto const cid = bookStore_.getCid(symbol);
+                if (cid == INVALID_CID)
+                {
+                    logger()->error("conflation every_update symbol not in symbol_list:{}", symbol);
+                    continue;
+                }
+                conflator_.setMode(cid, ConflationMode::EVERY_UPDATE);
+            }
+        }
+        logger()->info("book changes conflated per poll");
+    }
+
+    using BinanceThread_t = MdVenueThread<OrderBookStore_t, BinanceClient_t>;
+    using FtxThread_t     = MdVenueThread<OrderBookStore_t, FtxClient_t>;
+
+    int32_t initMdThreads(std::string configFile, const std::vector<symbol_t>& symbols, MDListener* mdListener)
+    {
+        auto iniFile = ini::IniFile(configFile);
+        auto cpu     = [&iniFile](const char* section) {
+            return iniFile[section].count("cpu") ? iniFile[section]["cpu"].as<int32_t>() : -1;
+        };
+        mdListener_ = mdListener;
+
+        binanceThread_ = std::make_unique<BinanceThread_t>();
+        binanceThread_->bookStore().setSymbols(symbols);
+        binanceThread_->bookStore().initBook(trading::Exchange::BINANCE, BinanceBookDepth);
+        initBinanceMd(configFile, binanceThread_->client(), binanceThread_.get());
+
+        ftxThread_ = std::make_unique<FtxThread_t>();
+        ftxThread_->bookStore().setSymbols(symbols);
+        initFtxMd(configFile, ftxThread_->client(), ftxThread_.get());
+
+        arbiter_.submit(&binanceThread_->ring());
+        arbiter_.submit(&ftxThread_->ring());
+
+        binanceThread_->start(cpu("markets.binance"));
+        ftxThread_->start(cpu("markets.ftx"));
+        logger_->info("market data on venue threads, binance cpu:{} ftx cpu:{}", cpu("markets.binance"),
+                      cpu("markets.ftx"));
+        return 0;
+    }
+
+    // what the venue threads have published so far, at most a ring's worth per call
+    int32_t drain()
+    {
+        size_t which{};
+        for (size_t n = 0; n < MdRingSize; ++n)
+        {
+            auto const* event = arbiter_.next(which);
+            if (!event)
+            {
+                break;
+            }
+            apply(*event);
+            arbiter_.readComplete(which);
+        }
+        return 0;
+    }
+
+    void apply(const MdEvent& event)
+    {
+        auto& book = bookStore_.getBook(event.cid);
+        switch (event.type)
+        {
+        case MdEventType::BOOK_CHANGE:
+        case MdEventType::SNAPSHOT_FINISHED:
+            book.setLevels(Side::BUY, event.bids.data(), event.bidLevels);
+            book.setLevels(Side::SELL, event.asks.data(), event.askLevels);
+            if (mdListener_)
+            {
+                event.type == MdEventType::BOOK_CHANGE ? mdListener_->onBookChange(event.cid)
+                                                       : mdListener_->onSnapshotFinished(event.cid);
+            }
+            break;
+        case MdEventType::TRADE:
+            book.setLastTrade(event.tradeTimestamp, event.tradeId, event.side, event.price, event.qty);
+            if (mdListener_)
+            {
+                mdListener_->onTrade(event.tradeTimestamp, event.cid, event.tradeId, event.side, event.price,
+                                     event.qty, event.isDone);
+            }
+            break;
+        case MdEventType::TICK:
+            if (mdListener_)
+            {
+                mdListener_->onTick(event.cid);
+            }
+            break;
+        }
+    }
+
   private:
     std::shared_ptr<logger::Logger> logger_;
     OrderBookStore_t bookStore_;
 
-    binance::WSClientBinance<OrderBookStore_t> binanceWSClient{bookStore_};
-    ftx::WSClientFtx<OrderBookStore_t> ftxWSClient{bookStore_};
+    BinanceClient_t binanceWSClient{bookStore_};
+    FtxClient_t ftxWSClient{bookStore_};
+
+    bool conflate_{false};
+    MdConflator<SYM_SIZE> conflator_;
+
+    bool mdThreads_{false};
+    MDListener* mdListener_{nullptr};
+    std::unique_ptr<BinanceThread_t> binanceThread_;
+    std::unique_ptr<FtxThread_t> ftxThread_;
+    MdArbiter<2> arbiter_;
 };
 
 } // namespace trading
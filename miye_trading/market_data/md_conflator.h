@@ -0,0 +1,100 @@
+#pragma once
+
+#include "market_data/book/exchange.h"
+#include "trading/md_listener.h"
+
+#include <array>
+#include <stdint.h>
+
+namespace miye
+{
+namespace trading
+{
+
+enum class ConflationMode : uint8_t
+{
+    EVERY_UPDATE = 0, // each onBookChange is passed on as it comes
+    LATEST            // one onBookChange per book per flush, the book as it is by then
+};
+
+/*
+ * Sits between the processors and the strategy's MDListener. Book changes
+ * of LATEST books only mark the cid dirty, flush() then tells the listener
+ * once per dirty book. Trades, ticks and snapshots are never conflated, a
+ * trade first delivers a pending change of its book so the order holds.
+ */
+template <size_t SYM_SIZE>
+class MdConflator : public MDListener
+{
+  public:
+    void setListener(MDListener* listener) { listener_ = listener; }
+    void setMode(int32_t cid, ConflationMode mode) { modes_[cid] = mode; }
+    void setMode(ConflationMode mode) { modes_.fill(mode); }
+    ConflationMode getMode(int32_t cid) const { return modes_[cid]; }
+
+    int32_t onSnapshotFinished(int32_t cid) override
+    {
+        clearDirty(cid);
+        return listener_->onSnapshotFinished(cid);
+    }
+
+    int32_t onBookChange(int32_t cid) override
+    {
+        ++bookChanges_;
+        if (modes_[cid] == ConflationMode::EVERY_UPDATE)
+        {
+            ++notified_;
+            return listener_->onBookChange(cid);
+        }
+        dirty_[cid / 64] |= uint64_t(1) << (cid % 64);
+        return 0;
+    }
+
+    int32_t onTrade(uint64_t timestamp, int32_t cid, uint64_t tradeId, Side side, Price price, Qty qty,
+                    bool isDone) override
+    {
+        if (isDirty(cid))
+        {
+            clearDirty(cid);
+            ++notified_;
+            listener_->onBookChange(cid);
+        }
+        return listener_->onTrade(timestamp, cid, tradeId, side, price, qty, isDone);
+    }
+
+    int32_t onTick(int32_t cid) override { return listener_->onTick(cid); }
+
+    // one onBookChange per dirty book, call when the feeds have been polled
+    void flush()
+    {
+        for (size_t word = 0; word < dirty_.size(); ++word)
+        {
+            while (dirty_[word])
+            {
+                auto const bit = __builtin_ctzll(dirty_[word]);
+                dirty_[word] &= dirty_[word] - 1;
+                ++notified_;
+                listener_->onBookChange(int32_t(word * 64 + bit));
+            }
+        }
+    }
+
+    uint64_t getBookChanges() const { return bookChanges_; }
+    uint64_t getNotified() const { return notified_; }
+    // book changes received per change delivered, 1.0 when nothing was conflated
+    double getConflationRatio() const { return notified_ ? double(bookChanges_) / notified_ : 1.0; }
+
+  private:
+    bool isDirty(int32_t cid) const { return dirty_[cid / 64] & (uint64_t(1) << (cid % 64)); }
+    void clearDirty(int32_t cid) { dirty_[cid / 64] &= ~(uint64_t(1) << (cid % 64)); }
+
+  private:
+    MDListener* listener_{nullptr};
+    std::array<uint64_t, (SYM_SIZE + 63) / 64> dirty_{};
+    std::array<ConflationMode, SYM_SIZE> modes_{};
+    uint64_t bookChanges_{0};
+    uint64_t notified_{0};
+};
+
+} // namespace trading
+} // namespace miye
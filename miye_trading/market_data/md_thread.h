@@ -0,0 +1,232 @@
+#pragma once
+
+#include "libcore/utils/spsc_ring.hpp"
+#include "market_data/book/exchange.h"
+#include "market_data/book/order_book.h"
+#include "trading/md_listener.h"
+
+#include <array>
+#include <atomic>
+#include <immintrin.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <thread>
+#include <time.h>
+
+namespace miye
+{
+namespace trading
+{
+
+/*
+ * Venue threads: every venue's websocket, json parsing and book building
+ * runs on a thread of its own against a private book store. What the
+ * strategy thread needs is handed over as MdEvents, a book change carries
+ * the top MdEventDepth levels, through one SPSC ring per venue.
+ */
+
+const constexpr size_t MdEventDepth{10};
+const constexpr size_t MdRingSize{4096};
+
+enum class MdEventType : uint8_t
+{
+    BOOK_CHANGE = 0,
+    SNAPSHOT_FINISHED,
+    TRADE,
+    TICK
+};
+
+struct MdEvent
+{
+    uint64_t timestamp{}; // CLOCK_MONOTONIC at the venue thread, orders the venues
+    uint64_t tradeTimestamp{};
+    uint64_t tradeId{};
+    int32_t cid{INVALID_CID};
+    MdEventType type{};
+    Side side{};
+    bool isDone{};
+    uint8_t bidLevels{};
+    uint8_t askLevels{};
+    Price price{};
+    Qty qty{};
+    std::array<PriceLevel<Price>, MdEventDepth> bids{}; // best first
+    std::array<PriceLevel<Price>, MdEventDepth> asks{};
+};
+
+using MdRing = utils::spsc_ring<MdEvent, MdRingSize>;
+
+inline uint64_t mdNowNs()
+{
+    struct timespec ts;
+    ::clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec) * 1'000'000'000 + ts.tv_nsec;
+}
+
+/*
+ * owns one venue's WSClient and books, is the MDListener of its processor
+ * and relays every callback into the ring
+ */
+template <typename OrderBookStore, typename WSClient_t>
+class MdVenueThread : public MDListener
+{
+  public:
+    MdVenueThread() { client_.setMdListener(this); }
+    ~MdVenueThread() { stop(); }
+
+    OrderBookStore& bookStore() { return bookStore_; }
+    WSClient_t& client() { return client_; }
+    MdRing& ring() { return ring_; }
+
+    // from here on the client belongs to the venue thread
+    void start(int32_t cpu)
+    {
+        running_ = true;
+        thread_  = std::thread([this, cpu] {
+            if (cpu >= 0)
+            {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(cpu, &set);
+                ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+            }
+            client_.connect();
+            while (running_.load(std::memory_order_relaxed))
+            {
+                client_.poll();
+            }
+        });
+    }
+
+    void stop()
+    {
+        if (thread_.joinable())
+        {
+            running_ = false;
+            thread_.join();
+        }
+    }
+
+    int32_t onSnapshotFinished(int32_t cid) override
+    {
+        publishBook(MdEventType::SNAPSHOT_FINISHED, cid);
+        return 0;
+    }
+
+    int32_t onBookChange(int32_t cid) override
+    {
+        publishBook(MdEventType::BOOK_CHANGE, cid);
+        return 0;
+    }
+
+    int32_t onTrade(uint64_t timestamp, int32_t cid, uint64_t tradeId, Side side, Price price, Qty qty,
+                    bool isDone) override
+    {
+        event_.timestamp      = mdNowNs();
+        event_.tradeTimestamp = timestamp;
+        event_.type           = MdEventType::TRADE;
+        event_.cid            = cid;
+        event_.tradeId        = tradeId;
+        event_.side           = side;
+        event_.price          = price;
+        event_.qty            = qty;
+        event_.isDone         = isDone;
+        push();
+        return 0;
+    }
+
+    int32_t onTick(int32_t cid) override
+    {
+        event_.timestamp = mdNowNs();
+        event_.type      = MdEventType::TICK;
+        event_.cid       = cid;
+        push();
+        return 0;
+    }
+
+    uint64_t getRingFullCount() const { return ringFull_.load(std::memory_order_relaxed); }
+
+  private:
+    void publishBook(MdEventType type, int32_t cid)
+    {
+        auto const& book = bookStore_.getBook(cid);
+        event_.timestamp = mdNowNs();
+        event_.type      = type;
+        event_.cid       = cid;
+        event_.bidLevels = copySide(book, Side::BUY, event_.bids);
+        event_.askLevels = copySide(book, Side::SELL, event_.asks);
+        push();
+    }
+
+    static uint8_t copySide(const OrderBook& book, Side side, std::array<PriceLevel<Price>, MdEventDepth>& levels)
+    {
+        auto const count = std::min(book.getLevelCount(side), MdEventDepth);
+        for (size_t i = 0; i < count; ++i)
+        {
+            levels[i] = book.getLevel(side, i);
+        }
+        return count;
+    }
+
+    // a slow strategy holds the venue back rather than losing its updates, until stop()
+    void push()
+    {
+        if (!ring_.try_push(event_))
+        {
+            ringFull_.fetch_add(1, std::memory_order_relaxed);
+            while (!ring_.try_push(event_))
+            {
+                if (!running_.load(std::memory_order_relaxed))
+                {
+                    return;
+                }
+                _mm_pause();
+            }
+        }
+    }
+
+  private:
+    OrderBookStore bookStore_;
+    WSClient_t client_{bookStore_};
+    MdRing ring_;
+    MdEvent event_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> ringFull_{0};
+};
+
+/*
+ * merges the venue rings on the strategy thread, oldest event first like
+ * qstream::arbiter does for streams
+ */
+template <size_t N>
+class MdArbiter
+{
+  public:
+    void submit(MdRing* ring) { rings_[count_++] = ring; }
+
+    // the oldest event at the front of any ring, nullptr when all are empty
+    const MdEvent* next(size_t& which)
+    {
+        const MdEvent* oldest = nullptr;
+        for (size_t i = 0; i < count_; ++i)
+        {
+            auto const* event = rings_[i]->front();
+            if (event && (!oldest || event->timestamp < oldest->timestamp))
+            {
+                oldest = event;
+                which  = i;
+            }
+        }
+        return oldest;
+    }
+
+    void readComplete(size_t which) { rings_[which]->pop(); }
+
+  private:
+    std::array<MdRing*, N> rings_{};
+    size_t count_{0};
+};
+
+} // namespace trading
+} // namespace miye
@@ -0,0 +1,176 @@
+#pragma once
+
+#include "libcore/qstream/mmap_headers.hpp"
+
+#include <algorithm>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace miye
+{
+namespace trading
+{
+
+struct CaptureMessage
+{
+    uint64_t timestamp{0}; // capture time ns, 0 if the capture has none
+    const char* data{nullptr};
+    size_t len{0};
+};
+
+/*
+ * Reads back captured websocket traffic, one raw message at a time:
+ *  - text captures, dinobot ring_logger "<writer_timestamp> <json>" lines
+ *    or plain "<json>" lines like the FTX captures of the fix acceptor
+ *  - mmfiles (qstream binary captures), a message per record, the record
+ *    timestamp as its capture time
+ * The kind is told by the mmfile magic. A message's data stays valid
+ * until the next call to next().
+ */
+class CaptureReader
+{
+  public:
+    CaptureReader() = default;
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+    ~CaptureReader() { close(); }
+
+    int32_t open(const std::string& path)
+    {
+        close();
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0)
+        {
+            std::cout << "ERROR cannot open capture:" << path << std::endl;
+            return -1;
+        }
+        struct stat st;
+        if (::fstat(fd_, &st) != 0)
+        {
+            std::cout << "ERROR cannot stat capture:" << path << std::endl;
+            return -1;
+        }
+        size_ = st.st_size;
+
+        uint64_t magic{0};
+        if (size_ >= sizeof(qstream::mmap_header) && ::pread(fd_, &magic, sizeof(magic), 0) == sizeof(magic) &&
+            magic == qstream::mmap_magic)
+        {
+            base_ = static_cast<char*>(::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0));
+            if (base_ == MAP_FAILED)
+            {
+                base_ = nullptr;
+                std::cout << "ERROR cannot map capture:" << path << std::endl;
+                return -1;
+            }
+            ::madvise(base_, size_, MADV_SEQUENTIAL);
+            auto const header = reinterpret_cast<const qstream::mmap_header*>(base_);
+            recSize_          = header->rec_size;
+            end_              = std::min<uint64_t>(header->write_offset, size_);
+            offset_           = sizeof(qstream::mmap_header);
+            return 0;
+        }
+
+        in_.open(path);
+        if (!in_)
+        {
+            std::cout << "ERROR cannot read capture:" << path << std::endl;
+            return -1;
+        }
+        return 0;
+    }
+
+    void close()
+    {
+        if (base_)
+        {
+            ::munmap(base_, size_);
+            base_ = nullptr;
+        }
+        if (fd_ >= 0)
+        {
+            ::close(fd_);
+            fd_ = -1;
+        }
+        in_.close();
+    }
+
+    bool isMmfile() const { return base_ != nullptr; }
+    uint64_t getBytes() const { return size_; }
+
+    // false at the end of the capture
+    bool next(CaptureMessage& msg) { return base_ ? nextRecord(msg) : nextLine(msg); }
+
+  private:
+    bool nextLine(CaptureMessage& msg)
+    {
+        while (std::getline(in_, line_))
+        {
+            if (line_.empty())
+            {
+                continue;
+            }
+            msg.timestamp = 0;
+            size_t start  = 0;
+            if (line_[0] != '{' && line_[0] != '[')
+            {
+                auto const space = line_.find(' ');
+                if (space == std::string::npos)
+                {
+                    continue;
+                }
+                msg.timestamp = strtoull(line_.c_str(), nullptr, 10);
+                start         = space + 1;
+            }
+            msg.data = line_.data() + start;
+            msg.len  = line_.size() - start;
+            return true;
+        }
+        return false;
+    }
+
+    bool nextRecord(CaptureMessage& msg)
+    {
+        auto const headerSize = recSize_ ? sizeof(qstream::record_header<false>) : sizeof(qstream::record_header<true>);
+        if (offset_ + headerSize > end_)
+        {
+            return false;
+        }
+        auto const rec = base_ + offset_;
+        size_t len     = recSize_;
+        if (!recSize_)
+        {
+            len = reinterpret_cast<const qstream::record_header<true>*>(rec)->rec_size;
+        }
+        if (offset_ + headerSize + len > end_)
+        {
+            return false;
+        }
+        msg.timestamp = reinterpret_cast<const qstream::record_header<false>*>(rec)->timestamp;
+        msg.data      = rec + headerSize;
+        // fixed size records are padded with zeros past the message
+        msg.len = recSize_ ? strnlen(msg.data, len) : len;
+        offset_ += ROUND_UP(headerSize + len, CACHE_LINE_SIZE);
+        return true;
+    }
+
+  private:
+    int fd_{-1};
+    uint64_t size_{0};
+    char* base_{nullptr};
+    uint64_t recSize_{0};
+    uint64_t offset_{0};
+    uint64_t end_{0};
+    std::ifstream in_;
+    std::string line_;
+};
+
+} // namespace trading
+} // namespace miye
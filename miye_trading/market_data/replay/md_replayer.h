@@ -0,0 +1,204 @@
+#pragma once
+
+#include "capture_reader.h"
+#include "libcore/time/hdr_histogram.hpp"
+#include "libcore/utils/crc32.hpp"
+#include "market_data/md_thread.h"
+
+#include <immintrin.h>
+#include <iomanip>
+#include <iostream>
+#include <stdint.h>
+#include <string>
+#include <time.h>
+
+namespace miye
+{
+namespace trading
+{
+
+enum class ReplayMode : uint8_t
+{
+    ORIGINAL = 0, // the gaps between messages as they were captured
+    SCALED,       // the captured gaps divided by the speed
+    MAX_SPEED     // no waiting
+};
+
+inline int32_t parseReplayMode(const std::string& name, ReplayMode& mode)
+{
+    if (name == "original")
+    {
+        mode = ReplayMode::ORIGINAL;
+    }
+    else if (name == "scaled")
+    {
+        mode = ReplayMode::SCALED;
+    }
+    else if (name == "max")
+    {
+        mode = ReplayMode::MAX_SPEED;
+    }
+    else
+    {
+        std::cout << "ERROR unknown replay mode:" << name << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Holds each message back until it is due: the capture time since the
+ * first message over speed has passed on the monotonic clock. Sleeps while
+ * more than SpinNs is left, spins the rest. Messages without a capture
+ * time are never held back.
+ */
+class ReplayPacer
+{
+  public:
+    static const constexpr uint64_t SpinNs{100'000};
+
+    ReplayPacer(ReplayMode mode, double speed = 1.0)
+        : mode_(mode), speed_(mode == ReplayMode::SCALED && speed > 0 ? speed : 1.0)
+    {
+    }
+
+    // returns how late the message is, ns
+    uint64_t wait(uint64_t timestamp)
+    {
+        if (mode_ == ReplayMode::MAX_SPEED || timestamp == 0)
+        {
+            return 0;
+        }
+        auto now = mdNowNs();
+        if (!started_)
+        {
+            started_      = true;
+            wallStart_    = now;
+            captureStart_ = timestamp;
+            return 0;
+        }
+        if (timestamp <= captureStart_)
+        {
+            return 0;
+        }
+        auto const due = wallStart_ + uint64_t((timestamp - captureStart_) / speed_);
+        if (now >= due)
+        {
+            return now - due;
+        }
+        if (due - now > 2 * SpinNs)
+        {
+            auto const sleepNs = due - now - SpinNs;
+            struct timespec ts{time_t(sleepNs / 1'000'000'000), long(sleepNs % 1'000'000'000)};
+            ::nanosleep(&ts, nullptr);
+        }
+        while (mdNowNs() < due)
+        {
+            _mm_pause();
+        }
+        return 0;
+    }
+
+  private:
+    ReplayMode mode_;
+    double speed_;
+    bool started_{false};
+    uint64_t wallStart_{0};
+    uint64_t captureStart_{0};
+};
+
+using ReplayHistogram = time::hdr_histogram<>;
+
+struct ReplayStats
+{
+    uint64_t messages{0};
+    uint64_t bytes{0};
+    uint64_t startNs{0};
+    uint64_t endNs{0};
+    ReplayHistogram handleNs; // sink call per message
+    ReplayHistogram lateNs;   // behind schedule when due, paced modes only
+
+    double getSeconds() const { return endNs > startNs ? (endNs - startNs) / 1e9 : 0.0; }
+    double getMessagesPerSec() const { return getSeconds() > 0 ? messages / getSeconds() : 0.0; }
+};
+
+template <typename OS>
+void printHistogram(OS& os, const char* name, const ReplayHistogram& h)
+{
+    os << name << " count:" << h.count() << " mean:" << std::fixed << std::setprecision(1) << h.mean()
+       << " min:" << h.min() << " p50:" << h.value_at_percentile(50) << " p90:" << h.value_at_percentile(90)
+       << " p99:" << h.value_at_percentile(99) << " p99.9:" << h.value_at_percentile(99.9) << " max:" << h.max()
+       << std::endl;
+}
+
+template <typename OS>
+void printReplayStats(OS& os, const ReplayStats& stats)
+{
+    os << "messages:" << stats.messages << " bytes:" << stats.bytes << " seconds:" << std::fixed
+       << std::setprecision(3) << stats.getSeconds() << " msgs/sec:" << std::setprecision(0)
+       << stats.getMessagesPerSec() << " MB/sec:" << std::setprecision(1)
+       << (stats.getSeconds() > 0 ? stats.bytes / stats.getSeconds() / 1e6 : 0.0) << std::endl;
+    printHistogram(os, "handle_ns", stats.handleNs);
+    if (stats.lateNs.count())
+    {
+        printHistogram(os, "late_ns", stats.lateNs);
+    }
+}
+
+/*
+ * Feeds every message of a capture to sink(data, len, timestamp), the
+ * shape of dinobot's websocket::parse_json, paced by the pacer. The clock
+ * is read around each sink call for the handle histogram.
+ */
+template <typename Sink>
+void replayCapture(CaptureReader& reader, ReplayPacer& pacer, Sink& sink, ReplayStats& stats)
+{
+    CaptureMessage msg;
+    if (!stats.startNs)
+    {
+        stats.startNs = mdNowNs();
+    }
+    while (reader.next(msg))
+    {
+        auto const late = pacer.wait(msg.timestamp);
+        if (late)
+        {
+            stats.lateNs.record(late);
+        }
+        auto const t0 = mdNowNs();
+        sink(msg.data, msg.len, msg.timestamp);
+        auto const t1 = mdNowNs();
+        stats.handleNs.record(t1 - t0);
+        ++stats.messages;
+        stats.bytes += msg.len;
+    }
+    stats.endNs = mdNowNs();
+}
+
+/*
+ * crc32 over the price and quantity units of the non empty levels, bids
+ * best first then asks, equal books give equal checksums whatever parser
+ * built them
+ */
+inline uint32_t bookChecksum(const OrderBook& book)
+{
+    uint32_t crc{0};
+    for (auto side : {Side::BUY, Side::SELL})
+    {
+        auto const count = book.getLevelCount(side);
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto const& lvl = book.getLevel(side, int32_t(i));
+            if (lvl.getQuantity().units() == 0)
+            {
+                continue;
+            }
+            int64_t const units[2] = {lvl.getPrice().units(), lvl.getQuantity().units()};
+            crc                    = utils::crc32(crc, units, sizeof(units));
+        }
+    }
+    return crc;
+}
+
+} // namespace trading
+} // namespace miye
@@ -0,0 +1,306 @@
+/*
+ * order_messages.hpp
+ * purpose: order entry records exchanged between strategies and an order
+ * gateway over mmap qstreams
+ *
+ * Every record is a fixed order_msg::msg_size bytes, so request and response
+ * streams are opened with recordsize=64 and a reader dispatches on type.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <ostream>
+
+#include "libcore/types/types.hpp"
+
+namespace miye
+{
+namespace types
+{
+namespace message
+{
+
+enum class msg_type_t : uint8_t
+{
+    undefined = 0,
+    order_insert,
+    order_cancel,
+    order_replace,
+    order_receipt,
+    order_booked,
+    order_executed,
+    order_cancelled,
+    order_rejected
+};
+
+enum class side_t : uint8_t
+{
+    undefined = 0,
+    buy,
+    sell
+};
+
+enum class duration_t : uint8_t
+{
+    undefined = 0,
+    day,
+    ioc,
+    gtc
+};
+
+enum class reject_reason_t : uint8_t
+{
+    undefined = 0,
+    parameter,   // exchange did not like the order
+    closed,      // market or instrument not trading
+    risk,        // pre-trade risk in the gateway
+    session,     // no FIX session to send it on
+    unknown_order
+};
+
+enum class cancel_reason_t : uint8_t
+{
+    undefined = 0,
+    strategy,
+    replace,  // first half of a replace
+    exchange  // unsolicited
+};
+
+inline const char* to_english(msg_type_t v)
+{
+    switch (v)
+    {
+    case msg_type_t::order_insert:
+        return "order_insert";
+    case msg_type_t::order_cancel:
+        return "order_cancel";
+    case msg_type_t::order_replace:
+        return "order_replace";
+    case msg_type_t::order_receipt:
+        return "order_receipt";
+    case msg_type_t::order_booked:
+        return "order_booked";
+    case msg_type_t::order_executed:
+        return "order_executed";
+    case msg_type_t::order_cancelled:
+        return "order_cancelled";
+    case msg_type_t::order_rejected:
+        return "order_rejected";
+    default:
+        return ENUM_UNKNOWN;
+    }
+}
+
+inline const char* to_english(side_t v)
+{
+    switch (v)
+    {
+    case side_t::buy:
+        return "buy";
+    case side_t::sell:
+        return "sell";
+    default:
+        return ENUM_UNKNOWN;
+    }
+}
+
+inline const char* to_english(duration_t v)
+{
+    switch (v)
+    {
+    case duration_t::day:
+        return "day";
+    case duration_t::ioc:
+        return "ioc";
+    case duration_t::gtc:
+        return "gtc";
+    default:
+        return ENUM_UNKNOWN;
+    }
+}
+
+inline const char* to_english(reject_reason_t v)
+{
+    switch (v)
+    {
+    case reject_reason_t::parameter:
+        return "parameter";
+    case reject_reason_t::closed:
+        return "closed";
+    case reject_reason_t::risk:
+        return "risk";
+    case reject_reason_t::session:
+        return "session";
+    case reject_reason_t::unknown_order:
+        return "unknown_order";
+    default:
+        return ENUM_UNKNOWN;
+    }
+}
+
+inline std::ostream& operator<<(std::ostream& os, msg_type_t v) { return os << to_english(v); }
+inline std::ostream& operator<<(std::ostream& os, side_t v) { return os << to_english(v); }
+inline std::ostream& operator<<(std::ostream& os, duration_t v) { return os << to_english(v); }
+inline std::ostream& operator<<(std::ostream& os, reject_reason_t v) { return os << to_english(v); }
+
+/*
+ * common head of all order records. order_key is the strategy's id for the
+ * order: session and strategy in the key route responses back, the whole
+ * key is unique across strategies so the gateway uses it as ClOrdID
+ */
+struct order_msg
+{
+    constexpr static const size_t msg_size = 64;
+
+    msg_type_t type{};
+    version_t version{};
+    session_t session{};
+    instrument_id_t instrument{};
+    order_key_t order_key{};
+    order_key_t cl_order_key{};
+    sequence_t sequence{};
+    uint32_t flags{};
+};
+
+struct order_insert : order_msg
+{
+    constexpr static const msg_type_t msg_type   = msg_type_t::order_insert;
+    constexpr static const version_t msg_version = 1;
+
+    uint64_t md_key{}; // md event that triggered the order, for tick to trade
+    double price{};
+    quantity_t volume{};
+    uint32_t account{};
+    side_t side{};
+    duration_t duration{};
+};
+
+struct order_cancel : order_msg
+{
+    constexpr static const msg_type_t msg_type   = msg_type_t::order_cancel;
+    constexpr static const version_t msg_version = 1;
+
+    side_t side{};
+    cancel_reason_t reason{};
+};
+
+// cancel of order_key and insert of cl_order_key in one request
+struct order_replace : order_msg
+{
+    constexpr static const msg_type_t msg_type   = msg_type_t::order_replace;
+    constexpr static const version_t msg_version = 1;
+
+    double price{};
+    quantity_t volume{};
+    side_t side{};
+    duration_t duration{};
+};
+
+// gateway has the request on the wire
+struct order_receipt : order_msg
+{
+    constexpr static const msg_type_t msg_type   = msg_type_t::order_receipt;
+    constexpr static const version_t msg_version = 1;
+
+    uint64_t om_receive_time{};
+    uint64_t om_sent_time{};
+};
+
+struct order_booked : order_msg
+{
+    constexpr static const msg_type_t msg_type   = msg_type_t::order_booked;
+    constexpr static const version_t msg_version = 1;
+
+    exchange_key_t exchange_key{};
+    double price{};
+    quantity_t volume{};
+    uint32_t account{};
+    side_t side{};
+    duration_t duration{};
+};
+
+struct order_executed : order_msg
+{
+    constexpr static const msg_type_t msg_type   = msg_type_t::order_executed;
+    constexpr static const version_t msg_version = 1;
+
+    match_id_t match_id{};
+    double executed_price{};
+    quantity_t executed_volume{};
+    quantity_t leaves_volume{};
+    side_t side{};
+};
+
+struct order_cancelled : order_msg
+{
+    constexpr static const msg_type_t msg_type   = msg_type_t::order_cancelled;
+    constexpr static const version_t msg_version = 1;
+
+    quantity_t cancelled_volume{};
+    side_t side{};
+    cancel_reason_t reason{};
+};
+
+struct order_rejected : order_msg
+{
+    constexpr static const msg_type_t msg_type   = msg_type_t::order_rejected;
+    constexpr static const version_t msg_version = 1;
+
+    msg_type_t request_type{}; // what was rejected
+    reject_reason_t reason{};
+    quantity_t rejected_volume{};
+    char reason_text[12]{};
+
+    void set_text(const char* text, size_t len)
+    {
+        len = std::min(len, sizeof(reason_text) - 1);
+        std::memcpy(reason_text, text, len);
+        reason_text[len] = '\0';
+    }
+};
+
+// storage for any of the above, what a response queue holds
+struct any_order
+{
+    alignas(8) char data[order_msg::msg_size];
+
+    const order_msg& head() const { return *reinterpret_cast<const order_msg*>(data); }
+};
+
+static_assert(sizeof(order_insert) <= order_msg::msg_size);
+static_assert(sizeof(order_cancel) <= order_msg::msg_size);
+static_assert(sizeof(order_replace) <= order_msg::msg_size);
+static_assert(sizeof(order_receipt) <= order_msg::msg_size);
+static_assert(sizeof(order_booked) <= order_msg::msg_size);
+static_assert(sizeof(order_executed) <= order_msg::msg_size);
+static_assert(sizeof(order_cancelled) <= order_msg::msg_size);
+static_assert(sizeof(order_rejected) <= order_msg::msg_size);
+
+// a record of type T, stamped and zero padded to msg_size for the stream
+template <typename T>
+struct record
+{
+    record()
+    {
+        std::memset(bytes.data, 0, sizeof(bytes.data));
+        auto* m    = new (bytes.data) T{};
+        m->type    = T::msg_type;
+        m->version = T::msg_version;
+    }
+
+    T* operator->() { return reinterpret_cast<T*>(bytes.data); }
+    const T* operator->() const { return reinterpret_cast<const T*>(bytes.data); }
+    T& operator*() { return *reinterpret_cast<T*>(bytes.data); }
+    const void* data() const { return bytes.data; }
+    constexpr static size_t size() { return order_msg::msg_size; }
+
+    any_order bytes;
+};
+
+} // namespace message
+} // namespace types
+} // namespace miye
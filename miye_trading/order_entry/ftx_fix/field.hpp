@@ -10,7 +10,8 @@
 #include "../ftx_fix/double_to_string.hpp"
 #include "../ftx_fix/number_to_string.hpp"
 #include "../ftx_fix/string_const.hpp"
-#include "../ftx_ftx/fix_number_utils.hpp"
+#include "libcore/types/fixed_point.hpp"
+#include "../ftx_fix/fix_number_utils.hpp"
 
 namespace miye::trading::fix
 {
@@ -82,6 +83,25 @@ class Field
         checkSum_ = PrefixCheckSum + fix::calcCheckSum(val_.data() + PrefixLen, len);
         fieldLen_ = PrefixLen + len;
     }
+
+    /*
+     * fixed-point price/qty, integer to ascii with the decimal point put in,
+     * no double formatting. precision is the wire decimals of the instrument,
+     * validated at load, clamped here so toChars never indexes past POW10
+     */
+    template <typename Tag, int32_t Decimals>
+    void set(FixedPoint<Tag, Decimals> v, uint32_t precision) noexcept
+    {
+        assert(precision <= uint32_t(Decimals));
+        precision = std::min(precision, uint32_t(Decimals));
+        auto len = v.toChars(val_.data() + PrefixLen, precision);
+        assert(len <= Len);
+        val_[PrefixLen + len] = FixSeparator;
+        len++;
+
+        checkSum_ = PrefixCheckSum + fix::calcCheckSum(val_.data() + PrefixLen, len);
+        fieldLen_ = PrefixLen + len;
+    }
     void reset() noexcept { init(); }
 
     void init()
@@ -0,0 +1,513 @@
+#pragma once
+
+#include <chrono>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "../ftx_fix/fix_enum.hpp"
+#include "../ftx_fix/fix_index.hpp"
+#include "../ftx_fix/fix_sim_book.hpp"
+#include "../ftx_fix/fix_template.hpp"
+#include "../ftx_fix/fix_utils.hpp"
+#include "../ftx_fix/ftx_fix_reader.hpp"
+#include "../ftx_fix/ftx_fix_writer.hpp"
+#include "../ftx_fix/time_utils.hpp"
+
+namespace miye::trading::fix::sim
+{
+
+/*
+ * FIFO of events that come due after a fixed latency, so due times are in
+ * order and only the head is checked. grows when full, which only happens
+ * while the latency is long compared to the message rate
+ */
+template <typename T>
+class DelayQueue
+{
+  public:
+    explicit DelayQueue(size_t capacity = 1 << 16)
+    {
+        size_t n = 16;
+        while (n < capacity)
+        {
+            n <<= 1;
+        }
+        items_.resize(n);
+    }
+
+    void push(uint64_t due, const T& v)
+    {
+        if (tail_ - head_ == items_.size())
+        {
+            grow();
+        }
+        items_[tail_++ & mask()] = Item{due, v};
+    }
+
+    // f(T&) for every item due at now
+    template <typename F>
+    void popDue(uint64_t now, F&& f)
+    {
+        while (head_ != tail_ && items_[head_ & mask()].due <= now)
+        {
+            f(items_[head_++ & mask()].value);
+        }
+    }
+
+    bool empty() const noexcept { return head_ == tail_; }
+    size_t size() const noexcept { return tail_ - head_; }
+
+  private:
+    struct Item
+    {
+        uint64_t due{};
+        T value{};
+    };
+
+    size_t mask() const noexcept { return items_.size() - 1; }
+
+    void grow()
+    {
+        std::vector<Item> items(items_.size() * 2);
+        for (size_t i = 0; head_ + i != tail_; ++i)
+        {
+            items[i] = items_[(head_ + i) & mask()];
+        }
+        tail_ -= head_;
+        head_ = 0;
+        items_.swap(items);
+    }
+
+    std::vector<Item> items_;
+    size_t head_{};
+    size_t tail_{};
+};
+
+/*
+ * Exchange end of an FTX FIX session for load and round trip tests of
+ * FixSession and the order gateway: Logon, Heartbeat, TestRequest, Logout,
+ * NewOrderSingle and OrderCancelRequest in, ExecutionReport and
+ * OrderCancelReject out, matched against a SimBook.
+ *
+ * Requests take effect ackLatency after they are read, fills go out
+ * fillLatency after the match. Everything rendered is appended to one
+ * buffer the caller writes to the socket once per read, which is what
+ * keeps loopback throughput at millions of messages a second.
+ */
+class FixAcceptor
+{
+  public:
+    constexpr static const size_t MaxMsgLen = 1024;
+
+    struct Config
+    {
+        std::string senderCompId{"FTX"};
+        uint64_t ackLatencyNs{};
+        uint64_t fillLatencyNs{};
+        uint32_t pricePrecision{8};
+    };
+
+  public:
+    FixAcceptor(const Config& config, SimBook& book) : config_(config), book_(book)
+    {
+        out_.resize(1 << 20);
+        in_.reserve(1 << 20);
+        outHeader_.setBeginString("FIX.4.2");
+        outHeader_.setSenderCompID(config_.senderCompId);
+    }
+
+    /*
+     * bytes read off the client connection, a partial message is kept for
+     * the next call. returns false once the client logged out or sent
+     * something that is not FIX
+     */
+    bool consume(const char* data, size_t size, uint64_t now)
+    {
+        stamp(now);
+        const char* p   = data;
+        const char* end = data + size;
+        if (!in_.empty())
+        {
+            in_.insert(in_.end(), data, data + size);
+            p   = in_.data();
+            end = p + in_.size();
+        }
+
+        while (end - p > ReadPrefixLen)
+        {
+            if (p[0] != '8')
+            {
+                loggedOut_ = true;
+                return false;
+            }
+            auto const len = get_single_fix_msg_len(get_fix_body_len(p));
+            if (size_t(end - p) < len)
+            {
+                break;
+            }
+            onMessage(p, len, now);
+            p += len;
+        }
+
+        if (in_.empty())
+        {
+            in_.assign(p, end);
+        }
+        else
+        {
+            in_.erase(in_.begin(), in_.begin() + (p - in_.data()));
+        }
+        return !loggedOut_;
+    }
+
+    // renders whatever came due
+    void poll(uint64_t now)
+    {
+        if (requests_.empty() && fills_.empty())
+        {
+            return;
+        }
+        stamp(now);
+        requests_.popDue(now, [this, now](Request& r) { process(r, now); });
+        fills_.popDue(now, [this](Fill& f) { sendFill(f); });
+    }
+
+    // replayed market data
+    void onMarket(uint32_t instrument, price_t bid, price_t ask, uint64_t now)
+    {
+        stamp(now);
+        book_.onMarket(instrument, bid, ask, [this, now](const SimFill& f) { scheduleFill(f, now); });
+    }
+
+    void onTrade(uint32_t instrument, price_t price, uint64_t now)
+    {
+        stamp(now);
+        book_.onTrade(instrument, price, [this, now](const SimFill& f) { scheduleFill(f, now); });
+    }
+
+    const char* outData() const noexcept { return out_.data(); }
+    size_t outSize() const noexcept { return outUsed_; }
+    void clearOut() noexcept { outUsed_ = 0; }
+
+    bool loggedOn() const noexcept { return loggedOn_; }
+    bool loggedOut() const noexcept { return loggedOut_; }
+    uint64_t messagesIn() const noexcept { return messagesIn_; }
+    uint64_t messagesOut() const noexcept { return messagesOut_; }
+
+  private:
+    // "8=FIX.4.2|9=" and the BodyLength digits
+    constexpr static const long ReadPrefixLen = 16;
+
+    enum class RequestType : uint8_t
+    {
+        New,
+        Cancel
+    };
+
+    struct Request
+    {
+        RequestType type{};
+        bool ioc{};
+        SideEnum side{};
+        uint32_t instrument{};
+        clorder_id_t clOrdId{};
+        quantity_t qty{};
+        price_t price{};
+    };
+
+    struct Fill
+    {
+        SimOrder order{};
+        price_t lastPx{};
+    };
+
+    void onMessage(const char* p, size_t len, uint64_t now)
+    {
+        ++messagesIn_;
+        if (!index_.parse(p, len) || !index_.validate())
+        {
+            return;
+        }
+        header_.reset();
+        header_.read(index_);
+
+        switch (header_.msgType.toEnum<MsgTypeEnum>())
+        {
+        case MsgTypeEnum::OrderSingle:
+            onNewOrderSingle(now);
+            break;
+        case MsgTypeEnum::OrderCancelRequest:
+            onOrderCancelRequest(now);
+            break;
+        case MsgTypeEnum::Logon:
+            onLogon();
+            break;
+        case MsgTypeEnum::TestRequest:
+            onTestRequest();
+            break;
+        case MsgTypeEnum::Logout:
+            onLogout();
+            break;
+        case MsgTypeEnum::HeartBeat:
+        default:
+            break;
+        }
+    }
+
+    void onLogon()
+    {
+        outHeader_.setTargetCompID(header_.senderCompId.getBegin(), header_.senderCompId.getLen());
+        seqNum_   = 0;
+        loggedOn_ = true;
+
+        Logon msg;
+        msg.setEncryptMethod(EncryptMethodEnum::None);
+        msg.setHeartbtlnt(30);
+        send(MsgTypeEnum::Logon, msg);
+    }
+
+    void onLogout()
+    {
+        Logout msg;
+        send(MsgTypeEnum::Logout, msg);
+        loggedOn_  = false;
+        loggedOut_ = true;
+    }
+
+    void onTestRequest()
+    {
+        TestRequestReader r;
+        Heartbeat msg;
+        if (index_.get(r.testReqId))
+        {
+            msg.setTestReqID(r.testReqId.getBegin(), r.testReqId.getLen());
+        }
+        send(MsgTypeEnum::HeartBeat, msg);
+    }
+
+    void onNewOrderSingle(uint64_t now)
+    {
+        newOrderReader_.reset();
+        newOrderReader_.read(index_);
+        auto const& r = newOrderReader_;
+
+        Request req;
+        req.type       = RequestType::New;
+        req.clOrdId    = r.clOrdId.toInteger<clorder_id_t>();
+        req.side       = r.side.toEnum<SideEnum>();
+        req.qty        = r.orderQty.toInteger<quantity_t>();
+        req.price      = r.price.toFloatingPoint<double>();
+        req.ioc        = !r.timeInForce.isNull() && r.timeInForce.toEnum<TimeInforceEnum>() == TimeInforceEnum::FillAndKill;
+        auto const ins = book_.findInstrument(std::string_view(r.symbol.getBegin(), r.symbol.getLen()));
+        if (ins < 0 || req.qty == 0 || (req.side != SideEnum::Buy && req.side != SideEnum::Sell))
+        {
+            sendReject(req, r.symbol.getBegin(), r.symbol.getLen(), "invalid order");
+            return;
+        }
+        req.instrument = uint32_t(ins);
+        schedule(req, now);
+    }
+
+    void onOrderCancelRequest(uint64_t now)
+    {
+        cancelReader_.reset();
+        cancelReader_.read(index_);
+        auto const& r = cancelReader_;
+
+        Request req;
+        req.type    = RequestType::Cancel;
+        req.clOrdId = r.origClOrdId.isNull() ? r.clOrdId.toInteger<clorder_id_t>()
+                                             : r.origClOrdId.toInteger<clorder_id_t>();
+        schedule(req, now);
+    }
+
+    void schedule(const Request& req, uint64_t now)
+    {
+        if (config_.ackLatencyNs == 0 && requests_.empty())
+        {
+            process(req, now);
+            return;
+        }
+        requests_.push(now + config_.ackLatencyNs, req);
+    }
+
+    void process(const Request& req, uint64_t now)
+    {
+        if (req.type == RequestType::Cancel)
+        {
+            processCancel(req);
+            return;
+        }
+
+        SimOrder o;
+        o.exchange_key.key = ++orderId_;
+        o.instrument       = req.instrument;
+        o.side             = req.side;
+        o.price            = req.price;
+        o.qty              = req.qty;
+        o.clord_id         = req.clOrdId;
+
+        if (book_.get(req.clOrdId))
+        {
+            sendReject(req, nullptr, 0, "duplicate ClOrdID");
+            return;
+        }
+
+        // the ack goes out before any fill it triggers
+        sendExecution(o, OrdStatusEnum::NewOrderAck, o.qty, 0, 0, 0);
+        auto const result = book_.newOrder(SimOrder(o), req.ioc, [this, now](const SimFill& f) { scheduleFill(f, now); });
+        if (result == SimBook::Result::Cancelled)
+        {
+            sendExecution(o, OrdStatusEnum::CancelAck, 0, 0, 0, 0);
+        }
+        else if (result == SimBook::Result::Rejected)
+        {
+            sendReject(req, nullptr, 0, "book full");
+        }
+    }
+
+    void processCancel(const Request& req)
+    {
+        auto const* o = book_.get(req.clOrdId);
+        if (!o)
+        {
+            OrderCancelReject msg;
+            msg.setOrderID(uint64_t(0));
+            msg.setClOrdID(req.clOrdId);
+            msg.setOrigClOrdID(req.clOrdId);
+            msg.setOrdStatus(OrdStatusEnum::Rejected);
+            msg.setCxlRejResponseTo('1');
+            msg.setCxlRejReason(1u); // unknown order, or too late: filled already
+            send(MsgTypeEnum::OrderCancelReject, msg);
+            return;
+        }
+        auto const order = *o;
+        book_.remove(req.clOrdId);
+        sendExecution(order, OrdStatusEnum::CancelAck, 0, 0, 0, 0);
+    }
+
+    void scheduleFill(const SimFill& f, uint64_t now)
+    {
+        const Fill fill{f.order, f.price};
+        if (config_.fillLatencyNs == 0 && fills_.empty())
+        {
+            sendFill(fill);
+            return;
+        }
+        fills_.push(now + config_.fillLatencyNs, fill);
+    }
+
+    // fills are always of the whole order
+    void sendFill(const Fill& f)
+    {
+        sendExecution(f.order, OrdStatusEnum::OrderFullyFilled, 0, f.order.qty, f.order.qty, f.lastPx);
+    }
+
+    void sendExecution(const SimOrder& o, OrdStatusEnum status, quantity_t leaves, quantity_t cum, quantity_t lastQty,
+                       price_t lastPx)
+    {
+        auto& msg = execReport_;
+        msg.reset();
+        msg.setOrderID(o.exchange_key.key);
+        msg.setClOrdID(o.clord_id);
+        msg.setExecID(++execId_);
+        msg.setExecType(status);
+        msg.setOrdStatus(status);
+        msg.setSymbol(book_.symbol(o.instrument));
+        msg.setSide(o.side);
+        msg.setOrderQty(o.qty);
+        msg.setPrice(o.price, config_.pricePrecision);
+        msg.setCumQty(cum);
+        msg.setLeavesQty(leaves);
+        if (lastQty)
+        {
+            msg.setLastQty(lastQty);
+            msg.setLastPx(lastPx, config_.pricePrecision);
+            msg.setAvgPx(lastPx, config_.pricePrecision);
+        }
+        send(MsgTypeEnum::ExecutionReport, msg);
+    }
+
+    void sendReject(const Request& req, const char* symbol, size_t symbolLen, const char* text)
+    {
+        auto& msg = execReport_;
+        msg.reset();
+        msg.setOrderID(uint64_t(0));
+        msg.setClOrdID(req.clOrdId);
+        msg.setExecID(++execId_);
+        msg.setExecType(OrdStatusEnum::Rejected);
+        msg.setOrdStatus(OrdStatusEnum::Rejected);
+        if (symbolLen)
+        {
+            msg.setSymbol(symbol, std::min(symbolLen, size_t(16)));
+        }
+        msg.setOrderQty(req.qty);
+        msg.setOrdRejReason(0u);
+        msg.setText(text, std::strlen(text));
+        send(MsgTypeEnum::ExecutionReport, msg);
+    }
+
+    template <typename Msg>
+    void send(MsgTypeEnum type, Msg& msg)
+    {
+        if (out_.size() - outUsed_ < MaxMsgLen)
+        {
+            out_.resize(out_.size() * 2);
+        }
+        outHeader_.setMsgType(type);
+        outHeader_.setMsgSeqNum(++seqNum_);
+        outHeader_.setBodyLength(outHeader_.calcLen() + msg.calcLen());
+
+        char* const begin = out_.data() + outUsed_;
+        char* p           = outHeader_.render(begin);
+        p                 = msg.render(p);
+        tail_.set(calcCheckSum(begin, p - begin) % 256);
+        outUsed_ += p - begin + tail_.render(p);
+        tail_.reset();
+        ++messagesOut_;
+    }
+
+    // SendingTime changes once a millisecond, not per message
+    void stamp(uint64_t now)
+    {
+        if (now - stampedAt_ >= 1'000'000)
+        {
+            time_utils::to_time_str(timestamp_, std::chrono::high_resolution_clock::now());
+            outHeader_.setSendingTime(timestamp_);
+            stampedAt_ = now;
+        }
+    }
+
+  private:
+    Config config_;
+    SimBook& book_;
+
+    FixIndex index_;
+    StandardHeaderReader header_;
+    NewOrderSingleReader newOrderReader_;
+    OrderCancelRequestReader cancelReader_;
+
+    ToFtxStandardHeader outHeader_;
+    ExecutionReport execReport_;
+    CheckSumField tail_;
+    std::string timestamp_ = std::string(OrderTemplateWidths::SendingTime, '0');
+    uint64_t stampedAt_{};
+
+    std::vector<char> in_;
+    std::vector<char> out_;
+    size_t outUsed_{};
+
+    DelayQueue<Request> requests_;
+    DelayQueue<Fill> fills_;
+
+    uint32_t seqNum_{};
+    order_id_t orderId_{};
+    uint64_t execId_{};
+    uint64_t messagesIn_{};
+    uint64_t messagesOut_{};
+    bool loggedOn_{};
+    bool loggedOut_{};
+};
+
+} // namespace miye::trading::fix::sim
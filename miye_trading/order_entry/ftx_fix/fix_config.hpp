@@ -1,5 +1,5 @@
 #pragma once
-#include <iosfwd>
+#include <ostream>
 #include <string>
 
 namespace miye::trading::fix
@@ -131,12 +131,12 @@ enum class OrdStatusEnum : char
 {
     NewOrderAck      = '0',
     PartialFill      = '1',
-    OrderFullyFilled = '3',
+    OrderFullyFilled = '2',
     CancelAck        = '4',
     ModifyAck        = '5',
     PendingCancel    = '6',
     //    Stopped            = '7',
-    //    Rejected           = '8',
+    Rejected         = '8',
     //    Suspended          = '9',
     PendingNew = 'A',
     //    Calculated         = 'B',
@@ -0,0 +1,308 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <stdint.h>
+
+#include <emmintrin.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "../ftx_fix/field_ptr.hpp"
+
+namespace miye::trading::fix
+{
+
+/*
+ * One pass index of a whole FIX message. The scanner compares 64 bytes at a
+ * time against SOH and '=' (SSE2, AVX2 when built for it) and walks the two
+ * bit masks, so the per byte loop of FixIstream::getCurrent only runs over
+ * the tag digits. The byte sum for CheckSum comes out of the same pass
+ * (psadbw).
+ *
+ * Every field lands in fields_ in message order, the first occurrence of a
+ * tag is also put in a small open addressing table so readers fetch fields
+ * by tag instead of switching over a stream. The table is stamped with a
+ * generation per message, nothing is cleared between messages.
+ */
+class FixIndex
+{
+  public:
+    constexpr static const uint32_t MaxFields = 255;
+    constexpr static const uint32_t BlockSize = 64;
+
+    struct Entry
+    {
+        FixId_t tag{};
+        uint32_t offset{}; // of the value
+        uint32_t len{};
+    };
+
+  public:
+    /*
+     * indexes [begin, begin + len), false if a field is malformed or there
+     * are more than MaxFields. the message must stay alive while in use
+     */
+    bool parse(const char* begin, size_t len) noexcept
+    {
+        begin_ = begin;
+        len_   = len;
+        nextGeneration();
+
+        // kept in a local so the compiler holds it in registers, the
+        // Entry stores could otherwise alias members
+        Scan scan{};
+        size_t pos = 0;
+        bool ok    = true;
+        for (; ok && pos + BlockSize <= len; pos += BlockSize)
+        {
+            ok = scanBlock(scan, begin + pos, pos, BlockSize);
+        }
+        if (ok && pos < len)
+        {
+            // zero padded copy, never read past the caller's buffer
+            alignas(BlockSize) char tail[BlockSize]{};
+            std::memcpy(tail, begin + pos, len - pos);
+            ok = scanBlock(scan, tail, pos, len - pos);
+        }
+        count_   = scan.count;
+        byteSum_ = scan.byteSum;
+        return ok && scan.fieldStart == len;
+    }
+
+    /*
+     * BodyLength (9) counts from after its own SOH up to "10=", CheckSum (10)
+     * is the byte sum of everything before "10=" modulo 256
+     */
+    bool validate() const noexcept
+    {
+        if (count_ < 3 || fields_[0].tag != 8 || fields_[1].tag != 9 || fields_[count_ - 1].tag != 10)
+        {
+            return false;
+        }
+        auto const& bodyLength = fields_[1];
+        auto const& checkSum   = fields_[count_ - 1];
+        const uint32_t bodyBegin = bodyLength.offset + bodyLength.len + 1;
+        const uint32_t trailer   = checkSum.offset - 3; // "10="
+        if (toUInteger<uint32_t>(begin_ + bodyLength.offset, bodyLength.len) != trailer - bodyBegin)
+        {
+            return false;
+        }
+
+        uint32_t trailerSum{};
+        for (size_t i = trailer; i < len_; ++i)
+        {
+            trailerSum += uint8_t(begin_[i]);
+        }
+        return checkSum.len == 3 &&
+               toUInteger<uint32_t>(begin_ + checkSum.offset, 3) == (byteSum_ - trailerSum) % 256;
+    }
+
+    const Entry* find(FixId_t tag) const noexcept
+    {
+        for (uint32_t h = hash(tag);; h = (h + 1) & HashMask)
+        {
+            const uint32_t slot = table_[h];
+            if ((slot >> 8) != generation_)
+            {
+                return nullptr;
+            }
+            auto const& e = fields_[slot & 0xff];
+            if (e.tag == tag)
+            {
+                return &e;
+            }
+        }
+    }
+
+    // points f at the field if the message has it, else leaves it alone
+    template <uint32_t ID>
+    bool get(FieldPtr<ID>& f) const noexcept
+    {
+        if (auto const* e = find(ID))
+        {
+            f.setBegin(begin_ + e->offset);
+            f.setLen(e->len);
+            return true;
+        }
+        return false;
+    }
+
+    uint32_t size() const noexcept { return count_; }
+    // offset just past the SOH of field i
+    uint32_t endOf(uint32_t i) const noexcept { return fields_[i].offset + fields_[i].len + 1; }
+    const Entry& operator[](uint32_t i) const noexcept { return fields_[i]; }
+    const char* data() const noexcept { return begin_; }
+    size_t length() const noexcept { return len_; }
+
+  private:
+    constexpr static const uint32_t HashSize = 1024; // load <= 1/4
+    constexpr static const uint32_t HashMask = HashSize - 1;
+
+    static uint32_t hash(FixId_t tag) noexcept { return (tag * 2654435761u) >> 22; }
+
+    void nextGeneration() noexcept
+    {
+        if (++generation_ == (1u << 24))
+        {
+            table_.fill(0);
+            generation_ = 1;
+        }
+    }
+
+    void insert(uint32_t idx) noexcept
+    {
+        const FixId_t tag = fields_[idx].tag;
+        for (uint32_t h = hash(tag);; h = (h + 1) & HashMask)
+        {
+            const uint32_t slot = table_[h];
+            if ((slot >> 8) != generation_)
+            {
+                table_[h] = (generation_ << 8) | idx;
+                return;
+            }
+            if (fields_[slot & 0xff].tag == tag)
+            {
+                return; // repeating group, keep the first
+            }
+        }
+    }
+
+    static uint64_t mask64(const char* p, char c) noexcept
+    {
+#ifdef __AVX2__
+        const __m256i needle = _mm256_set1_epi8(c);
+        const __m256i a      = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        const __m256i b      = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+        const uint64_t lo    = uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, needle)));
+        const uint64_t hi    = uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(b, needle)));
+        return lo | (hi << 32);
+#else
+        const __m128i needle = _mm_set1_epi8(c);
+        uint64_t m{};
+        for (int i = 0; i < 4; ++i)
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * i));
+            m |= uint64_t(uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, needle))) & 0xffff) << (16 * i);
+        }
+        return m;
+#endif
+    }
+
+    static uint32_t sum64(const char* p) noexcept
+    {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i acc        = zero;
+        for (int i = 0; i < 4; ++i)
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * i));
+            acc             = _mm_add_epi64(acc, _mm_sad_epu8(v, zero));
+        }
+        return uint32_t(_mm_cvtsi128_si32(acc) + _mm_cvtsi128_si32(_mm_unpackhi_epi64(acc, acc)));
+    }
+
+    // bits n and up
+    static uint64_t fromBit(uint32_t n) noexcept { return n >= 64 ? 0 : ~((1ULL << n) - 1); }
+
+    struct Scan
+    {
+        uint32_t fieldStart;
+        uint32_t eqPos;
+        uint32_t count;
+        uint32_t byteSum;
+        bool haveEq;
+    };
+
+    // bits of the block at or after the start of the current field
+    static uint64_t fromField(const Scan& scan, size_t base) noexcept
+    {
+        return scan.fieldStart <= base ? ~0ULL : fromBit(uint32_t(scan.fieldStart - base));
+    }
+
+    /*
+     * block holds bytes [base, base + valid) of the message. a field may
+     * straddle blocks, the scan state carries over
+     */
+    bool scanBlock(Scan& scan, const char* block, size_t base, size_t valid) noexcept
+    {
+        scan.byteSum += sum64(block);
+        uint64_t soh = mask64(block, '\001');
+        uint64_t eq  = mask64(block, '=');
+        if (valid < BlockSize)
+        {
+            soh &= ~fromBit(uint32_t(valid));
+            eq &= ~fromBit(uint32_t(valid));
+        }
+        eq &= fromField(scan, base);
+
+        while (soh)
+        {
+            const uint32_t bit = __builtin_ctzll(soh);
+            soh &= soh - 1;
+
+            // first '=' of the field, unless an earlier block had it
+            if (!scan.haveEq)
+            {
+                if (!(eq & ~fromBit(bit)))
+                {
+                    return false;
+                }
+                scan.eqPos = uint32_t(base + __builtin_ctzll(eq));
+            }
+            if (!addField(scan, uint32_t(base + bit)))
+            {
+                return false;
+            }
+            // '=' inside the value are not separators
+            eq &= fromBit(bit + 1);
+        }
+        // the field runs on into the next block
+        if (!scan.haveEq && eq)
+        {
+            scan.eqPos  = uint32_t(base + __builtin_ctzll(eq));
+            scan.haveEq = true;
+        }
+        return true;
+    }
+
+    bool addField(Scan& scan, uint32_t end) noexcept
+    {
+        const uint32_t tagLen = scan.eqPos - scan.fieldStart;
+        if (tagLen == 0 || tagLen > 9 || scan.count == MaxFields)
+        {
+            return false;
+        }
+        FixId_t tag{};
+        for (const char* p = begin_ + scan.fieldStart; p != begin_ + scan.eqPos; ++p)
+        {
+            const uint32_t d = uint32_t(*p - '0');
+            if (d > 9)
+            {
+                return false;
+            }
+            tag = tag * 10 + d;
+        }
+
+        auto& e  = fields_[scan.count];
+        e.tag    = tag;
+        e.offset = scan.eqPos + 1;
+        e.len    = end - scan.eqPos - 1;
+        insert(scan.count++);
+        scan.fieldStart = end + 1;
+        scan.haveEq     = false;
+        return true;
+    }
+
+  private:
+    const char* begin_{};
+    size_t len_{};
+    uint32_t count_{};
+    uint32_t byteSum_{};
+    uint32_t generation_{};
+    std::array<Entry, MaxFields + 1> fields_{};
+    std::array<uint32_t, HashSize> table_{};
+};
+
+} // namespace miye::trading::fix
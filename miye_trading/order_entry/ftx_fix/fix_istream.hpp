@@ -1,6 +1,6 @@
 #pragma once
 #include <cassert>
-#include "../ftx_ftx/field_ptr.hpp"
+#include "../ftx_fix/field_ptr.hpp"
 
 namespace miye::trading::fix
 {
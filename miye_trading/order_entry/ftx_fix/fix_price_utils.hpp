@@ -3,6 +3,8 @@
 #include <cstdint>
 
 #include "../ftx_fix/float_utils.hpp"
+#include "libcore/math/fast-math.hpp"
+#include "libcore/types/fixed_point.hpp"
 
 namespace qx
 {
@@ -14,16 +16,30 @@ inline double round_by_tick_and_precision(float value, float tick_size, uint32_t
     double v = value;
     if (tick_size > 0)
     {
-        v = qx::math::utils::to_nearest_tick(value, tick_size);
+        v = (long)((v + tick_size / 2.0) / tick_size) * tick_size;
     }
     if (precision > 0)
     {
-        double m = math::apply_exponent_scaler(1.0, precision);
+        double m = miye::math::apply_exponent_scaler(1.0, int(precision));
         v        = round(v * m) / m;
     }
     return v;
 }
 
+/*
+ * exact version of round_by_tick_and_precision, rounds half away from zero
+ * to the nearest tick on the integer units
+ */
+inline miye::Price round_to_nearest_tick(miye::Price value, miye::Price tick_size)
+{
+    if (tick_size <= miye::Price{})
+    {
+        return value;
+    }
+    auto const half = miye::Price(tick_size.units() / 2);
+    return value < miye::Price{} ? (value - half).ceilTo(tick_size) : (value + half).floorTo(tick_size);
+}
+
 inline int32_t get_precision_digit(float display_factor)
 {
 	constexpr static const float epsilon = 0.00000001;
@@ -90,6 +106,11 @@ inline double apply_price_factor_to_out_price(double price, double display_facto
 	return price / display_factor;
 }
 
+inline miye::Price apply_price_factor_to_out_price(miye::Price price, double display_factor)
+{
+	return display_factor == 1.0 ? price : miye::Price::fromDouble(price.toDouble() / display_factor);
+}
+
 inline double apply_price_factor_to_in_price(double price, double display_factor)
 {
 	return price * display_factor;
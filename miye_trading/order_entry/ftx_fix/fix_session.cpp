@@ -1,20 +1,19 @@
 #include "../ftx_fix/fix_session.hpp"
 
 #include "../ftx_fix/time_utils.hpp"
-#include "../ftx_ftx/fix_number_utils.hpp"
-#include "../ftx_ftx/ftx_fix_reader.hpp"
+#include "../ftx_fix/fix_number_utils.hpp"
+#include "../ftx_fix/ftx_fix_reader.hpp"
 
 namespace miye::trading::fix::ftx
 {
 
 FixSession::~FixSession() { saveSeqNum(); }
 
-void FixSession::saveSeqNum() { fix::utils::save_seq_num_id(sequence_file, seqNum_.getSeqNum(), exchangeSeqNum_); }
+// counters are already in the store mapping, this only forces them to disk
+void FixSession::saveSeqNum() { store_.sync(); }
 
 void FixSession::init(uint32_t seqNum, uint32_t exchSeqNum)
 {
-    static const std::string FUT("FUT");
-
     seqNum_.setSeqNum(seqNum);
     exchangeSeqNum_       = exchSeqNum;
     expectNextExchSeqNum_ = exchangeSeqNum_ + 1;
@@ -23,36 +22,16 @@ void FixSession::init(uint32_t seqNum, uint32_t exchSeqNum)
     // expectNextExchSeqNum_ << std::endl;
 
     /*
-     * StandardHeader to CME common static fields
+     * StandardHeader common static fields
      */
     outHeader_.setBeginString("FIX.4.2");
     outHeader_.setSenderCompID(config_.sender_comp_id);
-    outHeader_.setTargetCompID("FTX");
+    outHeader_.setTargetCompID(config_.target_comp_id);
 
     /*
      * OrderSingleNew common static fields
      */
     newOrder_.setHandInst(HandInstEnum::AutomatedExecution);
-    newOrder_.setCustomerOrFirm(CustomerOrFirmEnum::Customer);
-    newOrder_.setManualOrderIndicator(ManualOrderIndicatorEnum::Automated);
-    newOrder_.setCtiCode(CtiCodeEnum::Cti4);
-    newOrder_.setAccount(config_.account);
-    newOrder_.setSecurityType(FUT);
-
-    /*
-     * OrderCancelRequest static fields
-     */
-    orderCancelRequest_.setAccount(config_.account);
-    orderCancelRequest_.setManualOrderIndicator(ManualOrderIndicatorEnum::Automated);
-
-    /*
-     * OrderCancelReplaceRequest
-     */
-    orderCancelReplaceRequest_.setManualOrderIndicator(ManualOrderIndicatorEnum::Automated);
-    orderCancelReplaceRequest_.setCustomerOrFirm(CustomerOrFirmEnum::Firm);
-    orderCancelReplaceRequest_.setAccount(config_.account);
-    orderCancelReplaceRequest_.setSecurityType(FUT);
-    orderCancelReplaceRequest_.setCtiCode(CtiCodeEnum::Cti4);
 }
 
 size_t FixSession::logon()
@@ -68,15 +47,11 @@ size_t FixSession::logon()
     //    }
 
     msg.setRawData(config_.password);
-    msg.setRawDataLength(config_.password.length());
     msg.setEncryptMethod(EncryptMethodEnum::None);
 
     // FTX heartbeat interval must set to 30
     constexpr static const std::chrono::seconds HeartBeatInterval = std::chrono::seconds(30);
     msg.setHeartbtlnt(HeartBeatInterval.count());
-    msg.setApplicationSystemName(config_.app_name);
-    msg.setApplicationSystemVendor(config_.system_vendor);
-    msg.setTradingSystemVersion(config_.app_version);
 
     outHeader_.setBodyLength(outHeader_.calcLen() + msg.calcLen());
     auto const len = render(outHeader_, msg);
@@ -91,7 +66,6 @@ size_t FixSession::logout()
     outHeader_.setSendingTime(time_utils::getTime());
 
     Logout msg;
-    msg.setText("bye");
     outHeader_.setBodyLength(outHeader_.calcLen() + msg.calcLen());
     return render(outHeader_, msg);
 }
@@ -165,31 +139,6 @@ size_t FixSession::onTestRequest()
     return render(outHeader_, msg);
 }
 
-size_t FixSession::onSequenceReset(uint32_t exchExpectSeqFromUs)
-{
-    const std::string timestamp = time_utils::getTime();
-
-    outHeader_.setMsgType(MsgTypeEnum::SequenceReset);
-    outHeader_.setSendingTime(timestamp);
-    outHeader_.setPossDupFlag("Y");
-
-    outHeader_.setOrigSendingTime(inFixHeader_.sendingTime.toString());
-    outHeader_.setLastMsgSeqNumProcessed(inFixHeader_.msgSeqNum.toInteger<uint32_t>());
-
-    SequenceReset msg;
-    msg.setGapFillFlag("Y");
-
-    outHeader_.setMsgSeqNum(exchExpectSeqFromUs);
-
-    msg.setNewSeqNo(seqNum_.getSeqNum() + 1);
-    outHeader_.setBodyLength(outHeader_.calcLen() + msg.calcLen());
-    auto const len = render(outHeader_, msg);
-
-    outHeader_.reset();
-    init(seqNum_.getSeqNum(), exchangeSeqNum_);
-    return len;
-}
-
 void FixSession::onHeartBeat()
 {
     HeartbeatReader r;
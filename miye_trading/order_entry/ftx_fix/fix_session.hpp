@@ -2,6 +2,7 @@
 
 #include <cassert>
 #include <chrono>
+#include <memory>
 #include <stdint.h>
 #include <string.h>
 #include <string>
@@ -9,12 +10,15 @@
 
 #include "../ftx_fix/fix_config.hpp"
 #include "../ftx_fix/fix_enum.hpp"
-#include "../ftx_fix/fix_sequence_id_file_parser.hpp"
+#include "../ftx_fix/fix_session_store.hpp"
+#include "../ftx_fix/fix_template.hpp"
 #include "../ftx_fix/fix_utils.hpp"
+#include "../ftx_fix/time_utils.hpp"
 #include "../ftx_fix/ftx_fix_reader.hpp"
 #include "../ftx_fix/ftx_fix_writer.hpp"
 #include "../ftx_fix/seq_num_generator.hpp"
-#include "../ftx_ftx/type_utils.hpp"
+#include "../ftx_fix/type_utils.hpp"
+#include "libcore/utils/reassembly_buffer.hpp"
 
 namespace miye::trading::fix::ftx
 {
@@ -42,21 +46,21 @@ class FixSession
 
     using CheckSum_t = Field<10, 3>;
 
+    // "8=FIX.4.2|9=" and enough of the BodyLength to know the message length
+    constexpr static const size_t ReadPrefixLen = 16;
+
   public:
     explicit FixSession(const fix_config_t& config, const std::string& segment, const std::string& sequence_file,
                         char* out_buffer)
-        : outBuffer_(out_buffer), config_(config), segment_(segment), sequence_file(sequence_file)
+        : outBuffer_(out_buffer), store_(sequence_file), config_(config), segment_(segment)
     {
         assert(!sequence_file.empty());
-        // auto const seq_pair = fix::utils::get_seq_num_id(sequence_file);
 
-        // fix_in_buf = std::make_shared<fundamentals::reassembly_buffer<InBufferSize>>();
+        fixInBuf_ = std::make_unique<fundamentals::reassembly_buffer<InBufferSize>>();
 
-        //        // set expected_exchange_seq to 1 so we accept what ever exchange sequence at logon
-        //        LOG_INFO("[fix session] segment: " << segment << ", loading sequence file: " << sequence_file << ",
-        //        local seq: "
-        //                                           << seq_pair.first << ", exchange seq: " << seq_pair.second);
-        // init(seq_pair.first, 0);
+        // resume where the store left off, a new store starts at 0/0 and
+        // accepts whatever exchange sequence comes at logon
+        init(store_.senderSeqNum(), store_.targetSeqNum());
     }
 
     ~FixSession();
@@ -97,6 +101,29 @@ class FixSession
         return render(outHeader_, newOrder_);
     }
 
+    size_t placeOrder(OrderTypeEnum orderType, TimeInforceEnum tif, uint64_t clOrdId, SideEnum side, Price price,
+                      uint32_t precision, quantity_t qty, const std::string& symbol, const std::string& securityDesc,
+                      const std::string& timestamp)
+    {
+        outHeader_.setMsgSeqNum(seqNum_.getNextSeqNum());
+        outHeader_.setMsgType(MsgTypeEnum::OrderSingle);
+
+        newOrder_.setTimeInForce(tif);
+        newOrder_.setOrdType(orderType);
+
+        assert(!timestamp.empty());
+        newOrder_.setSide(side);
+        if (orderType != OrderTypeEnum::MarketLimitOrder)
+        {
+            newOrder_.setPrice(price, precision);
+        }
+        newOrder_.setOrderQty(qty);
+        newOrder_.setClOrdID(clOrdId);
+
+        outHeader_.setBodyLength(outHeader_.calcLen() + newOrder_.calcLen());
+        return render(outHeader_, newOrder_);
+    }
+
     size_t placeOrder(OrderTypeEnum orderType, TimeInforceEnum tif, uint64_t clOrdId, SideEnum side, uint64_t price,
                       quantity_t qty, const std::string& symbol, const std::string& securityDesc,
                       const std::string& timestamp)
@@ -137,19 +164,109 @@ class FixSession
         return render(outHeader_, orderCancelRequest_);
     }
 
+    /*
+     * template path: the message is rendered once per instrument/side by
+     * initTemplate(), per order only the variable slots are patched
+     */
+    void initTemplate(NewOrderSingleTemplate& tmpl, const std::string& symbol, SideEnum side, OrderTypeEnum orderType,
+                      TimeInforceEnum tif, uint32_t precision, uint32_t qtyPrecision) const
+    {
+        tmpl.init(config_, symbol, side, orderType, tif, precision, qtyPrecision);
+    }
+
+    void initTemplate(OrderCancelRequestTemplate& tmpl) const { tmpl.init(config_); }
+
+    size_t placeOrder(NewOrderSingleTemplate& tmpl, uint64_t clOrdId, Price price, Qty qty,
+                      const std::string& timestamp)
+    {
+        assert(timestamp.size() == OrderTemplateWidths::SendingTime);
+        auto const seqNum = seqNum_.getNextSeqNum();
+        auto const len    = tmpl.render(seqNum, timestamp.data(), clOrdId, price, qty);
+        assert(len <= OutBufferSize);
+        std::memcpy(outBuffer_, tmpl.data(), len);
+        store_.append(seqNum, outBuffer_, len);
+        return len;
+    }
+
+    size_t cancelOrder(OrderCancelRequestTemplate& tmpl, order_id_t orderId, clorder_id_t clOrdId,
+                       const std::string& timestamp)
+    {
+        assert(timestamp.size() == OrderTemplateWidths::SendingTime);
+        auto const seqNum = seqNum_.getNextSeqNum();
+        auto const len    = tmpl.render(seqNum, timestamp.data(), orderId, clOrdId);
+        assert(len <= OutBufferSize);
+        std::memcpy(outBuffer_, tmpl.data(), len);
+        store_.append(seqNum, outBuffer_, len);
+        return len;
+    }
+
+    /*
+     * renders header, msg and CheckSum into outBuffer_ and journals the
+     * message under the sequence number just taken, so it can be resent
+     */
     template <typename Msg>
     size_t render(ToFtxStandardHeader& header, Msg& msg)
+    {
+        auto const len = renderUnjournaled(header, msg);
+        store_.append(seqNum_.getSeqNum(), outBuffer_, len);
+        return len;
+    }
+
+    template <typename Msg>
+    size_t renderUnjournaled(ToFtxStandardHeader& header, Msg& msg)
     {
         char* p = header.render(outBuffer_);
         p       = msg.render(p);
-        // TODO:FIX LEN
-        //        const uint16_t cksum = (header.getCheckSum() + msg.getCheckSum()) % 256;
-        //        tail_.set(cksum);
-        //        auto const tail_len = tail_.render(p);
-        //        auto len            = p - outBuffer_ + tail_len;
-        // ASSERT_MSG(len <= OutBufferSize, DUMP(len) << DUMP(OutBufferSize));
+        tail_.set(calcCheckSum(outBuffer_, p - outBuffer_) % 256);
+        auto const len = p - outBuffer_ + tail_.render(p);
+        assert(len <= OutBufferSize);
         tail_.reset();
-        return 0;
+        return len;
+    }
+
+    /*
+     * serves a ResendRequest from the store: application messages go out
+     * again with PossDupFlag, runs of admin messages (or ones no longer in
+     * the store) are collapsed into SequenceReset-GapFill
+     */
+    template <typename Handler>
+    void onResendRequest(Handler& handler)
+    {
+        ResendRequestReader r;
+        r.read(fixIstream_);
+
+        auto const last  = seqNum_.getSeqNum();
+        auto const begin = std::max(r.beginSeqNo.toInteger<uint32_t>(), 1u);
+        auto end         = r.endSeqNo.toInteger<uint32_t>();
+        if (end == 0 || end > last) // 0 is "up to the latest"
+        {
+            end = last;
+        }
+
+        const std::string timestamp = time_utils::getTime();
+        uint32_t gapBegin{};
+        for (uint32_t seq = begin; seq <= end; ++seq)
+        {
+            auto const msg = store_.get(seq);
+            if (msg.empty() || isAdminMsg(msg))
+            {
+                gapBegin = gapBegin ? gapBegin : seq;
+                continue;
+            }
+            if (gapBegin)
+            {
+                sendGapFill(handler, gapBegin, seq, timestamp);
+                gapBegin = 0;
+            }
+            if (auto const len = store_.renderResend(seq, timestamp, outBuffer_, OutBufferSize))
+            {
+                handler.send_and_log(outBuffer_, len);
+            }
+        }
+        if (gapBegin)
+        {
+            sendGapFill(handler, gapBegin, end + 1, timestamp);
+        }
     }
 
     /*---------------------------------------------------------------------------------
@@ -165,6 +282,14 @@ class FixSession
         expectNextExchSeqNum_ =
             exchangeSeqNum_ + 2; // because we do not wait for gateway logout message, so we assume we receive it.
 
+        // the exchange started a new session, the Logon it answers is our
+        // first message of it and nothing sent before can be resent
+        if (r.isResetSeqNum())
+        {
+            seqNum_.setSeqNum(1);
+            store_.resetSession(1, exchangeSeqNum_);
+        }
+
         inSessionResetSeq_ = true;
         handler.on_logon();
     }
@@ -191,7 +316,7 @@ class FixSession
     {
         auto& reader = executionReportReader_;
 
-        reader.read(fixIstream_);
+        reader.read(fixIndex_);
         auto const orderStatus = reader.ordStatus.toEnum<OrdStatusEnum>();
 
         switch (orderStatus)
@@ -227,15 +352,15 @@ class FixSession
         case OrdStatusEnum::ModifyAck:
             assert(0); // no cancel_replace support
             break;
-            //        case OrdStatusEnum::Rejected: // order level, Nack
-            //        {
-            //            handler.onOrderReject(reader.orderId.toInteger<order_id_t>(),
-            //                                  reader.clOrdId.toInteger<clorder_id_t>(),
-            //                                  reader.orderQty.toInteger<quantity_t>(),
-            //                                  reader.ordRejReason.toInteger<uint32_t>(),
-            //                                  reader.text.toString());
-            //            break;
-            //        }
+        case OrdStatusEnum::Rejected: // order level, Nack
+        {
+            handler.onOrderReject(reader.orderId.toInteger<order_id_t>(),
+                                  reader.clOrdId.toInteger<clorder_id_t>(),
+                                  reader.orderQty.toInteger<quantity_t>(),
+                                  reader.ordRejReason.toInteger<uint32_t>(),
+                                  reader.text.toString());
+            break;
+        }
             //        case OrdStatusEnum::Expired: // Order Elimination
             //        {
             //            // 39=C
@@ -272,20 +397,21 @@ class FixSession
         handler.onSessionLevelReject(seq, text);
     }
 
-    //    template <typename Handler>
-    //    void onOrderCancelReject(Handler& handler)
-    //    {
-    //        auto& reader = orderCancelRejectReader_;
-    //        reader.read(fixIstream_);
-    //        handler.onOrderCancelReject(
-    //            reader.orderId.toInteger<order_id_t>(), reader.clOrdId.toInteger<clorder_id_t>(),
-    //            reader.text.toString());
-    //    }
+    template <typename Handler>
+    void onOrderCancelReject(Handler& handler)
+    {
+        auto& reader = orderCancelRejectReader_;
+        reader.read(fixIndex_);
+        // cancels go out without a ClOrdID of their own, the order is in OrigClOrdID
+        auto const clOrdId = reader.orgiClOrdId.isNull() ? reader.clOrdId.toInteger<clorder_id_t>()
+                                                         : reader.orgiClOrdId.toInteger<clorder_id_t>();
+        handler.onOrderCancelReject(
+            reader.orderId.toInteger<order_id_t>(), clOrdId, reader.cXlRejReason.toInteger<uint32_t>());
+        reader.reset();
+    }
 
     void onHeartBeat();
     size_t onTestRequest();
-    size_t onSequenceReset(uint32_t exchExpectSeqFromUs);
-    void onResendRequest();
 
     template <typename Handler>
     uint32_t processIncomingMsg(Handler& handler, const char* begin, size_t bufLen)
@@ -294,8 +420,16 @@ class FixSession
 
         const char* p = begin;
 
-        fixIstream_.setBuffer(begin, bufLen);
-        inFixHeader_.read(fixIstream_);
+        if (!fixIndex_.parse(begin, bufLen) || !fixIndex_.validate())
+        {
+            // garbled BodyLength/CheckSum, drop it and let the gap check ask for a resend
+            return 0;
+        }
+        inFixHeader_.read(fixIndex_);
+
+        // the session readers not on the index walk the body from its first field
+        auto const headerLen = headerLength();
+        fixIstream_.setBuffer(begin + headerLen, bufLen - headerLen);
 
         auto const& bodyLengthField = inFixHeader_.bodyLength;
         uint32_t fixMsgLen          = 10 + 3 + bodyLengthField.getLen() + bodyLengthField.toInteger<uint32_t>() +
@@ -312,7 +446,6 @@ class FixSession
         }
         else if (arrivedSeqNum == exchangeSeqNum_ + 1) // normal msg update
         {
-            arrivedSeqNum += 1;
             exchangeSeqNum_ = arrivedSeqNum;
         }
         else if (arrivedSeqNum > exchangeSeqNum_ + 1) // gap detected, request resend
@@ -328,18 +461,15 @@ class FixSession
         {
             exchangeSeqNum_ = arrivedSeqNum;
         }
+        store_.setTargetSeqNum(exchangeSeqNum_);
 
         switch (inFixHeader_.msgType.toEnum<MsgTypeEnum>())
         {
         case MsgTypeEnum::Reject: // session level reject
         {
-            //            SessionLevelRejectReader r;
-            //            r.read(fixIstream_);
-            //            LOG_ERROR("MSGW session level order placement reject, RefSeqNum: " <<
-            //            r.refSeqNum.toInteger<uint32_t>()
-            //                                                                               << ", reason: " <<
-            //                                                                               r.text.toString());
-            //            onSessionLevelReject(handler, r.refSeqNum.toInteger<uint32_t>(), r.text.toString());
+            SessionLevelRejectReader r;
+            r.read(fixIstream_);
+            onSessionLevelReject(handler, r.refSeqNum.toInteger<uint32_t>(), r.text.toString());
             break;
         }
         case MsgTypeEnum::ExecutionReport: {
@@ -385,12 +515,7 @@ class FixSession
             break;
         }
         case MsgTypeEnum::ResendRequest: {
-            //            ResendRequestReader r;
-            //            r.read(fixIstream_);
-            //
-            //            auto const exchExpectSeqFromUs = r.beginSeqNo.toInteger<uint32_t>();
-            //            // no fixIstream.reset() ?
-            //            return onSequenceReset(exchExpectSeqFromUs);
+            onResendRequest(handler);
             break;
         }
         default:
@@ -403,62 +528,45 @@ class FixSession
         return 0;
     }
 
-    //    template <typename Handler>
-    //    void consume_tcp_buffer(Handler& handler, const ::qx::qstream::place& plc, bool logged_in)
-    //    {
-    //        static const size_t read_prefix_len = 16;
-    //#if 0
-    //        // if there was leftover junk in the packet after the previous fix message
-    //        // it will remain in the buffer and we have to dump it.
-    //        // is this possible? Testing will tell.
-    //        if(!::strncmp((char*)plc.start, "8=FIX.4.2", 9)) {
-    //            fix_in_buf->clear();
-    //        }
-    //#endif
-    //        fix_in_buf->copy_to_back((char*)plc.start, plc.size);
-    //        if (!logged_in && *fix_in_buf->data() != '8')
-    //        {
-    //            // error messages when not yet logged in are not in fix protocol
-    //            LOG_ERROR("Error msg from exchange on " << DUMP(segment_) << "while not logged in "
-    //                                                    << std::string(fix_in_buf->data(),
-    //                                                    fix_in_buf->buffer_used()));
-    //
-    //            // dump the input buffer in its entirety and get out
-    //            fix_in_buf->clear();
-    //            return;
-    //        }
-    //        // should now be sure to have a fix message at the start of the buffer
-    //        INVARIANT_MSG(*fix_in_buf->data() == '8', DUMP(std::string(fix_in_buf->data(),
-    //        fix_in_buf->buffer_used())));
-    //
-    //        // if we have enough of the message to know its size
-    //        while (fix_in_buf->buffer_used() > read_prefix_len)
-    //        {
-    //            auto const fix_body_len = fix::get_fix_body_len(fix_in_buf->data());
-    //            auto const fix_msg_len  = fix::get_single_fix_msg_len(fix_body_len);
-    //            if (fix_in_buf->buffer_used() < fix_msg_len)
-    //            {
-    //                // still haven't received all fix message yet, append and return to loop
-    //                return;
-    //            }
-    //            else
-    //            {
-    //                INVARIANT_MSG(*fix_in_buf->data() == '8', DUMP(fix_in_buf->data()));
-    //                consume_single_fix(handler, fix_in_buf->data(), fix_msg_len);
-    //                fix_in_buf->remove_from_front(fix_msg_len);
-    //            }
-    //        }
-    //    }
-    //
-    //    template <typename Handler>
-    //    void consume_single_fix(Handler& handler, const char* p, size_t total_len)
-    //    {
-    //        auto const len = processIncomingMsg(handler, p, total_len);
-    //        if (len > 0)
-    //        {
-    //            handler.send_and_log(outBuffer_, len);
-    //        }
-    //    }
+    /*
+     * bytes as read off the socket: complete messages are processed, a
+     * partial one is kept for the next read. replies (heartbeat, resend
+     * request) go straight back through handler.send_and_log
+     */
+    template <typename Handler>
+    void consumeTcpBuffer(Handler& handler, const char* data, size_t size)
+    {
+        auto& buf = *fixInBuf_;
+        buf.copy_to_back(const_cast<char*>(data), size);
+        if (buf.data()[0] != '8')
+        {
+            // error messages when not yet logged in are not in fix protocol
+            handler.log(buf.data(), buf.buffer_used());
+            buf.clear();
+            return;
+        }
+
+        size_t consumed = 0;
+        while (buf.buffer_used() - consumed > ReadPrefixLen)
+        {
+            const char* const p   = buf.data() + consumed;
+            auto const fixBodyLen = get_fix_body_len(p);
+            auto const fixMsgLen  = get_single_fix_msg_len(fixBodyLen);
+            if (buf.buffer_used() - consumed < fixMsgLen)
+            {
+                break; // rest of it comes with the next read
+            }
+            if (auto const len = processIncomingMsg(handler, p, fixMsgLen))
+            {
+                handler.send_and_log(outBuffer_, len);
+            }
+            consumed += fixMsgLen;
+        }
+        if (consumed)
+        {
+            buf.remove_from_front(consumed);
+        }
+    }
 
     void saveSeqNum();
     uint32_t getSeq(const std::string& text);
@@ -467,6 +575,65 @@ class FixSession
     uint32_t getLastSequenceNum() const { return seqNum_.getSeqNum(); }
 
   private:
+    // session level messages are gap filled, never resent
+    static bool isAdminMsg(std::string_view msg) noexcept
+    {
+        auto const type = msg.find("\00135=");
+        if (type == std::string_view::npos || type + 5 >= msg.size() || msg[type + 5] != '\001')
+        {
+            return false;
+        }
+        switch (msg[type + 4])
+        {
+        case '0': // Heartbeat
+        case '1': // TestRequest
+        case '2': // ResendRequest
+        case '3': // Reject
+        case '4': // SequenceReset
+        case '5': // Logout
+        case 'A': // Logon
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    /*
+     * SequenceReset-GapFill over [begin, newSeqNo), sent as the resend of
+     * begin. It is built from the session header alone, what the store
+     * still holds of the gap does not matter, and is not journaled: begin
+     * was journaled when it was first sent
+     */
+    template <typename Handler>
+    void sendGapFill(Handler& handler, uint32_t begin, uint32_t newSeqNo, const std::string& timestamp)
+    {
+        outHeader_.setMsgSeqNum(begin);
+        outHeader_.setMsgType(MsgTypeEnum::SequenceReset);
+        outHeader_.setSendingTime(timestamp);
+        outHeader_.setPossDupFlag('Y');
+        outHeader_.setOrigSendingTime(timestamp);
+
+        SequenceReset msg;
+        msg.setGapFillFlag('Y');
+        msg.setNewSeqNo(newSeqNo);
+        outHeader_.setBodyLength(outHeader_.calcLen() + msg.calcLen());
+        auto const len = renderUnjournaled(outHeader_, msg);
+
+        outHeader_.resetPossDupFlag();
+        outHeader_.resetOrigSendingTime();
+        handler.send_and_log(outBuffer_, len);
+    }
+
+    size_t headerLength() const noexcept
+    {
+        uint32_t i = 0;
+        while (i < fixIndex_.size() && StandardHeaderReader::isHeaderTag(fixIndex_[i].tag))
+        {
+            ++i;
+        }
+        return i == 0 ? 0 : fixIndex_.endOf(i - 1);
+    }
+
     /*
      * Set *static* header fields
      * They will remain same during the application runtime
@@ -477,14 +644,16 @@ class FixSession
     char* outBuffer_{};
 
     SequenceNumGenerator seqNum_{};
+    FixSessionStore store_;
     ToFtxStandardHeader outHeader_;
     NewOrderSingle newOrder_;
     OrderCancelRequest orderCancelRequest_;
     CheckSumField tail_;
 
-    // std::shared_ptr<fundamentals::reassembly_buffer<InBufferSize>> fix_in_buf;
+    std::unique_ptr<fundamentals::reassembly_buffer<InBufferSize>> fixInBuf_;
 
     FixIstream fixIstream_;
+    FixIndex fixIndex_;
     StandardHeaderReader inFixHeader_{};
     ExecutionReportReader executionReportReader_{};
     OrderCancelRejectReader orderCancelRejectReader_{};
@@ -497,7 +666,6 @@ class FixSession
 
     bool inSessionResetSeq_{};
     bool has_sent_replay_{};
-    std::string sequence_file;
 };
 
 } // namespace miye::trading::fix::ftx
@@ -0,0 +1,337 @@
+#pragma once
+
+#include <cassert>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <string_view>
+#include <sys/file.h>
+#include <sys/stat.h>
+
+#include "libcore/essential/assert.hpp"
+#include "libcore/essential/platform_defs.hpp"
+#include "libcore/utils/syscalls_files.hpp"
+#include "libcore/utils/syscalls_mmap.hpp"
+
+#include "../ftx_fix/fix_number_utils.hpp"
+#include "../ftx_fix/ftx_fix_reader.hpp"
+
+namespace miye::trading::fix
+{
+
+/*
+ * Persistent state of one FIX session in a single mmap'd file:
+ *
+ *   [Header][Slot x maxMessages][journal]
+ *
+ * Every outbound message is appended to the journal and the slot of its
+ * MsgSeqNum records where, so a ResendRequest is served from memory. The
+ * sequence numbers live in the header and are updated in place, there is
+ * no syscall per message. The file is sparse, unused journal pages cost
+ * no disk.
+ *
+ * The page cache outlives the process, after a crash the file holds every
+ * store made before it. sync() is only needed against losing the host. A
+ * message is written before its slot and the slot before the header, the
+ * constructor rolls the header forward over slots written after it.
+ *
+ * resetSession() starts a new FIX session. Slots carry the generation
+ * they were written in, bumping it drops them all without touching them.
+ */
+class FixSessionStore
+{
+  public:
+    constexpr static const uint32_t DefaultMaxMessages  = 1u << 20;
+    constexpr static const uint64_t DefaultJournalBytes = 256ull << 20;
+
+  public:
+    /*
+     * opens or creates path. maxMessages/journalBytes size a new file, an
+     * existing one keeps its own
+     */
+    explicit FixSessionStore(const std::string& path, uint32_t maxMessages = DefaultMaxMessages,
+                             uint64_t journalBytes = DefaultJournalBytes)
+    {
+        fd_ = syscalls::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        syscalls::flock(fd_, LOCK_EX | LOCK_NB);
+
+        struct stat64 statinfo;
+        syscalls::fstat64(fd_, &statinfo);
+
+        const bool created = statinfo.st_size == 0;
+        if (created)
+        {
+            size_ = mappingSize(maxMessages, journalBytes);
+            syscalls::ftruncate64(fd_, size_);
+        }
+        else
+        {
+            INVARIANT_MSG(size_t(statinfo.st_size) >= sizeof(Header),
+                          path << " is not a FIX session store " << DUMP(statinfo.st_size));
+            size_ = statinfo.st_size;
+        }
+
+        base_ = static_cast<char*>(syscalls::mmap64(0, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0));
+        header_ = reinterpret_cast<Header*>(base_);
+
+        if (created)
+        {
+            header_->magic        = Magic;
+            header_->maxMessages  = maxMessages;
+            header_->journalBytes = journalBytes;
+            header_->generation   = 1;
+        }
+        INVARIANT_MSG(header_->magic == Magic, path << " is not a FIX session store");
+        INVARIANT_MSG(mappingSize(header_->maxMessages, header_->journalBytes) == size_,
+                      path << " size does not match its header " << DUMP(size_) << DUMP(header_->maxMessages)
+                           << DUMP(header_->journalBytes));
+
+        slots_   = reinterpret_cast<Slot*>(base_ + sizeof(Header));
+        journal_ = base_ + sizeof(Header) + sizeof(Slot) * header_->maxMessages;
+        recover();
+    }
+
+    ~FixSessionStore()
+    {
+        if (base_)
+        {
+            syscalls::munmap(base_, size_);
+            syscalls::close(fd_);
+        }
+    }
+
+    FixSessionStore(const FixSessionStore&) = delete;
+    FixSessionStore& operator=(const FixSessionStore&) = delete;
+
+  public:
+    // last MsgSeqNum sent
+    uint32_t senderSeqNum() const noexcept { return header_->senderSeqNum; }
+    // last MsgSeqNum received
+    uint32_t targetSeqNum() const noexcept { return header_->targetSeqNum; }
+    void setTargetSeqNum(uint32_t seqNum) noexcept { header_->targetSeqNum = seqNum; }
+
+    /*
+     * records outbound message seqNum, sequence numbers must increase. false
+     * once the store is full: the sequence number still advances but the
+     * message can only be gap filled
+     */
+    bool append(uint32_t seqNum, const char* msg, size_t len) noexcept
+    {
+        assert(seqNum > header_->senderSeqNum);
+        const uint64_t tail = header_->tail;
+        const bool fits     = seqNum < header_->maxMessages && tail + len <= header_->journalBytes;
+        if (fits)
+        {
+            std::memcpy(journal_ + tail, msg, len);
+            auto& slot  = slots_[seqNum];
+            slot.offset = tail;
+            slot.len    = uint32_t(len);
+            __atomic_store_n(&slot.generation, header_->generation, __ATOMIC_RELEASE);
+            __atomic_store_n(&header_->tail, tail + len, __ATOMIC_RELEASE);
+        }
+        __atomic_store_n(&header_->senderSeqNum, seqNum, __ATOMIC_RELEASE);
+        return fits;
+    }
+
+    // the message as sent, empty if it was never journaled
+    std::string_view get(uint32_t seqNum) const noexcept
+    {
+        if (seqNum >= header_->maxMessages)
+        {
+            return {};
+        }
+        auto const& slot = slots_[seqNum];
+        if (__atomic_load_n(&slot.generation, __ATOMIC_ACQUIRE) != header_->generation)
+        {
+            return {};
+        }
+        return {journal_ + slot.offset, slot.len};
+    }
+
+    /*
+     * message seqNum ready to resend: PossDupFlag(43)=Y, SendingTime(52) set
+     * to sendingTime and the original moved to OrigSendingTime(122), then
+     * BodyLength and CheckSum redone.
+     * 0 if seqNum is not journaled or out is too small
+     */
+    size_t renderResend(uint32_t seqNum, std::string_view sendingTime, char* out, size_t outLen) const noexcept
+    {
+        auto const msg = get(seqNum);
+        if (msg.size() < TrailerLen)
+        {
+            return 0;
+        }
+        const char* const end = msg.data() + msg.size() - TrailerLen;
+        const char* const bodyLengthField = nextField(msg.data(), end);
+        const char* const bodyBegin       = nextField(bodyLengthField, end);
+        const std::string_view beginString(msg.data(), bodyLengthField - msg.data());
+
+        // body goes after the widest "9=" possible, moved down once its length is known
+        const size_t reserve = beginString.size() + MaxBodyLengthLen;
+        if (outLen < reserve + TrailerLen)
+        {
+            return 0;
+        }
+        Out o{out + reserve, out + outLen - TrailerLen};
+
+        for (const char* f = bodyBegin; f < end;)
+        {
+            const char* const eq   = static_cast<const char*>(std::memchr(f, '=', end - f));
+            const char* const next = nextField(f, end);
+            if (!eq || eq > next)
+            {
+                return 0;
+            }
+            const FixId_t tag = toUInteger<FixId_t>(f, eq - f);
+            const std::string_view field(f, next - f);
+            const std::string_view value(eq + 1, next - eq - 2);
+            f = next;
+
+            if (tag == PossDupFlag || tag == PossResend || tag == OrigSendingTime)
+            {
+                continue;
+            }
+            if (tag == SendingTime)
+            {
+                o.put("43=Y\001");
+                o.put("52=", sendingTime, "\001");
+                o.put("122=", value, "\001");
+            }
+            else
+            {
+                o.put(field);
+            }
+        }
+        if (o.overflow)
+        {
+            return 0;
+        }
+
+        const uint32_t bodyLength = uint32_t(o.p - (out + reserve));
+        char* p = out;
+        std::memcpy(p, beginString.data(), beginString.size());
+        p += beginString.size();
+        *p++ = '9';
+        *p++ = '=';
+        p += u32toa(bodyLength, p);
+        *p++ = '\001';
+        std::memmove(p, out + reserve, bodyLength);
+        p += bodyLength;
+
+        const uint32_t cksum = calcCheckSum(out, p - out) % 256;
+        *p++ = '1';
+        *p++ = '0';
+        *p++ = '=';
+        *p++ = char('0' + cksum / 100);
+        *p++ = char('0' + cksum / 10 % 10);
+        *p++ = char('0' + cksum % 10);
+        *p++ = '\001';
+        return p - out;
+    }
+
+    /*
+     * new FIX session, e.g. after a sequence reset at logon. previous
+     * messages are no longer resendable
+     */
+    void resetSession(uint32_t senderSeqNum = 0, uint32_t targetSeqNum = 0) noexcept
+    {
+        __atomic_store_n(&header_->generation, header_->generation + 1, __ATOMIC_RELEASE);
+        header_->tail         = 0;
+        header_->senderSeqNum = senderSeqNum;
+        header_->targetSeqNum = targetSeqNum;
+    }
+
+    // flush to disk, blocks
+    void sync() noexcept { syscalls::msync(base_, size_, MS_SYNC); }
+
+  private:
+    constexpr static const uint64_t Magic = 0x3130455353584946ull; // "FIXSSE01"
+
+    constexpr static const FixId_t PossDupFlag     = 43;
+    constexpr static const FixId_t SendingTime     = 52;
+    constexpr static const FixId_t PossResend      = 97;
+    constexpr static const FixId_t OrigSendingTime = 122;
+
+    constexpr static const size_t TrailerLen       = 7; // "10=nnn|"
+    constexpr static const size_t MaxBodyLengthLen = 9; // "9=nnnnnn|"
+
+    struct alignas(CACHE_LINE_SIZE) Header
+    {
+        uint64_t magic;
+        uint64_t journalBytes;
+        uint64_t tail;
+        uint32_t maxMessages;
+        uint32_t generation;
+        uint32_t senderSeqNum;
+        uint32_t targetSeqNum;
+    };
+
+    struct Slot
+    {
+        uint64_t offset;
+        uint32_t len;
+        uint32_t generation;
+    };
+
+    // bounds checked appends for renderResend
+    struct Out
+    {
+        char* p;
+        char* end;
+        bool overflow{};
+
+        template <typename... S>
+        void put(const S&... s) noexcept
+        {
+            (putOne(std::string_view(s)), ...);
+        }
+
+        void putOne(std::string_view s) noexcept
+        {
+            if (size_t(end - p) < s.size())
+            {
+                overflow = true;
+                return;
+            }
+            std::memcpy(p, s.data(), s.size());
+            p += s.size();
+        }
+    };
+
+    static size_t mappingSize(uint32_t maxMessages, uint64_t journalBytes) noexcept
+    {
+        return sizeof(Header) + sizeof(Slot) * size_t(maxMessages) + journalBytes;
+    }
+
+    // start of the field after the one at f
+    static const char* nextField(const char* f, const char* end) noexcept
+    {
+        auto const soh = static_cast<const char*>(std::memchr(f, '\001', end - f));
+        return soh ? soh + 1 : end;
+    }
+
+    // slots that made it to the file after the last header update
+    void recover() noexcept
+    {
+        for (uint32_t seqNum = header_->senderSeqNum + 1; seqNum < header_->maxMessages; ++seqNum)
+        {
+            auto const& slot = slots_[seqNum];
+            if (slot.generation != header_->generation || slot.offset != header_->tail)
+            {
+                break;
+            }
+            header_->tail += slot.len;
+            header_->senderSeqNum = seqNum;
+        }
+    }
+
+  private:
+    int fd_{-1};
+    size_t size_{};
+    char* base_{};
+    Header* header_{};
+    Slot* slots_{};
+    char* journal_{};
+};
+
+} // namespace miye::trading::fix
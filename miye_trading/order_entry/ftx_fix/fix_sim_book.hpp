@@ -0,0 +1,214 @@
+#pragma once
+
+#include <functional>
+#include <set>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../ftx_fix/fix_enum.hpp"
+#include "../ftx_fix/order_container.hpp"
+
+namespace miye::trading::fix::sim
+{
+
+// a client order resting in the simulator
+struct SimOrder
+{
+    struct
+    {
+        uint64_t key{};
+    } exchange_key; // OrderID(37)
+    uint32_t fix_sequence{};
+    uint32_t instrument{};
+    SideEnum side{};
+    price_t price{};
+    quantity_t qty{};
+    clorder_id_t clord_id{};
+};
+
+struct SimFill
+{
+    const SimOrder& order;
+    price_t price;
+};
+
+/*
+ * The simplest book that gives fills: client orders against one market
+ * price per side, taken from config or from replayed market data.
+ *
+ * An order crossing the market fills in full at the market price, an IOC
+ * that does not is cancelled, anything else rests. A resting buy fills at
+ * its limit once the ask comes down to it or a trade prints below it, a
+ * sell the other way round. Queue position and partial fills are left to
+ * the exchange sim in qstream.
+ */
+class SimBook
+{
+  public:
+    enum class Result : uint8_t
+    {
+        Rested,
+        Filled,
+        Cancelled, // IOC that did not cross
+        Rejected   // duplicate ClOrdID or book full
+    };
+
+    explicit SimBook(uint32_t capacity = basic_order_container<SimOrder>::default_capacity) : orders_(capacity) {}
+
+    uint32_t addInstrument(const std::string& symbol, price_t bid, price_t ask)
+    {
+        instruments_.push_back(Instrument{symbol, bid, ask, {}, {}});
+        return uint32_t(instruments_.size() - 1);
+    }
+
+    // instruments are few, a scan beats hashing the symbol
+    int32_t findInstrument(std::string_view symbol) const noexcept
+    {
+        for (size_t i = 0; i < instruments_.size(); ++i)
+        {
+            if (instruments_[i].symbol == symbol)
+            {
+                return int32_t(i);
+            }
+        }
+        return -1;
+    }
+
+    const std::string& symbol(uint32_t instrument) const { return instruments_[instrument].symbol; }
+    size_t instrumentCount() const noexcept { return instruments_.size(); }
+
+    /*
+     * onFill(const SimFill&) is called before the order leaves the book,
+     * the order is only kept when Rested
+     */
+    template <typename F>
+    Result newOrder(SimOrder&& o, bool ioc, F&& onFill)
+    {
+        auto const& ins    = instruments_[o.instrument];
+        auto const touch   = o.side == SideEnum::Buy ? ins.ask : ins.bid;
+        bool const crosses = touch > 0 && (o.side == SideEnum::Buy ? o.price >= touch : o.price <= touch);
+        if (crosses || ioc)
+        {
+            if (crosses)
+            {
+                onFill(SimFill{o, touch});
+                return Result::Filled;
+            }
+            return Result::Cancelled;
+        }
+
+        auto const clordId = o.clord_id;
+        auto* order        = orders_.add(clordId, std::move(o));
+        if (!order)
+        {
+            return Result::Rejected;
+        }
+        levels(order->instrument, order->side).insert(order->price);
+        return Result::Rested;
+    }
+
+    SimOrder* get(clorder_id_t clordId) noexcept { return orders_.get(clordId); }
+
+    void remove(clorder_id_t clordId)
+    {
+        auto const* o = orders_.get(clordId);
+        if (!o)
+        {
+            return;
+        }
+        auto const like = *o;
+        orders_.remove(clordId);
+        if (orders_.count_at_level(like) == 0)
+        {
+            levels(like.instrument, like.side).erase(like.price);
+        }
+    }
+
+    // new market prices, 0 for a side that is not there
+    template <typename F>
+    void onMarket(uint32_t instrument, price_t bid, price_t ask, F&& onFill)
+    {
+        auto& ins = instruments_[instrument];
+        ins.bid   = bid;
+        ins.ask   = ask;
+        if (ask > 0)
+        {
+            sweep(instrument, SideEnum::Buy, [ask](price_t px) { return px >= ask; }, onFill);
+        }
+        if (bid > 0)
+        {
+            sweep(instrument, SideEnum::Sell, [bid](price_t px) { return px <= bid; }, onFill);
+        }
+    }
+
+    // a print trades through every resting order priced better than it
+    template <typename F>
+    void onTrade(uint32_t instrument, price_t price, F&& onFill)
+    {
+        sweep(instrument, SideEnum::Buy, [price](price_t px) { return px > price; }, onFill);
+        sweep(instrument, SideEnum::Sell, [price](price_t px) { return px < price; }, onFill);
+    }
+
+    size_t size() const noexcept { return orders_.size(); }
+
+  private:
+    struct Instrument
+    {
+        std::string symbol;
+        price_t bid{};
+        price_t ask{};
+        // prices with resting client orders, best first
+        std::set<price_t, std::greater<price_t>> bidLevels;
+        std::set<price_t> askLevels;
+    };
+
+    struct LevelSet
+    {
+        Instrument& ins;
+        SideEnum side;
+
+        void insert(price_t px)
+        {
+            side == SideEnum::Buy ? (void)ins.bidLevels.insert(px) : (void)ins.askLevels.insert(px);
+        }
+        void erase(price_t px) { side == SideEnum::Buy ? (void)ins.bidLevels.erase(px) : (void)ins.askLevels.erase(px); }
+    };
+
+    LevelSet levels(uint32_t instrument, SideEnum side) { return LevelSet{instruments_[instrument], side}; }
+
+    template <typename Set, typename Crossed, typename F>
+    void sweepLevels(Set& set, uint32_t instrument, SideEnum side, Crossed&& crossed, F& onFill)
+    {
+        while (!set.empty() && crossed(*set.begin()))
+        {
+            auto const px = *set.begin();
+            set.erase(set.begin());
+            orders_.for_each_at_level(instrument, uint32_t(side), px, [&](SimOrder& o) {
+                onFill(SimFill{o, o.price});
+                orders_.remove(o.clord_id);
+            });
+        }
+    }
+
+    template <typename Crossed, typename F>
+    void sweep(uint32_t instrument, SideEnum side, Crossed&& crossed, F& onFill)
+    {
+        auto& ins = instruments_[instrument];
+        if (side == SideEnum::Buy)
+        {
+            sweepLevels(ins.bidLevels, instrument, side, crossed, onFill);
+        }
+        else
+        {
+            sweepLevels(ins.askLevels, instrument, side, crossed, onFill);
+        }
+    }
+
+  private:
+    std::vector<Instrument> instruments_;
+    basic_order_container<SimOrder> orders_;
+};
+
+} // namespace miye::trading::fix::sim
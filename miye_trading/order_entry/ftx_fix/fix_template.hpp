@@ -0,0 +1,471 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <stdint.h>
+#include <string>
+
+#include "../ftx_fix/field.hpp"
+#include "../ftx_fix/fix_config.hpp"
+#include "../ftx_fix/fix_enum.hpp"
+#include "../ftx_fix/fix_number_utils.hpp"
+#include "libcore/types/fixed_point.hpp"
+
+namespace miye::trading::fix
+{
+
+/*
+ * Pre-rendered FIX message. The whole message, header to CheckSum, is laid
+ * out once; fields that change per message are either slots of fixed width
+ * that get overwritten in place (numbers zero padded, which FIX int, Qty,
+ * Price and UTCTimestamp allow) or tail fields. Tail fields are for String
+ * values such as ClOrdID that must go out unpadded: they are rendered after
+ * the rest of the body on every render(), FIX does not order body fields
+ * outside repeating groups. BodyLength is written in front of the body per
+ * render. CheckSum is kept as a running byte sum of the fixed part,
+ * adjusted by (new - old) over the patched bytes only, plus the sums of the
+ * BodyLength digits and the tail.
+ *
+ * build:  reset() addField()/addSlot()/addTailField() ... finish()
+ * send:   setUInt()/setChars()/setDecimal()/setTail() ... render()
+ */
+class FixTemplate
+{
+  public:
+    constexpr static const size_t BufferLen     = 512;
+    constexpr static const size_t MaxSlots      = 8;
+    constexpr static const size_t MaxTailFields = 4;
+
+    struct Slot
+    {
+        uint16_t offset{};
+        uint16_t width{};
+    };
+
+  public:
+    void reset(const char* beginString = "FIX.4.2") noexcept
+    {
+        beginString_    = beginString;
+        bodyLen_        = 0;
+        len_            = 0;
+        slotCount_      = 0;
+        tailFieldCount_ = 0;
+        checkSum_       = 0;
+    }
+
+    void addField(uint32_t tag, const char* v, size_t length) noexcept
+    {
+        char* p = appendTag(tag);
+        std::memcpy(p, v, length);
+        p[length] = FixSeparator;
+        bodyLen_ += length + 1;
+        assert(bodyLen_ < BufferLen);
+    }
+
+    void addField(uint32_t tag, const std::string& v) noexcept { addField(tag, v.data(), v.size()); }
+    void addField(uint32_t tag, char v) noexcept { addField(tag, &v, 1); }
+
+    /*
+     * reserves width bytes for the value, returns the slot id. the slot
+     * starts out as zeros until set
+     */
+    uint32_t addSlot(uint32_t tag, uint32_t width) noexcept
+    {
+        assert(slotCount_ < MaxSlots);
+        char* p = appendTag(tag);
+        std::memset(p, '0', width);
+        p[width] = FixSeparator;
+
+        auto& slot  = slots_[slotCount_];
+        slot.offset = uint16_t(p - body_.data());
+        slot.width  = uint16_t(width);
+        bodyLen_ += width + 1;
+        assert(bodyLen_ < BufferLen);
+        return slotCount_++;
+    }
+
+    /*
+     * an unsigned value rendered without padding at the end of the body,
+     * in the order the tail fields were added. returns the tail field id,
+     * the value is 0 until set
+     */
+    uint32_t addTailField(uint32_t tag) noexcept
+    {
+        assert(tailFieldCount_ < MaxTailFields);
+        auto& f = tailFields_[tailFieldCount_];
+        f.tagLen = uint8_t(u32toa(tag, f.tag));
+        f.tag[f.tagLen++] = '=';
+        f.value           = 0;
+        return tailFieldCount_++;
+    }
+
+    /*
+     * lays out 8=|9=|<body>, room left in front for the widest BodyLength,
+     * and takes the byte sum. slot offsets move from the body to the buffer
+     */
+    void finish() noexcept
+    {
+        char* p = appendRaw(prefix_.data(), "8=", 2);
+        p       = appendRaw(p, beginString_.data(), beginString_.size());
+        *p++    = FixSeparator;
+        p       = appendRaw(p, "9=", 2);
+        prefixLen_ = p - prefix_.data();
+        prefixSum_ = byteSum(prefix_.data(), prefixLen_);
+
+        bodyStart_ = prefixLen_ + MaxBodyLengthLen + 1;
+        assert(bodyStart_ + bodyLen_ + MaxTailLen + TailLen <= BufferLen);
+        std::memcpy(buffer_.data() + bodyStart_, body_.data(), bodyLen_);
+        for (uint32_t i = 0; i < slotCount_; ++i)
+        {
+            slots_[i].offset += uint16_t(bodyStart_);
+        }
+        checkSum_ = byteSum(buffer_.data() + bodyStart_, bodyLen_);
+        render();
+    }
+
+    /*
+     * per message patching. values must fit the slot width
+     */
+    void setUInt(uint32_t slot, uint64_t v) noexcept
+    {
+        auto const& s = slots_[slot];
+        char tmp[20];
+        char* q = tmp + s.width;
+        do
+        {
+            *--q = char('0' + v % 10);
+            v /= 10;
+        } while (v && q != tmp);
+        assert(v == 0);
+        std::memset(tmp, '0', q - tmp);
+        patch(buffer_.data() + s.offset, tmp, s.width);
+    }
+
+    void setChars(uint32_t slot, const char* v, size_t length) noexcept
+    {
+        auto const& s = slots_[slot];
+        assert(length == s.width);
+        patch(buffer_.data() + s.offset, v, s.width);
+    }
+
+    /*
+     * fixed-point with exactly digits decimals, zero padded after the sign.
+     * digits above Decimals are clamped
+     */
+    template <typename Tag, int32_t Decimals>
+    void setDecimal(uint32_t slot, FixedPoint<Tag, Decimals> v, uint32_t digits) noexcept
+    {
+        assert(digits <= uint32_t(Decimals));
+        digits        = std::min(digits, uint32_t(Decimals));
+        auto const& s = slots_[slot];
+        char value[32];
+        size_t n = v.toChars(value, int32_t(digits));
+        assert(n <= s.width);
+
+        char tmp[32];
+        const bool negative = value[0] == '-';
+        const size_t pad    = s.width - n;
+        if (negative)
+        {
+            tmp[0] = '-';
+        }
+        std::memset(tmp + negative, '0', pad);
+        std::memcpy(tmp + negative + pad, value + negative, n - negative);
+        patch(buffer_.data() + s.offset, tmp, s.width);
+    }
+
+    void setTail(uint32_t field, uint64_t v) noexcept { tailFields_[field].value = v; }
+
+    /*
+     * renders the tail fields, BodyLength and CheckSum, after this
+     * data()/size() is the message
+     */
+    size_t render() noexcept
+    {
+        char* const tail = buffer_.data() + bodyStart_ + bodyLen_;
+        char* p          = tail;
+        for (uint32_t i = 0; i < tailFieldCount_; ++i)
+        {
+            auto const& f = tailFields_[i];
+            p             = appendRaw(p, f.tag, f.tagLen);
+            p += u64toa(f.value, p);
+            *p++ = FixSeparator;
+        }
+        uint32_t sum = checkSum_ + byteSum(tail, p - tail);
+
+        // u32toa can write 10 digits, the BodyLength has at most MaxBodyLengthLen
+        char digits[10];
+        auto const n = std::min<size_t>(u32toa(uint32_t(bodyLen_ + (p - tail)), digits), MaxBodyLengthLen);
+        start_       = bodyStart_ - 1 - n - prefixLen_;
+        char* q      = appendRaw(buffer_.data() + start_, prefix_.data(), prefixLen_);
+        q            = appendRaw(q, digits, n);
+        *q           = FixSeparator;
+        sum += prefixSum_ + byteSum(digits, n) + uint8_t(FixSeparator);
+
+        lastCheckSum_ = sum % 256;
+        p             = appendRaw(p, "10=", 3);
+        p[0]          = char('0' + lastCheckSum_ / 100);
+        p[1]          = char('0' + lastCheckSum_ / 10 % 10);
+        p[2]          = char('0' + lastCheckSum_ % 10);
+        p[3]          = FixSeparator;
+        len_          = p + 4 - (buffer_.data() + start_);
+        return len_;
+    }
+
+    size_t render(char* out) noexcept
+    {
+        render();
+        std::memcpy(out, data(), len_);
+        return len_;
+    }
+
+    const char* data() const noexcept { return buffer_.data() + start_; }
+    size_t size() const noexcept { return len_; }
+    uint32_t getCheckSum() const noexcept { return lastCheckSum_; }
+
+  private:
+    constexpr static const size_t TailLen          = 7; // 10=xxx|
+    constexpr static const size_t MaxBodyLengthLen = 3; // the body is shorter than BufferLen
+    static_assert(BufferLen < 1000, "BodyLength must fit MaxBodyLengthLen digits");
+    constexpr static const size_t MaxTailLen       = MaxTailFields * (10 + 1 + 20 + 1); // tag=max uint64_t|
+
+    struct TailField
+    {
+        char tag[12];
+        uint8_t tagLen{};
+        uint64_t value{};
+    };
+
+    // eight bytes at a time into four 16 bit lanes, cannot overflow below BufferLen
+    static uint32_t byteSum(const char* p, size_t n) noexcept
+    {
+        constexpr uint64_t Mask = 0x00ff00ff00ff00ffULL;
+        uint64_t lanes{};
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            uint64_t w;
+            std::memcpy(&w, p + i, 8);
+            lanes += (w & Mask) + ((w >> 8) & Mask);
+        }
+        uint32_t sum = uint32_t((lanes & 0xffff) + ((lanes >> 16) & 0xffff) + ((lanes >> 32) & 0xffff) + (lanes >> 48));
+        for (; i < n; ++i)
+        {
+            sum += uint8_t(p[i]);
+        }
+        return sum;
+    }
+
+    static char* appendRaw(char* p, const char* v, size_t n) noexcept
+    {
+        std::memcpy(p, v, n);
+        return p + n;
+    }
+
+    char* appendTag(uint32_t tag) noexcept
+    {
+        char* p = body_.data() + bodyLen_;
+        auto n  = u32toa(tag, p);
+        p[n]    = '=';
+        bodyLen_ += n + 1;
+        return p + n + 1;
+    }
+
+    // unsigned wrap around keeps the sum right modulo 256
+    void patch(char* dst, const char* src, size_t n) noexcept
+    {
+        checkSum_ += byteSum(src, n) - byteSum(dst, n);
+        std::memcpy(dst, src, n);
+    }
+
+  private:
+    std::array<char, BufferLen> buffer_{};
+    std::array<char, BufferLen> body_{};
+    std::array<char, 32> prefix_{};
+    std::array<Slot, MaxSlots> slots_{};
+    std::array<TailField, MaxTailFields> tailFields_{};
+    std::string beginString_{"FIX.4.2"};
+    size_t prefixLen_{};
+    size_t bodyStart_{};
+    size_t start_{};
+    size_t bodyLen_{};
+    size_t len_{};
+    uint32_t slotCount_{};
+    uint32_t tailFieldCount_{};
+    uint32_t prefixSum_{};
+    uint32_t checkSum_{}; // the fixed part of the body
+    uint32_t lastCheckSum_{};
+};
+
+/*
+ * slot widths, the Field<> lengths of ftx_fix_writer.hpp. ClOrdID, OrderID
+ * and OrigClOrdID are Strings, they are tail fields and not padded
+ */
+struct OrderTemplateWidths
+{
+    constexpr static const uint32_t MsgSeqNum   = 9;  // MsgSeqNum_t
+    constexpr static const uint32_t SendingTime = 21; // YYYYMMDD-HH:MM:SS.sss
+    constexpr static const uint32_t OrderQty    = 20; // Qty with its decimals, as Price
+    constexpr static const uint32_t Price       = 20; // Price_t
+};
+
+// standard header in ToFtxStandardHeader order
+inline void addTemplateHeader(FixTemplate& t, const fix_config_t& config, MsgTypeEnum msgType, uint32_t& seqSlot,
+                              uint32_t& timeSlot)
+{
+    t.reset("FIX.4.2");
+    t.addField(35, static_cast<char>(msgType));
+    seqSlot = t.addSlot(34, OrderTemplateWidths::MsgSeqNum);
+    t.addField(49, config.sender_comp_id);
+    timeSlot = t.addSlot(52, OrderTemplateWidths::SendingTime);
+    t.addField(56, config.target_comp_id);
+}
+
+/*
+ * NewOrderSingle for one instrument/side/type, rendered once. per order only
+ * MsgSeqNum, SendingTime, OrderQty and Price are patched and ClOrdID is
+ * rendered. priceDigits/qtyDigits are the instrument's wire decimals
+ */
+class NewOrderSingleTemplate
+{
+  public:
+    void init(const fix_config_t& config, const std::string& symbol, SideEnum side, OrderTypeEnum ordType,
+              TimeInforceEnum tif, uint32_t priceDigits, uint32_t qtyDigits)
+    {
+        priceDigits_ = std::min(priceDigits, uint32_t(Price::decimals));
+        qtyDigits_   = std::min(qtyDigits, uint32_t(Qty::decimals));
+        addTemplateHeader(t_, config, MsgTypeEnum::OrderSingle, seqSlot_, timeSlot_);
+        t_.addField(21, '1');
+        t_.addField(55, symbol);
+        t_.addField(40, static_cast<char>(ordType));
+        qtySlot_  = t_.addSlot(38, OrderTemplateWidths::OrderQty);
+        hasPrice_ = ordType != OrderTypeEnum::MarketLimitOrder;
+        if (hasPrice_)
+        {
+            priceSlot_ = t_.addSlot(44, OrderTemplateWidths::Price);
+        }
+        t_.addField(54, static_cast<char>(side));
+        t_.addField(59, static_cast<char>(tif));
+        clOrdIdField_ = t_.addTailField(11);
+        t_.finish();
+    }
+
+    size_t render(uint32_t seqNum, const char* sendingTime, uint64_t clOrdId, Price price, Qty qty) noexcept
+    {
+        t_.setUInt(seqSlot_, seqNum);
+        t_.setChars(timeSlot_, sendingTime, OrderTemplateWidths::SendingTime);
+        t_.setTail(clOrdIdField_, clOrdId);
+        t_.setDecimal(qtySlot_, qty, qtyDigits_);
+        if (hasPrice_)
+        {
+            t_.setDecimal(priceSlot_, price, priceDigits_);
+        }
+        return t_.render();
+    }
+
+    const char* data() const noexcept { return t_.data(); }
+    size_t size() const noexcept { return t_.size(); }
+
+  private:
+    FixTemplate t_;
+    uint32_t seqSlot_{};
+    uint32_t timeSlot_{};
+    uint32_t clOrdIdField_{};
+    uint32_t qtySlot_{};
+    uint32_t priceSlot_{};
+    uint32_t priceDigits_{};
+    uint32_t qtyDigits_{};
+    bool hasPrice_{};
+};
+
+/*
+ * OrderCancelRequest, OrderID and OrigClOrdID rendered per cancel
+ */
+class OrderCancelRequestTemplate
+{
+  public:
+    void init(const fix_config_t& config)
+    {
+        addTemplateHeader(t_, config, MsgTypeEnum::OrderCancelRequest, seqSlot_, timeSlot_);
+        orderIdField_     = t_.addTailField(37);
+        origClOrdIdField_ = t_.addTailField(41);
+        t_.finish();
+    }
+
+    size_t render(uint32_t seqNum, const char* sendingTime, uint64_t orderId, uint64_t origClOrdId) noexcept
+    {
+        t_.setUInt(seqSlot_, seqNum);
+        t_.setChars(timeSlot_, sendingTime, OrderTemplateWidths::SendingTime);
+        t_.setTail(orderIdField_, orderId);
+        t_.setTail(origClOrdIdField_, origClOrdId);
+        return t_.render();
+    }
+
+    const char* data() const noexcept { return t_.data(); }
+    size_t size() const noexcept { return t_.size(); }
+
+  private:
+    FixTemplate t_;
+    uint32_t seqSlot_{};
+    uint32_t timeSlot_{};
+    uint32_t orderIdField_{};
+    uint32_t origClOrdIdField_{};
+};
+
+/*
+ * OrderCancelReplaceRequest for one instrument/side, for venues that take
+ * it (FTX acks with ModifyAck which FixSession does not handle yet)
+ */
+class OrderCancelReplaceTemplate
+{
+  public:
+    void init(const fix_config_t& config, const std::string& symbol, SideEnum side, OrderTypeEnum ordType,
+              uint32_t priceDigits, uint32_t qtyDigits)
+    {
+        priceDigits_ = std::min(priceDigits, uint32_t(Price::decimals));
+        qtyDigits_   = std::min(qtyDigits, uint32_t(Qty::decimals));
+        addTemplateHeader(t_, config, MsgTypeEnum::OrderCancelReplaceRequest, seqSlot_, timeSlot_);
+        t_.addField(21, '1');
+        t_.addField(55, symbol);
+        t_.addField(40, static_cast<char>(ordType));
+        qtySlot_   = t_.addSlot(38, OrderTemplateWidths::OrderQty);
+        priceSlot_ = t_.addSlot(44, OrderTemplateWidths::Price);
+        t_.addField(54, static_cast<char>(side));
+        clOrdIdField_     = t_.addTailField(11);
+        orderIdField_     = t_.addTailField(37);
+        origClOrdIdField_ = t_.addTailField(41);
+        t_.finish();
+    }
+
+    size_t render(uint32_t seqNum, const char* sendingTime, uint64_t clOrdId, uint64_t orderId, uint64_t origClOrdId,
+                  Price price, Qty qty) noexcept
+    {
+        t_.setUInt(seqSlot_, seqNum);
+        t_.setChars(timeSlot_, sendingTime, OrderTemplateWidths::SendingTime);
+        t_.setTail(clOrdIdField_, clOrdId);
+        t_.setTail(orderIdField_, orderId);
+        t_.setTail(origClOrdIdField_, origClOrdId);
+        t_.setDecimal(qtySlot_, qty, qtyDigits_);
+        t_.setDecimal(priceSlot_, price, priceDigits_);
+        return t_.render();
+    }
+
+    const char* data() const noexcept { return t_.data(); }
+    size_t size() const noexcept { return t_.size(); }
+
+  private:
+    FixTemplate t_;
+    uint32_t seqSlot_{};
+    uint32_t timeSlot_{};
+    uint32_t clOrdIdField_{};
+    uint32_t orderIdField_{};
+    uint32_t origClOrdIdField_{};
+    uint32_t qtySlot_{};
+    uint32_t priceSlot_{};
+    uint32_t priceDigits_{};
+    uint32_t qtyDigits_{};
+};
+
+} // namespace miye::trading::fix
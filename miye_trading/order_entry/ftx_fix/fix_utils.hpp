@@ -10,21 +10,15 @@ namespace miye::trading::fix
 {
 inline size_t get_single_fix_msg_len(size_t body_len)
 {
-    // 8=FIX.4.2|9=194|  <-- 16
+    // 8=FIX.4.2|9=194|  <-- 12 + digits + 1
     // 10=107|           <-- 7
 
-    size_t fix_msg_len{body_len};
-
-    if (body_len >= 100)
-    {
-        fix_msg_len += 23;
-    }
-    else
+    size_t digits = 1;
+    for (size_t n = body_len; n >= 10; n /= 10)
     {
-        fix_msg_len += 22;
+        ++digits;
     }
-
-    return fix_msg_len;
+    return body_len + 12 + digits + 1 + 7;
 }
 
 inline size_t get_fix_body_len(const char* p)
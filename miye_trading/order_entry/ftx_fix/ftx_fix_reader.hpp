@@ -4,6 +4,7 @@
 
 #include "../ftx_fix/field_ptr.hpp"
 #include "../ftx_fix/fix_enum.hpp"
+#include "../ftx_fix/fix_index.hpp"
 #include "../ftx_fix/fix_istream.hpp"
 
 namespace miye::trading::fix
@@ -121,6 +122,35 @@ struct ExecutionReportReader
         return fs;
     }
 
+    // direct lookup, fields missing from the message are left untouched
+    const FixIndex& read(const FixIndex& idx)
+    {
+        idx.get(avgPx);
+        idx.get(commission);
+        idx.get(commType);
+        idx.get(clOrdId);
+        idx.get(cumQty);
+        idx.get(execId);
+        idx.get(lastPx);
+        idx.get(lastQty);
+        idx.get(orderId);
+        idx.get(orderQty);
+        idx.get(ordStatus);
+        idx.get(price);
+        idx.get(side);
+        idx.get(symbol);
+        idx.get(text);
+        idx.get(transactTime);
+        idx.get(ordRejReason);
+        idx.get(execType);
+        idx.get(leavesQty);
+        idx.get(cxlQty);
+        idx.get(aggressorIndicator);
+        idx.get(fillTradeId);
+        idx.get(liquidation);
+        return idx;
+    }
+
     void reset()
     {
         avgPx.reset();
@@ -204,8 +234,9 @@ struct HeartbeatReader
 
 struct LogonReader
 {
-    using EncryptMethod_t = FieldPtr<98>;
-    using HeartBtlnt_t    = FieldPtr<108>;
+    using EncryptMethod_t   = FieldPtr<98>;
+    using HeartBtlnt_t      = FieldPtr<108>;
+    using ResetSeqNumFlag_t = FieldPtr<141>;
 
     LogonReader() = default;
 
@@ -222,6 +253,9 @@ struct LogonReader
             case HeartBtlnt_t::Id():
                 heartBtlnt.setPointers(field);
                 break;
+            case ResetSeqNumFlag_t::Id():
+                resetSeqNumFlag.setPointers(field);
+                break;
             default:
                 return fs;
             }
@@ -234,10 +268,14 @@ struct LogonReader
     {
         encryptMethod.reset();
         heartBtlnt.reset();
+        resetSeqNumFlag.reset();
     }
 
+    bool isResetSeqNum() const { return !resetSeqNumFlag.isNull() && resetSeqNumFlag.getBegin()[0] == 'Y'; }
+
     EncryptMethod_t encryptMethod;
     HeartBtlnt_t heartBtlnt;
+    ResetSeqNumFlag_t resetSeqNumFlag;
 };
 
 struct LogoutReader
@@ -482,6 +520,18 @@ struct OrderCancelRejectReader
         return fs;
     }
 
+    // direct lookup, fields missing from the message are left untouched
+    const FixIndex& read(const FixIndex& idx)
+    {
+        idx.get(clOrdId);
+        idx.get(orderId);
+        idx.get(ordStatus);
+        idx.get(orgiClOrdId);
+        idx.get(cxlRejResponseTo);
+        idx.get(cXlRejReason);
+        return idx;
+    }
+
     void reset()
     {
         clOrdId.reset();
@@ -890,6 +940,8 @@ struct StandardHeaderReader
             case BodyLength_t::Id():
                 bodyLength.setPointers(field);
                 break;
+            case MsgSeqNum_t::Id():
+                msgSeqNum.setPointers(field);
                 break;
             case MsgType_t::Id():
                 msgType.setPointers(field);
@@ -908,10 +960,50 @@ struct StandardHeaderReader
         return fs;
     }
 
+    // StandardHeader tags, whether or not this reader keeps them
+    static bool isHeaderTag(FixId_t tag) noexcept
+    {
+        switch (tag)
+        {
+        case 8:
+        case 9:
+        case 34:
+        case 35:
+        case 43:
+        case 49:
+        case 50:
+        case 52:
+        case 56:
+        case 57:
+        case 97:
+        case 115:
+        case 122:
+        case 128:
+        case 142:
+        case 143:
+        case 369:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    const FixIndex& read(const FixIndex& idx)
+    {
+        idx.get(beginString);
+        idx.get(bodyLength);
+        idx.get(msgSeqNum);
+        idx.get(msgType);
+        idx.get(senderCompId);
+        idx.get(targetCompId);
+        return idx;
+    }
+
     void reset()
     {
         beginString.reset();
         bodyLength.reset();
+        msgSeqNum.reset();
         msgType.reset();
         senderCompId.reset();
         targetCompId.reset();
@@ -954,4 +1046,80 @@ struct TestRequestReader
     TestReqID_t testReqId;
 };
 
+/*
+ * client side messages, what the FIX acceptor simulator reads. only the
+ * FixIndex lookup, the acceptor indexes every message
+ */
+struct NewOrderSingleReader
+{
+    using ClOrdID_t     = FieldPtr<11>;
+    using Symbol_t      = FieldPtr<55>;
+    using Side_t        = FieldPtr<54>;
+    using OrderQty_t    = FieldPtr<38>;
+    using OrdType_t     = FieldPtr<40>;
+    using Price_t       = FieldPtr<44>;
+    using TimeInForce_t = FieldPtr<59>;
+
+    NewOrderSingleReader() = default;
+
+    const FixIndex& read(const FixIndex& idx)
+    {
+        idx.get(clOrdId);
+        idx.get(symbol);
+        idx.get(side);
+        idx.get(orderQty);
+        idx.get(ordType);
+        idx.get(price);
+        idx.get(timeInForce);
+        return idx;
+    }
+
+    void reset()
+    {
+        clOrdId.reset();
+        symbol.reset();
+        side.reset();
+        orderQty.reset();
+        ordType.reset();
+        price.reset();
+        timeInForce.reset();
+    }
+
+    ClOrdID_t clOrdId;
+    Symbol_t symbol;
+    Side_t side;
+    OrderQty_t orderQty;
+    OrdType_t ordType;
+    Price_t price;
+    TimeInForce_t timeInForce;
+};
+
+struct OrderCancelRequestReader
+{
+    using ClOrdID_t     = FieldPtr<11>;
+    using OrderID_t     = FieldPtr<37>;
+    using OrigClOrdID_t = FieldPtr<41>;
+
+    OrderCancelRequestReader() = default;
+
+    const FixIndex& read(const FixIndex& idx)
+    {
+        idx.get(clOrdId);
+        idx.get(orderId);
+        idx.get(origClOrdId);
+        return idx;
+    }
+
+    void reset()
+    {
+        clOrdId.reset();
+        orderId.reset();
+        origClOrdId.reset();
+    }
+
+    ClOrdID_t clOrdId;
+    OrderID_t orderId;
+    OrigClOrdID_t origClOrdId;
+};
+
 } // namespace miye::trading::fix
@@ -4,7 +4,7 @@
 
 #include "../ftx_fix/field.hpp"
 #include "../ftx_fix/type_utils.hpp"
-#include "../ftx_ftx/string_const.hpp"
+#include "../ftx_fix/string_const.hpp"
 
 namespace miye::trading::fix
 {
@@ -123,6 +123,142 @@ class TestRequest
     uint32_t len_{};
 };
 
+class ResendRequest
+{
+  public:
+    using BeginSeqNo_t = Field<7, 9>;
+    using EndSeqNo_t   = Field<16, 9>;
+
+  public:
+    ResendRequest() = default;
+
+    template <typename... T>
+    void setBeginSeqNo(T&&... t) noexcept
+    {
+        beginSeqNo_.set(std::forward<T>(t)...);
+    }
+
+    template <typename... T>
+    void setEndSeqNo(T&&... t) noexcept
+    {
+        endSeqNo_.set(std::forward<T>(t)...);
+    }
+
+    void reset()
+    {
+        beginSeqNo_.reset();
+        endSeqNo_.reset();
+    }
+
+    uint32_t calcLen() noexcept
+    {
+        len_ = 0;
+        len_ += beginSeqNo_.len();
+        len_ += endSeqNo_.len();
+
+        return len_;
+    }
+
+    char* render(char* p)
+    {
+        uint32_t checkSum{};
+        char* ptr(p);
+
+        std::memcpy(ptr, beginSeqNo_.begin(), beginSeqNo_.len());
+        ptr += beginSeqNo_.len();
+        checkSum += beginSeqNo_.getCheckSum();
+
+        std::memcpy(ptr, endSeqNo_.begin(), endSeqNo_.len());
+        ptr += endSeqNo_.len();
+        checkSum += endSeqNo_.getCheckSum();
+
+        checkSum_ = checkSum;
+        return ptr;
+    }
+
+    uint32_t getCheckSum() const noexcept { return checkSum_; }
+    uint32_t getLen() const noexcept { return len_; }
+
+  private:
+    BeginSeqNo_t beginSeqNo_;
+    EndSeqNo_t endSeqNo_;
+
+  private:
+    uint32_t checkSum_{};
+    uint32_t len_{};
+};
+
+class SequenceReset
+{
+  public:
+    using GapFillFlag_t = Field<123, 1>;
+    using NewSeqNo_t    = Field<36, 9>;
+
+  public:
+    SequenceReset() = default;
+
+    template <typename... T>
+    void setGapFillFlag(T&&... t) noexcept
+    {
+        gapFillFlag_.set(std::forward<T>(t)...);
+    }
+
+    template <typename... T>
+    void setNewSeqNo(T&&... t) noexcept
+    {
+        newSeqNo_.set(std::forward<T>(t)...);
+    }
+
+    void reset()
+    {
+        gapFillFlag_.reset();
+        newSeqNo_.reset();
+    }
+
+    uint32_t calcLen() noexcept
+    {
+        len_ = 0;
+        if (gapFillFlag_.isSet())
+        {
+            len_ += gapFillFlag_.len();
+        }
+        len_ += newSeqNo_.len();
+
+        return len_;
+    }
+
+    char* render(char* p)
+    {
+        uint32_t checkSum{};
+        char* ptr(p);
+
+        if (gapFillFlag_.isSet())
+        {
+            std::memcpy(ptr, gapFillFlag_.begin(), gapFillFlag_.len());
+            ptr += gapFillFlag_.len();
+            checkSum += gapFillFlag_.getCheckSum();
+        }
+
+        std::memcpy(ptr, newSeqNo_.begin(), newSeqNo_.len());
+        ptr += newSeqNo_.len();
+        checkSum += newSeqNo_.getCheckSum();
+
+        checkSum_ = checkSum;
+        return ptr;
+    }
+
+    uint32_t getCheckSum() const noexcept { return checkSum_; }
+    uint32_t getLen() const noexcept { return len_; }
+
+  private:
+    GapFillFlag_t gapFillFlag_;
+    NewSeqNo_t newSeqNo_;
+
+  private:
+    uint32_t checkSum_{};
+    uint32_t len_{};
+};
+
 class Logon
 {
   public:
@@ -623,7 +759,7 @@ class OrderCancelRequest
         uint32_t checkSum{};
         char* ptr(p);
 
-        assert(!(orderId_.isSet() & origClOrdId_.isSet));
+        assert(!(orderId_.isSet() && origClOrdId_.isSet()));
         /*
          * TODO: Only one of OrderID (37) and OrigClOrdID (41) should be provided.
          */
@@ -833,177 +969,852 @@ class OrderStatusRequest
     uint32_t len_{};
 };
 
-class ToFtxStandardHeader
+/*
+ * exchange side messages, what the FIX acceptor simulator sends back
+ */
+class ExecutionReport
 {
   public:
-    using BeginString_t            = Field<8, 7>;
-    using BodyLength_t             = Field<9, 6>;
-    using MsgType_t                = Field<35, 2>;
-    using MsgSeqNum_t              = Field<34, 9>;
-    using SenderCompID_t           = Field<49, 7>;
-    using SendingTime_t            = Field<52, 21>;
-    using LastMsgSeqNumProcessed_t = Field<369, 9>;
-    using TargetCompID_t           = Field<56, 7>;
-    using OrigSendingTime_t        = Field<122, 21>;
+    using OrderID_t      = Field<37, 20>;
+    using ClOrdID_t      = Field<11, 20>;
+    using OrigClOrdID_t  = Field<41, 20>;
+    using ExecID_t       = Field<17, 20>;
+    using ExecType_t     = Field<150, 1>;
+    using OrdStatus_t    = Field<39, 1>;
+    using Symbol_t       = Field<55, 16>;
+    using Side_t         = Field<54, 1>;
+    using OrderQty_t     = Field<38, 20>;
+    using Price_t        = Field<44, 20>;
+    using LastPx_t       = Field<31, 20>;
+    using LastQty_t      = Field<32, 20>;
+    using CumQty_t       = Field<14, 20>;
+    using LeavesQty_t    = Field<151, 20>;
+    using AvgPx_t        = Field<6, 20>;
+    using OrdRejReason_t = Field<103, 3>;
+    using Text_t         = Field<58, 32>;
 
   public:
-    ToFtxStandardHeader() = default;
+    ExecutionReport() = default;
 
     template <typename... T>
-    void setBeginString(T&&... t) noexcept
+    void setOrderID(T&&... t) noexcept
     {
-        beginString_.set(std::forward<T>(t)...);
+        orderId_.set(std::forward<T>(t)...);
     }
     template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
-    void setBeginString(T v) noexcept
+    void setOrderID(T v) noexcept
     {
-        beginString_.set(toUnderlyingType(v));
+        orderId_.set(toUnderlyingType(v));
     }
 
     template <typename... T>
-    void setBodyLength(T&&... t) noexcept
+    void setClOrdID(T&&... t) noexcept
     {
-        bodyLength_.set(std::forward<T>(t)...);
+        clOrdId_.set(std::forward<T>(t)...);
     }
     template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
-    void setBodyLength(T v) noexcept
+    void setClOrdID(T v) noexcept
     {
-        bodyLength_.set(toUnderlyingType(v));
+        clOrdId_.set(toUnderlyingType(v));
     }
 
     template <typename... T>
-    void setMsgType(T&&... t) noexcept
+    void setOrigClOrdID(T&&... t) noexcept
     {
-        msgType_.set(std::forward<T>(t)...);
+        origClOrdId_.set(std::forward<T>(t)...);
     }
     template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
-    void setMsgType(T v) noexcept
+    void setOrigClOrdID(T v) noexcept
     {
-        msgType_.set(toUnderlyingType(v));
+        origClOrdId_.set(toUnderlyingType(v));
     }
 
     template <typename... T>
-    void setMsgSeqNum(T&&... t) noexcept
+    void setExecID(T&&... t) noexcept
     {
-        msgSeqNum_.set(std::forward<T>(t)...);
+        execId_.set(std::forward<T>(t)...);
     }
     template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
-    void setMsgSeqNum(T v) noexcept
+    void setExecID(T v) noexcept
     {
-        msgSeqNum_.set(toUnderlyingType(v));
+        execId_.set(toUnderlyingType(v));
     }
 
     template <typename... T>
-    void setSenderCompID(T&&... t) noexcept
+    void setExecType(T&&... t) noexcept
     {
-        senderCompId_.set(std::forward<T>(t)...);
+        execType_.set(std::forward<T>(t)...);
     }
     template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
-    void setSenderCompID(T v) noexcept
+    void setExecType(T v) noexcept
     {
-        senderCompId_.set(toUnderlyingType(v));
+        execType_.set(toUnderlyingType(v));
     }
 
     template <typename... T>
-    void setSendingTime(T&&... t) noexcept
+    void setOrdStatus(T&&... t) noexcept
     {
-        sendingTime_.set(std::forward<T>(t)...);
+        ordStatus_.set(std::forward<T>(t)...);
     }
     template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
-    void setSendingTime(T v) noexcept
+    void setOrdStatus(T v) noexcept
     {
-        sendingTime_.set(toUnderlyingType(v));
+        ordStatus_.set(toUnderlyingType(v));
     }
 
     template <typename... T>
-    void setLastMsgSeqNumProcessed(T&&... t) noexcept
+    void setSymbol(T&&... t) noexcept
     {
-        lastMsgSeqNumProcessed_.set(std::forward<T>(t)...);
+        symbol_.set(std::forward<T>(t)...);
     }
     template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
-    void setLastMsgSeqNumProcessed(T v) noexcept
+    void setSymbol(T v) noexcept
     {
-        lastMsgSeqNumProcessed_.set(toUnderlyingType(v));
+        symbol_.set(toUnderlyingType(v));
     }
 
     template <typename... T>
-    void setTargetCompID(T&&... t) noexcept
+    void setSide(T&&... t) noexcept
     {
-        targetCompId_.set(std::forward<T>(t)...);
+        side_.set(std::forward<T>(t)...);
     }
     template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
-    void setTargetCompID(T v) noexcept
+    void setSide(T v) noexcept
     {
-        targetCompId_.set(toUnderlyingType(v));
+        side_.set(toUnderlyingType(v));
     }
 
     template <typename... T>
-    void setOrigSendingTime(T&&... t) noexcept
+    void setOrderQty(T&&... t) noexcept
     {
-        origSendingTime_.set(std::forward<T>(t)...);
+        orderQty_.set(std::forward<T>(t)...);
     }
     template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
-    void setOrigSendingTime(T v) noexcept
+    void setOrderQty(T v) noexcept
     {
-        origSendingTime_.set(toUnderlyingType(v));
+        orderQty_.set(toUnderlyingType(v));
     }
 
-    void reset()
+    template <typename... T>
+    void setPrice(T&&... t) noexcept
     {
-        beginString_.reset();
-        bodyLength_.reset();
-        msgType_.reset();
-        msgSeqNum_.reset();
-        senderCompId_.reset();
-        sendingTime_.reset();
-        lastMsgSeqNumProcessed_.reset();
-        targetCompId_.reset();
-        origSendingTime_.reset();
+        price_.set(std::forward<T>(t)...);
     }
-
-    uint32_t calcLen() noexcept
+    template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
+    void setPrice(T v) noexcept
     {
-        len_ = 0;
-        len_ += msgType_.len();
-        len_ += msgSeqNum_.len();
-
-        len_ += senderCompId_.len();
+        price_.set(toUnderlyingType(v));
+    }
 
-        len_ += sendingTime_.len();
+    template <typename... T>
+    void setLastPx(T&&... t) noexcept
+    {
+        lastPx_.set(std::forward<T>(t)...);
+    }
+    template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
+    void setLastPx(T v) noexcept
+    {
+        lastPx_.set(toUnderlyingType(v));
+    }
 
-        if (lastMsgSeqNumProcessed_.isSet())
-        {
-            len_ += lastMsgSeqNumProcessed_.len();
-        }
-        len_ += targetCompId_.len();
+    template <typename... T>
+    void setLastQty(T&&... t) noexcept
+    {
+        lastQty_.set(std::forward<T>(t)...);
+    }
+    template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
+    void setLastQty(T v) noexcept
+    {
+        lastQty_.set(toUnderlyingType(v));
+    }
 
-        if (origSendingTime_.isSet())
-        {
-            len_ += origSendingTime_.len();
-        }
-        return len_;
+    template <typename... T>
+    void setCumQty(T&&... t) noexcept
+    {
+        cumQty_.set(std::forward<T>(t)...);
+    }
+    template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
+    void setCumQty(T v) noexcept
+    {
+        cumQty_.set(toUnderlyingType(v));
     }
 
-    char* render(char* p)
+    template <typename... T>
+    void setLeavesQty(T&&... t) noexcept
     {
-        uint32_t checkSum{};
-        char* ptr(p);
+        leavesQty_.set(std::forward<T>(t)...);
+    }
+    template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
+    void setLeavesQty(T v) noexcept
+    {
+        leavesQty_.set(toUnderlyingType(v));
+    }
 
-        std::memcpy(ptr, beginString_.begin(), beginString_.len());
-        ptr += beginString_.len();
-        checkSum += beginString_.getCheckSum();
+    template <typename... T>
+    void setAvgPx(T&&... t) noexcept
+    {
+        avgPx_.set(std::forward<T>(t)...);
+    }
+    template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
+    void setAvgPx(T v) noexcept
+    {
+        avgPx_.set(toUnderlyingType(v));
+    }
 
-        std::memcpy(ptr, bodyLength_.begin(), bodyLength_.len());
-        ptr += bodyLength_.len();
-        checkSum += bodyLength_.getCheckSum();
+    template <typename... T>
+    void setOrdRejReason(T&&... t) noexcept
+    {
+        ordRejReason_.set(std::forward<T>(t)...);
+    }
+    template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
+    void setOrdRejReason(T v) noexcept
+    {
+        ordRejReason_.set(toUnderlyingType(v));
+    }
 
-        std::memcpy(ptr, msgType_.begin(), msgType_.len());
-        ptr += msgType_.len();
-        checkSum += msgType_.getCheckSum();
+    template <typename... T>
+    void setText(T&&... t) noexcept
+    {
+        text_.set(std::forward<T>(t)...);
+    }
+    template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
+    void setText(T v) noexcept
+    {
+        text_.set(toUnderlyingType(v));
+    }
 
-        std::memcpy(ptr, msgSeqNum_.begin(), msgSeqNum_.len());
-        ptr += msgSeqNum_.len();
-        checkSum += msgSeqNum_.getCheckSum();
+    void reset()
+    {
+        orderId_.reset();
+        clOrdId_.reset();
+        origClOrdId_.reset();
+        execId_.reset();
+        execType_.reset();
+        ordStatus_.reset();
+        symbol_.reset();
+        side_.reset();
+        orderQty_.reset();
+        price_.reset();
+        lastPx_.reset();
+        lastQty_.reset();
+        cumQty_.reset();
+        leavesQty_.reset();
+        avgPx_.reset();
+        ordRejReason_.reset();
+        text_.reset();
+    }
+
+    uint32_t calcLen() noexcept
+    {
+        len_ = 0;
+        if (orderId_.isSet())
+        {
+            len_ += orderId_.len();
+        }
+        if (clOrdId_.isSet())
+        {
+            len_ += clOrdId_.len();
+        }
+        if (origClOrdId_.isSet())
+        {
+            len_ += origClOrdId_.len();
+        }
+        if (execId_.isSet())
+        {
+            len_ += execId_.len();
+        }
+        if (execType_.isSet())
+        {
+            len_ += execType_.len();
+        }
+        if (ordStatus_.isSet())
+        {
+            len_ += ordStatus_.len();
+        }
+        if (symbol_.isSet())
+        {
+            len_ += symbol_.len();
+        }
+        if (side_.isSet())
+        {
+            len_ += side_.len();
+        }
+        if (orderQty_.isSet())
+        {
+            len_ += orderQty_.len();
+        }
+        if (price_.isSet())
+        {
+            len_ += price_.len();
+        }
+        if (lastPx_.isSet())
+        {
+            len_ += lastPx_.len();
+        }
+        if (lastQty_.isSet())
+        {
+            len_ += lastQty_.len();
+        }
+        if (cumQty_.isSet())
+        {
+            len_ += cumQty_.len();
+        }
+        if (leavesQty_.isSet())
+        {
+            len_ += leavesQty_.len();
+        }
+        if (avgPx_.isSet())
+        {
+            len_ += avgPx_.len();
+        }
+        if (ordRejReason_.isSet())
+        {
+            len_ += ordRejReason_.len();
+        }
+        if (text_.isSet())
+        {
+            len_ += text_.len();
+        }
+        return len_;
+    }
+
+    char* render(char* p)
+    {
+        uint32_t checkSum{};
+        char* ptr(p);
+
+        if (orderId_.isSet())
+        {
+            std::memcpy(ptr, orderId_.begin(), orderId_.len());
+            ptr += orderId_.len();
+            checkSum += orderId_.getCheckSum();
+        }
+        if (clOrdId_.isSet())
+        {
+            std::memcpy(ptr, clOrdId_.begin(), clOrdId_.len());
+            ptr += clOrdId_.len();
+            checkSum += clOrdId_.getCheckSum();
+        }
+        if (origClOrdId_.isSet())
+        {
+            std::memcpy(ptr, origClOrdId_.begin(), origClOrdId_.len());
+            ptr += origClOrdId_.len();
+            checkSum += origClOrdId_.getCheckSum();
+        }
+        if (execId_.isSet())
+        {
+            std::memcpy(ptr, execId_.begin(), execId_.len());
+            ptr += execId_.len();
+            checkSum += execId_.getCheckSum();
+        }
+        if (execType_.isSet())
+        {
+            std::memcpy(ptr, execType_.begin(), execType_.len());
+            ptr += execType_.len();
+            checkSum += execType_.getCheckSum();
+        }
+        if (ordStatus_.isSet())
+        {
+            std::memcpy(ptr, ordStatus_.begin(), ordStatus_.len());
+            ptr += ordStatus_.len();
+            checkSum += ordStatus_.getCheckSum();
+        }
+        if (symbol_.isSet())
+        {
+            std::memcpy(ptr, symbol_.begin(), symbol_.len());
+            ptr += symbol_.len();
+            checkSum += symbol_.getCheckSum();
+        }
+        if (side_.isSet())
+        {
+            std::memcpy(ptr, side_.begin(), side_.len());
+            ptr += side_.len();
+            checkSum += side_.getCheckSum();
+        }
+        if (orderQty_.isSet())
+        {
+            std::memcpy(ptr, orderQty_.begin(), orderQty_.len());
+            ptr += orderQty_.len();
+            checkSum += orderQty_.getCheckSum();
+        }
+        if (price_.isSet())
+        {
+            std::memcpy(ptr, price_.begin(), price_.len());
+            ptr += price_.len();
+            checkSum += price_.getCheckSum();
+        }
+        if (lastPx_.isSet())
+        {
+            std::memcpy(ptr, lastPx_.begin(), lastPx_.len());
+            ptr += lastPx_.len();
+            checkSum += lastPx_.getCheckSum();
+        }
+        if (lastQty_.isSet())
+        {
+            std::memcpy(ptr, lastQty_.begin(), lastQty_.len());
+            ptr += lastQty_.len();
+            checkSum += lastQty_.getCheckSum();
+        }
+        if (cumQty_.isSet())
+        {
+            std::memcpy(ptr, cumQty_.begin(), cumQty_.len());
+            ptr += cumQty_.len();
+            checkSum += cumQty_.getCheckSum();
+        }
+        if (leavesQty_.isSet())
+        {
+            std::memcpy(ptr, leavesQty_.begin(), leavesQty_.len());
+            ptr += leavesQty_.len();
+            checkSum += leavesQty_.getCheckSum();
+        }
+        if (avgPx_.isSet())
+        {
+            std::memcpy(ptr, avgPx_.begin(), avgPx_.len());
+            ptr += avgPx_.len();
+            checkSum += avgPx_.getCheckSum();
+        }
+        if (ordRejReason_.isSet())
+        {
+            std::memcpy(ptr, ordRejReason_.begin(), ordRejReason_.len());
+            ptr += ordRejReason_.len();
+            checkSum += ordRejReason_.getCheckSum();
+        }
+        if (text_.isSet())
+        {
+            std::memcpy(ptr, text_.begin(), text_.len());
+            ptr += text_.len();
+            checkSum += text_.getCheckSum();
+        }
+
+        checkSum_ = checkSum;
+        return ptr;
+    }
+
+    uint32_t getCheckSum() const noexcept { return checkSum_; }
+    uint32_t getLen() const noexcept { return len_; }
+
+  private:
+    OrderID_t orderId_;
+    ClOrdID_t clOrdId_;
+    OrigClOrdID_t origClOrdId_;
+    ExecID_t execId_;
+    ExecType_t execType_;
+    OrdStatus_t ordStatus_;
+    Symbol_t symbol_;
+    Side_t side_;
+    OrderQty_t orderQty_;
+    Price_t price_;
+    LastPx_t lastPx_;
+    LastQty_t lastQty_;
+    CumQty_t cumQty_;
+    LeavesQty_t leavesQty_;
+    AvgPx_t avgPx_;
+    OrdRejReason_t ordRejReason_;
+    Text_t text_;
+
+  private:
+    uint32_t checkSum_{};
+    uint32_t len_{};
+};
+
+class OrderCancelReject
+{
+  public:
+    using OrderID_t          = Field<37, 20>;
+    using ClOrdID_t          = Field<11, 20>;
+    using OrigClOrdID_t      = Field<41, 20>;
+    using OrdStatus_t        = Field<39, 1>;
+    using CxlRejResponseTo_t = Field<434, 1>;
+    using CxlRejReason_t     = Field<102, 3>;
+    using Text_t             = Field<58, 32>;
+
+  public:
+    OrderCancelReject() = default;
+
+    template <typename... T>
+    void setOrderID(T&&... t) noexcept
+    {
+        orderId_.set(std::forward<T>(t)...);
+    }
+    template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
+    void setOrderID(T v) noexcept
+    {
+        orderId_.set(toUnderlyingType(v));
+    }
+
+    template <typename... T>
+    void setClOrdID(T&&... t) noexcept
+    {
+        clOrdId_.set(std::forward<T>(t)...);
+    }
+    template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
+    void setClOrdID(T v) noexcept
+    {
+        clOrdId_.set(toUnderlyingType(v));
+    }
+
+    template <typename... T>
+    void setOrigClOrdID(T&&... t) noexcept
+    {
+        origClOrdId_.set(std::forward<T>(t)...);
+    }
+    template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
+    void setOrigClOrdID(T v) noexcept
+    {
+        origClOrdId_.set(toUnderlyingType(v));
+    }
+
+    template <typename... T>
+    void setOrdStatus(T&&... t) noexcept
+    {
+        ordStatus_.set(std::forward<T>(t)...);
+    }
+    template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
+    void setOrdStatus(T v) noexcept
+    {
+        ordStatus_.set(toUnderlyingType(v));
+    }
+
+    template <typename... T>
+    void setCxlRejResponseTo(T&&... t) noexcept
+    {
+        cxlRejResponseTo_.set(std::forward<T>(t)...);
+    }
+    template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
+    void setCxlRejResponseTo(T v) noexcept
+    {
+        cxlRejResponseTo_.set(toUnderlyingType(v));
+    }
+
+    template <typename... T>
+    void setCxlRejReason(T&&... t) noexcept
+    {
+        cxlRejReason_.set(std::forward<T>(t)...);
+    }
+    template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
+    void setCxlRejReason(T v) noexcept
+    {
+        cxlRejReason_.set(toUnderlyingType(v));
+    }
+
+    template <typename... T>
+    void setText(T&&... t) noexcept
+    {
+        text_.set(std::forward<T>(t)...);
+    }
+    template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
+    void setText(T v) noexcept
+    {
+        text_.set(toUnderlyingType(v));
+    }
+
+    void reset()
+    {
+        orderId_.reset();
+        clOrdId_.reset();
+        origClOrdId_.reset();
+        ordStatus_.reset();
+        cxlRejResponseTo_.reset();
+        cxlRejReason_.reset();
+        text_.reset();
+    }
+
+    uint32_t calcLen() noexcept
+    {
+        len_ = 0;
+        if (orderId_.isSet())
+        {
+            len_ += orderId_.len();
+        }
+        if (clOrdId_.isSet())
+        {
+            len_ += clOrdId_.len();
+        }
+        if (origClOrdId_.isSet())
+        {
+            len_ += origClOrdId_.len();
+        }
+        if (ordStatus_.isSet())
+        {
+            len_ += ordStatus_.len();
+        }
+        if (cxlRejResponseTo_.isSet())
+        {
+            len_ += cxlRejResponseTo_.len();
+        }
+        if (cxlRejReason_.isSet())
+        {
+            len_ += cxlRejReason_.len();
+        }
+        if (text_.isSet())
+        {
+            len_ += text_.len();
+        }
+        return len_;
+    }
+
+    char* render(char* p)
+    {
+        uint32_t checkSum{};
+        char* ptr(p);
+
+        if (orderId_.isSet())
+        {
+            std::memcpy(ptr, orderId_.begin(), orderId_.len());
+            ptr += orderId_.len();
+            checkSum += orderId_.getCheckSum();
+        }
+        if (clOrdId_.isSet())
+        {
+            std::memcpy(ptr, clOrdId_.begin(), clOrdId_.len());
+            ptr += clOrdId_.len();
+            checkSum += clOrdId_.getCheckSum();
+        }
+        if (origClOrdId_.isSet())
+        {
+            std::memcpy(ptr, origClOrdId_.begin(), origClOrdId_.len());
+            ptr += origClOrdId_.len();
+            checkSum += origClOrdId_.getCheckSum();
+        }
+        if (ordStatus_.isSet())
+        {
+            std::memcpy(ptr, ordStatus_.begin(), ordStatus_.len());
+            ptr += ordStatus_.len();
+            checkSum += ordStatus_.getCheckSum();
+        }
+        if (cxlRejResponseTo_.isSet())
+        {
+            std::memcpy(ptr, cxlRejResponseTo_.begin(), cxlRejResponseTo_.len());
+            ptr += cxlRejResponseTo_.len();
+            checkSum += cxlRejResponseTo_.getCheckSum();
+        }
+        if (cxlRejReason_.isSet())
+        {
+            std::memcpy(ptr, cxlRejReason_.begin(), cxlRejReason_.len());
+            ptr += cxlRejReason_.len();
+            checkSum += cxlRejReason_.getCheckSum();
+        }
+        if (text_.isSet())
+        {
+            std::memcpy(ptr, text_.begin(), text_.len());
+            ptr += text_.len();
+            checkSum += text_.getCheckSum();
+        }
+
+        checkSum_ = checkSum;
+        return ptr;
+    }
+
+    uint32_t getCheckSum() const noexcept { return checkSum_; }
+    uint32_t getLen() const noexcept { return len_; }
+
+  private:
+    OrderID_t orderId_;
+    ClOrdID_t clOrdId_;
+    OrigClOrdID_t origClOrdId_;
+    OrdStatus_t ordStatus_;
+    CxlRejResponseTo_t cxlRejResponseTo_;
+    CxlRejReason_t cxlRejReason_;
+    Text_t text_;
+
+  private:
+    uint32_t checkSum_{};
+    uint32_t len_{};
+};
+
+
+class ToFtxStandardHeader
+{
+  public:
+    using BeginString_t            = Field<8, 7>;
+    using BodyLength_t             = Field<9, 6>;
+    using MsgType_t                = Field<35, 2>;
+    using MsgSeqNum_t              = Field<34, 9>;
+    using PossDupFlag_t            = Field<43, 1>;
+    using SenderCompID_t           = Field<49, 7>;
+    using SendingTime_t            = Field<52, 21>;
+    using LastMsgSeqNumProcessed_t = Field<369, 9>;
+    using TargetCompID_t           = Field<56, 7>;
+    using OrigSendingTime_t        = Field<122, 21>;
+
+  public:
+    ToFtxStandardHeader() = default;
+
+    template <typename... T>
+    void setBeginString(T&&... t) noexcept
+    {
+        beginString_.set(std::forward<T>(t)...);
+    }
+    template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
+    void setBeginString(T v) noexcept
+    {
+        beginString_.set(toUnderlyingType(v));
+    }
+
+    template <typename... T>
+    void setBodyLength(T&&... t) noexcept
+    {
+        bodyLength_.set(std::forward<T>(t)...);
+    }
+    template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
+    void setBodyLength(T v) noexcept
+    {
+        bodyLength_.set(toUnderlyingType(v));
+    }
+
+    template <typename... T>
+    void setMsgType(T&&... t) noexcept
+    {
+        msgType_.set(std::forward<T>(t)...);
+    }
+    template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
+    void setMsgType(T v) noexcept
+    {
+        msgType_.set(toUnderlyingType(v));
+    }
+
+    template <typename... T>
+    void setMsgSeqNum(T&&... t) noexcept
+    {
+        msgSeqNum_.set(std::forward<T>(t)...);
+    }
+    template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
+    void setMsgSeqNum(T v) noexcept
+    {
+        msgSeqNum_.set(toUnderlyingType(v));
+    }
+
+    template <typename... T>
+    void setPossDupFlag(T&&... t) noexcept
+    {
+        possDupFlag_.set(std::forward<T>(t)...);
+    }
+    void resetPossDupFlag() noexcept { possDupFlag_.reset(); }
+
+    template <typename... T>
+    void setSenderCompID(T&&... t) noexcept
+    {
+        senderCompId_.set(std::forward<T>(t)...);
+    }
+    template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
+    void setSenderCompID(T v) noexcept
+    {
+        senderCompId_.set(toUnderlyingType(v));
+    }
+
+    template <typename... T>
+    void setSendingTime(T&&... t) noexcept
+    {
+        sendingTime_.set(std::forward<T>(t)...);
+    }
+    template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
+    void setSendingTime(T v) noexcept
+    {
+        sendingTime_.set(toUnderlyingType(v));
+    }
+
+    template <typename... T>
+    void setLastMsgSeqNumProcessed(T&&... t) noexcept
+    {
+        lastMsgSeqNumProcessed_.set(std::forward<T>(t)...);
+    }
+    template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
+    void setLastMsgSeqNumProcessed(T v) noexcept
+    {
+        lastMsgSeqNumProcessed_.set(toUnderlyingType(v));
+    }
+
+    template <typename... T>
+    void setTargetCompID(T&&... t) noexcept
+    {
+        targetCompId_.set(std::forward<T>(t)...);
+    }
+    template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
+    void setTargetCompID(T v) noexcept
+    {
+        targetCompId_.set(toUnderlyingType(v));
+    }
+
+    template <typename... T>
+    void setOrigSendingTime(T&&... t) noexcept
+    {
+        origSendingTime_.set(std::forward<T>(t)...);
+    }
+    template <typename T, typename = std::enable_if_t<std::is_enum<T>::value>>
+    void setOrigSendingTime(T v) noexcept
+    {
+        origSendingTime_.set(toUnderlyingType(v));
+    }
+    void resetOrigSendingTime() noexcept { origSendingTime_.reset(); }
+
+    void reset()
+    {
+        beginString_.reset();
+        bodyLength_.reset();
+        msgType_.reset();
+        msgSeqNum_.reset();
+        possDupFlag_.reset();
+        senderCompId_.reset();
+        sendingTime_.reset();
+        lastMsgSeqNumProcessed_.reset();
+        targetCompId_.reset();
+        origSendingTime_.reset();
+    }
+
+    uint32_t calcLen() noexcept
+    {
+        len_ = 0;
+        len_ += msgType_.len();
+        len_ += msgSeqNum_.len();
+
+        if (possDupFlag_.isSet())
+        {
+            len_ += possDupFlag_.len();
+        }
+        len_ += senderCompId_.len();
+
+        len_ += sendingTime_.len();
+
+        if (lastMsgSeqNumProcessed_.isSet())
+        {
+            len_ += lastMsgSeqNumProcessed_.len();
+        }
+        len_ += targetCompId_.len();
+
+        if (origSendingTime_.isSet())
+        {
+            len_ += origSendingTime_.len();
+        }
+        return len_;
+    }
+
+    char* render(char* p)
+    {
+        uint32_t checkSum{};
+        char* ptr(p);
+
+        std::memcpy(ptr, beginString_.begin(), beginString_.len());
+        ptr += beginString_.len();
+        checkSum += beginString_.getCheckSum();
+
+        std::memcpy(ptr, bodyLength_.begin(), bodyLength_.len());
+        ptr += bodyLength_.len();
+        checkSum += bodyLength_.getCheckSum();
+
+        std::memcpy(ptr, msgType_.begin(), msgType_.len());
+        ptr += msgType_.len();
+        checkSum += msgType_.getCheckSum();
+
+        std::memcpy(ptr, msgSeqNum_.begin(), msgSeqNum_.len());
+        ptr += msgSeqNum_.len();
+        checkSum += msgSeqNum_.getCheckSum();
+
+        if (possDupFlag_.isSet())
+        {
+            std::memcpy(ptr, possDupFlag_.begin(), possDupFlag_.len());
+            ptr += possDupFlag_.len();
+            checkSum += possDupFlag_.getCheckSum();
+        }
 
         std::memcpy(ptr, senderCompId_.begin(), senderCompId_.len());
         ptr += senderCompId_.len();
@@ -1045,6 +1856,7 @@ class ToFtxStandardHeader
     BodyLength_t bodyLength_;
     MsgType_t msgType_;
     MsgSeqNum_t msgSeqNum_;
+    PossDupFlag_t possDupFlag_;
     SenderCompID_t senderCompId_;
     SendingTime_t sendingTime_;
     LastMsgSeqNumProcessed_t lastMsgSeqNumProcessed_;
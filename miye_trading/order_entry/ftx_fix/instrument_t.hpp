@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <stdint.h>
+#include <string>
+
+#include "libcore/types/types.hpp"
+#include "position/position.h"
+
+#include "../ftx_fix/fix_template.hpp"
+#include "message/order_messages.hpp"
+
+namespace miye::trading::fix
+{
+
+/*
+ * an instrument the order gateway trades: how it goes out on FIX and the
+ * risk limits it is checked against. the order templates are rendered at
+ * startup, placing an order only patches them
+ */
+struct instrument_t
+{
+    types::instrument_id_t instrument_id{};
+    std::string symbol;     // Symbol(55)
+    Price tick_size{};
+    uint32_t precision{};   // price digits on the wire
+    uint32_t qty_precision{}; // qty digits on the wire
+    int32_t risk_id{};      // index into risk::Risk::symbolRisks
+
+    std::array<NewOrderSingleTemplate, 2> new_order; // buy, sell
+
+    // symbol and cid preset, allowOrder only needs side, price and qty per order
+    miye::order_t risk_order{};
+    position::SymbolPosition position{};
+
+    NewOrderSingleTemplate& new_order_template(types::message::side_t side)
+    {
+        return new_order[side == types::message::side_t::sell];
+    }
+};
+
+} // namespace miye::trading::fix
@@ -1,8 +1,10 @@
 #pragma once
 #include "libcore/types/types.hpp"
+#include "message/order_messages.hpp"
 
 #include <cstdint>
-#include "../ftx_ftx/fix_enum.hpp"
+#include "../ftx_fix/fix_enum.hpp"
+#include "../ftx_fix/type_utils.hpp"
 
 namespace miye::trading::fix
 {
@@ -47,6 +49,7 @@ struct order_t
     types::order_key_t exchange_key{0};
     types::message::side_t side{};
     quantity_t qty{};
+    quantity_t filled{}; // executed so far
     types::instrument_id_t instrument{};
     price_t price{};
     types::message::duration_t duration{};
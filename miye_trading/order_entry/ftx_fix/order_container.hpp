@@ -1,93 +1,407 @@
 #pragma once
 
-#include <unordered_map>
 #include <cassert>
-#include <iostream>
-#include "../ftx_ftx/order.hpp"
+#include <cstring>
+#include <memory>
+#include <stdint.h>
+#include <type_traits>
 
-namespace qx
-{
-namespace cme
+#include "../ftx_fix/order.hpp"
+
+namespace miye::trading::fix
 {
 
-class order_container
+/*
+ * open addressing map to a slot index: linear probing, deletes shift the
+ * following run back so there are no tombstones. sized once
+ */
+template <typename Key, typename Hash>
+class order_index
 {
-public:
-	using order_map = std::unordered_map<order_id_t, order_t>;
+  public:
+    constexpr static const uint32_t npos = ~0u;
 
-public:
-	order_container() = default;
+    explicit order_index(uint32_t capacity)
+    {
+        size_t n = 16;
+        while (n < size_t(capacity) * 2) // load <= 1/2
+        {
+            n <<= 1;
+        }
+        mask_    = n - 1;
+        entries_ = std::make_unique<entry[]>(n);
+    }
 
-public:
-	order_t* get(order_id_t clord_id)
-	{
-		auto it = orders.find(clord_id);
-		return it == orders.end() ? nullptr : &it->second;
-	}
+    uint32_t find(const Key& key) const noexcept
+    {
+        for (size_t i = Hash{}(key)&mask_;; i = (i + 1) & mask_)
+        {
+            auto const& e = entries_[i];
+            if (e.value == npos || e.key == key)
+            {
+                return e.value;
+            }
+        }
+    }
 
-	const order_t* get(order_id_t clord_id) const
-	{
-		auto it = orders.find(clord_id);
-		return it == orders.end() ? nullptr : &it->second;
-	}
+    // false if key is already there, unless overwrite
+    bool insert(const Key& key, uint32_t value, bool overwrite = false) noexcept
+    {
+        assert(value != npos);
+        for (size_t i = Hash{}(key)&mask_;; i = (i + 1) & mask_)
+        {
+            auto& e = entries_[i];
+            if (e.value == npos)
+            {
+                e.key   = key;
+                e.value = value;
+                return true;
+            }
+            if (e.key == key)
+            {
+                if (overwrite)
+                {
+                    e.value = value;
+                }
+                return overwrite;
+            }
+        }
+    }
 
-    const order_t* getBySequence(uint32_t sequence) const
+    void erase(const Key& key) noexcept
     {
-        for (auto it = orders.begin(); it != orders.end(); ++it)
+        size_t i = Hash{}(key)&mask_;
+        while (entries_[i].value != npos && !(entries_[i].key == key))
+        {
+            i = (i + 1) & mask_;
+        }
+        if (entries_[i].value == npos)
         {
-            if (it->second.fix_sequence == sequence)
+            return;
+        }
+        // pull back every later entry of the run that would not be found past the hole
+        for (size_t j = (i + 1) & mask_; entries_[j].value != npos; j = (j + 1) & mask_)
+        {
+            const size_t home = Hash{}(entries_[j].key) & mask_;
+            if (((j - home) & mask_) >= ((j - i) & mask_))
             {
-                return &it->second;
+                entries_[i] = entries_[j];
+                i           = j;
             }
         }
-        return nullptr;
+        entries_[i].value = npos;
+    }
+
+  private:
+    struct entry
+    {
+        Key key{};
+        uint32_t value{npos};
+    };
+
+    size_t mask_{};
+    std::unique_ptr<entry[]> entries_;
+};
+
+struct order_key_hash
+{
+    size_t operator()(uint64_t key) const noexcept
+    {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        return size_t(key ^ (key >> 33));
+    }
+};
+
+// (instrument, side, price) of resting orders
+struct order_level_key
+{
+    uint64_t price_bits{};
+    uint32_t instrument{};
+    uint32_t side{};
+
+    bool operator==(const order_level_key& rhs) const noexcept
+    {
+        return price_bits == rhs.price_bits && instrument == rhs.instrument && side == rhs.side;
+    }
+
+    template <typename Order>
+    static order_level_key of(const Order& o) noexcept
+    {
+        order_level_key k;
+        auto const price = o.price + decltype(o.price)(); // -0.0 and 0.0 are one level
+        static_assert(sizeof(price) <= sizeof(k.price_bits));
+        std::memcpy(&k.price_bits, &price, sizeof(price));
+        k.instrument = uint32_t(o.instrument);
+        k.side       = uint32_t(o.side);
+        return k;
+    }
+};
+
+struct order_level_hash
+{
+    size_t operator()(const order_level_key& k) const noexcept
+    {
+        return order_key_hash{}(k.price_bits ^ (uint64_t(k.instrument) << 32 | k.side) * 0x9e3779b97f4a7c15ULL);
     }
+};
 
-	void add(order_id_t clord_id, order_t&& order)
-	{
-		auto it = orders.insert(std::make_pair(clord_id, std::forward<order_t>(order)));
-		//assert(it.second == true);
-		if (it.second)
-		{
-			//std::cout << __PRETTY_FUNCTION__ << ", add order to container: " << order << std::endl;
-		}
-		else
-		{
-			//std::cout << __PRETTY_FUNCTION__ << ", add order failed. existing order: " << it.first->second << std::endl;
-		}
-	}
+/*
+ * Live orders in preallocated slots. Pointers stay valid until remove(), so
+ * the order handler and the strategy can hold on to them.
+ *
+ * Primary key is the clOrdID, secondary indexes find an order by the FIX
+ * sequence it was last sent under (RefSeqNum of a reject), by exchange
+ * order id once acked, and every order resting at (instrument, side,
+ * price) through a list per level. All lookups are O(1), nothing allocates
+ * after construction.
+ *
+ * Order needs fix_sequence, exchange_key.key, instrument, side and price.
+ */
+template <typename Order>
+class basic_order_container
+{
+  public:
+    constexpr static const uint32_t default_capacity = 1u << 17;
+    constexpr static const uint32_t npos             = ~0u;
 
-    void update(order_id_t clord_id, order_id_t order_id, price_t price, quantity_t qty)
+  public:
+    explicit basic_order_container(uint32_t capacity = default_capacity)
+        : capacity_(capacity), slots_(std::make_unique<slot[]>(capacity)), levels_(std::make_unique<level[]>(capacity)),
+          by_clord_id_(capacity), by_sequence_(capacity), by_exchange_id_(capacity), by_level_(capacity)
     {
-        auto it = orders.find(clord_id);
-        if (it != orders.end())
+        for (uint32_t i = 0; i < capacity_; ++i)
         {
-            auto& order    = it->second;
-            order.price    = price;
-            order.qty      = qty;
-            order.exchange_key.key  = order_id;
+            slots_[i].next  = i + 1 < capacity_ ? i + 1 : npos;
+            levels_[i].next = slots_[i].next;
+        }
+        free_slot_  = capacity_ ? 0 : npos;
+        free_level_ = free_slot_;
+    }
+
+    basic_order_container(const basic_order_container&) = delete;
+    basic_order_container& operator=(const basic_order_container&) = delete;
+
+  public:
+    Order* get(order_id_t clord_id) noexcept { return at(by_clord_id_.find(clord_id)); }
+    const Order* get(order_id_t clord_id) const noexcept { return at(by_clord_id_.find(clord_id)); }
+
+    const Order* getBySequence(uint32_t sequence) const noexcept { return at(by_sequence_.find(sequence)); }
+    const Order* getByExchangeId(order_id_t order_id) const noexcept { return at(by_exchange_id_.find(order_id)); }
 
-            //std::cout << __PRETTY_FUNCTION__ << ", clord_id: " << clord_id << ", order_id: " << order_id
-            //        << ", price: " << price << ", qty: " << qty << std::endl;
+    // nullptr if clord_id is live already or the container is full
+    Order* add(order_id_t clord_id, Order&& order)
+    {
+        if (free_slot_ == npos || !by_clord_id_.insert(clord_id, free_slot_))
+        {
+            return nullptr;
         }
-        else
+        const uint32_t idx = free_slot_;
+        auto& s            = slots_[idx];
+        free_slot_         = s.next;
+
+        s.order    = std::move(order);
+        s.clord_id = clord_id;
+        index_sequence(idx);
+        index_exchange_id(idx);
+        link_level(idx);
+        ++size_;
+        return &s.order;
+    }
+
+    // ack or amend: exchange order id, new price (moves level) and qty
+    void update(order_id_t clord_id, order_id_t order_id, price_t price, quantity_t qty) noexcept
+    {
+        const uint32_t idx = by_clord_id_.find(clord_id);
+        if (idx == npos)
         {
-            //std::cout << __PRETTY_FUNCTION__ << ", order not found from container. clord_id: " << clord_id
-            //         << ", order_id: " << order_id << ", price: " << price << ", qty: " << qty << std::endl;
+            return;
+        }
+        auto& o = slots_[idx].order;
+        if (o.exchange_key.key != order_id)
+        {
+            unindex_exchange_id(idx);
+            o.exchange_key.key = order_id;
+            index_exchange_id(idx);
+        }
+        if (o.price != price)
+        {
+            unlink_level(idx);
+            o.price = price;
+            link_level(idx);
+        }
+        o.qty = qty;
+    }
+
+    // the order went out again (cancel, replace) under a new FIX sequence
+    void resequence(order_id_t clord_id, uint32_t sequence) noexcept
+    {
+        const uint32_t idx = by_clord_id_.find(clord_id);
+        if (idx == npos)
+        {
+            return;
+        }
+        unindex_sequence(idx);
+        slots_[idx].order.fix_sequence = sequence;
+        index_sequence(idx);
+    }
+
+    size_t remove(order_id_t clord_id) noexcept
+    {
+        const uint32_t idx = by_clord_id_.find(clord_id);
+        if (idx == npos)
+        {
+            return 0;
+        }
+        auto& s = slots_[idx];
+        by_clord_id_.erase(clord_id);
+        unindex_sequence(idx);
+        unindex_exchange_id(idx);
+        unlink_level(idx);
+
+        s.next     = free_slot_;
+        free_slot_ = idx;
+        --size_;
+        return 1;
+    }
+
+    // f(Order&) for each order resting at the level, oldest first
+    template <typename F>
+    void for_each_at_level(uint32_t instrument, uint32_t side, price_t price, F&& f)
+    {
+        Order probe{};
+        probe.instrument = decltype(probe.instrument)(instrument);
+        probe.side       = decltype(probe.side)(side);
+        probe.price      = price;
+        const uint32_t l = by_level_.find(order_level_key::of(probe));
+        if (l == npos)
+        {
+            return;
+        }
+        for (uint32_t i = levels_[l].head; i != npos;)
+        {
+            const uint32_t next = slots_[i].level_next;
+            f(slots_[i].order);
+            i = next;
         }
     }
 
-    size_t remove(order_id_t clord_id)
-	{
-		auto const cnt = orders.erase(clord_id);
-		//std::cout << __PRETTY_FUNCTION__ << " remove order " << cnt << " from container: " << ", order_id: " << clord_id << std::endl;
-		return cnt;
-	}
+    uint32_t count_at_level(const Order& like) const noexcept
+    {
+        const uint32_t l = by_level_.find(order_level_key::of(like));
+        return l == npos ? 0 : levels_[l].count;
+    }
 
-private:
-	order_map orders;
+    size_t size() const noexcept { return size_; }
+    size_t capacity() const noexcept { return capacity_; }
 
+  private:
+    struct slot
+    {
+        Order order{};
+        order_id_t clord_id{};
+        uint32_t next{npos}; // free list
+        uint32_t level{npos};
+        uint32_t level_prev{npos};
+        uint32_t level_next{npos};
+    };
+
+    struct level
+    {
+        order_level_key key{};
+        uint32_t head{npos};
+        uint32_t tail{npos};
+        uint32_t count{};
+        uint32_t next{npos}; // free list
+    };
+
+    Order* at(uint32_t idx) const noexcept { return idx == npos ? nullptr : &slots_[idx].order; }
+
+    // sequence/exchange id may be shared or unset (0), only the owner is indexed
+    void index_sequence(uint32_t idx) noexcept
+    {
+        if (auto const seq = slots_[idx].order.fix_sequence)
+        {
+            by_sequence_.insert(seq, idx, true);
+        }
+    }
+
+    void unindex_sequence(uint32_t idx) noexcept
+    {
+        auto const seq = slots_[idx].order.fix_sequence;
+        if (seq && by_sequence_.find(seq) == idx)
+        {
+            by_sequence_.erase(seq);
+        }
+    }
+
+    void index_exchange_id(uint32_t idx) noexcept
+    {
+        if (auto const id = slots_[idx].order.exchange_key.key)
+        {
+            by_exchange_id_.insert(id, idx, true);
+        }
+    }
+
+    void unindex_exchange_id(uint32_t idx) noexcept
+    {
+        auto const id = slots_[idx].order.exchange_key.key;
+        if (id && by_exchange_id_.find(id) == idx)
+        {
+            by_exchange_id_.erase(id);
+        }
+    }
+
+    // appended at the back of its level
+    void link_level(uint32_t idx) noexcept
+    {
+        auto& s        = slots_[idx];
+        auto const key = order_level_key::of(s.order);
+        uint32_t l     = by_level_.find(key);
+        if (l == npos)
+        {
+            l           = free_level_; // at most one level per order, never runs out first
+            free_level_ = levels_[l].next;
+            levels_[l]  = level{key};
+            by_level_.insert(key, l);
+        }
+        auto& lv     = levels_[l];
+        s.level      = l;
+        s.level_prev = lv.tail;
+        s.level_next = npos;
+        (lv.tail == npos ? lv.head : slots_[lv.tail].level_next) = idx;
+        lv.tail                                                   = idx;
+        ++lv.count;
+    }
+
+    void unlink_level(uint32_t idx) noexcept
+    {
+        auto& s  = slots_[idx];
+        auto& lv = levels_[s.level];
+        (s.level_prev == npos ? lv.head : slots_[s.level_prev].level_next) = s.level_next;
+        (s.level_next == npos ? lv.tail : slots_[s.level_next].level_prev) = s.level_prev;
+        if (--lv.count == 0)
+        {
+            by_level_.erase(lv.key);
+            lv.next     = free_level_;
+            free_level_ = s.level;
+        }
+        s.level = npos;
+    }
+
+  private:
+    uint32_t capacity_{};
+    size_t size_{};
+    uint32_t free_slot_{npos};
+    uint32_t free_level_{npos};
+    std::unique_ptr<slot[]> slots_;
+    std::unique_ptr<level[]> levels_;
+    order_index<uint64_t, order_key_hash> by_clord_id_;
+    order_index<uint64_t, order_key_hash> by_sequence_;
+    order_index<uint64_t, order_key_hash> by_exchange_id_;
+    order_index<order_level_key, order_level_hash> by_level_;
 };
 
-} // namespace cme
-} // namespace qx
+using order_container = basic_order_container<order_t>;
+
+} // namespace miye::trading::fix
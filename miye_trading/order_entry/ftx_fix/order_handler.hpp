@@ -1,170 +1,224 @@
 #pragma once
-#include "instrument_t.hpp"
-#include "libcore/qstream/mmap_writer.hpp"
-#include "libcore/utils/logging.hpp"
-#include "libcore/time/profiler.hpp"
 #include "libcore/essential/assert.hpp"
-#include <array>
+#include "libcore/qstream/mmap_writer.hpp"
+#include "libcore/qstream/qstream_place.hpp"
+#include "libcore/qstream/tcp_writer.hpp"
+#include "libs/logger/logger.hpp"
+#include "message/order_messages.hpp"
+#include "position/position.h"
+#include "risk/risk.h"
 #include <cassert>
+#include <chrono>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "../ftx_fix/fix_enum.hpp"
 #include "../ftx_fix/fix_price_utils.hpp"
 #include "../ftx_fix/fix_session.hpp"
+#include "../ftx_fix/instrument_t.hpp"
 #include "../ftx_fix/order.hpp"
 #include "../ftx_fix/order_container.hpp"
 #include "../ftx_fix/time_utils.hpp"
 
-namespace qx
-{
-namespace cme
-{
-using side_t = ::qx::types::message::side_t;
-
-inline side_t to_side(SideEnum side)
+namespace miye::trading::fix
 {
-    return side == SideEnum::Buy ? side_t::buy : side_t::sell;
-}
-
-template<typename Clock_t, typename session_t>
+using side_t = types::message::side_t;
+
+inline side_t to_side(SideEnum side) { return side == SideEnum::Buy ? side_t::buy : side_t::sell; }
+inline SideEnum to_fix_side(side_t side) { return side == side_t::sell ? SideEnum::Sell : SideEnum::Buy; }
+
+/*
+ * Order entry for every strategy of the gateway over one FIX session.
+ *
+ * Requests are the records strategies write to their request streams:
+ * on_request() runs pre-trade risk and sends them through the session's
+ * order templates, nothing is allocated on the way. The FIX callbacks turn
+ * execution reports into response records, written to the response stream
+ * of the strategy in the order key.
+ *
+ * ClOrdID is the strategy's order_key, which already holds session and
+ * strategy, so strategies sharing the session never collide and a report
+ * can be routed even for an order the gateway no longer knows.
+ *
+ * FTX acks OrderCancelReplaceRequest with a ModifyAck FixSession does not
+ * handle, order_replace is sent as a cancel of order_key and a new order
+ * under cl_order_key. A cancel for an order not acked yet is held and sent
+ * once the ack brings the exchange order id.
+ */
+template <typename Clock_t>
 struct order_handler_t
 {
-    using mm_writer_t   = ::qx::qstream::mmap_writer<Clock_t>;
-    using tcp_writer_t  = ::qx::qstream::tcp_writer<Clock_t>;
-    using fix_session_t = cme::FixSession;
-
-    using order_insert_t   = ::qx::types::message::order_insert;
-    using order_cancel_t   = ::qx::types::message::order_cancel;
-    using order_replace_t  = ::qx::types::message::order_replace;
-    using order_executed_t = ::qx::types::message::order_executed;
-    using order_booked_t   = ::qx::types::message::order_booked;
-    using order_rejected_t = ::qx::types::message::order_rejected;
-    using side_t           = ::qx::types::message::side_t;
-
-    using instrument_map_t = std::unordered_map<qx::types::instrument_id_t, instrument_t>;
-    using time_point_t     = std::chrono::high_resolution_clock::time_point;
-
-    order_handler_t(instrument_map_t& instruments,
-                    mm_writer_t*      mm_order_response_writer,
-                    tcp_writer_t*     tcp_writer,
-					mm_writer_t*	  fix_log_writer,
-                    const char*       buffer,
-                    const session_t&  session)
-    : instruments(instruments)
-    , out_buffer(buffer)
-    , fix_session(session)
-    , mm_order_response_writer(mm_order_response_writer)
-    , tcp_writer(tcp_writer)
-    , fix_log_writer(fix_log_writer)
-    , sequence(0)
+    using mm_writer_t   = qstream::mmap_writer<Clock_t>;
+    using tcp_writer_t  = qstream::tcp_writer<Clock_t>;
+    using fix_session_t = ftx::FixSession;
+
+    using order_msg_t       = types::message::order_msg;
+    using order_insert_t    = types::message::order_insert;
+    using order_cancel_t    = types::message::order_cancel;
+    using order_replace_t   = types::message::order_replace;
+    using order_receipt_t   = types::message::order_receipt;
+    using order_booked_t    = types::message::order_booked;
+    using order_executed_t  = types::message::order_executed;
+    using order_cancelled_t = types::message::order_cancelled;
+    using order_rejected_t  = types::message::order_rejected;
+    using msg_type_t        = types::message::msg_type_t;
+    using reject_reason_t   = types::message::reject_reason_t;
+    using cancel_reason_t   = types::message::cancel_reason_t;
+
+    template <typename T>
+    using record_t = types::message::record<T>;
+
+    using instrument_map_t = std::unordered_map<types::instrument_id_t, instrument_t>;
+
+    order_handler_t(instrument_map_t& instruments, fix_session_t& session, const char* buffer,
+                    tcp_writer_t* tcp_writer, mm_writer_t* fix_log_writer, risk::Risk& risk, logger::Logger* log)
+        : instruments(instruments), out_buffer(buffer), fix_session(session), tcp_writer(tcp_writer),
+          fix_log_writer(fix_log_writer), risk(risk), log_(log), timestamp(OrderTemplateWidths::SendingTime, '0')
     {
+        fix_session.initTemplate(cancel_template);
+    }
+
+    // responses for orders of strategy go to writer
+    void add_strategy(types::strategy_id_t strategy, mm_writer_t* writer)
+    {
+        if (response_writers.size() <= strategy)
+        {
+            response_writers.resize(strategy + 1);
+        }
+        response_writers[strategy] = writer;
     }
 
     //------------------------------------------------------------------------------------------------------//
     //-------------------------------------- outgoing message functions-------------------------------------//
     //------------------------------------------------------------------------------------------------------//
-    template<typename Profiler>
-    inline uint64_t place_order(const order_insert_t& oi, const uint64_t now, const std::string& timestamp, uint64_t hi_arb_start_cycles,  Profiler& prof)
+
+    // one record off a request stream
+    void on_request(const qstream::place& plc, uint64_t now)
     {
-        // only support limit order for now
-        ASSERT(oi.duration == qx::types::message::duration_t::day);
-        ASSERT(oi.side != qx::types::message::side_t::undefined);
-        const cme::SideEnum side =
-            oi.side == qx::types::message::side_t::sell ? cme::SideEnum::Sell : cme::SideEnum::Buy;
-        auto const& ins = get_security_desc(oi.instrument);
-
-        size_t len = 0;
-
-        double d_price = price_utils::round_by_tick_and_precision(oi.price, ins.tick_size, ins.precision);
-        double price = price_utils::apply_price_factor_to_out_price(d_price, ins.display_factor);
-
-        int32_t last_precision = qx::price_utils::get_precision_delta(ins.precision, ins.display_factor);
-
-		len = fix_session.placeOrder(cme::OrderTypeEnum::Limitorder,
-										 cme::TimeInforceEnum::Day,
-										 oi.order_key.key,
-										 side,
-										 price,			// double
-										 last_precision,
-										 oi.volume,
-										 ins.symbol,
-										 ins.security_desc,
-										 timestamp);
-        TIME(fix_msg_prepared);
-
-        auto send_ts = send_and_log(out_buffer, len);
-        TIME(fix_msg_sent);
-
-        WRITE_TIME(prof, time::profiler_trigger::om_fix_msg_prep, fix_msg_prepared - hi_arb_start_cycles, 0, 0, 0, 0, 0);
-        WRITE_TIME(prof, time::profiler_trigger::om_msg_sent, fix_msg_sent - fix_msg_prepared, 0, 0, 0, 0, 0);
-
-        // send order receipt back to trading engine for profile measurement
+        if (UNLIKELY(plc.size < order_msg_t::msg_size))
         {
-        	types::message::order_receipt om {};
-        	om.order_key = oi.order_key;
-        	om.instrument = oi.instrument;
-        	om.session = trading::session;
-        	/*
-        	 * if md_key is populated, sets to om_receive_time for profiling
-        	 */
-        	om.om_receive_time = oi.md_key > 0 ? oi.md_key.key : now;
-        	om.om_sent_time = send_ts;
-        	mm_order_response_writer->write(&om, sizeof(types::message::order_receipt));
+            log_->error("short order request size:{}", plc.size);
+            return;
+        }
+        auto const& head = *static_cast<const order_msg_t*>(plc.start);
+        switch (head.type)
+        {
+        case msg_type_t::order_insert:
+            place_order(static_cast<const order_insert_t&>(head), now);
+            break;
+        case msg_type_t::order_cancel:
+            cancel_order(static_cast<const order_cancel_t&>(head), now);
+            break;
+        case msg_type_t::order_replace:
+            replace_order(static_cast<const order_replace_t&>(head), now);
+            break;
+        default:
+            log_->error("unexpected order request type:{} order_key:{}", to_english(head.type), head.order_key);
+            break;
         }
-
-        // map order_insert_t.order_key.key to clord_id(tag 11)
-        // when order acks from exchange, set order_t::order_id to exchange_order_id(tag37)
-        const order_id_t clord_id = oi.order_key.key;
-        orders.add(clord_id, order_t(oi, fix_session.getLastSequenceNum()));
-
-        LOG_INFO("[place_order] instrument: cme_inst: " << ins.instrument_id
-        		  << ", order_id: " << oi.order_key.key
-        		  << ", cl_order_id: " << oi.cl_order_key.key
-				  << ", oi.order: " << oi.order_key
-        		  << ", instrument: " << oi.instrument
-				  << ", order_type: " << toUnderlyingType(cme::OrderTypeEnum::Limitorder)
-				  << ", tif: " << toUnderlyingType(cme::TimeInforceEnum::Day)
-        		  << ", original price: " << oi.price
-				  << ", applied display factor price: " << price
-				  << ", qty: " << oi.volume
-				  << ", side: " << oi.side
-				  << ", symbol: " << ins.symbol
-				  << ", security_desc: " << ins.security_desc
-				  << ", send_ts: " << send_ts);
-        return send_ts;
     }
 
-    inline uint64_t cancel_order(const order_cancel_t& o, const uint64_t now, const std::string& timestamp)
+    uint64_t place_order(const order_insert_t& oi, uint64_t now)
     {
-        const uint64_t order_id = o.order_key.key;
-        auto const&    ins      = get_security_desc(o.instrument);
-
-        assert(o.side != side_t::undefined);
-        const cme::SideEnum side = o.side == side_t::sell ? cme::SideEnum::Sell : cme::SideEnum::Buy;
+        auto* ins = find_instrument(oi.instrument);
+        if (!ins || oi.side == side_t::undefined)
+        {
+            reject(oi, msg_type_t::order_insert, reject_reason_t::parameter, oi.volume, "bad request");
+            return 0;
+        }
+        if (!session_enabled())
+        {
+            reject(oi, msg_type_t::order_insert, reject_reason_t::session, oi.volume, "no session");
+            return 0;
+        }
+        if (orders.get(oi.order_key.key) || orders.size() == orders.capacity())
+        {
+            reject(oi, msg_type_t::order_insert, reject_reason_t::parameter, oi.volume, "order key");
+            return 0;
+        }
+        auto const price = qx::price_utils::round_to_nearest_tick(Price::fromDouble(oi.price), ins->tick_size);
+        if (!allow_order(*ins, oi.side, price, oi.volume, now))
+        {
+            reject(oi, msg_type_t::order_insert, reject_reason_t::risk, oi.volume, "risk");
+            return 0;
+        }
+        return send_new_order(*ins, oi, price, now);
+    }
 
-        auto* order = orders.get(order_id);
+    uint64_t cancel_order(const order_cancel_t& oc, uint64_t now)
+    {
+        const order_id_t clord_id = oc.order_key.key;
+        auto* order               = orders.get(clord_id);
         if (!order)
         {
-        	LOG_INFO("[cancel_order] order not found, order_id: " << order_id);
+            reject(oc, msg_type_t::order_cancel, reject_reason_t::unknown_order, 0, "unknown");
             return 0;
         }
-        else
+        if (order->last_request != msg_type_t::order_insert)
+        {
+            return 0; // already being cancelled
+        }
+        if (!session_enabled())
+        {
+            reject(oc, msg_type_t::order_cancel, reject_reason_t::session, 0, "no session");
+            return 0;
+        }
+        order->last_request = msg_type_t::order_cancel;
+        if (order->status != order_status_t::booked)
+        {
+            return 0; // goes out with the ack
+        }
+        return send_cancel(*order, clord_id);
+    }
+
+    uint64_t replace_order(const order_replace_t& orp, uint64_t now)
+    {
+        const order_id_t clord_id = orp.order_key.key;
+        auto* order               = orders.get(clord_id);
+        auto* ins                 = find_instrument(orp.instrument);
+        if (!order || order->last_request != msg_type_t::order_insert)
+        {
+            reject(orp, msg_type_t::order_replace, reject_reason_t::unknown_order, orp.volume, "unknown");
+            return 0;
+        }
+        if (!ins || orders.get(orp.cl_order_key.key) || orders.size() == orders.capacity())
         {
-            // just return if orders are not found?
-            // how should we handle if order entry adapter is restarted?
-            auto const len = fix_session.cancelOrder(side, order->exchange_key.key, order_id, ins.symbol, ins.security_desc, timestamp);
-            auto send_ts = send_and_log(out_buffer, len);
-            order->last_request = types::message::msg_type_t::order_cancel;
-            LOG_INFO("[cancel_order] cancel order: " << *order
-				  << ", receive_time: " << now
-				  << ", send_ts: " << send_ts);
-            return send_ts;
+            reject(orp, msg_type_t::order_replace, reject_reason_t::parameter, orp.volume, "bad request");
+            return 0;
         }
+        if (!session_enabled())
+        {
+            reject(orp, msg_type_t::order_replace, reject_reason_t::session, orp.volume, "no session");
+            return 0;
+        }
+        auto const price = qx::price_utils::round_to_nearest_tick(Price::fromDouble(orp.price), ins->tick_size);
+        if (!allow_order(*ins, orp.side, price, orp.volume, now))
+        {
+            reject(orp, msg_type_t::order_replace, reject_reason_t::risk, orp.volume, "risk");
+            return 0;
+        }
+
+        order->last_request = msg_type_t::order_replace;
+        if (order->status == order_status_t::booked)
+        {
+            send_cancel(*order, clord_id);
+        }
+
+        order_insert_t oi{};
+        static_cast<order_msg_t&>(oi) = orp;
+        oi.type         = msg_type_t::order_insert;
+        oi.order_key    = orp.cl_order_key;
+        oi.price        = orp.price;
+        oi.volume       = orp.volume;
+        oi.side         = orp.side;
+        oi.duration     = orp.duration;
+        return send_new_order(*ins, oi, price, now);
     }
 
     uint64_t send_and_log(const char* buf, size_t len) const
     {
-        ASSERT_MSG(len <= FixSession::OutBufferSize, DUMP(len) << DUMP(FixSession::OutBufferSize));
+        ASSERT_MSG(len <= fix_session_t::OutBufferSize, DUMP(len) << DUMP(fix_session_t::OutBufferSize));
         tcp_writer->write(buf, len);
         auto ts = tcp_writer->last_send_ts();
         fix_log_writer->write(buf, len);
@@ -173,387 +227,315 @@ struct order_handler_t
 
     void logon()
     {
-    	auto const len = fix_session.logon();
-    	send_and_log(out_buffer, len);
+        auto const len = fix_session.logon();
+        send_and_log(out_buffer, len);
     }
 
     void logout()
     {
-    	if (session_enabled())
-    	{
-			auto const len = fix_session.logout();
-			send_and_log(out_buffer, len);
-    	}
+        if (session_enabled())
+        {
+            auto const len = fix_session.logout();
+            send_and_log(out_buffer, len);
+        }
     }
 
     void send_heartbeat()
     {
-    	auto const len = fix_session.sendHeartBeat();
-    	send_and_log(out_buffer, len);
+        auto const len = fix_session.sendHeartBeat();
+        send_and_log(out_buffer, len);
     }
 
-    void log(const char* buf, size_t len) const
-    {
-    	fix_log_writer->write(buf, len);
-    }
-    /*
-     * not supported at the moment
-     */
-    inline void cancel_replace_order(tcp_writer_t&, fix_session_t&, const order_replace_t&, const std::string&)
-    {
-    	assert(0);
-    }
+    void log(const char* buf, size_t len) const { fix_log_writer->write(buf, len); }
 
     //------------------------------------------------------------------------------------------------------//
     //-------------------------------------- incoming message callbacks ------------------------------------//
     //------------------------------------------------------------------------------------------------------//
-    void consume_tcp_buffer(const ::qx::qstream::place& plc)
+    void consume_tcp_buffer(const qstream::place& plc)
     {
-
-        fix_session.consume_tcp_buffer(*this, plc, session_enabled());
+        fix_session.consumeTcpBuffer(*this, static_cast<const char*>(plc.start), plc.size);
     }
 
-    void onOrderAck(uint64_t     exchange_instrument_id,
-					order_id_t   order_id,
-					clorder_id_t clord_id,
-                    quantity_t   qty,
-                    price_t      price,
-                    SideEnum     side,
-					const std::string& security_desc)
+    void onOrderAck(order_id_t order_id, clorder_id_t clord_id, quantity_t qty, price_t price, SideEnum side)
     {
-
-        assert(side != SideEnum::Unknown);
-
-        ::qx::types::message::order_booked om{};
-        om.session = trading::session;
-        om.order_key.key = clord_id;
-        om.volume = qty;
-
-        om.price = price_utils::apply_price_factor_to_in_price(price, get_display_factor(security_desc));
-
-        om.exchange_key = order_id;
-        om.side = to_side(side);
-        om.sequence = sequence;
+        record_t<order_booked_t> om;
+        om->order_key.key = clord_id;
+        om->exchange_key  = order_id;
+        om->price         = price;
+        om->volume        = qty;
+        om->side          = to_side(side);
 
         auto* order = orders.get(clord_id);
-        if (order)
+        if (!order)
         {
-            order->status = order_status_t::booked;
-            order->exchange_key.key = order_id;
-            om.cl_order_key = order->clord_id;
-            om.instrument = order->instrument;
-            om.duration = order->duration;
-
-            LOG_INFO("onOrderAck, change order exchange id and status: " << *order);
+            log_->error("onOrderAck unknown clord_id:{} order_id:{}", clord_id, order_id);
+            respond(om);
+            return;
         }
-        else
+        orders.update(clord_id, order_id, price, qty);
+        order->status     = order_status_t::booked;
+        om->instrument    = order->instrument;
+        om->cl_order_key  = order->clord_id;
+        om->duration      = order->duration;
+        respond(om);
+
+        // cancel or replace that came in before the ack
+        if (order->last_request != msg_type_t::order_insert)
         {
-            uint32_t qcl_instrument_id = get_qcl_instrument(security_desc);
-            om.instrument = qcl_instrument_id;
-
-            LOG_ERROR("Unable to locate exchange order on order ack " << order_id << " for exchange instrument " << exchange_instrument_id << " qcl_instrument_id " << qcl_instrument_id);
+            send_cancel(*order, clord_id);
         }
-
-        mm_order_response_writer->write(&om, sizeof(order_booked_t));
-        ++sequence;
-
-        LOG_INFO("onOrderAck, exchange_instrument_id: " << exchange_instrument_id
-                << ", instrument_id: " << om.instrument
-        		<< ", security_desc: "   << security_desc
-        		<< ", clord_id: " << clord_id
-        		<< ", order_id: " << order_id
-				<< ", qty: "      << qty
-				<< ", price: "    << price
-				<< ", side: "     << static_cast<char>(side));
-
     }
 
-    void onOrderReject(uint64_t           exchange_instrument_id,
-    				   order_id_t         order_id,
-                       clorder_id_t       clord_id,
-                       quantity_t         qty,
-                       uint32_t           reject_reason,
-					   const std::string& security_desc,
+    void onOrderReject(order_id_t order_id, clorder_id_t clord_id, quantity_t qty, uint32_t reject_reason,
                        const std::string& text)
     {
-    	using qx::types::message::reject_reason_t;
-
-        order_rejected_t om{};
-        om.session          = trading::session;
-        om.order_key.key    = clord_id;
-        om.rejected_volume  = qty;
-        om.reason_text      = text;
-        om.sequence = sequence;
-
-        auto* order = orders.get(clord_id);
-        if (order)
-        {
-            om.instrument       = order->instrument;
-            om.cl_order_key = order->clord_id;
-            om.request_type = order->last_request;
-
-            auto const cnt = orders.remove(clord_id);
-            LOG_INFO("[onOrderReject] order rejected by gateway, exchange order_id: " << order_id
-                    << ", clord_id: " << clord_id
-                    << ", qty: " << qty
-                    << ", reject_id: " << reject_reason
-                    << ", security_desc: " << security_desc
-                    << ", reject reason: " << text
-                    << " " << cnt << " order removed from cache");
-        }
-        else
+        record_t<order_rejected_t> om;
+        om->order_key.key   = clord_id;
+        om->request_type    = msg_type_t::order_insert;
+        om->reason          = reject_reason_t::parameter;
+        om->rejected_volume = qty;
+        om->set_text(text.data(), text.size());
+        if (auto const* order = orders.get(clord_id))
         {
-            uint32_t qcl_instrument_id = get_qcl_instrument(security_desc);
-            om.instrument = qcl_instrument_id;
-            LOG_ERROR("Unable to locate exchange order on reject " << order_id << " for exchange instrument " << exchange_instrument_id << " qcl_instrument_id " << qcl_instrument_id);
+            om->instrument   = order->instrument;
+            om->cl_order_key = order->clord_id;
+            order_done(*order);
         }
+        respond(om);
+        orders.remove(clord_id);
 
-
-        /*
-         * http://www.cmegroup.com/confluence/display/EPICSANDBOX/iLink+Reject+Codes
-         */
-        if (reject_reason == 2130 || reject_reason == 1003)
-        {
-        	om.reason = reject_reason_t::closed;
-        }
-        else
-        {
-        	om.reason = reject_reason_t::parameter;
-        }
-        mm_order_response_writer->write(&om, sizeof(order_rejected_t));
-        ++sequence;
-
+        log_->info("onOrderReject clord_id:{} order_id:{} reason:{} text:{}", clord_id, order_id, reject_reason, text);
     }
 
-    void onFill(uint64_t           exchange_instrument_id,
-                uint64_t           order_id,
-                uint64_t           clord_id,
-                price_t            price,
-                uint32_t           exec_qty,
-                uint32_t           leaves_qty,
-                SideEnum           side,
-                const std::string& security_desc,
-                bool               full_fill)
+    void onFill(order_id_t order_id, clorder_id_t clord_id, price_t price, quantity_t exec_qty,
+                quantity_t leaves_qty, SideEnum side, bool full_fill)
     {
-        order_executed_t om {};
-
-        om.session          = trading::session;
-        om.order_key.key    = clord_id;
-
-        double display_factor = get_display_factor(security_desc);
-
-        om.executed_price  = price_utils::apply_price_factor_to_in_price(price, display_factor);
-        om.executed_volume = exec_qty;
-        om.side            = to_side(side);
-        om.sequence        = sequence;
-        ++sequence;
-
-        LOG_INFO("[onFill], order fill, order_id: " << order_id
-        		<< ", clord_id: " << clord_id
-				<< ", price: " << price
-				<< ", real price: " << om.executed_price
-				<< ", volume: " << exec_qty
-				<< ", leaves_qty: " << leaves_qty
-				<< ", side: " << toUnderlyingType(side)
-				<< ", security_desc: " << security_desc
-				<< ", is_full_fill: " << full_fill);
-
-        auto* order = orders.get(clord_id);
-
+        record_t<order_executed_t> om;
+        om->order_key.key   = clord_id;
+        om->match_id        = ++match_id;
+        om->executed_price  = price;
+        om->executed_volume = exec_qty;
+        om->leaves_volume   = leaves_qty;
+        om->side            = to_side(side);
+        auto* order         = orders.get(clord_id);
         if (order)
         {
-            om.instrument = order->instrument;
-            om.cl_order_key = order->clord_id;
+            om->instrument   = order->instrument;
+            om->cl_order_key = order->clord_id;
+            order->filled += exec_qty;
+            if (auto* ins = find_instrument(order->instrument))
+            {
+                ins->position.onFill(to_position_side(order->side), order->price, price, exec_qty);
+            }
         }
         else
         {
-            uint32_t qcl_instrument_id = get_qcl_instrument(security_desc);
-            om.instrument = qcl_instrument_id;
-            LOG_ERROR("Unable to locate exchange order on fill " << order_id << " for exchange instrument " << exchange_instrument_id << " qcl_instrument_id " << qcl_instrument_id);
+            log_->error("onFill unknown clord_id:{} order_id:{}", clord_id, order_id);
         }
-
-        mm_order_response_writer->write(&om, sizeof(order_executed_t));
+        respond(om);
 
         if (full_fill)
         {
-            auto const cnt = orders.remove(clord_id);
-            LOG_INFO("[onFill] " << cnt << " order removed from cache, clord_id: " << clord_id);
+            if (order)
+            {
+                order_done(*order);
+            }
+            orders.remove(clord_id);
         }
     }
 
-    void onCancelAck(uint64_t     exchange_instrument_id,
-                     order_id_t   order_id,
-                     clorder_id_t clord_id,
-                     quantity_t   qty,
-                     price_t      price,
-                     SideEnum     side,
-					 const std::string& security_desc)
+    void onCancelAck(order_id_t order_id, clorder_id_t clord_id, quantity_t qty, price_t price, SideEnum side)
     {
-        ::qx::types::message::order_cancelled om{};
-
-        om.session          = trading::session;
-        om.order_key.key    = clord_id;
-
-        om.cancelled_volume = qty;
-        om.side             = to_side(side);
-        om.sequence = sequence++;
-
-        auto* order = orders.get(clord_id);
-        if (order)
+        record_t<order_cancelled_t> om;
+        om->order_key.key    = clord_id;
+        om->cancelled_volume = qty;
+        om->side             = to_side(side);
+        om->reason           = cancel_reason_t::exchange;
+        if (auto const* order = orders.get(clord_id))
         {
-            om.instrument = order->instrument;
-            om.cl_order_key = order->clord_id;
-        }
-        else
-        {
-            uint32_t qcl_instrument_id = get_qcl_instrument(security_desc);
-            om.instrument = qcl_instrument_id;
-            LOG_ERROR("Unable to locate exchange order cancel ack " << order_id << " for exchange instrument " << exchange_instrument_id << " qcl_instrument_id " << qcl_instrument_id);
+            om->instrument   = order->instrument;
+            om->cl_order_key = order->clord_id;
+            if (order->last_request == msg_type_t::order_replace)
+            {
+                om->reason = cancel_reason_t::replace;
+            }
+            else if (order->last_request == msg_type_t::order_cancel)
+            {
+                om->reason = cancel_reason_t::strategy;
+            }
+            order_done(*order);
         }
-        mm_order_response_writer->write(&om, sizeof(::qx::types::message::order_cancelled));
-
-        auto const cnt = orders.remove(clord_id);
-
-        LOG_INFO("[onCancelAck] order_id: " << order_id
-        		<< ", clord_id: " << clord_id
-				<< ", price: " << price
-				<< ", volume: " << qty
-				<< ", side: " << toUnderlyingType(side)
-				<< " " << cnt << " order removed from cache");
+        respond(om);
+        orders.remove(clord_id);
     }
 
-    void onOrderCancelReject(uint64_t order_id, uint64_t clord_id, const std::string& text)
+    void onOrderCancelReject(order_id_t order_id, clorder_id_t clord_id, uint32_t reason)
     {
-    	::qx::types::message::order_rejected om {};
-        om.order_key.key    = clord_id;
-        om.session          = trading::session;
-        om.reason_text      = text;
-        auto* order = orders.get(clord_id);
-        if (order)
-        {
-            om.instrument = order->instrument;
-            om.cl_order_key = order->clord_id;
-        }
-        else
+        record_t<order_rejected_t> om;
+        om->order_key.key = clord_id;
+        om->request_type  = msg_type_t::order_cancel;
+        om->reason        = reason == 1 ? reject_reason_t::unknown_order : reject_reason_t::parameter;
+        if (auto* order = orders.get(clord_id))
         {
-            LOG_INFO("Unable to locate exchange order cancel reject " << order_id);
+            om->instrument      = order->instrument;
+            om->cl_order_key    = order->clord_id;
+            om->request_type    = order->last_request;
+            order->last_request = msg_type_t::order_insert;
         }
+        respond(om);
 
-        mm_order_response_writer->write(&om, sizeof(::qx::types::message::order_rejected));
-
-    	LOG_INFO("[onOrderCancelReject] order_id: " << order_id
-    			<< ", clord_id: " << clord_id
-				<< ", reason: " << text);
-    }
-
-    void onTradeCancelled(uint64_t           order_id,
-                          uint64_t           clord_id,
-                          price_t            price,
-                          uint32_t           last_qty,
-                          SideEnum           side,
-                          const std::string& exec_id,
-                          const std::string& symbol)
-    {
-        LOG_ERROR("trade cancelled, symbol:" << symbol
-        		  << ", order_id: " << order_id
-        		  << ", clord_id: " << clord_id
-				  << ", price: "    << price
-				  << ", last_qty: "	<< last_qty
-				  << ", side: "		<< toUnderlyingType(side)
-				  << ", trade_id: " << exec_id);
+        log_->info("onOrderCancelReject clord_id:{} order_id:{} reason:{}", clord_id, order_id, reason);
     }
 
     void onSessionLevelReject(uint32_t seq, const std::string& reason)
     {
-        const order_t* o = orders.getBySequence(seq);
-        if (o)
+        auto const* o = orders.getBySequence(seq);
+        if (!o)
         {
-            onOrderCancelReject(o->order_id.key, o->clord_id.key, reason);
+            log_->error("session level reject, no order for fix sequence:{} reason:{}", seq, reason);
+            return;
+        }
+        if (o->status == order_status_t::booked)
+        {
+            onOrderCancelReject(o->exchange_key.key, o->order_id.key, 0);
         }
         else
         {
-            LOG_ERROR("Unable to find order matching fix sequence " << seq);
+            onOrderReject(o->exchange_key.key, o->order_id.key, o->qty, 0, reason);
         }
     }
 
     void on_logon()
     {
-    	enable_session();
+        log_->info("fix session logged on");
+        enable_session();
     }
 
     void on_logout()
     {
-    	disable_session();
+        log_->info("fix session logged out");
+        disable_session();
     }
 
-    const cme::instrument_t& get_security_desc(qx::types::instrument_id_t instrument_id) const
+    void disable_session() { is_session_ok = false; }
+    void enable_session() { is_session_ok = true; }
+    bool session_enabled() const { return is_session_ok; }
+    size_t live_orders() const { return orders.size(); }
+
+  private:
+    instrument_t* find_instrument(types::instrument_id_t instrument_id)
     {
         auto it = instruments.find(instrument_id);
-        assert(it != instruments.end());
-        return it->second;
+        return it == instruments.end() ? nullptr : &it->second;
     }
 
-    uint32_t get_qcl_instrument(const std::string& security_desc) const
+    static Side to_position_side(side_t side) { return side == side_t::sell ? Side::SELL : Side::BUY; }
+
+    // what is left of an order that is cancelled, rejected or filled is no longer open
+    void order_done(const order_t& order)
     {
-        for (auto const e : instruments)
+        if (auto* ins = find_instrument(order.instrument))
         {
-            if (e.second.security_desc == security_desc)
-            {
-                return e.first;
-            }
+            auto const leaves = order.qty > order.filled ? order.qty - order.filled : 0;
+            ins->position.onOrderDone(to_position_side(order.side), order.price, leaves);
         }
-
-        return 0;
     }
 
-    double get_display_factor(const std::string& security_desc) const
+    bool allow_order(instrument_t& ins, side_t side, Price price, quantity_t qty, uint64_t now)
     {
-        for (auto const e : instruments)
-        {
-            auto const& instrument = e.second;
-            if (instrument.security_desc == security_desc)
-            {
-                return instrument.display_factor;
-            }
-        }
-
-        LOG_WARNING("display factor not found for " << security_desc << " use default 1.0");
-        return 1.0;
+        auto& o     = ins.risk_order;
+        o.side      = to_position_side(side);
+        o.price     = price;
+        o.qty       = Qty::fromDouble(qty);
+        o.entrySize = o.qty;
+        o.size      = o.qty;
+        return risk.allowOrder(
+            time::NanoTime{std::chrono::nanoseconds(now)}, ins.risk_id, ins.symbol, o, ins.position);
     }
 
-    session_t& get_session() { return fix_session; }
+    uint64_t send_new_order(instrument_t& ins, const order_insert_t& oi, Price price, uint64_t now)
+    {
+        stamp();
+        auto const len =
+            fix_session.placeOrder(ins.new_order_template(oi.side), oi.order_key.key, price, Qty::fromDouble(oi.volume),
+                                   timestamp);
+        auto const send_ts = send_and_log(out_buffer, len);
+
+        order_t order(oi, fix_session.getLastSequenceNum());
+        order.price  = price.toDouble();
+        order.status = order_status_t::new_order;
+        ins.position.onPlaceOrder(to_position_side(oi.side), order.price, oi.volume);
+        orders.add(oi.order_key.key, std::move(order));
+
+        record_t<order_receipt_t> om;
+        static_cast<order_msg_t&>(*om) = oi;
+        om->type            = msg_type_t::order_receipt;
+        om->version         = order_receipt_t::msg_version;
+        om->om_receive_time = oi.md_key ? oi.md_key : now;
+        om->om_sent_time    = send_ts;
+        respond(om);
+        return send_ts;
+    }
 
-    const time_point_t& get_last_sent_tp() const { return last_sent_tp; }
-    void set_last_sent_tp(const time_point_t& tp) { last_sent_tp = tp; }
+    uint64_t send_cancel(order_t& order, order_id_t clord_id)
+    {
+        stamp();
+        auto const len     = fix_session.cancelOrder(cancel_template, order.exchange_key.key, clord_id, timestamp);
+        auto const send_ts = send_and_log(out_buffer, len);
+        order.status       = order_status_t::pending_close;
+        orders.resequence(clord_id, fix_session.getLastSequenceNum());
+        return send_ts;
+    }
 
-    bool can_send_next_msg(const time_point_t& tp) const
+    void reject(const order_msg_t& request, msg_type_t request_type, reject_reason_t reason, quantity_t qty,
+                const char* text)
     {
-    	return tp - last_sent_tp > std::chrono::seconds(29);
+        record_t<order_rejected_t> om;
+        static_cast<order_msg_t&>(*om) = request;
+        om->type            = msg_type_t::order_rejected;
+        om->version         = order_rejected_t::msg_version;
+        om->request_type    = request_type;
+        om->reason          = reason;
+        om->rejected_volume = qty;
+        om->set_text(text, std::strlen(text));
+        respond(om);
+
+        log_->error("rejected {} order_key:{} reason:{}", to_english(request_type), request.order_key.key,
+                    to_english(reason));
     }
-    void disable_session() { is_session_ok = false; }
-    void enable_session() { is_session_ok = true; }
-    bool session_enabled() const { return is_session_ok; }
-    void warm_cache()
+
+    template <typename T>
+    void respond(record_t<T>& om)
     {
-        if(tcp_writer){
-            // this causes untraceable onload segfault
-            //PREFETCH_WRITE(&tcp_writer->writebuffer[0]);
+        om->sequence = ++sequence;
+        auto const strategy = om->order_key.strategy;
+        auto* writer        = strategy < response_writers.size() ? response_writers[strategy] : nullptr;
+        if (UNLIKELY(!writer))
+        {
+            log_->error("no response stream for strategy:{} {}", strategy, to_english(om->type));
+            return;
         }
+        writer->write(om.data(), om.size());
     }
 
-private:
+    // SendingTime for the order templates, fixed width
+    void stamp() { time_utils::to_time_str(timestamp, std::chrono::high_resolution_clock::now()); }
+
+  private:
     instrument_map_t& instruments;
-    const char*       out_buffer{};
-    session_t         fix_session{};
-    mm_writer_t*      mm_order_response_writer{};
-    tcp_writer_t*     tcp_writer{};
-    mm_writer_t*	  fix_log_writer {};
-    time_point_t      last_sent_tp;
-    bool is_session_ok {};
-    order_container   orders;
-    uint32_t          sequence;
+    const char* out_buffer{};
+    fix_session_t& fix_session;
+    tcp_writer_t* tcp_writer{};
+    mm_writer_t* fix_log_writer{};
+    risk::Risk& risk;
+    logger::Logger* log_{};
+    std::vector<mm_writer_t*> response_writers;
+    OrderCancelRequestTemplate cancel_template;
+    std::string timestamp;
+    bool is_session_ok{};
+    order_container orders;
+    uint32_t sequence{};
+    uint64_t match_id{};
 };
 
-} // namespace cme
-} // namespace qx
-
+} // namespace miye::trading::fix
@@ -1,22 +1,42 @@
 #include "benchmark/benchmark.h"
 #include <iostream>
 #include <string.h>
+#include <string>
 
+#include "../../ftx_fix/fix_index.hpp"
 #include "../../ftx_fix/fix_number_utils.hpp"
 #include "../../ftx_fix/ftx_fix_reader.hpp"
 #include "../../ftx_fix/ftx_fix_writer.hpp"
 #include "../../ftx_fix/string_const.hpp"
 
+using namespace miye::trading::fix;
+
+static std::string with_trailer(std::string m)
+{
+    char cksum[4];
+    snprintf(cksum, sizeof(cksum), "%03u", calcCheckSum(m.data(), m.size()) % 256);
+    return m + "10=" + cksum + "\001";
+}
+
+// ftx fill, header fields first then the body
+static const std::string fill_report = [] {
+    std::string body = "35=8\00149=FTX\00156=LJT0QLN\00134=9589\00152=20210406-12:31:53.061\001"
+                       "1=main\0016=0\00111=1019100002\00114=0.0010\00117=84285:27897646\00131=58123.5\00132=0.0010"
+                       "\00137=844213050107\00138=0.0020\00139=1\00140=2\00144=58123.5\00154=1\00155=BTC-PERP\001"
+                       "60=20210406-12:31:53.060\001150=1\001151=0.0010\0011057=Y\0011366=2738121\00112=0.0379"
+                       "\00113=3\001";
+    return with_trailer("8=FIX.4.2\0019=" + std::to_string(body.size()) + "\001" + body);
+}();
+
 static void fix_reader(benchmark::State& state)
 {
-    const char* fix="8=FIX.4.2\0019=314\00135=8\00134=9589\001369=9904\00152=20170406-12:31:53.061\00149=CME\00150=84\00156=LJT0QLN\00157=RVINE\001143=HK\0011=88234\0016=0\00111=1019100002\00114=0\00117=84285:27897646\00120=0\00137=844213050107\00138=7\00139=0\00140=2\00141=0\00144=151.46875\00148=39039\00154=1\00155=ZB\00159=0\00160=20170406-12:31:53.060\001107=ZBM7\001150=0\001151=7\001167=FUT\001432=20170406\0011028=N\0015979=1491481913060258537\00110=184\001";
-    qx::cme::StandardHeaderReader headerReader;
-    qx::cme::ExecutionReportReader msgReader;
+    StandardHeaderReader headerReader;
+    ExecutionReportReader msgReader;
 
-    while(state.KeepRunning())
+    while (state.KeepRunning())
     {
-        qx::cme::FixIstream fixIstream;
-        fixIstream.setBuffer(fix, strlen(fix));
+        FixIstream fixIstream;
+        fixIstream.setBuffer(fill_report.data(), fill_report.size());
 
         benchmark::DoNotOptimize(headerReader.read(fixIstream));
         benchmark::DoNotOptimize(msgReader.read(fixIstream));
@@ -28,70 +48,110 @@ static void fix_reader(benchmark::State& state)
 
 BENCHMARK(fix_reader);
 
+// every field through getCurrent, the work the index does in one pass
+static void fix_istream_walk(benchmark::State& state)
+{
+    while (state.KeepRunning())
+    {
+        FixIstream fixIstream;
+        fixIstream.setBuffer(fill_report.data(), fill_report.size());
+        uint32_t tags{};
+        while (fixIstream.hasNext())
+        {
+            tags += std::get<0>(fixIstream.getCurrent());
+        }
+        benchmark::DoNotOptimize(tags);
+    }
+}
+
+BENCHMARK(fix_istream_walk);
+
+static void fix_reader_indexed(benchmark::State& state)
+{
+    FixIndex index;
+    StandardHeaderReader headerReader;
+    ExecutionReportReader msgReader;
+
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(index.parse(fill_report.data(), fill_report.size()));
+        headerReader.read(index);
+        msgReader.read(index);
+        benchmark::DoNotOptimize(msgReader.lastPx.getBegin());
+
+        headerReader.reset();
+        msgReader.reset();
+    }
+}
+
+BENCHMARK(fix_reader_indexed);
+
+// what the istream path would need on top to check BodyLength/CheckSum
+static void fix_validate_scalar(benchmark::State& state)
+{
+    while (state.KeepRunning())
+    {
+        auto const n = fill_report.size() - 7;
+        benchmark::DoNotOptimize(calcCheckSum(fill_report.data(), n) % 256 ==
+                                 toUInteger<uint32_t>(fill_report.data() + n + 3, 3));
+    }
+}
+
+BENCHMARK(fix_validate_scalar);
+
+static void fix_index_validate(benchmark::State& state)
+{
+    FixIndex index;
+    if (!index.parse(fill_report.data(), fill_report.size()) || !index.validate())
+    {
+        state.SkipWithError("fill_report does not validate");
+    }
+    while (state.KeepRunning())
+    {
+        index.parse(fill_report.data(), fill_report.size());
+        benchmark::DoNotOptimize(index.validate());
+    }
+}
+
+BENCHMARK(fix_index_validate);
+
 static void OrderNewWriter(benchmark::State& state)
 {
-    qx::cme::ToCmeStandardHeader header;
+    ToFtxStandardHeader header;
 
     header.setBeginString("FIX.4.2");
     header.setMsgSeqNum(123456789);
-    header.setBodyLength(122);
-    header.setMsgType("D");
+    header.setMsgType(MsgTypeEnum::OrderSingle);
     header.setSenderCompID("LJT0QLN");
-    header.setSenderSubID("RVINE");
-    header.setSendingTime("20170406-12:29:10.711");
-    header.setTargetCompID("CME");
-    header.setTargetSubID("84");
-    header.setSenderLocationID("HK");
-
-    qx::cme::NewOrder o;
-    o.setOrdType("2");
-    o.setTransactTime("20170406-12:29:10.711");
-    o.setSecurityDesc("ESH7");
-    o.setSymbol("ESH7");
-    o.setSecurityType("FUT");
-    o.setSide("1");
-    o.setPrice(std::to_string(47.55));
-    o.setOrderQty(42);
-    o.setCustOrderHandlingInst("1");
-    o.setCustomerOrFirm(0);
-    o.setManualOrderIndicator("N");
-    o.setCtiCode("4");
+    header.setSendingTime("20210406-12:29:10.711");
+    header.setTargetCompID("FTX");
+
+    NewOrderSingle o;
+    o.setHandInst('1');
+    o.setSymbol("BTCUSD");
 
     std::array<char, 512> buffer{};
     std::fill(std::begin(buffer), std::end(buffer), 0x01);
 
-    qx::cme::Field<10, 3> tail;
+    CheckSumField tail;
     int i = 1;
 
-    constexpr acutus::string_const Limit("1");
-    constexpr acutus::string_const bid("1");
-    constexpr acutus::string_const ask("2");
-    constexpr acutus::string_const symbol("ESH7");   
-    constexpr acutus::string_const securityType("FUT");
-    
-    std::string timestamp("20170406-12:29:10.711");
-
-    while(state.KeepRunning())
+    while (state.KeepRunning())
     {
         header.setMsgSeqNum(++i);
-        header.setBodyLength(header.calcLen() + o.calcLen());
-        
-        o.setOrdType(Limit);
-        o.setTransactTime(timestamp.data(), timestamp.size());
-        o.setSecurityDesc(symbol);
-        o.setSymbol(symbol);
-        o.setSecurityType(securityType);
-        o.setSide(ask);
-        o.setPrice(47.55);
+
+        o.setOrdType(OrderTypeEnum::Limitorder);
+        o.setSide(SideEnum::Sell);
+        o.setPrice(47.55, 2);
         o.setOrderQty(42);
         o.setClOrdID(100000001);
-        auto p = header.render(buffer.data());
-        p = o.render(p);
+        header.setBodyLength(header.calcLen() + o.calcLen());
 
-        auto const cksum = (header.getCheckSum() + o.getCheckSum()) % 256;
+        auto p = header.render(buffer.data());
+        p      = o.render(p);
 
-        tail.set(cksum);
-        std::memcpy(p, tail.begin(), tail.len());
+        tail.set(uint16_t(calcCheckSum(buffer.data(), p - buffer.data()) % 256));
+        tail.render(p);
     }
 }
 
@@ -99,52 +159,35 @@ BENCHMARK(OrderNewWriter);
 
 static void OrderCancelWriter(benchmark::State& state)
 {
-    qx::cme::ToCmeStandardHeader header;
+    ToFtxStandardHeader header;
 
     header.setBeginString("FIX.4.2");
     header.setMsgSeqNum(123456789);
-    header.setBodyLength(122);
-    header.setMsgType("D");
+    header.setMsgType(MsgTypeEnum::OrderCancelRequest);
     header.setSenderCompID("LJT0QLN");
-    header.setSenderSubID("RVINE");
-    header.setSendingTime("20170406-12:29:10.711");
-    header.setTargetCompID("CME");
-    header.setTargetSubID("84");
-    header.setSenderLocationID("HK");
-
-    qx::cme::OrderCancelRequest o;
-    o.setTransactTime("20170406-12:29:10.711");
-    o.setSecurityDesc("ESH7");
-    o.setSymbol("ESH7");
-    o.setSecurityType("FUT");
-    o.setManualOrderIndicator("N");
+    header.setSendingTime("20210406-12:29:10.711");
+    header.setTargetCompID("FTX");
+
+    OrderCancelRequest o;
 
     std::array<char, 512> buffer{};
     std::fill(std::begin(buffer), std::end(buffer), 0x01);
 
-    qx::cme::Field<10, 3> tail;
+    CheckSumField tail;
     int i = 1;
 
-    while(state.KeepRunning())
+    while (state.KeepRunning())
     {
         header.setMsgSeqNum(++i);
-        header.setBodyLength(header.calcLen() + o.calcLen());
-        
+
         o.setOrderID(++i);
-        o.setClOrdID(100000001);
-        o.setClOrdID(i);
-        o.setTransactTime(acutus::string_const("20170406-12:29:10.711"));
-        o.setSecurityDesc(acutus::string_const("ESH7"));
-        o.setSymbol(acutus::string_const("ESH7"));
-        o.setSecurityType(acutus::string_const("FUT"));
-        o.setSide(acutus::string_const("1"));
-        
-        auto p = header.render(buffer.begin());
-        p = o.render(p);
-        auto const cksum = (header.getCheckSum() + o.getCheckSum()) % 256;
-
-        tail.set(cksum);
-        std::memcpy(p, tail.begin(), tail.len());
+        header.setBodyLength(header.calcLen() + o.calcLen());
+
+        auto p = header.render(buffer.data());
+        p      = o.render(p);
+
+        tail.set(uint16_t((header.getCheckSum() + o.getCheckSum()) % 256));
+        tail.render(p);
     }
 }
 
@@ -0,0 +1,93 @@
+#include "benchmark/benchmark.h"
+#include <stdio.h>
+#include <string>
+
+#include "../../ftx_fix/fix_acceptor.hpp"
+#include "../../ftx_fix/fix_number_utils.hpp"
+
+using namespace miye::trading::fix;
+using namespace miye::trading::fix::sim;
+
+namespace
+{
+
+constexpr uint32_t BatchOrders = 1000;
+
+std::string fix_msg(const std::string& body)
+{
+    std::string m = "8=FIX.4.2\0019=" + std::to_string(body.size()) + "\001" + body;
+    char cksum[4];
+    snprintf(cksum, sizeof(cksum), "%03u", calcCheckSum(m.data(), m.size()) % 256);
+    return m + "10=" + cksum + "\001";
+}
+
+std::string header(char msgType, uint32_t seq)
+{
+    return std::string("35=") + msgType + "\00134=" + std::to_string(seq) +
+           "\00149=LJT0QLN\00152=20210406-12:31:53.061\00156=FTX\001";
+}
+
+// a resting buy and its cancel per order, the book is empty again after the batch
+std::string rest_and_cancel()
+{
+    std::string batch;
+    uint32_t seq = 1;
+    for (uint32_t i = 1; i <= BatchOrders; ++i)
+    {
+        batch += fix_msg(header('D', ++seq) + "11=" + std::to_string(i) +
+                         "\00155=BTC-PERP\00154=1\00138=1\00140=2\00144=58000\00159=1\001");
+        batch += fix_msg(header('F', ++seq) + "37=0\00141=" + std::to_string(i) + "\001");
+    }
+    return batch;
+}
+
+// buys through the ask, an ack and a fill back for every order
+std::string crossing()
+{
+    std::string batch;
+    uint32_t seq = 1;
+    for (uint32_t i = 1; i <= BatchOrders; ++i)
+    {
+        batch += fix_msg(header('D', ++seq) + "11=" + std::to_string(i) +
+                         "\00155=BTC-PERP\00154=1\00138=1\00140=2\00144=58200\00159=3\001");
+    }
+    return batch;
+}
+
+void run_batch(benchmark::State& state, const std::string& batch, uint64_t latencyNs)
+{
+    SimBook book;
+    book.addInstrument("BTC-PERP", 58123, 58124);
+    FixAcceptor::Config config;
+    config.ackLatencyNs  = latencyNs;
+    config.fillLatencyNs = latencyNs;
+    FixAcceptor acceptor(config, book);
+
+    uint64_t now = 1;
+    while (state.KeepRunning())
+    {
+        acceptor.consume(batch.data(), batch.size(), now);
+        now += latencyNs;
+        acceptor.poll(now);
+        benchmark::DoNotOptimize(acceptor.outData());
+        acceptor.clearOut();
+    }
+    state.SetItemsProcessed(acceptor.messagesIn() + acceptor.messagesOut());
+    state.SetBytesProcessed(int64_t(state.iterations()) * batch.size());
+}
+} // namespace
+
+static void acceptor_rest_and_cancel(benchmark::State& state) { run_batch(state, rest_and_cancel(), 0); }
+
+BENCHMARK(acceptor_rest_and_cancel);
+
+static void acceptor_crossing(benchmark::State& state) { run_batch(state, crossing(), 0); }
+
+BENCHMARK(acceptor_crossing);
+
+// every request and fill through the delay queues
+static void acceptor_crossing_delayed(benchmark::State& state) { run_batch(state, crossing(), 50'000); }
+
+BENCHMARK(acceptor_crossing_delayed);
+
+BENCHMARK_MAIN();
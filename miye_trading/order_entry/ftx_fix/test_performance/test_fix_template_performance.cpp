@@ -0,0 +1,103 @@
+#include "benchmark/benchmark.h"
+#include <array>
+#include <string.h>
+#include <string>
+
+#include "../../ftx_fix/fix_index.hpp"
+#include "../../ftx_fix/fix_template.hpp"
+#include "../../ftx_fix/ftx_fix_writer.hpp"
+
+using namespace miye::trading;
+using namespace miye::trading::fix;
+
+static const std::string sendingTime("20210406-12:29:10.711");
+
+static fix_config_t make_config()
+{
+    fix_config_t config;
+    config.sender_comp_id = "LJT0QLN";
+    return config;
+}
+
+static miye::Price price_at(uint64_t i) { return miye::Price::fromUnits(4755'00000000LL + int64_t(i % 64) * 50'00000LL); }
+static miye::Qty qty_at(uint64_t i) { return miye::Qty::fromUnits(int64_t(1 + i % 10) * 100000LL); }
+
+// every field set, lengths summed and rendered per order
+static void new_order_fields(benchmark::State& state)
+{
+    ToFtxStandardHeader header;
+    header.setBeginString("FIX.4.2");
+    header.setSenderCompID("LJT0QLN");
+    header.setTargetCompID("FTX");
+
+    NewOrderSingle o;
+    CheckSumField tail;
+    std::array<char, 512> buffer{};
+    uint64_t i = 0;
+
+    while (state.KeepRunning())
+    {
+        ++i;
+        header.setMsgSeqNum(uint32_t(i));
+        header.setMsgType(MsgTypeEnum::OrderSingle);
+        header.setSendingTime(sendingTime);
+        o.setHandInst('1');
+        o.setClOrdID(1000000 + i);
+        o.setSymbol("BTCUSD");
+        o.setOrdType(OrderTypeEnum::Limitorder);
+        o.setOrderQty(uint32_t(1 + i % 10));
+        o.setPrice(price_at(i), 2);
+        o.setSide(SideEnum::Buy);
+        o.setTimeInForce(TimeInforceEnum::GoodTillCancel);
+        header.setBodyLength(header.calcLen() + o.calcLen());
+
+        char* p = header.render(buffer.data());
+        p       = o.render(p);
+        // NewOrderSingle keeps no checksum, count the rendered bytes
+        tail.set(uint16_t(calcCheckSum(buffer.data(), p - buffer.data()) % 256));
+        p += tail.render(p);
+        benchmark::DoNotOptimize(p);
+    }
+}
+
+BENCHMARK(new_order_fields);
+
+// rendered once, 4 slots patched and ClOrdID rendered per order
+static void new_order_template(benchmark::State& state)
+{
+    NewOrderSingleTemplate t;
+    t.init(make_config(), "BTCUSD", SideEnum::Buy, OrderTypeEnum::Limitorder, TimeInforceEnum::GoodTillCancel, 2, 3);
+
+    // BodyLength and the incremental checksum have to agree with a full recount
+    t.render(7, sendingTime.data(), 1234567, price_at(3), qty_at(3));
+    FixIndex idx;
+    if (!idx.parse(t.data(), t.size()) || !idx.validate())
+    {
+        state.SkipWithError("template BodyLength or checksum mismatch");
+    }
+
+    uint64_t i = 0;
+    while (state.KeepRunning())
+    {
+        ++i;
+        benchmark::DoNotOptimize(t.render(uint32_t(i), sendingTime.data(), 1000000 + i, price_at(i), qty_at(i)));
+    }
+}
+
+BENCHMARK(new_order_template);
+
+static void cancel_template(benchmark::State& state)
+{
+    OrderCancelRequestTemplate t;
+    t.init(make_config());
+    uint64_t i = 0;
+    while (state.KeepRunning())
+    {
+        ++i;
+        benchmark::DoNotOptimize(t.render(uint32_t(i), sendingTime.data(), 84285000000 + i, 1000000 + i));
+    }
+}
+
+BENCHMARK(cancel_template);
+
+BENCHMARK_MAIN();
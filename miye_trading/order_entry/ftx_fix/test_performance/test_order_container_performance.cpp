@@ -0,0 +1,199 @@
+#include "benchmark/benchmark.h"
+#include <algorithm>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "../../ftx_fix/order_container.hpp"
+
+using namespace miye::trading::fix;
+
+namespace
+{
+
+// the members basic_order_container indexes, without the order_insert plumbing of order_t
+struct bench_order
+{
+    struct
+    {
+        uint64_t key{};
+    } exchange_key;
+    uint32_t instrument{};
+    uint32_t side{};
+    price_t price{};
+    quantity_t qty{};
+    uint32_t fix_sequence{};
+};
+
+constexpr uint32_t LiveOrders = 100'000;
+
+bench_order make_order(uint32_t i)
+{
+    bench_order o;
+    o.instrument   = i % 50;
+    o.side         = i & 1;
+    o.price        = 100.0 + (i % 2000) * 0.5; // ~50 orders a level
+    o.qty          = 1;
+    o.fix_sequence = i + 1;
+    return o;
+}
+
+std::vector<order_id_t> shuffled_ids()
+{
+    std::vector<order_id_t> ids(LiveOrders);
+    for (uint32_t i = 0; i < LiveOrders; ++i)
+    {
+        ids[i] = 1'000'000'000ull + i * 7919ull;
+    }
+    std::shuffle(ids.begin(), ids.end(), std::mt19937_64(42));
+    return ids;
+}
+
+} // namespace
+
+static void container_get(benchmark::State& state)
+{
+    basic_order_container<bench_order> orders;
+    auto const ids = shuffled_ids();
+    for (uint32_t i = 0; i < LiveOrders; ++i)
+    {
+        orders.add(ids[i], make_order(i));
+    }
+    size_t i = 0;
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(orders.get(ids[i]));
+        i = i + 1 == LiveOrders ? 0 : i + 1;
+    }
+}
+
+BENCHMARK(container_get);
+
+static void unordered_map_get(benchmark::State& state)
+{
+    std::unordered_map<order_id_t, bench_order> orders;
+    auto const ids = shuffled_ids();
+    for (uint32_t i = 0; i < LiveOrders; ++i)
+    {
+        orders.emplace(ids[i], make_order(i));
+    }
+    size_t i = 0;
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(orders.find(ids[i]));
+        i = i + 1 == LiveOrders ? 0 : i + 1;
+    }
+}
+
+BENCHMARK(unordered_map_get);
+
+static void container_get_by_sequence(benchmark::State& state)
+{
+    basic_order_container<bench_order> orders;
+    auto const ids = shuffled_ids();
+    for (uint32_t i = 0; i < LiveOrders; ++i)
+    {
+        orders.add(ids[i], make_order(i));
+    }
+    uint32_t seq = 1;
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(orders.getBySequence(seq));
+        seq = seq == LiveOrders ? 1 : seq + 1;
+    }
+}
+
+BENCHMARK(container_get_by_sequence);
+
+// what getBySequence cost with the map: a scan over the live orders
+static void unordered_map_get_by_sequence(benchmark::State& state)
+{
+    std::unordered_map<order_id_t, bench_order> orders;
+    auto const ids = shuffled_ids();
+    for (uint32_t i = 0; i < LiveOrders; ++i)
+    {
+        orders.emplace(ids[i], make_order(i));
+    }
+    uint32_t seq = 1;
+    while (state.KeepRunning())
+    {
+        const bench_order* found = nullptr;
+        for (auto const& kv : orders)
+        {
+            if (kv.second.fix_sequence == seq)
+            {
+                found = &kv.second;
+                break;
+            }
+        }
+        benchmark::DoNotOptimize(found);
+        seq = seq == LiveOrders ? 1 : seq + 1;
+    }
+}
+
+BENCHMARK(unordered_map_get_by_sequence);
+
+// steady state churn at 100k live: one order out, one in
+static void container_add_remove(benchmark::State& state)
+{
+    basic_order_container<bench_order> orders;
+    auto ids = shuffled_ids();
+    for (uint32_t i = 0; i < LiveOrders; ++i)
+    {
+        orders.add(ids[i], make_order(i));
+    }
+    size_t i      = 0;
+    order_id_t id = 2'000'000'000ull;
+    while (state.KeepRunning())
+    {
+        orders.remove(ids[i]);
+        ids[i] = ++id;
+        benchmark::DoNotOptimize(orders.add(ids[i], make_order(uint32_t(id))));
+        i = i + 1 == LiveOrders ? 0 : i + 1;
+    }
+}
+
+BENCHMARK(container_add_remove);
+
+static void unordered_map_add_remove(benchmark::State& state)
+{
+    std::unordered_map<order_id_t, bench_order> orders;
+    auto ids = shuffled_ids();
+    for (uint32_t i = 0; i < LiveOrders; ++i)
+    {
+        orders.emplace(ids[i], make_order(i));
+    }
+    size_t i      = 0;
+    order_id_t id = 2'000'000'000ull;
+    while (state.KeepRunning())
+    {
+        orders.erase(ids[i]);
+        ids[i] = ++id;
+        benchmark::DoNotOptimize(orders.emplace(ids[i], make_order(uint32_t(id))));
+        i = i + 1 == LiveOrders ? 0 : i + 1;
+    }
+}
+
+BENCHMARK(unordered_map_add_remove);
+
+static void container_level_walk(benchmark::State& state)
+{
+    basic_order_container<bench_order> orders;
+    auto const ids = shuffled_ids();
+    for (uint32_t i = 0; i < LiveOrders; ++i)
+    {
+        orders.add(ids[i], make_order(i));
+    }
+    uint32_t i = 0;
+    while (state.KeepRunning())
+    {
+        auto const o = make_order(i++);
+        quantity_t qty{};
+        orders.for_each_at_level(o.instrument, o.side, o.price, [&](bench_order& r) { qty += r.qty; });
+        benchmark::DoNotOptimize(qty);
+    }
+}
+
+BENCHMARK(container_level_walk);
+
+BENCHMARK_MAIN();
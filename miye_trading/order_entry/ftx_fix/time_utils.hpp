@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <string>
 #include <sys/time.h>
 #include <ctime>
@@ -15,7 +16,7 @@ inline std::string getTime()
     auto milli = t.tv_usec / 1000;
 
     char buffer[0xFF] {};
-    auto len = strftime(buffer, sizeof(buffer), "%Y%m%d-%H:%M:%S", qx::gmtime::gmtime(&t.tv_sec));
+    auto len = strftime(buffer, sizeof(buffer), "%Y%m%d-%H:%M:%S", miye::gmtime::gmtime(&t.tv_sec));
     sprintf(buffer + len, ".%03ld", milli);
 
     return std::string(buffer, len + 4);
@@ -28,7 +29,7 @@ inline void to_time_str(std::string& str, const std::chrono::high_resolution_clo
 	auto const ms = duration_cast<milliseconds>(tp.time_since_epoch());
 	auto const s = duration_cast<seconds>(ms);
 	const std::time_t t = s.count();
-	auto len = strftime((char*)str.data(), size_t(21), "%Y%m%d-%H:%M:%S", qx::gmtime::gmtime(&t));
+	auto len = strftime((char*)str.data(), size_t(21), "%Y%m%d-%H:%M:%S", miye::gmtime::gmtime(&t));
 
 	auto const milli = ms.count() % 1000;
 	sprintf((char*)str.data() + len, ".%03ld", milli);
@@ -0,0 +1,266 @@
+#define BOOST_TEST_MODULE test_fix_session_store
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <stdio.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "../fix_index.hpp"
+#include "../fix_session.hpp"
+#include "../fix_session_store.hpp"
+
+using namespace miye::trading::fix;
+
+namespace
+{
+
+std::string storePath()
+{
+    return "/tmp/test_fix_session_store." + std::to_string(::getpid());
+}
+
+std::string withTrailer(const std::string& body)
+{
+    std::string m = "8=FIX.4.2\0019=" + std::to_string(body.size()) + "\001" + body;
+    char cksum[8];
+    snprintf(cksum, sizeof(cksum), "%03u", calcCheckSum(m.data(), m.size()) % 256);
+    return m + "10=" + cksum + "\001";
+}
+
+std::string order(uint32_t seqNum)
+{
+    return withTrailer("35=D\00134=" + std::to_string(seqNum) +
+                       "\00149=LJT0QLN\00152=20210406-12:31:53.061\00156=FTX\00111=" + std::to_string(1000 + seqNum) +
+                       "\00154=1\00155=BTC-PERP\00138=1\00140=2\00144=58123.5\001");
+}
+
+std::string heartbeat(uint32_t seqNum)
+{
+    return withTrailer("35=0\00134=" + std::to_string(seqNum) +
+                       "\00149=LJT0QLN\00152=20210406-12:31:53.061\00156=FTX\001");
+}
+
+std::string resendRequest(uint32_t begin, uint32_t end)
+{
+    return withTrailer("35=2\00134=1\00149=FTX\00152=20210406-12:40:00.000\00156=LJT0QLN\0017=" +
+                       std::to_string(begin) + "\00116=" + std::to_string(end) + "\001");
+}
+
+std::string logon(bool resetSeqNum)
+{
+    return withTrailer(std::string("35=A\00134=1\00149=FTX\00152=20210406-12:40:00.000\00156=LJT0QLN\00198=0\001108=30\001") +
+                       (resetSeqNum ? "141=Y\001" : ""));
+}
+
+// what the session sends back, one string per message
+struct SentMessages
+{
+    std::vector<std::string> sent;
+
+    uint64_t send_and_log(const char* buf, size_t len)
+    {
+        sent.emplace_back(buf, len);
+        return 0;
+    }
+    void log(const char*, size_t) {}
+    bool session_enabled() const { return true; }
+    void on_logon() {}
+    void on_logout() {}
+
+    template <typename... A>
+    void onOrderAck(A&&...) {}
+    template <typename... A>
+    void onOrderReject(A&&...) {}
+    template <typename... A>
+    void onCancelAck(A&&...) {}
+    template <typename... A>
+    void onFill(A&&...) {}
+    template <typename... A>
+    void onTradeCancelled(A&&...) {}
+    template <typename... A>
+    void onOrderCancelReject(A&&...) {}
+    template <typename... A>
+    void onSessionLevelReject(A&&...) {}
+};
+
+// the session's replies to a ResendRequest for [begin, end] over what the store at path holds
+std::vector<std::string> resend(const std::string& path, uint32_t begin, uint32_t end)
+{
+    fix_config_t config;
+    config.sender_comp_id = "LJT0QLN";
+    std::vector<char> out(ftx::FixSession::OutBufferSize);
+    ftx::FixSession session(config, "test", path, out.data());
+
+    SentMessages handler;
+    auto const msg = resendRequest(begin, end);
+    session.consumeTcpBuffer(handler, msg.data(), msg.size());
+    return handler.sent;
+}
+
+std::string field(const FixIndex& idx, FixId_t tag)
+{
+    auto const* e = idx.find(tag);
+    return e ? std::string(idx.data() + e->offset, e->len) : std::string();
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TestSessionStoreJournal)
+{
+    auto const path = storePath();
+    {
+        FixSessionStore store(path, 1024, 1 << 20);
+        BOOST_CHECK_EQUAL(store.senderSeqNum(), 0u);
+        for (uint32_t seq = 1; seq <= 10; ++seq)
+        {
+            auto const msg = order(seq);
+            BOOST_CHECK(store.append(seq, msg.data(), msg.size()));
+        }
+        store.setTargetSeqNum(42);
+        BOOST_CHECK(store.get(11).empty());
+    }
+
+    // reopened: counters and messages are back
+    FixSessionStore store(path);
+    BOOST_CHECK_EQUAL(store.senderSeqNum(), 10u);
+    BOOST_CHECK_EQUAL(store.targetSeqNum(), 42u);
+    BOOST_CHECK_EQUAL(std::string(store.get(7)), order(7));
+
+    store.resetSession();
+    BOOST_CHECK(store.get(7).empty());
+    BOOST_CHECK_EQUAL(store.senderSeqNum(), 0u);
+
+    ::unlink(path.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(TestSessionStoreResend)
+{
+    auto const path = storePath();
+    FixSessionStore store(path, 1024, 1 << 20);
+    auto const msg = order(1);
+    store.append(1, msg.data(), msg.size());
+
+    char out[512];
+    auto const len = store.renderResend(1, "20210406-12:40:00.000", out, sizeof(out));
+    BOOST_REQUIRE(len > 0);
+
+    FixIndex idx;
+    BOOST_REQUIRE(idx.parse(out, len));
+    BOOST_CHECK(idx.validate());
+    BOOST_CHECK_EQUAL(field(idx, 34), "1");
+    BOOST_CHECK_EQUAL(field(idx, 43), "Y");
+    BOOST_CHECK_EQUAL(field(idx, 52), "20210406-12:40:00.000");
+    BOOST_CHECK_EQUAL(field(idx, 122), "20210406-12:31:53.061");
+    BOOST_CHECK_EQUAL(field(idx, 11), "1001");
+
+    BOOST_CHECK_EQUAL(store.renderResend(1, "20210406-12:40:00.000", out, 32), 0u);
+    ::unlink(path.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(TestSessionResendGapFill)
+{
+    auto const path = storePath();
+    {
+        FixSessionStore store(path, 1024, 1 << 20);
+        for (uint32_t seq = 1; seq <= 4; ++seq)
+        {
+            auto const msg = seq % 2 ? heartbeat(seq) : order(seq);
+            store.append(seq, msg.data(), msg.size());
+        }
+    }
+    auto const sent = resend(path, 1, 0);
+    BOOST_REQUIRE_EQUAL(sent.size(), 4u);
+
+    FixIndex idx;
+    const char* const expected[][3] = {{"4", "1", "2"}, {"D", "2", ""}, {"4", "3", "4"}, {"D", "4", ""}};
+    for (size_t i = 0; i < sent.size(); ++i)
+    {
+        BOOST_REQUIRE(idx.parse(sent[i].data(), sent[i].size()));
+        BOOST_CHECK(idx.validate());
+        BOOST_CHECK_EQUAL(field(idx, 35), expected[i][0]);
+        BOOST_CHECK_EQUAL(field(idx, 34), expected[i][1]);
+        BOOST_CHECK_EQUAL(field(idx, 36), expected[i][2]);
+        BOOST_CHECK_EQUAL(field(idx, 43), "Y");
+    }
+    BOOST_REQUIRE(idx.parse(sent[0].data(), sent[0].size()));
+    BOOST_CHECK_EQUAL(field(idx, 123), "Y");
+    BOOST_CHECK_EQUAL(field(idx, 49), "LJT0QLN");
+    BOOST_CHECK_EQUAL(field(idx, 56), "FTX");
+    BOOST_CHECK(!field(idx, 122).empty());
+    ::unlink(path.c_str());
+}
+
+// messages of a previous generation are gone, the gap is still filled from its first sequence number
+BOOST_AUTO_TEST_CASE(TestSessionResendGapFillNotJournaled)
+{
+    auto const path = storePath();
+    {
+        FixSessionStore store(path, 1024, 1 << 20);
+        auto const msg = order(1);
+        store.append(1, msg.data(), msg.size());
+        store.resetSession(2);
+        auto const hb = heartbeat(3);
+        store.append(3, hb.data(), hb.size());
+        auto const next = order(4);
+        store.append(4, next.data(), next.size());
+    }
+    auto sent = resend(path, 1, 4);
+    BOOST_REQUIRE_EQUAL(sent.size(), 2u);
+
+    FixIndex idx;
+    BOOST_REQUIRE(idx.parse(sent[0].data(), sent[0].size()));
+    BOOST_CHECK(idx.validate());
+    BOOST_CHECK_EQUAL(field(idx, 35), "4");
+    BOOST_CHECK_EQUAL(field(idx, 34), "1");
+    BOOST_CHECK_EQUAL(field(idx, 36), "4");
+    BOOST_REQUIRE(idx.parse(sent[1].data(), sent[1].size()));
+    BOOST_CHECK_EQUAL(field(idx, 34), "4");
+    BOOST_CHECK_EQUAL(field(idx, 11), "1004");
+
+    // nothing journaled at all
+    {
+        FixSessionStore store(path);
+        store.resetSession(6);
+    }
+    sent = resend(path, 2, 0);
+    BOOST_REQUIRE_EQUAL(sent.size(), 1u);
+    BOOST_REQUIRE(idx.parse(sent[0].data(), sent[0].size()));
+    BOOST_CHECK(idx.validate());
+    BOOST_CHECK_EQUAL(field(idx, 34), "2");
+    BOOST_CHECK_EQUAL(field(idx, 36), "7");
+    ::unlink(path.c_str());
+}
+
+// a Logon with ResetSeqNumFlag starts a new session, the journal of the old one is dropped
+BOOST_AUTO_TEST_CASE(TestSessionLogonResetSeqNum)
+{
+    auto const path = storePath();
+    {
+        FixSessionStore store(path, 1024, 1 << 20);
+        for (uint32_t seq = 1; seq <= 4; ++seq)
+        {
+            auto const msg = order(seq);
+            store.append(seq, msg.data(), msg.size());
+        }
+    }
+    for (bool const reset : {false, true})
+    {
+        fix_config_t config;
+        config.sender_comp_id = "LJT0QLN";
+        std::vector<char> out(ftx::FixSession::OutBufferSize);
+        ftx::FixSession session(config, "test", path, out.data());
+        BOOST_CHECK_EQUAL(session.getLastSequenceNum(), 4u);
+
+        SentMessages handler;
+        auto const msg = logon(reset);
+        session.consumeTcpBuffer(handler, msg.data(), msg.size());
+        BOOST_CHECK_EQUAL(session.getLastSequenceNum(), reset ? 1u : 4u);
+    }
+
+    FixSessionStore store(path);
+    BOOST_CHECK_EQUAL(store.senderSeqNum(), 1u);
+    BOOST_CHECK_EQUAL(store.targetSeqNum(), 1u);
+    BOOST_CHECK(store.get(2).empty());
+    ::unlink(path.c_str());
+}
@@ -0,0 +1,72 @@
+#define BOOST_TEST_MODULE test_fix_template
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <string>
+
+#include "../fix_index.hpp"
+#include "../fix_template.hpp"
+
+using namespace miye;
+using namespace miye::trading::fix;
+
+namespace
+{
+
+const std::string sendingTime("20210406-12:29:10.711");
+
+fix_config_t makeConfig()
+{
+    fix_config_t config;
+    config.sender_comp_id = "LJT0QLN";
+    return config;
+}
+
+std::string field(const FixIndex& idx, FixId_t tag)
+{
+    auto const* e = idx.find(tag);
+    return e ? std::string(idx.data() + e->offset, e->len) : std::string();
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TestNewOrderTemplateIds)
+{
+    NewOrderSingleTemplate t;
+    t.init(makeConfig(), "BTC-PERP", SideEnum::Buy, OrderTypeEnum::Limitorder, TimeInforceEnum::GoodTillCancel, 1, 4);
+
+    FixIndex idx;
+    // BodyLength and CheckSum follow the ClOrdID length, whichever way it goes
+    for (uint64_t clOrdId : {7ull, 1234567ull, 18446744073709551615ull, 42ull})
+    {
+        auto const len =
+            t.render(3, sendingTime.data(), clOrdId, Price::fromUnits(58123'50000000LL), Qty::fromUnits(1234567));
+        BOOST_REQUIRE(idx.parse(t.data(), len));
+        BOOST_CHECK(idx.validate());
+        BOOST_CHECK_EQUAL(field(idx, 11), std::to_string(clOrdId));
+        BOOST_CHECK_EQUAL(field(idx, 34), "000000003");
+        BOOST_CHECK_EQUAL(field(idx, 55), "BTC-PERP");
+        BOOST_CHECK_EQUAL(std::stod(field(idx, 44)), 58123.5);
+        // 0.01234567 at 4 qty decimals
+        BOOST_CHECK_EQUAL(std::stod(field(idx, 38)), 0.0123);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestCancelTemplateIds)
+{
+    OrderCancelRequestTemplate t;
+    t.init(makeConfig());
+
+    FixIndex idx;
+    auto len = t.render(9, sendingTime.data(), 84285000001, 1001);
+    BOOST_REQUIRE(idx.parse(t.data(), len));
+    BOOST_CHECK(idx.validate());
+    BOOST_CHECK_EQUAL(field(idx, 37), "84285000001");
+    BOOST_CHECK_EQUAL(field(idx, 41), "1001");
+
+    len = t.render(10, sendingTime.data(), 5, 6);
+    BOOST_CHECK_EQUAL(t.size(), len);
+    BOOST_REQUIRE(idx.parse(t.data(), len));
+    BOOST_CHECK(idx.validate());
+    BOOST_CHECK_EQUAL(field(idx, 37), "5");
+    BOOST_CHECK_EQUAL(field(idx, 41), "6");
+}
@@ -63,15 +63,62 @@ struct SymbolPosition
     }
     double getDayPnl() const { return getNetPosition() * markPx - (todayBuyValue - todaySellValue); }
 
-    void onFill(price_t price, quantity_t qty)
+    // an order sent, its qty stays open until filled or done
+    void onPlaceOrder(Side side, price_t price, quantity_t qty)
     {
-        buyQty += qty;
-        buyValue += price * qty;
+        if (side == Side::BUY)
+        {
+            openBuyQty += qty;
+            openBuyValue += price * qty;
+            numBuyOrder++;
+        }
+        else
+        {
+            openSellQty += qty;
+            openSellValue += price * qty;
+            numSellOrder++;
+        }
     }
 
-    void onPlaceOrder();
-    void onCancelOrder();
-    void onReject();
+    // qty of an order at orderPrice filled at fillPrice, moved from open to position
+    void onFill(Side side, price_t orderPrice, price_t fillPrice, quantity_t qty)
+    {
+        if (side == Side::BUY)
+        {
+            openBuyQty -= qty;
+            openBuyValue -= orderPrice * qty;
+            buyQty += qty;
+            buyValue += fillPrice * qty;
+            todayBuy += qty;
+            todayBuyValue += fillPrice * qty;
+        }
+        else
+        {
+            openSellQty -= qty;
+            openSellValue -= orderPrice * qty;
+            sellQty += qty;
+            sellValue += fillPrice * qty;
+            todaySell += qty;
+            todaySellValue += fillPrice * qty;
+        }
+    }
+
+    // order cancelled, rejected or fully filled, leavesQty of it is no longer open
+    void onOrderDone(Side side, price_t price, quantity_t leavesQty)
+    {
+        if (side == Side::BUY)
+        {
+            openBuyQty -= leavesQty;
+            openBuyValue -= price * leavesQty;
+            numBuyOrder--;
+        }
+        else
+        {
+            openSellQty -= leavesQty;
+            openSellValue -= price * leavesQty;
+            numSellOrder--;
+        }
+    }
 };
 
 class PortforlioPositions
@@ -8,7 +8,7 @@ namespace miye::risk
 inline void hash_combine(std::size_t& seed) {}
 
 template <typename T, typename... Args>
-inline void hash_combine(std::size_t seed, const T& v, Args... args)
+inline void hash_combine(std::size_t& seed, const T& v, Args... args)
 {
     std::hash<T> hasher;
     // boost::hash_combined implementation
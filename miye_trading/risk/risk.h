@@ -3,6 +3,7 @@
 #include "libcore/math/math_utils.hpp"
 #include "libcore/types/types.hpp"
 #include "libcore/utils/nano_time.h"
+#include "libcore/utils/rate_limiter.h"
 #include "libcore/utils/rolling_queue.h"
 
 namespace miye::risk
@@ -120,28 +121,28 @@ struct RiskState
 struct SymbolRisk
 {
     RiskState state{};
-    price_t refPrice{NAN};
-    price_t maxPriceDeviation{NAN};
-    price_t limitDown{NAN};
-    price_t limitUp{NAN};
+    Price refPrice{Price::invalid()};
+    Price maxPriceDeviation{Price::invalid()};
+    Price limitDown{Price::invalid()};
+    Price limitUp{Price::invalid()};
 
     int32_t repeatedOrderRate{};
     size_t repeatedOrderHashValue{0};
-    quantity_t minOrderSize{0.0};
-    int32_t currentOrderRate{0};
+    Qty minOrderSize{};
     int32_t currentRejectRate{0};
-    quantity_t maxOpen{0.0};
-    quantity_t maxOrderSize{0.0};
-    quantity_t minmax{0.0};
-    price_t minmaxValue{0.0};
-    price_t maxOrderValue{0.0};
-    price_t priceDeviation{0.0};
+    Qty maxOpen{};
+    Qty maxOrderSize{};
+    Qty minmax{};
+    double minmaxValue{0.0};
+    double maxOrderValue{0.0};
+    double priceDeviation{0.0};
     int32_t maxOrderRate{};
     int32_t maxRepeatedOrderRate{};
+    utils::RateLimiter orderRateLimiter{};
 
     time::NanoTime lastResetTimestamp{};
 
-    int32_t init(price_t priceDeviation, price_t limitDown, price_t limitUp)
+    int32_t init(double priceDeviation, Price limitDown, Price limitUp)
     {
         this->priceDeviation = priceDeviation;
         this->limitDown      = limitDown;
@@ -149,16 +150,22 @@ struct SymbolRisk
         return 0;
     }
 
+    // maxOrderRate orders per TimeoutWindow
+    void setMaxOrderRate(int32_t rate)
+    {
+        maxOrderRate = rate;
+        orderRateLimiter.init(rate, TimeoutWindow);
+    }
+
     bool isHalted() const { return state.isHalted(); }
-    void setRefPrice(price_t price)
+    void setRefPrice(Price price)
     {
-        this->refPrice = refPrice;
+        this->refPrice = price;
 
-        this->maxPriceDeviation = priceDeviation * price;
+        this->maxPriceDeviation = Price::fromDouble(priceDeviation * price.toDouble());
     }
     void resetCounters(time::NanoTime timestamp)
     {
-        currentOrderRate       = 0;
         currentRejectRate      = 0;
         repeatedOrderHashValue = 0;
         repeatedOrderRate      = 0;
@@ -167,44 +174,50 @@ struct SymbolRisk
     }
     bool checkBasics(logger::Logger* logger, const symbol_t& symbol, const order_t& order) const
     {
-        if (std::isnan(order.qty) || std::isinf(order.qty) || math::greaterThan(order.qty, maxOrderSize) ||
-            math::floatEqual(order.qty, 0.0))
+        if (!order.qty.isValid() || order.qty > maxOrderSize || order.qty == Qty{})
         {
             logger->critical("invalid order qty {}", order);
             return false;
         }
 
-        if (std::isnan(order.price) || std::isinf(order.price))
+        if (!order.price.isValid())
         {
             logger->critical("invalid order price {}", order);
 
             return false;
         }
-        if (order.getSide() != Side::BUY || order.getSide() != Side::SELL)
+        if (order.getSide() != Side::BUY && order.getSide() != Side::SELL)
         {
             logger->critical("invalid order side {}", order);
             return false;
         }
 
-        return false;
+        return true;
     }
 
-    bool hasAvailableSymOrderRate() const { return currentOrderRate < maxOrderRate; }
-    bool checkOrderRate(logger::Logger* logger, const symbol_t& symbol)
+    bool hasAvailableSymOrderRate(time::NanoTime timestamp) const
+    {
+        return orderRateLimiter.available(timestamp) > 0;
+    }
+    bool checkOrderRate(time::NanoTime timestamp, logger::Logger* logger, const symbol_t& symbol)
     {
-        if (++currentOrderRate > maxOrderRate)
+        if (!orderRateLimiter.tryAcquire(timestamp))
         {
             logger->error("symbolRisk checkOrderRate symbol:{} maxOrderRate:{}", symbol, maxOrderRate);
             return false;
         }
         return true;
     }
-    bool checkRepeatedOrderRate(logger::Logger* logger, const symbol_t& symbol, const order_t& order)
+    bool checkRepeatedOrderRate(time::NanoTime timestamp, logger::Logger* logger, const symbol_t& symbol,
+                                const order_t& order)
     {
         std::size_t hashValue{};
-        hash_combine(
-            hashValue, (uint32_t)order.getSide(), order.getEntrySize(), order.getPrice(), order.getOrderType());
-        if (repeatedOrderHashValue != hashValue || time::NanoClock::now() - lastResetTimestamp > TimeoutWindow)
+        hash_combine(hashValue,
+                     (uint32_t)order.getSide(),
+                     order.getEntrySize().units(),
+                     order.getPrice().units(),
+                     order.getOrderType());
+        if (repeatedOrderHashValue != hashValue || timestamp - lastResetTimestamp > TimeoutWindow)
         {
             repeatedOrderHashValue = hashValue;
             repeatedOrderRate      = 1;
@@ -214,7 +227,7 @@ struct SymbolRisk
             repeatedOrderRate++;
         }
 
-        if (repeatedOrderRate > maxOrderRate)
+        if (repeatedOrderRate > maxRepeatedOrderRate)
         {
             logger->error(
                 "symbolRisk checkRepeatedOrderRate maxRepeatedOrderRate:{} order:{}", maxRepeatedOrderRate, order);
@@ -227,13 +240,14 @@ struct SymbolRisk
                        const position::SymbolPosition& pos)
     {
         auto const orderQty = order.getQty();
+        auto const netPos   = Qty::fromDouble(pos.getNetPosition());
         if (order.getSide() == Side::BUY)
         {
-            return std::abs(pos.getNetPosition() + orderQty) < std::abs(pos.getNetPosition());
+            return abs(netPos + orderQty) < abs(netPos);
         }
         else if (order.getSide() == Side::SELL)
         {
-            return std::abs(pos.getNetPosition() - orderQty) < std::abs(pos.getNetPosition());
+            return abs(netPos - orderQty) < abs(netPos);
         }
         return false;
     }
@@ -241,15 +255,18 @@ struct SymbolRisk
                           const position::SymbolPosition& pos)
     {
 
+        auto const netPos = Qty::fromDouble(pos.getNetPosition());
         if (order.getSide() == Side::BUY)
         {
-            auto const currentMinMax = pos.getNetPosition() + pos.getOpenBuy() + order.getEntrySize();
-            return std::abs(currentMinMax) < std::abs(pos.getNetPosition() + pos.getOpenBuy());
+            auto const openMinMax    = netPos + Qty::fromDouble(pos.getOpenBuy());
+            auto const currentMinMax = openMinMax + order.getEntrySize();
+            return abs(currentMinMax) < abs(openMinMax);
         }
         else if (order.getSide() == Side::SELL)
         {
-            auto const currentMinMax = pos.getNetPosition() - pos.getOpenSell() - order.getEntrySize();
-            return std::abs(currentMinMax) < std::abs(pos.getNetPosition() - pos.getOpenSell());
+            auto const openMinMax    = netPos - Qty::fromDouble(pos.getOpenSell());
+            auto const currentMinMax = openMinMax - order.getEntrySize();
+            return abs(currentMinMax) < abs(openMinMax);
         }
         return false;
     }
@@ -265,7 +282,7 @@ struct SymbolRisk
     }
     bool checkMaxOpen(logger::Logger* logger, const order_t& order, const position::SymbolPosition& pos) const
     {
-        auto const openSize = order.getSide() == Side::BUY ? pos.getOpenBuy() : pos.getOpenSell();
+        auto const openSize = Qty::fromDouble(order.getSide() == Side::BUY ? pos.getOpenBuy() : pos.getOpenSell());
         if (openSize + order.getEntrySize() > this->maxOpen)
         {
             logger->critical(
@@ -280,12 +297,12 @@ struct SymbolRisk
 
     bool checkOrderValue(logger::Logger* logger, const symbol_t& symbol, const order_t& order)
     {
-        if (std::isnan(order.getPrice()) || std::isinf(order.getPrice()))
+        if (!order.getPrice().isValid())
         {
             logger->critical("symbolRisk checkOrderValue invalid order price:{} order:{}", order.getPrice(), order);
             return false;
         }
-        auto const orderValue = order.getSize() * order.getPrice();
+        auto const orderValue = notional(order.getPrice(), order.getSize());
         if (math::greaterThan(orderValue, maxOrderValue))
         {
             return false;
@@ -296,15 +313,17 @@ struct SymbolRisk
     bool checkMinMax(logger::Logger* logger, const symbol_t& symbol, const order_t& order,
                      const position::SymbolPosition& pos)
     {
+        auto const netPos = Qty::fromDouble(pos.getNetPosition());
         if (order.getSide() == Side::BUY)
         {
-            auto const currentMinMax = pos.getNetPosition() + pos.getOpenBuy() + order.getSize();
+            auto const openMinMax    = netPos + Qty::fromDouble(pos.getOpenBuy());
+            auto const currentMinMax = openMinMax + order.getSize();
             // pass non risk increasing orders, this is necessary as we may be already over lmit without the new order
-            if (std::abs(currentMinMax) <= std::abs(pos.getNetPosition() + pos.getOpenBuy()))
+            if (abs(currentMinMax) <= abs(openMinMax))
             {
                 return true;
             }
-            if (std::abs(currentMinMax) > this->minmax)
+            if (abs(currentMinMax) > this->minmax)
             {
                 logger->critical("symbolRisk checkMinMax buy failed order {}", order);
                 return false;
@@ -312,12 +331,13 @@ struct SymbolRisk
         }
         else
         {
-            auto const currentMinMax = pos.getNetPosition() - pos.getOpenSell() - order.getSize();
-            if (std::abs(currentMinMax) <= std::abs(pos.getNetPosition() - pos.getOpenSell()))
+            auto const openMinMax    = netPos - Qty::fromDouble(pos.getOpenSell());
+            auto const currentMinMax = openMinMax - order.getSize();
+            if (abs(currentMinMax) <= abs(openMinMax))
             {
                 return true;
             }
-            if (std::abs(currentMinMax) > this->minmax)
+            if (abs(currentMinMax) > this->minmax)
             {
                 logger->critical("symbolRisk checkMinMax sell failed order {}", order);
                 return false;
@@ -328,8 +348,7 @@ struct SymbolRisk
     bool checkMinMaxValue(logger::Logger* logger, const symbol_t& symbol, const order_t& order,
                           const position::SymbolPosition& pos)
     {
-        if (std::isnan(order.getPrice()) || std::isinf(order.getPrice()) || std::isnan(order.getQty()) ||
-            std::isinf(order.getQty()) || math::floatEqual(order.getQty(), 0.0))
+        if (!order.getPrice().isValid() || !order.getQty().isValid() || order.getQty() == Qty{})
         {
             logger->critical("symbolRisk checkMinMaxValue invalid order price or qty, order {}", order);
             return false;
@@ -338,13 +357,13 @@ struct SymbolRisk
         if (order.getSide() == Side::BUY)
         {
             auto const currentMinMaxValue =
-                pos.getNetValue() + pos.getOpenBuyValue() + order.getSize() * order.getPrice();
+                pos.getNetValue() + pos.getOpenBuyValue() + notional(order.getPrice(), order.getSize());
             // pass non risk increasing orders, this is necessary as we may be already over lmit without the new order
             if (std::abs(currentMinMaxValue) <= std::abs(pos.getNetValue() + pos.getOpenBuyValue()))
             {
                 return true;
             }
-            if (std::abs(currentMinMaxValue) > this->minmax)
+            if (std::abs(currentMinMaxValue) > this->minmaxValue)
             {
                 logger->critical("symbolRisk checkMinMaxValue buy failed order {}", order);
                 return false;
@@ -353,12 +372,12 @@ struct SymbolRisk
         else
         {
             auto const currentMinMaxValue =
-                pos.getNetValue() - pos.getOpenBuyValue() - order.getSize() * order.getPrice();
+                pos.getNetValue() - pos.getOpenBuyValue() - notional(order.getPrice(), order.getSize());
             if (std::abs(currentMinMaxValue) <= std::abs(pos.getNetValue() - pos.getOpenSellValue()))
             {
                 return false;
             }
-            if (std::abs(currentMinMaxValue) > this->minmax)
+            if (std::abs(currentMinMaxValue) > this->minmaxValue)
             {
                 logger->critical("symbolRisk checkMinMaxValue sell failed order {}", order);
                 return false;
@@ -368,14 +387,14 @@ struct SymbolRisk
     }
 
     StateEnum reconcileFill(logger::Logger* logger, const symbol_t& symbol, const order_t& order, Side fillSide,
-                            price_t fillPrice, quantity_t fillQty) const
+                            Price fillPrice, Qty fillQty) const
     {
         if (order.getSide() != fillSide)
         {
             logger->critical("symbolRisk reconcileFill failed, fill side:{} order:{}", toString(fillSide), order);
             return StateEnum::FillSideMisMatch;
         }
-        if (math::greaterThan(order.getEntrySize(), fillQty))
+        if (order.getEntrySize() > fillQty)
         {
             return StateEnum::FillSizeExceedOrderSize;
         }
@@ -392,7 +411,7 @@ struct GlobalRisk
     uint16_t maxOrderRate{};
     uint16_t maxRejectRate{};
     uint16_t maxRepeatedOrderRate{};
-    quantity_t minmax{};
+    Qty minmax{};
     double minmaxValue{};
     double buyingPower{};
     double netBuyingPower{};
@@ -414,7 +433,7 @@ struct GlobalRisk
     utils::RollingQueue srvOrderRate{};
     utils::RollingQueue srvRejectRate{};
 
-    void setMinMax(quantity_t value) { this->minmax = value; }
+    void setMinMax(Qty value) { this->minmax = value; }
     void setMinMaxValue(double value) { this->minmaxValue = value; }
     void setBuyingPower(double value) { this->buyingPower = value; }
     void setNetBuyingPower(double value) { this->netBuyingPower = value; }
@@ -439,7 +458,7 @@ struct GlobalRisk
     // void accumulateExternalRejet(logger::Logger* logger, time::NanoTime timestamp, RejectReason reject) {}
 
     bool checkOrderRate(time::NanoTime timestamp, logger::Logger* logger, int32_t cid, const symbol_t& symbol,
-                        Side side, price_t price, quantity_t qty)
+                        Side side, Price price, Qty qty)
     {
         srvOrderRate.roll(timestamp);
         if (srvOrderRate.getSize() >= maxOrderRate)
@@ -449,20 +468,42 @@ struct GlobalRisk
             logger->critical("brechaed maxOrderRate:{} strategy is not allowed to send orders for {} milliseconds. set "
                              "lock state:{}",
                              maxOrderRate,
+                             std::chrono::duration_cast<std::chrono::milliseconds>(TimeoutWindow).count(),
                              toString(StateEnum::MaxServerOrderRate));
 
             return false;
         }
+        if (!srvOrderRate.append(timestamp))
+        {
+            logger->critical("order rate queue full, capacity:{} maxOrderRate:{}", srvOrderRate.capacity(),
+                             maxOrderRate);
+            return false;
+        }
         return true;
     }
 
+    // maxOrderRate orders per second, the queue holds at least rate + 1
+    void setMaxOrderRate(uint16_t rate)
+    {
+        maxOrderRate = rate;
+        srvOrderRate.init(RateWindow, rateCapacity(maxOrderRate));
+    }
+
     int32_t init()
     {
-        auto const window = std::chrono::milliseconds(999);
-        srvOrderRate.init(window);
-        srvRejectRate.init(window);
+        // sized once so the order path never allocates
+        srvOrderRate.init(RateWindow, rateCapacity(maxOrderRate));
+        srvRejectRate.init(RateWindow, rateCapacity(maxRejectRate));
         return 0;
     }
+
+  private:
+    static constexpr std::chrono::milliseconds RateWindow{999};
+
+    static size_t rateCapacity(uint16_t rate)
+    {
+        return std::max<size_t>(utils::RollingQueue::DefaultCapacity, size_t(rate) + 1);
+    }
 };
 
 struct Risk
@@ -481,7 +522,7 @@ struct Risk
         symbolRisks[cid] = sr;
         return true;
     }
-    void setRefPrice(int32_t cid, price_t price) { symbolRisks[cid].setRefPrice(price); }
+    void setRefPrice(int32_t cid, Price price) { symbolRisks[cid].setRefPrice(price); }
 
     bool checkMaxOrderNum(const symbol_t& symbol, uint32_t liveOrderCount)
     {
@@ -527,11 +568,21 @@ struct Risk
         // TODO: implement
         // if (symRisk.checkPriceDeviation)
 
-        if (!symRisk.checkOrderRate(logger(), symbol))
+        // position limits apply once they are set
+        if (symRisk.maxOpen > Qty{} && !symRisk.checkMaxOpen(logger(), order, symPos))
         {
             return false;
         }
-        if (!symRisk.checkRepeatedOrderRate(logger(), symbol, order))
+        if (symRisk.minmax > Qty{} && !symRisk.checkMinMax(logger(), symbol, order, symPos))
+        {
+            return false;
+        }
+
+        if (!symRisk.checkOrderRate(timestamp, logger(), symbol))
+        {
+            return false;
+        }
+        if (!symRisk.checkRepeatedOrderRate(timestamp, logger(), symbol, order))
         {
             return false;
         }
@@ -541,7 +592,7 @@ struct Risk
             return false;
         }
 
-        return false;
+        return true;
     }
 
     bool checkOrderRate(time::NanoTime timestamp, const symbol_t& symbol, const order_t& order)
@@ -0,0 +1,101 @@
+#include "benchmark/benchmark.h"
+#include "spdlog/sinks/null_sink.h"
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "libcore/types/types.hpp"
+#include "libs/logger/logger.hpp"
+#include "position/position.h"
+#include "risk/risk.h"
+
+using namespace miye;
+
+namespace
+{
+
+struct RiskFixture
+{
+    std::shared_ptr<logger::Logger> log{
+        std::make_shared<logger::Logger>("risk_bench", std::make_shared<spdlog::sinks::null_sink_st>())};
+    position::PortforlioPositions positions{};
+    std::vector<symbol_t> symbols{"BTC-PERP"};
+    position::SymbolPosition symPos{};
+    risk::Risk risk{positions, symbols};
+    order_t order{};
+
+    RiskFixture()
+    {
+        risk.init(log.get());
+        risk.globalRisk.setMaxOrderRate(60000);
+        risk.globalRisk.maxRepeatedOrderRate = 60000;
+        risk.globalRisk.init();
+
+        risk::SymbolRisk sr{};
+        sr.maxOrderSize         = Qty::fromDouble(10.0);
+        sr.maxRepeatedOrderRate = 1000000;
+        sr.setMaxOrderRate(1000000);
+        risk.symbolRisks.resize(symbols.size());
+        risk.setSymbolRisk(0, sr);
+
+        order.symbol = symbols[0];
+        order.side   = Side::BUY;
+        order.price  = Price::fromDouble(57120.5);
+        order.qty    = Qty::fromDouble(0.01);
+        order.cid    = 0;
+    }
+};
+
+} // namespace
+
+// full pre-trade path on the accept side, one order every 20us so the
+// rolling window holds ~50k timestamps and every check rolls one out
+static void allow_order(benchmark::State& state)
+{
+    RiskFixture f;
+    time::NanoTime ts{std::chrono::seconds(1600000000)};
+    size_t passed = 0;
+    while (state.KeepRunning())
+    {
+        ts += std::chrono::microseconds(20);
+        passed += f.risk.allowOrder(ts, 0, f.symbols[0], f.order, f.symPos);
+    }
+    if (passed != size_t(state.iterations()))
+    {
+        state.SkipWithError("order rejected");
+    }
+}
+
+BENCHMARK(allow_order);
+
+static void rolling_queue(benchmark::State& state)
+{
+    utils::RollingQueue queue;
+    queue.init(std::chrono::milliseconds(999), 65536);
+    time::NanoTime ts{std::chrono::seconds(1600000000)};
+    while (state.KeepRunning())
+    {
+        ts += std::chrono::microseconds(20);
+        benchmark::DoNotOptimize(queue.roll(ts));
+        queue.append(ts);
+        benchmark::DoNotOptimize(queue.getSize());
+    }
+}
+
+BENCHMARK(rolling_queue);
+
+static void rate_limiter(benchmark::State& state)
+{
+    utils::RateLimiter limiter;
+    limiter.init(50, std::chrono::seconds(1));
+    time::NanoTime ts{std::chrono::seconds(1600000000)};
+    while (state.KeepRunning())
+    {
+        ts += std::chrono::microseconds(20);
+        benchmark::DoNotOptimize(limiter.tryAcquire(ts));
+    }
+}
+
+BENCHMARK(rate_limiter);
+
+BENCHMARK_MAIN();
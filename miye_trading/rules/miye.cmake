@@ -109,6 +109,11 @@ if (NOT CMAKE_BUILD_TYPE)
 endif()
 
 option(CHECK_LIBRARY_DEPS "Verify inter-library dependencies and header usage" ON)
+option(PROFILING "Compile in TIME/WRITE_TIME and SPAN_ latency stamps" OFF)
+
+if(PROFILING)
+    add_definitions(-DPROFILING)
+endif()
 
 if(CHECK_LIBRARY_DEPS)
     set_property(GLOBAL PROPERTY GLOBAL_DEPENDS_NO_CYCLES ON)
@@ -0,0 +1,99 @@
+/*
+ * backtest_main.hpp
+ * purpose: main of a strategy's backtest binary
+ *
+ *   int main(int argc, char** argv)
+ *   {
+ *       return miye::trading::backtest::main<MyStrategy>(argc, argv);
+ *   }
+ *
+ * MyStrategy(const job_t&, const ini::IniFile&) reads its parameters for
+ * job.variant from the same file. Sessions run on many threads at once, so
+ * the file is only read through at().
+ *
+ * [backtest]
+ * first_date    = 20210101
+ * last_date     = 20210630
+ * workers       = 0          # 0 is one per core
+ * variants      = 1
+ * skip_weekends = false
+ * exchange      = exchangesim_w:ftx@latency=500000,exchangetype=queue
+ * report        = /tmp/backtest.csv
+ *
+ * [instrument.BTC-PERP]
+ * id        = 1
+ * tick_size = 1
+ * streams   = mmap:/data/md/{date}/ftx.md
+ */
+#pragma once
+
+#include "libcore/utils/string_utils.hpp"
+#include "libs/inifile/inicpp.h"
+#include "trading/backtest/backtest_runner.hpp"
+#include "trading/backtest/sim_session.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace miye::trading::backtest
+{
+
+constexpr static const char* InstrumentSection = "instrument.";
+
+inline std::vector<instrument_spec> read_instruments(ini::IniFile& config)
+{
+    std::vector<instrument_spec> instruments;
+    for (auto& section : config)
+    {
+        if (section.first.rfind(InstrumentSection, 0) != 0)
+        {
+            continue;
+        }
+        auto& s = section.second;
+        instrument_spec spec;
+        spec.instrument = s["id"].as<instrument_id_t>();
+        spec.tick_size  = s["tick_size"].as<double>();
+        spec.streams    = string_utils::split(s["streams"].as<std::string>(), ',');
+        instruments.push_back(std::move(spec));
+    }
+    return instruments;
+}
+
+template <typename Strategy>
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: " << argv[0] << " backtest.ini" << std::endl;
+        return 1;
+    }
+    ini::IniFile config(argv[1]);
+    auto& section = config["backtest"];
+
+    auto jobs = make_jobs(time::date_t(section["first_date"].as<std::string>()),
+                          time::date_t(section["last_date"].as<std::string>()), read_instruments(config),
+                          section["variants"].as<uint32_t>(), section["skip_weekends"].as<bool>());
+    if (jobs.empty())
+    {
+        std::cerr << "no market data in the date range" << std::endl;
+        return 1;
+    }
+
+    runner pool(std::move(jobs), section["workers"].as<uint32_t>());
+    std::cerr << "backtest jobs:" << pool.job_count() << " workers:" << pool.worker_count() << std::endl;
+
+    auto const exchange = section["exchange"].as<std::string>();
+    auto const results  = pool.run([&](const job_t& job) {
+        sim_session<Strategy> session(job, exchange, std::as_const(config));
+        return session.run();
+    });
+
+    std::ofstream report(section["report"].as<std::string>());
+    write_report(report, results);
+    return report ? 0 : 1;
+}
+
+} // namespace miye::trading::backtest
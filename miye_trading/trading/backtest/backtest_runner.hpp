@@ -0,0 +1,381 @@
+/*
+ * backtest_runner.hpp
+ * purpose: replay many days of many instruments at once
+ *
+ * A backtest is cut into jobs, one day of one instrument for one parameter
+ * variant, and a pool of workers replays them. Every worker owns everything
+ * a replay touches, so workers share nothing but the job counter and scale
+ * with cores as long as the files come off disk fast enough:
+ * - workers are spread over the numa nodes and pinned, each builds its
+ *   replay chain on its own thread so the memory is local to it
+ * - the biggest files go first and the variants of one file run side by
+ *   side, so the pool finishes together and a file is read once per sweep
+ * - files are advised sequential, the files of the next round of jobs are
+ *   read ahead while this round runs, and dropped from the page cache once
+ *   the last variant is done with them
+ */
+#pragma once
+
+#include "libcore/essential/assert.hpp"
+#include "libcore/qstream/qstream_common.hpp"
+#include "libcore/time/date.hpp"
+#include "libcore/types/types.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <pthread.h>
+#include <sched.h>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <tuple>
+#include <unistd.h>
+#include <vector>
+
+namespace miye::trading::backtest
+{
+
+using types::fp_t;
+using types::instrument_id_t;
+
+// market data of an instrument, {date} in a stream is replaced by yyyymmdd
+struct instrument_spec
+{
+    instrument_id_t instrument{};
+    fp_t tick_size{};
+    std::vector<std::string> streams;
+};
+
+// one day of one instrument for one parameter variant
+struct job_t
+{
+    time::date_t date;
+    instrument_id_t instrument{};
+    uint32_t variant{};
+    fp_t tick_size{};
+    std::vector<std::string> streams; // qstream descriptions for the day
+    uint64_t bytes{};                 // of the streams on disk
+    uint32_t file_group{};            // jobs replaying the same streams
+};
+
+struct result_t
+{
+    time::date_t date;
+    instrument_id_t instrument{};
+    uint32_t variant{};
+    uint64_t md_events{};
+    uint64_t orders{};
+    uint64_t fills{};
+    double volume{};
+    double cash{}; // sells add, buys take away
+    double position{};
+    double mark{}; // last mid, what an open position is worth
+    uint64_t elapsed_ns{};
+
+    double pnl() const { return cash + (position != 0 ? position * mark : 0); }
+};
+
+inline std::string expand_date(std::string description, time::date_t date)
+{
+    static const std::string key("{date}");
+    auto const yyyymmdd = std::to_string(date.to_yyyymmdd());
+    for (auto pos = description.find(key); pos != std::string::npos; pos = description.find(key))
+    {
+        description.replace(pos, key.size(), yyyymmdd);
+    }
+    return description;
+}
+
+inline uint64_t file_size(const std::string& path)
+{
+    struct stat st;
+    return ::stat(path.c_str(), &st) == 0 ? uint64_t(st.st_size) : 0;
+}
+
+/*
+ * jobs for every day in [first, last] that has data, largest first, the
+ * variants of a day next to each other
+ */
+inline std::vector<job_t> make_jobs(time::date_t first, time::date_t last, const std::vector<instrument_spec>& instruments,
+                                    uint32_t variants, bool skip_weekends)
+{
+    std::vector<job_t> files;
+    for (auto date = first; date <= last; date = date.next_day())
+    {
+        if (skip_weekends && date.is_weekend())
+        {
+            continue;
+        }
+        for (auto const& spec : instruments)
+        {
+            job_t job;
+            job.date       = date;
+            job.instrument = spec.instrument;
+            job.tick_size  = spec.tick_size;
+            for (auto const& stream : spec.streams)
+            {
+                job.streams.push_back(expand_date(stream, date));
+                job.bytes += file_size(qstream::extract_path(job.streams.back()));
+            }
+            if (job.bytes > 0)
+            {
+                files.push_back(std::move(job));
+            }
+        }
+    }
+
+    std::stable_sort(files.begin(), files.end(), [](const job_t& a, const job_t& b) { return a.bytes > b.bytes; });
+
+    std::vector<job_t> jobs;
+    jobs.reserve(files.size() * variants);
+    for (uint32_t group = 0; group < files.size(); ++group)
+    {
+        for (uint32_t variant = 0; variant < variants; ++variant)
+        {
+            jobs.push_back(files[group]);
+            jobs.back().variant    = variant;
+            jobs.back().file_group = group;
+        }
+    }
+    return jobs;
+}
+
+/*
+ * cpus by numa node from sysfs, one node with every online cpu where the
+ * kernel has no numa
+ */
+inline std::vector<std::vector<int>> numa_cpus()
+{
+    auto parse_cpulist = [](const std::string& list) {
+        std::vector<int> cpus;
+        size_t pos = 0;
+        while (pos < list.size())
+        {
+            auto const comma = std::min(list.find(',', pos), list.size());
+            auto const range = list.substr(pos, comma - pos);
+            auto const dash  = range.find('-');
+            if (!range.empty())
+            {
+                int const from = std::stoi(range.substr(0, dash));
+                int const to   = dash == std::string::npos ? from : std::stoi(range.substr(dash + 1));
+                for (int cpu = from; cpu <= to; ++cpu)
+                {
+                    cpus.push_back(cpu);
+                }
+            }
+            pos = comma + 1;
+        }
+        return cpus;
+    };
+
+    std::vector<std::vector<int>> nodes;
+    for (int node = 0;; ++node)
+    {
+        std::ifstream in("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        std::string list;
+        if (!in || !std::getline(in, list))
+        {
+            break;
+        }
+        auto cpus = parse_cpulist(list);
+        if (!cpus.empty())
+        {
+            nodes.push_back(std::move(cpus));
+        }
+    }
+    if (nodes.empty())
+    {
+        nodes.emplace_back();
+        for (int cpu = 0; cpu < int(std::thread::hardware_concurrency()); ++cpu)
+        {
+            nodes.back().push_back(cpu);
+        }
+    }
+    return nodes;
+}
+
+// worker i goes to node i % nodes, so a small pool still uses every memory controller
+inline int worker_cpu(const std::vector<std::vector<int>>& nodes, uint32_t worker)
+{
+    auto const& cpus = nodes[worker % nodes.size()];
+    return cpus.empty() ? -1 : cpus[(worker / nodes.size()) % cpus.size()];
+}
+
+inline bool pin_to_cpu(int cpu)
+{
+    if (cpu < 0)
+    {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set) == 0;
+}
+
+inline void advise_streams(const job_t& job, int advice)
+{
+    for (auto const& stream : job.streams)
+    {
+        auto const fd = ::open(qstream::extract_path(stream).c_str(), O_RDONLY);
+        if (fd >= 0)
+        {
+            ::posix_fadvise(fd, 0, 0, advice);
+            ::close(fd);
+        }
+    }
+}
+
+/*
+ * replay(const job_t&) -> result_t runs on the workers and builds its whole
+ * replay chain itself
+ */
+class runner
+{
+  public:
+    runner(std::vector<job_t> jobs, uint32_t workers)
+        : jobs_(std::move(jobs)), workers_(workers ? workers : std::max(1u, std::thread::hardware_concurrency()))
+    {
+        uint32_t groups = 0;
+        for (auto const& job : jobs_)
+        {
+            groups = std::max(groups, job.file_group + 1);
+        }
+        pending_ = std::make_unique<std::atomic<uint32_t>[]>(groups);
+        for (uint32_t g = 0; g < groups; ++g)
+        {
+            pending_[g] = 0;
+        }
+        for (auto const& job : jobs_)
+        {
+            ++pending_[job.file_group];
+        }
+    }
+
+    template <typename Replay>
+    std::vector<result_t> run(Replay&& replay)
+    {
+        auto const nodes = numa_cpus();
+        std::vector<std::vector<result_t>> results(workers_);
+        std::vector<std::thread> threads;
+
+        // the first round is read ahead before anybody starts
+        for (size_t i = 0; i < std::min<size_t>(workers_, jobs_.size()); ++i)
+        {
+            advise_streams(jobs_[i], POSIX_FADV_WILLNEED);
+        }
+
+        for (uint32_t w = 0; w < workers_; ++w)
+        {
+            threads.emplace_back([this, w, &nodes, &results, &replay] {
+                pin_to_cpu(worker_cpu(nodes, w));
+                work(results[w], replay);
+            });
+        }
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+
+        std::vector<result_t> merged;
+        for (auto& r : results)
+        {
+            merged.insert(merged.end(), r.begin(), r.end());
+        }
+        std::sort(merged.begin(), merged.end(), [](const result_t& a, const result_t& b) {
+            return std::tie(a.variant, a.date.i, a.instrument) < std::tie(b.variant, b.date.i, b.instrument);
+        });
+        return merged;
+    }
+
+    size_t job_count() const { return jobs_.size(); }
+    uint32_t worker_count() const { return workers_; }
+
+  private:
+    template <typename Replay>
+    void work(std::vector<result_t>& results, Replay& replay)
+    {
+        for (size_t i = next_++; i < jobs_.size(); i = next_++)
+        {
+            auto const& job = jobs_[i];
+            if (i + workers_ < jobs_.size())
+            {
+                advise_streams(jobs_[i + workers_], POSIX_FADV_WILLNEED);
+            }
+            advise_streams(job, POSIX_FADV_SEQUENTIAL);
+
+            auto const start = std::chrono::steady_clock::now();
+            results.push_back(replay(job));
+            results.back().elapsed_ns =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+            if (--pending_[job.file_group] == 0)
+            {
+                advise_streams(job, POSIX_FADV_DONTNEED);
+            }
+        }
+    }
+
+  private:
+    std::vector<job_t> jobs_;
+    uint32_t workers_;
+    std::atomic<size_t> next_{0};
+    std::unique_ptr<std::atomic<uint32_t>[]> pending_;
+};
+
+/*
+ * per day rows, then a line per variant: total pnl, mean and stdev of the
+ * daily pnl, fills and volume, what a parameter sweep is ranked on
+ */
+inline void write_report(std::ostream& os, const std::vector<result_t>& results)
+{
+    os << "variant,date,instrument,md_events,orders,fills,volume,position,mark,pnl,elapsed_ms\n";
+    os << std::fixed << std::setprecision(6);
+    for (auto const& r : results)
+    {
+        os << r.variant << ',' << r.date << ',' << r.instrument << ',' << r.md_events << ',' << r.orders << ','
+           << r.fills << ',' << r.volume << ',' << r.position << ',' << r.mark << ',' << r.pnl() << ','
+           << r.elapsed_ns / 1'000'000 << '\n';
+    }
+
+    struct summary
+    {
+        std::map<int32_t, double> daily; // pnl by date, instruments summed
+        uint64_t fills{};
+        double volume{};
+    };
+    std::map<uint32_t, summary> variants;
+    for (auto const& r : results)
+    {
+        auto& s = variants[r.variant];
+        s.daily[r.date.i] += r.pnl();
+        s.fills += r.fills;
+        s.volume += r.volume;
+    }
+
+    os << "\nvariant,days,pnl,mean_daily_pnl,stdev_daily_pnl,fills,volume\n";
+    for (auto const& [variant, s] : variants)
+    {
+        double sum = 0, sum_sq = 0;
+        for (auto const& [date, pnl] : s.daily)
+        {
+            sum += pnl;
+            sum_sq += pnl * pnl;
+        }
+        auto const days   = double(s.daily.size());
+        auto const mean   = days > 0 ? sum / days : 0;
+        auto const stdev  = days > 1 ? std::sqrt(std::max(0.0, (sum_sq - days * mean * mean) / (days - 1))) : 0;
+        os << variant << ',' << s.daily.size() << ',' << sum << ',' << mean << ',' << stdev << ',' << s.fills << ','
+           << s.volume << '\n';
+    }
+}
+
+} // namespace miye::trading::backtest
@@ -0,0 +1,162 @@
+/*
+ * sim_session.hpp
+ * purpose: the replay chain of one backtest job
+ *
+ * The market data streams of the day go through an arbiter on the job's own
+ * replay_clock into an exchange simulator, the strategy sees every quote
+ * after the simulator has matched it and sends its orders back into the
+ * same simulator. Nothing is shared with other sessions.
+ *
+ * Strategy is built per job and provides
+ *   Strategy(const job_t&, Args...)
+ *   void on_quote(const message::quote&, order_sink<Clock>&)
+ *   void on_response(const message::order_msg&, order_sink<Clock>&)
+ *   void on_end(order_sink<Clock>&)
+ */
+#pragma once
+
+#include "libcore/qstream/arbiter.hpp"
+#include "libcore/qstream/exchangesim_reader.hpp"
+#include "libcore/qstream/exchangesim_writer.hpp"
+#include "libcore/qstream/variantqstream_reader.hpp"
+#include "libcore/time/clock.hpp"
+#include "trading/backtest/backtest_runner.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace miye::trading::backtest
+{
+
+namespace message = types::message;
+
+// where a strategy sends orders, straight into the simulated exchange
+template <typename Clock>
+class order_sink
+{
+  public:
+    order_sink(qstream::exchangesim_writer<Clock>& exchange, result_t& result) : exchange_(exchange), result_(result)
+    {
+    }
+
+    template <typename T>
+    void send(T& request)
+    {
+        request.type    = T::msg_type;
+        request.version = T::msg_version;
+        ++result_.orders;
+        exchange_.announce(qstream::place(&request, sizeof(T)));
+    }
+
+  private:
+    qstream::exchangesim_writer<Clock>& exchange_;
+    result_t& result_;
+};
+
+template <typename Strategy, int MaxStreams = 8>
+class sim_session
+{
+  public:
+    using Clock_t    = time::replay_clock;
+    using reader_t   = qstream::variantqstream_reader<Clock_t>;
+    using arbiter_t  = qstream::arbiter<Clock_t, reader_t, MaxStreams>;
+    using exchange_t = qstream::exchangesim_writer<Clock_t>;
+    using sink_t     = order_sink<Clock_t>;
+
+  public:
+    // exchange is the exchangesim description, with the latency and exchangetype of the simulation
+    template <typename... Args>
+    sim_session(const job_t& job, const std::string& exchange, Args&&... args)
+        : job_(job), exchange_(clk_, exchange), responses_(exchange_), strategy_(job, std::forward<Args>(args)...)
+    {
+        INVARIANT_MSG(job.streams.size() <= size_t(MaxStreams),
+                      "backtest job has " << job.streams.size() << " streams, session takes " << MaxStreams);
+        exchange_.tick_size = job.tick_size;
+        result_.date        = job.date;
+        result_.instrument  = job.instrument;
+        result_.variant     = job.variant;
+    }
+
+    result_t run()
+    {
+        std::vector<std::unique_ptr<reader_t>> readers;
+        arbiter_t arb(clk_);
+        for (auto const& stream : job_.streams)
+        {
+            readers.push_back(std::make_unique<reader_t>(clk_, stream));
+            arb.submit(readers.back().get());
+        }
+        arb.submission_complete();
+
+        sink_t sink(exchange_, result_);
+        for (auto id = arb.ruling(); id < qstream::arbiter_error::end; id = arb.ruling())
+        {
+            clk_.set(arb.winning_time(id));
+            auto const plc = readers[id - 1]->read();
+            if (plc.is_eof())
+            {
+                arb.withdraw(id);
+                continue;
+            }
+            arb.read_complete(id);
+
+            auto const* m = reinterpret_cast<const message::miye_msg*>(plc.start);
+            if (m->type != message::msg_type_t::quote && m->type != message::msg_type_t::trade_summary_quote)
+            {
+                continue;
+            }
+            auto const* q = reinterpret_cast<const message::quote*>(plc.start);
+            if (q->instrument != job_.instrument)
+            {
+                continue;
+            }
+
+            ++result_.md_events;
+            if (q->bid_qty[0] > 0 && q->ask_qty[0] > 0)
+            {
+                result_.mark = (q->bid_px[0] + q->ask_px[0]) / 2;
+            }
+
+            // resting orders match against the quote before the strategy reacts to it
+            exchange_.announce(plc);
+            drain(sink);
+            strategy_.on_quote(*q, sink);
+            drain(sink);
+        }
+
+        strategy_.on_end(sink);
+        drain(sink);
+        return result_;
+    }
+
+  private:
+    void drain(sink_t& sink)
+    {
+        while (!exchange_.order_responses.empty())
+        {
+            auto const plc = responses_.read();
+            auto const& r  = *reinterpret_cast<const message::order_msg*>(plc.start);
+            if (r.type == message::msg_type_t::order_executed)
+            {
+                auto const& e   = reinterpret_cast<const message::order_executed&>(r);
+                auto const sign = e.side == message::side_t::buy ? 1.0 : -1.0;
+                ++result_.fills;
+                result_.volume += e.executed_volume;
+                result_.position += sign * e.executed_volume;
+                result_.cash -= sign * e.executed_volume * e.executed_price;
+            }
+            strategy_.on_response(r, sink);
+        }
+    }
+
+  private:
+    const job_t& job_;
+    Clock_t clk_;
+    exchange_t exchange_;
+    qstream::exchangesim_reader<Clock_t> responses_;
+    Strategy strategy_;
+    result_t result_;
+};
+
+} // namespace miye::trading::backtest
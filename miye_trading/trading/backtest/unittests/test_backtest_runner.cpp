@@ -0,0 +1,149 @@
+#define BOOST_TEST_MODULE test_backtest_runner
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "trading/backtest/backtest_runner.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace miye;
+using namespace miye::trading::backtest;
+
+namespace
+{
+
+// a scratch directory with a file of bytes for each yyyymmdd given
+struct MdDir
+{
+    std::string path;
+
+    MdDir()
+    {
+        char tmpl[] = "/tmp/test_backtest_runner.XXXXXX";
+        path        = ::mkdtemp(tmpl);
+    }
+    ~MdDir()
+    {
+        for (auto const& file : files)
+        {
+            std::remove(file.c_str());
+        }
+        ::rmdir(path.c_str());
+    }
+
+    void add(const std::string& name, size_t bytes)
+    {
+        files.push_back(path + "/" + name);
+        std::ofstream(files.back()) << std::string(bytes, 'x');
+    }
+
+    std::vector<std::string> files;
+};
+
+std::vector<std::string> lines(const std::string& text)
+{
+    std::vector<std::string> out;
+    std::istringstream in(text);
+    for (std::string line; std::getline(in, line);)
+    {
+        out.push_back(line);
+    }
+    return out;
+}
+
+result_t result(uint32_t variant, int day, instrument_id_t instrument, double cash, double position, double mark)
+{
+    result_t r;
+    r.variant    = variant;
+    r.date       = time::date_t(2021, 1, day);
+    r.instrument = instrument;
+    r.cash       = cash;
+    r.position   = position;
+    r.mark       = mark;
+    r.fills      = 2;
+    r.volume     = 1.5;
+    return r;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TestMakeJobsLargestFirstVariantsTogether)
+{
+    MdDir dir;
+    // 2021-01-01 is a friday, 02/03 the weekend, 04 has no file
+    dir.add("ftx.20210101", 100);
+    dir.add("ftx.20210102", 300);
+    dir.add("ftx.20210103", 50);
+    dir.add("ftx.20210105", 200);
+    dir.add("binance.20210105", 400);
+
+    std::vector<instrument_spec> instruments(2);
+    instruments[0].instrument = 1;
+    instruments[0].tick_size  = 0.5;
+    instruments[0].streams    = {"mmap:" + dir.path + "/ftx.{date}@follow"};
+    instruments[1].instrument = 2;
+    instruments[1].streams    = {"mmap:" + dir.path + "/binance.{date}"};
+
+    auto const jobs = make_jobs(time::date_t(2021, 1, 1), time::date_t(2021, 1, 5), instruments, 2, false);
+    BOOST_REQUIRE_EQUAL(jobs.size(), 10u);
+
+    std::vector<uint64_t> bytes{400, 400, 300, 300, 200, 200, 100, 100, 50, 50};
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL(jobs[i].bytes, bytes[i]);
+        BOOST_CHECK_EQUAL(jobs[i].variant, i % 2);
+        BOOST_CHECK_EQUAL(jobs[i].file_group, i / 2);
+    }
+    BOOST_CHECK_EQUAL(jobs[0].instrument, 2);
+    BOOST_CHECK_EQUAL(jobs[2].instrument, 1);
+    BOOST_CHECK_EQUAL(jobs[2].tick_size, 0.5);
+    BOOST_CHECK_EQUAL(jobs[2].date.to_yyyymmdd(), 20210102u);
+    BOOST_REQUIRE_EQUAL(jobs[2].streams.size(), 1u);
+    BOOST_CHECK_EQUAL(jobs[2].streams[0], "mmap:" + dir.path + "/ftx.20210102@follow");
+
+    auto const weekdays = make_jobs(time::date_t(2021, 1, 1), time::date_t(2021, 1, 5), instruments, 1, true);
+    BOOST_REQUIRE_EQUAL(weekdays.size(), 3u);
+    for (auto const& job : weekdays)
+    {
+        BOOST_CHECK(!job.date.is_weekend());
+    }
+
+    BOOST_CHECK(make_jobs(time::date_t(2021, 1, 6), time::date_t(2021, 1, 9), instruments, 1, false).empty());
+}
+
+BOOST_AUTO_TEST_CASE(TestWriteReport)
+{
+    // variant 0 makes 10 then loses 4 over two days of two instruments, variant 1 trades one day
+    std::vector<result_t> results{
+        result(0, 4, 1, -100.0, 1.0, 108.0),
+        result(0, 4, 2, 2.0, 0.0, 50.0),
+        result(0, 5, 1, -4.0, 0.0, 108.0),
+        result(1, 4, 1, 7.0, 0.0, 0.0),
+    };
+    std::ostringstream os;
+    write_report(os, results);
+
+    auto const out = lines(os.str());
+    BOOST_REQUIRE_EQUAL(out.size(), 9u);
+    BOOST_CHECK_EQUAL(out[0], "variant,date,instrument,md_events,orders,fills,volume,position,mark,pnl,elapsed_ms");
+    BOOST_CHECK_EQUAL(out[1].substr(0, 2), "0,");
+    BOOST_CHECK(out[1].find(",8.000000,") != std::string::npos);
+    BOOST_CHECK(out[4].find(",7.000000,") != std::string::npos);
+    BOOST_CHECK(out[5].empty());
+    BOOST_CHECK_EQUAL(out[6], "variant,days,pnl,mean_daily_pnl,stdev_daily_pnl,fills,volume");
+
+    // daily pnl 10 and -4: mean 3, sample stdev sqrt(98)
+    std::ostringstream v0;
+    v0 << std::fixed << std::setprecision(6) << "0,2," << 6.0 << ',' << 3.0 << ',' << std::sqrt(98.0) << ",6,"
+       << 4.5;
+    BOOST_CHECK_EQUAL(out[7], v0.str());
+
+    std::ostringstream v1;
+    v1 << std::fixed << std::setprecision(6) << "1,1," << 7.0 << ',' << 7.0 << ',' << 0.0 << ",2," << 1.5;
+    BOOST_CHECK_EQUAL(out[8], v1.str());
+}
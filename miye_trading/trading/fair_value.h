@@ -0,0 +1,420 @@
+#pragma once
+#include "libcore/types/types.hpp"
+#include "libcore/utils/string_utils.hpp"
+#include "libs/inifile/inicpp.h"
+#include "market_data/book/exchange.h"
+#include "market_data/book/order_book.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <iterator>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace miye
+{
+namespace trading
+{
+
+/*
+ * Consolidated top of book and fair value of one underlying quoted on
+ * several venues, e.g. BINANCE:FTMUSDT and FTX:FTM-PERP.
+ *
+ * [fair_value]
+ * underlyings = FTM
+ * FTM         = BINANCE:FTMUSDT,FTX:FTM-PERP
+ *
+ * [fair_value.binance]     # per venue, every key optional
+ * weight     = 1.0         # share in the fair value
+ * fee_bps    = 4           # taker fee, bids are lowered and asks raised by it
+ * latency_ns = 2000000     # feed latency, counts towards the age of its books
+ * stale_ns   = 500000000   # a book older than this, latency included, is left out
+ * depth      = 5           # levels summed for the depth weighted mid
+ */
+
+const constexpr size_t FairValueMaxVenues{4};
+
+struct FairValueListener
+{
+    virtual ~FairValueListener() = default;
+
+    virtual int32_t onFairValueChange(int32_t uid) = 0;
+};
+
+struct VenueParams
+{
+    double weight{1.0};
+    double feeBps{0.0};
+    uint64_t latencyNs{0};
+    uint64_t staleNs{1'000'000'000};
+    uint32_t depth{1};
+};
+
+struct FairValue
+{
+    // best fee adjusted prices over the venues and where they are
+    double bidPx{NAN};
+    double askPx{NAN};
+    Qty bidQty{};
+    Qty askQty{};
+    int32_t bidCid{INVALID_CID};
+    int32_t askCid{INVALID_CID};
+
+    // weighted over the venues of their depth weighted mids
+    double fair{NAN};
+    uint32_t venues{0};
+    uint64_t timestamp{0};
+
+    bool isValid() const { return venues > 0; }
+};
+
+/*
+ * onBookChange() costs the same whatever the number of underlyings: the
+ * fair value is kept as running sums and the best bid/ask are only looked
+ * for again over the underlying's venues when the venue holding them
+ * backs off. Stale venues are dropped by onTimer().
+ *
+ * A venue's weight is constant while its book is fresh, it does not decay
+ * with age: that would change every term of the sums on each update. The
+ * feed latency only brings the venue's stale cut off forward.
+ */
+class FairValueEngine
+{
+  public:
+    int32_t init(std::string configFile, const std::vector<symbol_t>& symbols)
+    {
+        auto iniFile           = ini::IniFile(configFile);
+        auto& section          = iniFile["fair_value"];
+        auto const underlyings = string_utils::split(section["underlyings"].as<std::string>(), ',');
+
+        for (auto const& name : underlyings)
+        {
+            auto const uid = addUnderlying(name);
+            for (auto const& symbol : string_utils::split(section[name].as<std::string>(), ','))
+            {
+                auto const it = std::find(symbols.begin(), symbols.end(), symbol);
+                if (it == symbols.end())
+                {
+                    std::cout << "ERROR fair value symbol not in global symbol_list:" << symbol << std::endl;
+                    return -1;
+                }
+                if (addVenue(uid, std::distance(symbols.begin(), it), loadParams(iniFile, symbol)) != 0)
+                {
+                    return -1;
+                }
+            }
+        }
+        return 0;
+    }
+
+    int32_t addUnderlying(const std::string& name)
+    {
+        underlyings_.emplace_back();
+        underlyings_.back().name = name;
+        return underlyings_.size() - 1;
+    }
+
+    int32_t addVenue(int32_t uid, int32_t cid, const VenueParams& params)
+    {
+        auto& underlying = underlyings_[uid];
+        if (underlying.venueNum == FairValueMaxVenues)
+        {
+            std::cout << "ERROR too many venues for underlying:" << underlying.name << std::endl;
+            return -1;
+        }
+        if (cid >= int32_t(cidToVenue_.size()))
+        {
+            cidToVenue_.resize(cid + 1);
+        }
+        auto& venue  = underlying.venues[underlying.venueNum];
+        venue.cid    = cid;
+        venue.params = params;
+        venue.fee    = params.feeBps / 10000;
+
+        cidToVenue_[cid] = VenueRef{uid, int32_t(underlying.venueNum)};
+        ++underlying.venueNum;
+        return 0;
+    }
+
+    void setListener(FairValueListener* listener) { listener_ = listener; }
+
+    // call from MDListener::onBookChange, the listener hears of the underlying when the venue's top moved
+    void onBookChange(uint64_t now, int32_t cid, const OrderBook& book)
+    {
+        if (cid >= int32_t(cidToVenue_.size()) || cidToVenue_[cid].uid == INVALID_CID)
+        {
+            return;
+        }
+        auto const ref   = cidToVenue_[cid];
+        auto& underlying = underlyings_[ref.uid];
+        auto& venue      = underlying.venues[ref.slot];
+        venue.updated    = now;
+
+        Venue next = venue;
+        quote(book, next);
+        if (!next.active && !venue.active)
+        {
+            return;
+        }
+        if (next.active == venue.active && next.bidPx == venue.bidPx && next.askPx == venue.askPx &&
+            next.bidQty == venue.bidQty && next.askQty == venue.askQty && next.fair == venue.fair)
+        {
+            return;
+        }
+
+        if (venue.active)
+        {
+            underlying.sumWeightedFair -= venue.params.weight * venue.fair;
+            underlying.sumWeight -= venue.params.weight;
+            --underlying.activeNum;
+        }
+        venue = next;
+        if (venue.active)
+        {
+            underlying.sumWeightedFair += venue.params.weight * venue.fair;
+            underlying.sumWeight += venue.params.weight;
+            ++underlying.activeNum;
+        }
+
+        updateTop(underlying, ref.slot);
+        publish(ref.uid, now);
+    }
+
+    // drops the venues whose books went stale, run it off a timer
+    void onTimer(uint64_t now)
+    {
+        for (int32_t uid = 0; uid < int32_t(underlyings_.size()); ++uid)
+        {
+            auto& underlying = underlyings_[uid];
+            bool dropped{false};
+            for (size_t slot = 0; slot < underlying.venueNum; ++slot)
+            {
+                auto& venue = underlying.venues[slot];
+                if (venue.active && isStale(venue, now))
+                {
+                    venue.active = false;
+                    dropped      = true;
+                }
+            }
+            if (dropped)
+            {
+                resum(underlying);
+                publish(uid, now);
+            }
+        }
+    }
+
+    const FairValue& get(int32_t uid) const { return underlyings_[uid].value; }
+
+    int32_t getUnderlying(int32_t cid) const
+    {
+        return cid < int32_t(cidToVenue_.size()) ? cidToVenue_[cid].uid : INVALID_CID;
+    }
+    const std::string& getName(int32_t uid) const { return underlyings_[uid].name; }
+    size_t getUnderlyingNum() const { return underlyings_.size(); }
+
+  private:
+    struct Venue
+    {
+        int32_t cid{INVALID_CID};
+        VenueParams params{};
+        double fee{0.0};
+
+        bool active{false};
+        double bidPx{NAN}; // fee adjusted
+        double askPx{NAN};
+        Qty bidQty{};
+        Qty askQty{};
+        double fair{NAN};
+        uint64_t updated{0};
+    };
+
+    struct Underlying
+    {
+        std::string name;
+        std::array<Venue, FairValueMaxVenues> venues{};
+        size_t venueNum{0};
+        size_t activeNum{0};
+        int32_t bidSlot{-1};
+        int32_t askSlot{-1};
+        double sumWeightedFair{0.0};
+        double sumWeight{0.0};
+        FairValue value{};
+    };
+
+    struct VenueRef
+    {
+        int32_t uid{INVALID_CID};
+        int32_t slot{-1};
+    };
+
+    static VenueParams loadParams(ini::IniFile& iniFile, const symbol_t& symbol)
+    {
+        VenueParams params{};
+        auto exchange = symbol.substr(0, symbol.find(':'));
+        auto& section = iniFile["fair_value." + string_utils::toLowercase(exchange)];
+        if (section.count("weight"))
+            params.weight = section["weight"].as<double>();
+        if (section.count("fee_bps"))
+            params.feeBps = section["fee_bps"].as<double>();
+        if (section.count("latency_ns"))
+            params.latencyNs = section["latency_ns"].as<uint64_t>();
+        if (section.count("stale_ns"))
+            params.staleNs = section["stale_ns"].as<uint64_t>();
+        if (section.count("depth"))
+            params.depth = std::max(section["depth"].as<uint32_t>(), 1u);
+        return params;
+    }
+
+    static bool isStale(const Venue& venue, uint64_t now)
+    {
+        return now + venue.params.latencyNs > venue.updated + venue.params.staleNs;
+    }
+
+    // the venue's fee adjusted top and its mid weighted by the qty on the top params.depth levels
+    static void quote(const OrderBook& book, Venue& venue)
+    {
+        auto const bidLevels = std::min<size_t>(book.getLevelCount(Side::BUY), venue.params.depth);
+        auto const askLevels = std::min<size_t>(book.getLevelCount(Side::SELL), venue.params.depth);
+        auto const bbo       = book.getBBO();
+        venue.active         = bidLevels > 0 && askLevels > 0 && bbo.isValid();
+        if (!venue.active)
+        {
+            return;
+        }
+
+        double bidDepth{0.0};
+        double askDepth{0.0};
+        for (size_t i = 0; i < bidLevels; ++i)
+        {
+            bidDepth += book.getLevel(Side::BUY, i).getQuantity().toDouble();
+        }
+        for (size_t i = 0; i < askLevels; ++i)
+        {
+            askDepth += book.getLevel(Side::SELL, i).getQuantity().toDouble();
+        }
+
+        venue.bidPx  = bbo.bidPx.toDouble() * (1 - venue.fee);
+        venue.askPx  = bbo.askPx.toDouble() * (1 + venue.fee);
+        venue.bidQty = bbo.bidQty;
+        venue.askQty = bbo.askQty;
+        venue.fair   = (venue.bidPx * askDepth + venue.askPx * bidDepth) / (bidDepth + askDepth);
+    }
+
+    static void updateTop(Underlying& underlying, int32_t slot)
+    {
+        auto const& venue = underlying.venues[slot];
+        if (!venue.active)
+        {
+            if (underlying.bidSlot == slot || underlying.askSlot == slot)
+            {
+                rescanTop(underlying);
+            }
+            return;
+        }
+
+        auto& bidSlot = underlying.bidSlot;
+        if (bidSlot == -1 || venue.bidPx > underlying.venues[bidSlot].bidPx)
+        {
+            bidSlot = slot;
+        }
+        else if (bidSlot == slot)
+        {
+            rescanTop(underlying);
+            return;
+        }
+
+        auto& askSlot = underlying.askSlot;
+        if (askSlot == -1 || venue.askPx < underlying.venues[askSlot].askPx)
+        {
+            askSlot = slot;
+        }
+        else if (askSlot == slot)
+        {
+            rescanTop(underlying);
+        }
+    }
+
+    static void rescanTop(Underlying& underlying)
+    {
+        underlying.bidSlot = -1;
+        underlying.askSlot = -1;
+        for (size_t slot = 0; slot < underlying.venueNum; ++slot)
+        {
+            auto const& venue = underlying.venues[slot];
+            if (!venue.active)
+            {
+                continue;
+            }
+            if (underlying.bidSlot == -1 || venue.bidPx > underlying.venues[underlying.bidSlot].bidPx)
+            {
+                underlying.bidSlot = slot;
+            }
+            if (underlying.askSlot == -1 || venue.askPx < underlying.venues[underlying.askSlot].askPx)
+            {
+                underlying.askSlot = slot;
+            }
+        }
+    }
+
+    // from scratch, also clears whatever rounding the running sums picked up
+    static void resum(Underlying& underlying)
+    {
+        underlying.sumWeightedFair = 0.0;
+        underlying.sumWeight       = 0.0;
+        underlying.activeNum       = 0;
+        for (size_t slot = 0; slot < underlying.venueNum; ++slot)
+        {
+            auto const& venue = underlying.venues[slot];
+            if (venue.active)
+            {
+                underlying.sumWeightedFair += venue.params.weight * venue.fair;
+                underlying.sumWeight += venue.params.weight;
+                ++underlying.activeNum;
+            }
+        }
+        rescanTop(underlying);
+    }
+
+    void publish(int32_t uid, uint64_t now)
+    {
+        auto& underlying = underlyings_[uid];
+        auto& value      = underlying.value;
+        value            = FairValue{};
+        value.timestamp  = now;
+        value.venues     = underlying.activeNum;
+        if (underlying.activeNum > 0 && underlying.sumWeight > 0)
+        {
+            value.fair = underlying.sumWeightedFair / underlying.sumWeight;
+        }
+        if (underlying.bidSlot != -1)
+        {
+            auto const& venue = underlying.venues[underlying.bidSlot];
+            value.bidPx       = venue.bidPx;
+            value.bidQty      = venue.bidQty;
+            value.bidCid      = venue.cid;
+        }
+        if (underlying.askSlot != -1)
+        {
+            auto const& venue = underlying.venues[underlying.askSlot];
+            value.askPx       = venue.askPx;
+            value.askQty      = venue.askQty;
+            value.askCid      = venue.cid;
+        }
+        if (listener_)
+        {
+            listener_->onFairValueChange(uid);
+        }
+    }
+
+  private:
+    std::vector<Underlying> underlyings_;
+    std::vector<VenueRef> cidToVenue_;
+    FairValueListener* listener_{nullptr};
+};
+
+} // namespace trading
+} // namespace miye
@@ -10,10 +10,14 @@ namespace trading
 struct instrument_t
 {
     symbol_t symbol;
-    price_t tickSize{}; // price step
-    quantity_t qtyStep{};
+    Price tickSize{}; // price step
+    Qty qtyStep{};
     double imfFactor{};
     int32_t positionLimitWgt{};
+
+    // decimals the exchange accepts on the wire
+    int32_t priceDecimals() const { return tickSize.significantDecimals(); }
+    int32_t qtyDecimals() const { return qtyStep.significantDecimals(); }
 };
 
 template <typename OS>
@@ -40,8 +44,8 @@ struct fmt_lib::formatter<miye::trading::instrument_t>
             ctx.out(),
             "symbol:{} tickSize{} qtyStep:{} imfFactor:{} positionLimitWgt:{}",
             i.symbol,
-            i.tickSize,
-            i.qtyStep,
+            i.tickSize.toDouble(),
+            i.qtyStep.toDouble(),
             i.imfFactor,
             i.positionLimitWgt);
     }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "libcore/time/span_tracer.hpp"
 #include "libcore/types/types.hpp"
 
 namespace miye::trading::ftx
@@ -13,7 +14,11 @@ struct CancelInfo
 
 struct OrderManager
 {
-    int32_t placeOrder(const symbol_t& symbol, Side side, price_t price, quantity_t qty) { return 0; }
+    int32_t placeOrder(const symbol_t& symbol, Side side, price_t price, quantity_t qty)
+    {
+        SPAN_STAMP(time::profiler_trigger::om_order_decision, 0);
+        return 0;
+    }
 
     // onConfirm, onCancel, onReject, onCancelReject
 
@@ -1,7 +1,6 @@
 #pragma once
-#include "libcore/math/math_util.h"
 #include "libcore/types/types.hpp"
-#include "libcore/utils/queue.hpp"
+#include "libcore/utils/rolling_stats.hpp"
 #include "trading.h"
 
 #include <vector>
@@ -11,44 +10,6 @@ namespace miye
 namespace trading
 {
 
-template <typename T = double>
-struct TradeItem
-{
-    T qty{};
-    TradeItem() = default;
-
-    explicit TradeItem(T v) : qty(v)
-    {
-    }
-
-    TradeItem& operator+=(const TradeItem& rhs)
-    {
-        qty += rhs.qty;
-        return *this;
-    }
-    TradeItem& operator-=(const TradeItem& rhs)
-    {
-        qty -= rhs.qty;
-        return *this;
-    }
-    TradeItem& operator=(const TradeItem& rhs)
-    {
-        this->qty = rhs.qty;
-        return *this;
-    }
-    bool operator==(const TradeItem& rhs) const
-    {
-        return math::floatEqual(this->qty, rhs.qty);
-    }
-};
-
-template <typename OS, typename T>
-OS& operator<<(OS& os, TradeItem<T> const& item)
-{
-    os << item.qty;
-    return os;
-}
-
 class TradeFlow
 {
   public:
@@ -60,7 +21,7 @@ class TradeFlow
         auto const tradeDir =
             trade.side == Side::BUY ? TradeDir::BUY : TradeDir::SELL;
 
-        tradeFlow_.add(timestamp, TradeItem<double>(trade.qty * tradeDir));
+        tradeFlow_.add(timestamp, trade.qty.toDouble() * tradeDir);
     }
 
     void decay(uint64_t timestamp)
@@ -68,21 +29,11 @@ class TradeFlow
         tradeFlow_.touch(timestamp);
     }
 
+    // signed over total traded qty in the window, both kept incrementally
     Signal calc()
     {
         Signal signal{};
-        auto const stateItem = tradeFlow_.sum();
-
-        double absSum{0.0};
-        for (int i = 0; i < tradeFlow_.size(); ++i)
-        {
-            auto const item = tradeFlow_[i];
-            absSum += abs(item.qty);
-        }
-
-        auto const rawAlpha = double(stateItem.qty) / double(absSum);
-        //        std::cout << "sum:" << stateItem.qty << " abs_sum:" << absSum
-        //                  << " rawAlpha:" << rawAlpha << std::endl;
+        auto const rawAlpha = tradeFlow_.sum() / tradeFlow_.abs_sum();
         signal.setValue(rawAlpha);
         return signal;
     }
@@ -94,7 +45,7 @@ class TradeFlow
     }
 
   private:
-    utils::Queue<TradeItem<double>> tradeFlow_;
+    utils::RollingStats tradeFlow_;
 };
 
 inline Signal TradeFlow::onTrade(uint64_t timestamp,
@@ -0,0 +1,187 @@
+#define BOOST_TEST_MODULE test_fair_value
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "market_data/book/order_book.h"
+#include "trading/fair_value.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace miye;
+using namespace miye::trading;
+
+namespace
+{
+
+struct Reference
+{
+    double bidPx{NAN};
+    double askPx{NAN};
+    double fair{NAN};
+    uint32_t venues{0};
+};
+
+// the fair value of the books from scratch, the way the engine defines it
+Reference reference(const std::vector<OrderBook>& books, const std::vector<VenueParams>& params)
+{
+    Reference ref;
+    double sumWeightedFair{0.0};
+    double sumWeight{0.0};
+    for (size_t cid = 0; cid < books.size(); ++cid)
+    {
+        auto const& book     = books[cid];
+        auto const bidLevels = std::min<size_t>(book.getLevelCount(Side::BUY), params[cid].depth);
+        auto const askLevels = std::min<size_t>(book.getLevelCount(Side::SELL), params[cid].depth);
+        if (bidLevels == 0 || askLevels == 0)
+        {
+            continue;
+        }
+        double bidDepth{0.0};
+        double askDepth{0.0};
+        for (size_t i = 0; i < bidLevels; ++i)
+        {
+            bidDepth += book.getLevel(Side::BUY, i).getQuantity().toDouble();
+        }
+        for (size_t i = 0; i < askLevels; ++i)
+        {
+            askDepth += book.getLevel(Side::SELL, i).getQuantity().toDouble();
+        }
+        auto const fee   = params[cid].feeBps / 10000;
+        auto const bbo   = book.getBBO();
+        auto const bidPx = bbo.bidPx.toDouble() * (1 - fee);
+        auto const askPx = bbo.askPx.toDouble() * (1 + fee);
+        auto const fair  = (bidPx * askDepth + askPx * bidDepth) / (bidDepth + askDepth);
+
+        sumWeightedFair += params[cid].weight * fair;
+        sumWeight += params[cid].weight;
+        ++ref.venues;
+        if (std::isnan(ref.bidPx) || bidPx > ref.bidPx)
+        {
+            ref.bidPx = bidPx;
+        }
+        if (std::isnan(ref.askPx) || askPx < ref.askPx)
+        {
+            ref.askPx = askPx;
+        }
+    }
+    if (ref.venues > 0)
+    {
+        ref.fair = sumWeightedFair / sumWeight;
+    }
+    return ref;
+}
+
+// 0..5 levels a side around mid, one side left empty now and then
+void randomBook(std::mt19937& rng, OrderBook& book)
+{
+    std::uniform_int_distribution<int32_t> levelNum(0, 5);
+    std::uniform_int_distribution<int32_t> midTicks(9900, 10100);
+    std::uniform_int_distribution<int32_t> gapTicks(1, 3);
+    std::uniform_int_distribution<int32_t> lots(1, 50);
+
+    auto const mid = midTicks(rng);
+    PriceLevel<Price> levels[5];
+    for (auto side : {Side::BUY, Side::SELL})
+    {
+        auto const count = levelNum(rng);
+        auto px          = side == Side::BUY ? mid - 1 : mid + 1;
+        for (int32_t i = 0; i < count; ++i)
+        {
+            levels[i] = PriceLevel<Price>(Price::fromDouble(px * 0.5), Qty::fromDouble(lots(rng) * 0.01));
+            px += side == Side::BUY ? -gapTicks(rng) : gapTicks(rng);
+        }
+        book.setLevels(side, levels, count);
+    }
+}
+
+void checkAgainstReference(const FairValue& value, const Reference& ref, const std::vector<OrderBook>& books,
+                           const std::vector<VenueParams>& params)
+{
+    BOOST_REQUIRE_EQUAL(value.venues, ref.venues);
+    if (ref.venues == 0)
+    {
+        BOOST_CHECK(std::isnan(value.fair));
+        BOOST_CHECK_EQUAL(value.bidCid, INVALID_CID);
+        BOOST_CHECK_EQUAL(value.askCid, INVALID_CID);
+        return;
+    }
+    BOOST_CHECK_EQUAL(value.bidPx, ref.bidPx);
+    BOOST_CHECK_EQUAL(value.askPx, ref.askPx);
+    BOOST_CHECK_CLOSE(value.fair, ref.fair, 1e-9);
+
+    // the venue reported for the best bid/ask does quote it
+    auto const bidFee = params[value.bidCid].feeBps / 10000;
+    auto const askFee = params[value.askCid].feeBps / 10000;
+    BOOST_CHECK_EQUAL(books[value.bidCid].getBBO().bidPx.toDouble() * (1 - bidFee), ref.bidPx);
+    BOOST_CHECK_EQUAL(books[value.askCid].getBBO().askPx.toDouble() * (1 + askFee), ref.askPx);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TestRandomUpdatesMatchResum)
+{
+    std::vector<VenueParams> params(FairValueMaxVenues);
+    params[0].weight = 1.0;
+    params[1].weight = 2.0;
+    params[1].feeBps = 4;
+    params[1].depth  = 3;
+    params[2].weight = 0.5;
+    params[2].feeBps = 2;
+    params[2].depth  = 5;
+    params[3].feeBps = 7.5;
+
+    FairValueEngine engine;
+    auto const uid = engine.addUnderlying("BTC");
+    for (int32_t cid = 0; cid < int32_t(params.size()); ++cid)
+    {
+        BOOST_REQUIRE_EQUAL(engine.addVenue(uid, cid, params[cid]), 0);
+    }
+
+    std::vector<OrderBook> books(params.size());
+    std::mt19937 rng(20211019);
+    std::uniform_int_distribution<int32_t> venue(0, int32_t(params.size()) - 1);
+    uint64_t now = 1'000'000'000;
+    for (int32_t i = 0; i < 100000; ++i)
+    {
+        auto const cid = venue(rng);
+        randomBook(rng, books[cid]);
+        engine.onBookChange(++now, cid, books[cid]);
+        checkAgainstReference(engine.get(uid), reference(books, params), books, params);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestStaleVenueDropped)
+{
+    std::vector<VenueParams> params(2);
+    params[0].staleNs   = 1000;
+    params[1].staleNs   = 1000;
+    params[1].latencyNs = 400;
+
+    FairValueEngine engine;
+    auto const uid = engine.addUnderlying("BTC");
+    engine.addVenue(uid, 0, params[0]);
+    engine.addVenue(uid, 1, params[1]);
+
+    std::vector<OrderBook> books(2);
+    PriceLevel<Price> bid[]{{Price::fromDouble(100.0), Qty::fromDouble(1.0)}};
+    PriceLevel<Price> ask[]{{Price::fromDouble(101.0), Qty::fromDouble(1.0)}};
+    for (int32_t cid = 0; cid < 2; ++cid)
+    {
+        books[cid].setLevels(Side::BUY, bid, 1);
+        books[cid].setLevels(Side::SELL, ask, 1);
+        engine.onBookChange(0, cid, books[cid]);
+    }
+    BOOST_CHECK_EQUAL(engine.get(uid).venues, 2u);
+
+    // the latency makes venue 1 stale 400ns earlier
+    engine.onTimer(700);
+    BOOST_CHECK_EQUAL(engine.get(uid).venues, 1u);
+    BOOST_CHECK_EQUAL(engine.get(uid).bidCid, 0);
+    BOOST_CHECK_EQUAL(engine.get(uid).askCid, 0);
+
+    engine.onTimer(1100);
+    BOOST_CHECK_EQUAL(engine.get(uid).venues, 0u);
+    BOOST_CHECK(std::isnan(engine.get(uid).fair));
+}